@@ -0,0 +1,218 @@
+/**********************************************************************************************
+*
+*   raylib.instance - Animated instance sets for instanced drawing
+*
+*   An InstanceSet lays out count instances on a cube grid and animates them on the CPU every
+*   frame (spin and bob with a per instance speed and phase), split in ranges across a JobPool.
+*   The result is one Matrix per instance, DrawInstanceSet() draws all of them with a single
+*   DrawMeshInstanced() call; DrawInstanceSetSingle() draws the same set with one DrawMesh()
+*   per instance, to measure what the per draw overhead costs.
+*
+*   Per instance tint: DrawMeshInstanced() only uploads the transforms, so the tint travels
+*   in their bottom row (m3, m7, m11, m15), which is (0, 0, 0, 1) for any affine transform.
+*   Instanced vertex shaders read it from instanceTransform[0..3].w and restore the row:
+*
+*       vec4 instanceTint = vec4(instanceTransform[0].w, instanceTransform[1].w, instanceTransform[2].w, instanceTransform[3].w);
+*       mat4 matInstance = instanceTransform;
+*       matInstance[0].w = 0.0; matInstance[1].w = 0.0; matInstance[2].w = 0.0; matInstance[3].w = 1.0;
+*
+*   CONFIGURATION:
+*
+*   #define RINSTANCE_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+*   DEPENDENCIES:
+*       rjobs.h     - JobPool used to update the transforms
+*
+**********************************************************************************************/
+
+#ifndef RINSTANCE_H
+#define RINSTANCE_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define INSTANCE_UPDATE_GRAIN   1024    // Instances per ParallelFor() range
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Animated instances
+typedef struct InstanceSet {
+    int count;
+    float scale;                // Uniform instance scale
+    float size;                 // Grid side length, the grid is centered on the origin
+    Matrix *transforms;         // Instance transforms, bottom row holds the tint
+    Vector3 *positions;         // Rest positions
+    Vector3 *motion;            // Phase, spin speed, bob height
+    Color *tints;
+} InstanceSet;
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+InstanceSet LoadInstanceSet(int count, float spacing, float scale);             // Lay out instances on a cube grid
+void UnloadInstanceSet(InstanceSet set);                                        // Unload instance arrays
+void UpdateInstanceSet(InstanceSet set, float time, JobPool *pool);             // Animate transforms, ranges run on pool
+void DrawInstanceSet(InstanceSet set, Mesh mesh, Material material);            // Draw all instances with one instanced draw call
+void DrawInstanceSetSingle(InstanceSet set, Mesh mesh, Material material);      // Draw instances one DrawMesh() call each
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RINSTANCE_H
+
+
+/***********************************************************************************
+*
+*   RINSTANCE IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RINSTANCE_IMPLEMENTATION)
+
+#include "raylib.h"
+#include "raymath.h"            // Required for: MatrixMultiply(), MatrixRotateXYZ(), MatrixScale(), MatrixTranslate()
+
+#include <math.h>               // Required for: sinf(), ceilf(), cbrtf()
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct {
+    InstanceSet set;
+    float time;
+} InstanceUpdate;
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static void UpdateInstanceRange(int start, int end, void *data);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Lay out instances on a cube grid centered on the origin
+// NOTE: Speeds, phases and tints only depend on the instance index, so runs are comparable
+InstanceSet LoadInstanceSet(int count, float spacing, float scale)
+{
+    InstanceSet set = { 0 };
+    if (count < 1) count = 1;
+
+    int side = (int)ceilf(cbrtf((float)count));
+
+    set.count = count;
+    set.scale = scale;
+    set.size = side*spacing;
+    set.transforms = (Matrix *)RL_CALLOC(count, sizeof(Matrix));
+    set.positions = (Vector3 *)RL_CALLOC(count, sizeof(Vector3));
+    set.motion = (Vector3 *)RL_CALLOC(count, sizeof(Vector3));
+    set.tints = (Color *)RL_CALLOC(count, sizeof(Color));
+
+    for (int i = 0; i < count; i++)
+    {
+        float x = (float)(i%side) - 0.5f*(side - 1);
+        float y = (float)((i/side)%side) - 0.5f*(side - 1);
+        float z = (float)(i/(side*side)) - 0.5f*(side - 1);
+
+        set.positions[i] = (Vector3){ x*spacing, y*spacing, z*spacing };
+        set.motion[i] = (Vector3){
+            (float)((i*7919)%1000)/1000.0f*2.0f*PI,
+            0.5f + 1.5f*(float)((i*104729)%1000)/1000.0f,
+            0.1f*spacing
+        };
+        set.tints[i] = ColorFromHSV(i*137.5f, 0.6f, 1.0f);
+    }
+
+    UpdateInstanceSet(set, 0.0f, NULL);
+
+    return set;
+}
+
+// Unload instance arrays
+void UnloadInstanceSet(InstanceSet set)
+{
+    RL_FREE(set.transforms);
+    RL_FREE(set.positions);
+    RL_FREE(set.motion);
+    RL_FREE(set.tints);
+}
+
+// Animate transforms at time, INSTANCE_UPDATE_GRAIN instances per job
+// NOTE: A NULL pool updates on the calling thread
+void UpdateInstanceSet(InstanceSet set, float time, JobPool *pool)
+{
+    InstanceUpdate update = { set, time };
+
+    if (pool == NULL) UpdateInstanceRange(0, set.count, &update);
+    else ParallelFor(pool, set.count, INSTANCE_UPDATE_GRAIN, UpdateInstanceRange, &update);
+}
+
+// Draw all instances with one instanced draw call
+// NOTE: material.shader needs an instanced vertex shader with
+// shader.locs[SHADER_LOC_MATRIX_MODEL] set to its instanceTransform attribute
+void DrawInstanceSet(InstanceSet set, Mesh mesh, Material material)
+{
+    DrawMeshInstanced(mesh, material, set.transforms, set.count);
+}
+
+// Draw instances one DrawMesh() call each, the tint goes through the material diffuse color
+void DrawInstanceSetSingle(InstanceSet set, Mesh mesh, Material material)
+{
+    Color color = material.maps[MATERIAL_MAP_DIFFUSE].color;
+
+    for (int i = 0; i < set.count; i++)
+    {
+        Matrix transform = set.transforms[i];
+        transform.m3 = 0.0f;
+        transform.m7 = 0.0f;
+        transform.m11 = 0.0f;
+        transform.m15 = 1.0f;
+
+        material.maps[MATERIAL_MAP_DIFFUSE].color = set.tints[i];
+        DrawMesh(mesh, material, transform);
+    }
+
+    material.maps[MATERIAL_MAP_DIFFUSE].color = color;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Update instance transforms of a range: spin around the instance center and bob up and down
+static void UpdateInstanceRange(int start, int end, void *data)
+{
+    const InstanceUpdate *update = (const InstanceUpdate *)data;
+    const InstanceSet *set = &update->set;
+    Matrix matScale = MatrixScale(set->scale, set->scale, set->scale);
+
+    for (int i = start; i < end; i++)
+    {
+        Vector3 motion = set->motion[i];
+        Vector3 position = set->positions[i];
+        float t = update->time*motion.y + motion.x;
+
+        Matrix matRotation = MatrixRotateXYZ((Vector3){ t, 0.7f*t, 0.0f });
+        Matrix matTranslation = MatrixTranslate(position.x, position.y + motion.z*sinf(t), position.z);
+        Matrix transform = MatrixMultiply(MatrixMultiply(matScale, matRotation), matTranslation);
+
+        Color tint = set->tints[i];
+        transform.m3 = tint.r/255.0f;
+        transform.m7 = tint.g/255.0f;
+        transform.m11 = tint.b/255.0f;
+        transform.m15 = tint.a/255.0f;
+
+        set->transforms[i] = transform;
+    }
+}
+
+#endif // RINSTANCE_IMPLEMENTATION
\ No newline at end of file
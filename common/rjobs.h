@@ -0,0 +1,529 @@
+/**********************************************************************************************
+*
+*   raylib.jobs - Minimal worker thread pool
+*
+*   Jobs are plain function pointers pushed into a FIFO queue consumed by a fixed set of
+*   worker threads. Jobs can be tracked in groups, waiting on a group makes the calling
+*   thread run queued jobs until the group is done, so the caller is never idle and nested
+*   ParallelFor() calls can not deadlock the pool.
+*
+*   CONFIGURATION:
+*
+*   #define RJOBS_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+*   NOTE: Jobs are recorded as profiler scopes when rprof.h is included before this file
+*   NOTE: Workers are pthreads, Win32 threads on _WIN32 (MSVC has no pthreads)
+*   NOTE: On PLATFORM_WEB (no pthreads) or with a pool of 0 threads, jobs run inline
+*
+**********************************************************************************************/
+
+#ifndef RJOBS_H
+#define RJOBS_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define JOBS_MAX_THREADS        64      // Max worker threads in a pool
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef void (*JobFunc)(void *data);                                // Job entry point
+typedef void (*JobRangeFunc)(int start, int end, void *data);       // ParallelFor() range entry point
+
+// Group of jobs that can be waited on together
+// NOTE: Only modified while holding the pool lock
+typedef struct JobGroup {
+    int pending;
+} JobGroup;
+
+typedef struct JobPool JobPool;
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+int GetCpuCoreCount(void);                                          // Get number of online CPU cores
+JobPool *LoadJobPool(int threadCount);                              // Start a pool (threadCount < 0: one per core minus the caller)
+void UnloadJobPool(JobPool *pool);                                  // Wait for queued jobs and stop workers
+int GetJobPoolThreadCount(const JobPool *pool);                     // Get number of worker threads
+
+void SubmitJob(JobPool *pool, JobFunc func, void *data, JobGroup *group);   // Queue a job, group is optional
+void WaitJobGroup(JobPool *pool, JobGroup *group);                  // Run queued jobs until group is done
+bool IsJobGroupDone(JobPool *pool, JobGroup *group);                // Check group is done without waiting
+void ParallelFor(JobPool *pool, int count, int grainSize, JobRangeFunc func, void *data);  // Split [0, count) in ranges and wait
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RJOBS_H
+
+
+/***********************************************************************************
+*
+*   RJOBS IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RJOBS_IMPLEMENTATION)
+
+#include "raylib.h"
+
+#if defined(_WIN32)
+    // NOTE: Leave out the windows.h parts whose names clash with raylib (Rectangle, CloseWindow(), DrawText()...)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOGDI
+    #define NOUSER
+    #define NOMINMAX
+    #include <windows.h>        // Required for: CreateThread(), SRWLOCK, CONDITION_VARIABLE, GetSystemInfo()
+    #define JOBS_THREADED
+#else
+    #include <unistd.h>         // Required for: sysconf()
+    #if !defined(PLATFORM_WEB)
+        #include <pthread.h>    // Required for: pthread_create(), pthread_mutex_*(), pthread_cond_*()
+        #define JOBS_THREADED
+    #endif
+#endif
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct {
+    JobFunc func;
+    void *data;
+    JobGroup *group;
+} Job;
+
+#if defined(_WIN32)
+typedef HANDLE JobThread;
+typedef SRWLOCK JobMutex;
+typedef CONDITION_VARIABLE JobCondition;
+#elif defined(JOBS_THREADED)
+typedef pthread_t JobThread;
+typedef pthread_mutex_t JobMutex;
+typedef pthread_cond_t JobCondition;
+#endif
+
+struct JobPool {
+    int threadCount;
+    bool running;
+
+    Job *queue;                 // Ring buffer of queued jobs
+    int queueCapacity;
+    int queueHead;
+    int queueCount;
+
+#if defined(JOBS_THREADED)
+    JobThread threads[JOBS_MAX_THREADS];
+    JobMutex lock;
+    JobCondition jobAvailable;
+    JobCondition jobDone;
+#endif
+};
+
+// Range of a ParallelFor() call
+typedef struct {
+    JobRangeFunc func;
+    void *data;
+    int start;
+    int end;
+} JobRange;
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+#if defined(JOBS_THREADED)
+static void PushJob(JobPool *pool, Job job);
+static bool PopJob(JobPool *pool, Job *job);
+static void FinishJob(JobPool *pool, Job job);
+static void *WorkerThread(void *arg);
+static void RunJob(Job job);
+
+static void InitPoolSync(JobPool *pool);                        // Init pool lock and conditions
+static void ClosePoolSync(JobPool *pool);                       // Destroy pool lock and conditions
+static bool StartWorker(JobPool *pool, int index);              // Start worker thread running WorkerThread()
+static void JoinWorker(JobPool *pool, int index);               // Wait for worker thread to exit
+static void LockPool(JobPool *pool);
+static void UnlockPool(JobPool *pool);
+static void WaitCondition(JobPool *pool, JobCondition *condition);  // Pool lock must be held
+static void WakeCondition(JobCondition *condition, bool all);
+#endif
+static void RunJobRange(void *data);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Get number of online CPU cores
+int GetCpuCoreCount(void)
+{
+    int count = 1;
+
+#if defined(_WIN32)
+    SYSTEM_INFO info = { 0 };
+    GetSystemInfo(&info);
+    count = (int)info.dwNumberOfProcessors;
+#else
+    count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    return (count > 0)? count : 1;
+}
+
+// Start a pool with the requested worker threads
+// NOTE: threadCount < 0 starts one thread per core minus one, the caller thread helps when waiting
+JobPool *LoadJobPool(int threadCount)
+{
+    JobPool *pool = (JobPool *)RL_CALLOC(1, sizeof(JobPool));
+
+    if (threadCount < 0) threadCount = GetCpuCoreCount() - 1;
+    if (threadCount > JOBS_MAX_THREADS) threadCount = JOBS_MAX_THREADS;
+#if !defined(JOBS_THREADED)
+    threadCount = 0;
+#endif
+
+    pool->running = true;
+    pool->queueCapacity = 64;
+    pool->queue = (Job *)RL_CALLOC(pool->queueCapacity, sizeof(Job));
+
+#if defined(JOBS_THREADED)
+    InitPoolSync(pool);
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        if (!StartWorker(pool, i)) break;
+        pool->threadCount++;
+    }
+#endif
+
+    TraceLog(LOG_INFO, "JOBS: Pool started with %i worker threads", pool->threadCount);
+
+    return pool;
+}
+
+// Wait for queued jobs and stop workers
+void UnloadJobPool(JobPool *pool)
+{
+    if (pool == NULL) return;
+
+#if defined(JOBS_THREADED)
+    LockPool(pool);
+    pool->running = false;
+    WakeCondition(&pool->jobAvailable, true);
+    UnlockPool(pool);
+
+    for (int i = 0; i < pool->threadCount; i++) JoinWorker(pool, i);
+
+    ClosePoolSync(pool);
+#endif
+
+    RL_FREE(pool->queue);
+    RL_FREE(pool);
+}
+
+// Get number of worker threads
+int GetJobPoolThreadCount(const JobPool *pool)
+{
+    return (pool != NULL)? pool->threadCount : 0;
+}
+
+// Queue a job, group is optional and gets its pending count increased
+void SubmitJob(JobPool *pool, JobFunc func, void *data, JobGroup *group)
+{
+    if ((pool == NULL) || (pool->threadCount == 0))
+    {
+        // No workers: run inline
+        func(data);
+        return;
+    }
+
+#if defined(JOBS_THREADED)
+    Job job = { func, data, group };
+
+    LockPool(pool);
+    if (group != NULL) group->pending++;
+    PushJob(pool, job);
+    WakeCondition(&pool->jobAvailable, false);
+    UnlockPool(pool);
+#endif
+}
+
+// Run queued jobs on the calling thread until all jobs in group are done
+void WaitJobGroup(JobPool *pool, JobGroup *group)
+{
+    if ((pool == NULL) || (pool->threadCount == 0) || (group == NULL)) return;
+
+#if defined(JOBS_THREADED)
+    LockPool(pool);
+
+    while (group->pending > 0)
+    {
+        Job job = { 0 };
+
+        if (PopJob(pool, &job))
+        {
+            UnlockPool(pool);
+            RunJob(job);
+            LockPool(pool);
+            FinishJob(pool, job);
+        }
+        else WaitCondition(pool, &pool->jobDone);
+    }
+
+    UnlockPool(pool);
+#endif
+}
+
+// Check all jobs in group are done, never blocks on running jobs
+bool IsJobGroupDone(JobPool *pool, JobGroup *group)
+{
+    if ((pool == NULL) || (pool->threadCount == 0) || (group == NULL)) return true;
+
+    bool done = true;
+
+#if defined(JOBS_THREADED)
+    LockPool(pool);
+    done = (group->pending == 0);
+    UnlockPool(pool);
+#endif
+
+    return done;
+}
+
+// Split [0, count) in ranges of at least grainSize items, run them on the pool and wait
+void ParallelFor(JobPool *pool, int count, int grainSize, JobRangeFunc func, void *data)
+{
+    if (count <= 0) return;
+    if (grainSize < 1) grainSize = 1;
+
+    int workers = GetJobPoolThreadCount(pool) + 1;
+    int rangeCount = (count + grainSize - 1)/grainSize;
+    if (rangeCount > workers*4) rangeCount = workers*4;     // A few ranges per worker for load balancing
+
+    if (rangeCount <= 1)
+    {
+        func(0, count, data);
+        return;
+    }
+
+    JobRange *ranges = (JobRange *)RL_MALLOC(rangeCount*sizeof(JobRange));
+    JobGroup group = { 0 };
+
+    for (int i = 0; i < rangeCount; i++)
+    {
+        ranges[i] = (JobRange){ func, data, (int)((long long)count*i/rangeCount), (int)((long long)count*(i + 1)/rangeCount) };
+        SubmitJob(pool, RunJobRange, &ranges[i], &group);
+    }
+
+    WaitJobGroup(pool, &group);
+
+    RL_FREE(ranges);
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+#if defined(JOBS_THREADED)
+// Push job into the ring buffer, growing it when full
+// NOTE: Pool lock must be held
+static void PushJob(JobPool *pool, Job job)
+{
+    if (pool->queueCount == pool->queueCapacity)
+    {
+        int capacity = pool->queueCapacity*2;
+        Job *queue = (Job *)RL_CALLOC(capacity, sizeof(Job));
+
+        for (int i = 0; i < pool->queueCount; i++) queue[i] = pool->queue[(pool->queueHead + i)%pool->queueCapacity];
+
+        RL_FREE(pool->queue);
+        pool->queue = queue;
+        pool->queueCapacity = capacity;
+        pool->queueHead = 0;
+    }
+
+    pool->queue[(pool->queueHead + pool->queueCount)%pool->queueCapacity] = job;
+    pool->queueCount++;
+}
+
+// Pop oldest job from the ring buffer
+// NOTE: Pool lock must be held
+static bool PopJob(JobPool *pool, Job *job)
+{
+    if (pool->queueCount == 0) return false;
+
+    *job = pool->queue[pool->queueHead];
+    pool->queueHead = (pool->queueHead + 1)%pool->queueCapacity;
+    pool->queueCount--;
+
+    return true;
+}
+
+// Mark job as done and wake up waiters
+// NOTE: Pool lock must be held
+static void FinishJob(JobPool *pool, Job job)
+{
+    if (job.group != NULL) job.group->pending--;
+
+    WakeCondition(&pool->jobDone, true);
+}
+
+// Worker thread loop, runs jobs until the pool is stopped and the queue is empty
+static void *WorkerThread(void *arg)
+{
+    JobPool *pool = (JobPool *)arg;
+
+#if defined(RPROF_H)
+    ProfSetThreadName("Worker");
+#endif
+
+    LockPool(pool);
+
+    while (true)
+    {
+        Job job = { 0 };
+
+        if (PopJob(pool, &job))
+        {
+            UnlockPool(pool);
+            RunJob(job);
+            LockPool(pool);
+            FinishJob(pool, job);
+        }
+        else if (pool->running) WaitCondition(pool, &pool->jobAvailable);
+        else break;
+    }
+
+    UnlockPool(pool);
+
+    return NULL;
+}
+
+// Run a popped job, recorded as a profiler scope when rprof.h is included before this file
+static void RunJob(Job job)
+{
+#if defined(RPROF_H)
+    ProfBeginScope("Job");
+#endif
+
+    job.func(job.data);
+
+#if defined(RPROF_H)
+    ProfEndScope();
+#endif
+}
+
+#if defined(_WIN32)
+// Win32 thread entry, runs the worker loop
+static DWORD WINAPI WorkerThreadWin32(LPVOID arg)
+{
+    WorkerThread(arg);
+    return 0;
+}
+
+// SRW locks and condition variables need no destruction
+static void InitPoolSync(JobPool *pool)
+{
+    InitializeSRWLock(&pool->lock);
+    InitializeConditionVariable(&pool->jobAvailable);
+    InitializeConditionVariable(&pool->jobDone);
+}
+
+static void ClosePoolSync(JobPool *pool)
+{
+    (void)pool;
+}
+
+static bool StartWorker(JobPool *pool, int index)
+{
+    pool->threads[index] = CreateThread(NULL, 0, WorkerThreadWin32, pool, 0, NULL);
+    return (pool->threads[index] != NULL);
+}
+
+static void JoinWorker(JobPool *pool, int index)
+{
+    WaitForSingleObject(pool->threads[index], INFINITE);
+    CloseHandle(pool->threads[index]);
+}
+
+static void LockPool(JobPool *pool)
+{
+    AcquireSRWLockExclusive(&pool->lock);
+}
+
+static void UnlockPool(JobPool *pool)
+{
+    ReleaseSRWLockExclusive(&pool->lock);
+}
+
+static void WaitCondition(JobPool *pool, JobCondition *condition)
+{
+    SleepConditionVariableSRW(condition, &pool->lock, INFINITE, 0);
+}
+
+static void WakeCondition(JobCondition *condition, bool all)
+{
+    if (all) WakeAllConditionVariable(condition);
+    else WakeConditionVariable(condition);
+}
+#else
+static void InitPoolSync(JobPool *pool)
+{
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->jobAvailable, NULL);
+    pthread_cond_init(&pool->jobDone, NULL);
+}
+
+static void ClosePoolSync(JobPool *pool)
+{
+    pthread_cond_destroy(&pool->jobDone);
+    pthread_cond_destroy(&pool->jobAvailable);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+static bool StartWorker(JobPool *pool, int index)
+{
+    return (pthread_create(&pool->threads[index], NULL, WorkerThread, pool) == 0);
+}
+
+static void JoinWorker(JobPool *pool, int index)
+{
+    pthread_join(pool->threads[index], NULL);
+}
+
+static void LockPool(JobPool *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+}
+
+static void UnlockPool(JobPool *pool)
+{
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void WaitCondition(JobPool *pool, JobCondition *condition)
+{
+    pthread_cond_wait(condition, &pool->lock);
+}
+
+static void WakeCondition(JobCondition *condition, bool all)
+{
+    if (all) pthread_cond_broadcast(condition);
+    else pthread_cond_signal(condition);
+}
+#endif
+#endif
+
+static void RunJobRange(void *data)
+{
+    JobRange *range = (JobRange *)data;
+    range->func(range->start, range->end, range->data);
+}
+
+#endif // RJOBS_IMPLEMENTATION
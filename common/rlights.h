@@ -0,0 +1,305 @@
+/**********************************************************************************************
+*
+*   raylib.lights - Some useful functions to deal with lights data
+*
+*   Lights live in one std140 uniform buffer shared by every shader that declares the
+*   LightBlock uniform block, so a light is stored once no matter how many shaders use it.
+*   UpdateLightValues() only stores the light on the CPU side and marks it dirty when it
+*   changed; UploadLights() sends the dirty ranges once per frame, unchanged lights cost
+*   nothing. Shaders loop over lightCount, not MAX_LIGHTS.
+*
+*   NOTE: Modified from the raylib example version: uniform buffer instead of per field
+*   SetShaderValue() calls, lights are no longer tied to one shader
+*
+*   CONFIGURATION:
+*
+*   #define RLIGHTS_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+*   #define MAX_LIGHTS
+*       Light buffer capacity, must match MAX_LIGHTS in the shaders (default 128, the 16 KB
+*       GL_MAX_UNIFORM_BLOCK_SIZE every GL 3.3 driver supports fits 255 lights)
+*
+*   LICENSE: zlib/libpng
+*
+*   Copyright (c) 2017-2024 Victor Fisac (@victorfisac) and Ramon Santamaria (@raysan5)
+*
+*   This software is provided "as-is", without any express or implied warranty. In no event
+*   will the authors be held liable for any damages arising from the use of this software.
+*
+*   Permission is granted to anyone to use this software for any purpose, including commercial
+*   applications, and to alter it and redistribute it freely, subject to the following restrictions:
+*
+*     1. The origin of this software must not be misrepresented; you must not claim that you
+*     wrote the original software. If you use this software in a product, an acknowledgment
+*     in the product documentation would be appreciated but is not required.
+*
+*     2. Altered source versions must be plainly marked as such, and must not be misrepresented
+*     as being the original software.
+*
+*     3. This notice may not be removed or altered from any source distribution.
+*
+**********************************************************************************************/
+
+#ifndef RLIGHTS_H
+#define RLIGHTS_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#if !defined(MAX_LIGHTS)
+    #define MAX_LIGHTS  128         // Max dynamic lights supported by shader
+#endif
+#define LIGHTS_BLOCK_NAME       "LightBlock"    // Uniform block name in shaders
+#define LIGHTS_BLOCK_BINDING    0               // Uniform buffer binding point
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+
+// Light data
+typedef struct {
+    int type;
+    bool enabled;
+    Vector3 position;
+    Vector3 target;
+    Color color;
+    float intensity;
+    float radius;               // Point light range, 0 for no cutoff
+
+    int index;                  // Slot in the light buffer
+} Light;
+
+// Light type
+typedef enum {
+    LIGHT_DIRECTIONAL = 0,
+    LIGHT_POINT
+} LightType;
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+bool LoadLights(void);                                      // Create light uniform buffer (requires GL context)
+void UnloadLights(void);                                    // Unload light uniform buffer
+void SetShaderLights(Shader shader);                        // Bind shader LightBlock to the light buffer
+Light CreateLight(int type, Vector3 position, Vector3 target, Color color, float intensity);    // Create a light in the next buffer slot
+void UpdateLightValues(Light light);                        // Store light properties, marks the light dirty if they changed
+int UploadLights(void);                                     // Upload dirty light ranges, returns uploaded bytes
+int GetLightCount(void);                                    // Get number of created lights
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RLIGHTS_H
+
+
+/***********************************************************************************
+*
+*   RLIGHTS IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RLIGHTS_IMPLEMENTATION)
+
+#include "raylib.h"
+
+#if defined(PLATFORM_DESKTOP)
+    // NOTE: Uniform buffers are not exposed by rlgl
+    #include "external/glad.h"
+#endif
+
+#include <string.h>             // Required for: memcmp(), memset()
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define LIGHTS_HEADER_SIZE      16          // lightCount, padded to the std140 struct array alignment
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Light in std140 layout (64 bytes), matches struct Light in the shaders
+typedef struct {
+    int enabled;
+    int type;
+    float intensity;
+    float radius;
+    float position[4];
+    float target[4];
+    float color[4];
+} LightData;
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static int lightsCount = 0;                     // Current amount of created lights
+static unsigned int lightsBuffer = 0;           // Uniform buffer id
+static LightData lightsData[MAX_LIGHTS] = { 0 };    // CPU copy of the buffer lights
+static bool lightsDirty[MAX_LIGHTS] = { 0 };    // Lights changed since last upload
+static bool lightsCountDirty = false;           // Light count changed since last upload
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+// ...
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Create light uniform buffer and bind it to LIGHTS_BLOCK_BINDING
+bool LoadLights(void)
+{
+#if defined(PLATFORM_DESKTOP)
+    glGenBuffers(1, &lightsBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, lightsBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, LIGHTS_HEADER_SIZE + MAX_LIGHTS*sizeof(LightData), NULL, GL_DYNAMIC_DRAW);
+
+    // Start from a known state, disabled lights and zero count
+    unsigned char header[LIGHTS_HEADER_SIZE] = { 0 };
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, LIGHTS_HEADER_SIZE, header);
+    glBufferSubData(GL_UNIFORM_BUFFER, LIGHTS_HEADER_SIZE, sizeof(lightsData), lightsData);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, LIGHTS_BLOCK_BINDING, lightsBuffer);
+
+    TraceLog(LOG_INFO, "LIGHTS: [ID %i] Light buffer loaded (%i lights | %i bytes)", lightsBuffer, MAX_LIGHTS, LIGHTS_HEADER_SIZE + MAX_LIGHTS*(int)sizeof(LightData));
+
+    return true;
+#else
+    TraceLog(LOG_WARNING, "LIGHTS: Uniform buffers not supported on this platform");
+
+    return false;
+#endif
+}
+
+// Unload light uniform buffer
+void UnloadLights(void)
+{
+#if defined(PLATFORM_DESKTOP)
+    if (lightsBuffer != 0) glDeleteBuffers(1, &lightsBuffer);
+#endif
+    lightsBuffer = 0;
+    lightsCount = 0;
+    memset(lightsData, 0, sizeof(lightsData));
+    memset(lightsDirty, 0, sizeof(lightsDirty));
+}
+
+// Bind shader LightBlock to the light buffer
+// NOTE: Every shader using the lights needs this once after loading
+void SetShaderLights(Shader shader)
+{
+#if defined(PLATFORM_DESKTOP)
+    unsigned int blockIndex = glGetUniformBlockIndex(shader.id, LIGHTS_BLOCK_NAME);
+
+    if (blockIndex != GL_INVALID_INDEX) glUniformBlockBinding(shader.id, blockIndex, LIGHTS_BLOCK_BINDING);
+    else TraceLog(LOG_WARNING, "SHADER: [ID %i] Uniform block %s not found", shader.id, LIGHTS_BLOCK_NAME);
+#else
+    (void)shader;
+#endif
+}
+
+// Create a light in the next buffer slot
+Light CreateLight(int type, Vector3 position, Vector3 target, Color color, float intensity)
+{
+    Light light = { 0 };
+
+    if (lightsCount < MAX_LIGHTS)
+    {
+        light.enabled = true;
+        light.type = type;
+        light.position = position;
+        light.target = target;
+        light.color = color;
+        light.intensity = intensity;
+        light.index = lightsCount;
+
+        lightsCount++;
+        lightsCountDirty = true;
+
+        UpdateLightValues(light);
+    }
+    else TraceLog(LOG_WARNING, "LIGHTS: Light buffer full (%i lights)", MAX_LIGHTS);
+
+    return light;
+}
+
+// Store light properties, marks the light dirty if they changed
+// NOTE: Cheap enough to call every frame, the buffer is only written by UploadLights()
+void UpdateLightValues(Light light)
+{
+    if ((light.index < 0) || (light.index >= lightsCount)) return;
+
+    LightData data = { 0 };
+    data.enabled = light.enabled? 1 : 0;
+    data.type = light.type;
+    data.intensity = light.intensity;
+    data.radius = light.radius;
+    data.position[0] = light.position.x;
+    data.position[1] = light.position.y;
+    data.position[2] = light.position.z;
+    data.target[0] = light.target.x;
+    data.target[1] = light.target.y;
+    data.target[2] = light.target.z;
+    data.color[0] = (float)light.color.r/255.0f;
+    data.color[1] = (float)light.color.g/255.0f;
+    data.color[2] = (float)light.color.b/255.0f;
+    data.color[3] = (float)light.color.a/255.0f;
+
+    if (memcmp(&lightsData[light.index], &data, sizeof(LightData)) != 0)
+    {
+        lightsData[light.index] = data;
+        lightsDirty[light.index] = true;
+    }
+}
+
+// Upload dirty light ranges, consecutive dirty lights are sent with one call
+// NOTE: Call once per frame before drawing, returns uploaded bytes
+int UploadLights(void)
+{
+    int uploaded = 0;
+
+#if defined(PLATFORM_DESKTOP)
+    if (lightsBuffer == 0) return 0;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, lightsBuffer);
+
+    if (lightsCountDirty)
+    {
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(int), &lightsCount);
+        uploaded += sizeof(int);
+        lightsCountDirty = false;
+    }
+
+    for (int i = 0; i < lightsCount; i++)
+    {
+        if (!lightsDirty[i]) continue;
+
+        int first = i;
+        while ((i < lightsCount) && lightsDirty[i]) lightsDirty[i++] = false;
+
+        int size = (i - first)*(int)sizeof(LightData);
+        glBufferSubData(GL_UNIFORM_BUFFER, LIGHTS_HEADER_SIZE + first*sizeof(LightData), size, &lightsData[first]);
+        uploaded += size;
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+#endif
+
+    return uploaded;
+}
+
+// Get number of created lights
+int GetLightCount(void)
+{
+    return lightsCount;
+}
+
+#endif // RLIGHTS_IMPLEMENTATION
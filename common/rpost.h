@@ -0,0 +1,578 @@
+/**********************************************************************************************
+*
+*   raylib.post - HDR scene target and single pass post-process chain
+*
+*   The 3D scene is rendered into a floating point target (RGBA16F) instead of the window,
+*   so lighting keeps values above 1.0 and shaders write linear color. With samples > 1 the
+*   scene is rendered into multisampled renderbuffers and resolved into the target, MSAA
+*   works as it did on the window framebuffer.
+*
+*   Screen effects (tonemap, gamma, grayscale, color grade) are added to a chain in the order
+*   they run, and the whole chain is compiled into one fragment shader (see GetPostShaderDefines()):
+*   every effect is a function of post.frag and the chain is a macro calling them in order.
+*   DrawPostProcess() draws the scene target through that shader once, so every effect runs
+*   once per pixel, not for every shaded fragment that is later overdrawn.
+*
+*   Dynamic resolution: the scene can be rendered into the lower left part of the target, scale
+*   times the target size, and DrawPostProcess() upscales it with bilinear filtering and a
+*   sharpening filter. With a budget set (SetPostDynamicResolution()) the scene GPU time is measured
+*   with timestamp queries, read POST_SCALE_LATENCY frames later so nothing stalls, and the scale
+*   moves in POST_SCALE_STEP steps: down as soon as the scene goes over budget, up when the next step
+*   is expected to fit with POST_SCALE_HEADROOM to spare. Every change is logged. Whatever is drawn
+*   after DrawPostProcess() (text, HUD) stays at the full resolution.
+*
+*   Chain shaders that declare sceneDepth also write the scene depth into the current framebuffer,
+*   so 3D drawn after DrawPostProcess() (grid, light markers) is hidden by the scene while its
+*   colors skip the effect chain.
+*
+*   CONFIGURATION:
+*
+*   #define RPOST_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+*   NOTE: Float render targets and multisampled renderbuffers are not exposed by rlgl,
+*   on other platforms LoadPostProcess() returns NULL and shaders keep writing display color
+*
+**********************************************************************************************/
+
+#ifndef RPOST_H
+#define RPOST_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define POST_MAX_EFFECTS        8           // Effects in one chain
+#define POST_SCALE_STEP         0.05f       // Dynamic resolution scale increment
+#define POST_SCALE_LATENCY      4           // Frames before scene GPU times are read
+#define POST_SCALE_SAMPLES      8           // Scene GPU times averaged at a scale before changing it
+#define POST_SCALE_HEADROOM     0.85f       // Fraction of the budget the scale aims for
+#define POST_SHARPNESS          0.5f        // Default sharpening of upscaled scenes
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Post-process effects, every effect is a function in post.frag
+typedef enum {
+    POST_TONEMAP = 0,           // HDR to display range: pow(color, color + 1)
+    POST_GAMMA,                 // Linear to gamma 2.2
+    POST_GRAYSCALE,             // NTSC luminance
+    POST_COLOR_GRADE            // Exposure, tint, saturation and contrast (see PostGrade)
+} PostEffect;
+
+// Color grade parameters, the defaults leave color unchanged
+typedef struct PostGrade {
+    float exposure;             // Color scale
+    Vector3 tint;               // Per channel scale (white balance)
+    float saturation;           // 0.0 gray, 1.0 unchanged
+    float contrast;             // Around linear middle gray, 1.0 unchanged
+} PostGrade;
+
+// Scene resolution, scaled by the dynamic resolution controller
+typedef struct PostResolution {
+    float scale;                // Fraction of the target size on each axis
+    int width;                  // Scene pixels rendered
+    int height;
+    double sceneTime;           // Seconds the GPU spent on the scene (smoothed), 0 until measured
+    double budget;              // Scene GPU time budget in seconds, 0 with a fixed scale
+} PostResolution;
+
+typedef struct PostProcess PostProcess;
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+PostProcess *LoadPostProcess(int width, int height, int samples);   // Load HDR scene target, samples > 1 enables MSAA (requires GL context)
+void UnloadPostProcess(PostProcess *post);                          // Unload scene target
+void AddPostEffect(PostProcess *post, PostEffect effect);          // Append effect to the chain, load the chain shader after the last one
+const char *GetPostShaderDefines(const PostProcess *post);          // Get shader #define block of the effect chain
+void SetPostShader(PostProcess *post, Shader shader);               // Set chain shader, also after it was reloaded
+void SetPostGrade(PostProcess *post, PostGrade grade);              // Set color grade parameters
+void SetPostScale(PostProcess *post, float scale);                  // Set scene resolution scale (0.0..1.0]
+void SetPostSharpness(PostProcess *post, float sharpness);          // Set sharpening of upscaled scenes, 0.0 disables
+void SetPostDynamicResolution(PostProcess *post, double budget, float minScale);    // Scale scene resolution to hold GPU time under budget seconds (0 disables)
+PostResolution GetPostResolution(const PostProcess *post);          // Get scene resolution and measured GPU time
+void BeginPostScene(PostProcess *post);                             // Render to the HDR scene target
+void EndPostScene(PostProcess *post);                               // Resolve scene target and return to the previous framebuffer
+void DrawPostProcess(PostProcess *post);                            // Draw scene target through the effect chain, one pass
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RPOST_H
+
+
+/***********************************************************************************
+*
+*   RPOST IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RPOST_IMPLEMENTATION)
+
+#include "raylib.h"
+#include "rlgl.h"
+
+#if defined(PLATFORM_DESKTOP)
+    // NOTE: Float color targets, multisampled renderbuffers and blits are not exposed by rlgl
+    #include "external/glad.h"
+#endif
+
+#include <string.h>             // Required for: strcat()
+#include <math.h>               // Required for: sqrtf(), floorf(), roundf(), fminf(), fmaxf()
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+struct PostProcess {
+    int width;
+    int height;
+    int samples;                // 1 when the scene is rendered into the target directly
+
+    unsigned int framebuffer;   // Resolved scene target
+    unsigned int texture;       // RGBA16F scene color, read by the chain
+    unsigned int depth;         // Depth texture (single sample), read by the chain shader
+    unsigned int msaaFramebuffer;
+    unsigned int msaaColor;
+    unsigned int msaaDepth;
+
+    int effects[POST_MAX_EFFECTS];
+    int effectCount;
+
+    Shader shader;
+    int exposureLoc;
+    int tintLoc;
+    int saturationLoc;
+    int contrastLoc;
+    int texelLoc;
+    int sharpnessLoc;
+    int depthLoc;               // sceneDepth sampler, -1 when the chain shader does not write depth
+    PostGrade grade;
+    bool gradeDirty;            // Grade uniforms not uploaded yet
+
+    float scale;                // Scene resolution scale, the scene fills scaleWidth x scaleHeight
+    int scaleWidth;
+    int scaleHeight;
+    float sharpness;
+    bool scaleDirty;            // Upscale uniforms not uploaded yet
+
+    double budget;              // Scene GPU time budget, 0 keeps the scale
+    float minScale;
+    double sceneTime;           // Smoothed scene GPU time at the current scale
+    int sceneSamples;           // GPU times averaged into sceneTime
+    unsigned int queries[POST_SCALE_LATENCY][2];    // Scene begin and end timestamps
+    float queryScale[POST_SCALE_LATENCY];           // Scale the queries were written at, 0 when unused
+    unsigned int frame;
+
+    int previousFramebuffer;    // Framebuffer bound at BeginPostScene()
+    int previousViewport[4];
+    int previousSize[2];        // rlgl framebuffer size at BeginPostScene()
+};
+
+//----------------------------------------------------------------------------------
+// Module Internal Functions Declaration
+//----------------------------------------------------------------------------------
+static void UpdatePostScale(PostProcess *post);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Load HDR scene target of width x height pixels
+// NOTE: samples is clamped to GL_MAX_SAMPLES, without float targets NULL is returned
+PostProcess *LoadPostProcess(int width, int height, int samples)
+{
+#if defined(PLATFORM_DESKTOP)
+    PostProcess *post = (PostProcess *)RL_CALLOC(1, sizeof(PostProcess));
+
+    int maxSamples = 1;
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+    if (samples > maxSamples) samples = maxSamples;
+    if (samples < 1) samples = 1;
+
+    post->width = width;
+    post->height = height;
+    post->samples = samples;
+    post->grade = (PostGrade){ 1.0f, (Vector3){ 1.0f, 1.0f, 1.0f }, 1.0f, 1.0f };
+    post->gradeDirty = true;
+    post->sharpness = POST_SHARPNESS;
+    SetPostScale(post, 1.0f);
+
+    // Resolved target, no mipmaps, bilinear filtering upscales scenes rendered at a lower scale
+    glGenTextures(1, &post->texture);
+    glBindTexture(GL_TEXTURE_2D, post->texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_HALF_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &post->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, post->framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, post->texture, 0);
+
+    // Depth is a texture even with MSAA, multisampled depth is resolved into it for the chain shader
+    glGenTextures(1, &post->depth);
+    glBindTexture(GL_TEXTURE_2D, post->depth);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, post->depth, 0);
+
+    bool complete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+
+    if (complete && (samples > 1))
+    {
+        // Scene is rendered multisampled and resolved into the target at EndPostScene()
+        glGenRenderbuffers(1, &post->msaaColor);
+        glBindRenderbuffer(GL_RENDERBUFFER, post->msaaColor);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA16F, width, height);
+
+        glGenRenderbuffers(1, &post->msaaDepth);
+        glBindRenderbuffer(GL_RENDERBUFFER, post->msaaDepth);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH_COMPONENT24, width, height);
+
+        glGenFramebuffers(1, &post->msaaFramebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, post->msaaFramebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, post->msaaColor);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, post->msaaDepth);
+
+        complete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    }
+
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!complete)
+    {
+        TraceLog(LOG_WARNING, "POST: Float render target not supported, post-process disabled");
+        UnloadPostProcess(post);
+        return NULL;
+    }
+
+    for (int i = 0; i < POST_SCALE_LATENCY; i++) glGenQueries(2, post->queries[i]);
+
+    long long bytes = (long long)width*height*12*((samples > 1)? samples + 1 : 1);     // Color and depth, MSAA and resolved
+    TraceLog(LOG_INFO, "POST: HDR scene target loaded (%ix%i | RGBA16F | %i samples | %.1f MB)", width, height, samples, bytes/(1024.0*1024.0));
+
+    return post;
+#else
+    TraceLog(LOG_WARNING, "POST: Float render targets not supported on this platform");
+    return NULL;
+#endif
+}
+
+// Unload scene target
+// NOTE: The chain shader belongs to the caller
+void UnloadPostProcess(PostProcess *post)
+{
+    if (post == NULL) return;
+
+#if defined(PLATFORM_DESKTOP)
+    if (post->msaaFramebuffer != 0) glDeleteFramebuffers(1, &post->msaaFramebuffer);
+    if (post->msaaColor != 0) glDeleteRenderbuffers(1, &post->msaaColor);
+    if (post->msaaDepth != 0) glDeleteRenderbuffers(1, &post->msaaDepth);
+    if (post->framebuffer != 0) glDeleteFramebuffers(1, &post->framebuffer);
+    if (post->depth != 0) glDeleteTextures(1, &post->depth);
+    if (post->texture != 0) glDeleteTextures(1, &post->texture);
+    if (post->queries[0][0] != 0) for (int i = 0; i < POST_SCALE_LATENCY; i++) glDeleteQueries(2, post->queries[i]);
+#endif
+
+    RL_FREE(post);
+}
+
+// Append effect to the chain, effects run in the order they were added
+// NOTE: The chain is compiled into the shader, changing it requires loading the shader again
+void AddPostEffect(PostProcess *post, PostEffect effect)
+{
+    if (post == NULL) return;
+
+    if (post->effectCount >= POST_MAX_EFFECTS)
+    {
+        TraceLog(LOG_WARNING, "POST: Effect chain full (%i effects)", POST_MAX_EFFECTS);
+        return;
+    }
+
+    post->effects[post->effectCount++] = effect;
+}
+
+// Get shader #define block of the effect chain, pass it to the post.frag loader
+// NOTE: POST_CHAIN(color) applies every effect function in chain order to color
+const char *GetPostShaderDefines(const PostProcess *post)
+{
+    static const char *calls[] = { " color = Tonemap(color);", " color = Gamma(color);", " color = Grayscale(color);", " color = ColorGrade(color);" };
+    static char defines[512] = { 0 };
+
+    strcpy(defines, "#define POST_CHAIN(color)");
+    if (post != NULL)
+    {
+        for (int i = 0; i < post->effectCount; i++) strcat(defines, calls[post->effects[i]]);
+    }
+    strcat(defines, "\n");
+
+    return defines;
+}
+
+// Set chain shader, loaded from post.vert/post.frag with GetPostShaderDefines()
+// NOTE: Call again after the shader was reloaded, grade uniforms are uploaded again
+void SetPostShader(PostProcess *post, Shader shader)
+{
+    if (post == NULL) return;
+
+    post->shader = shader;
+    post->exposureLoc = GetShaderLocation(shader, "postExposure");
+    post->tintLoc = GetShaderLocation(shader, "postTint");
+    post->saturationLoc = GetShaderLocation(shader, "postSaturation");
+    post->contrastLoc = GetShaderLocation(shader, "postContrast");
+    post->texelLoc = GetShaderLocation(shader, "postTexel");
+    post->sharpnessLoc = GetShaderLocation(shader, "postSharpness");
+    post->depthLoc = GetShaderLocation(shader, "sceneDepth");
+    post->gradeDirty = true;
+
+    int depthSlot = 1;
+    if (post->depthLoc != -1) SetShaderValue(shader, post->depthLoc, &depthSlot, SHADER_UNIFORM_INT);
+    post->scaleDirty = true;
+}
+
+// Set color grade parameters, used by POST_COLOR_GRADE
+void SetPostGrade(PostProcess *post, PostGrade grade)
+{
+    if (post == NULL) return;
+
+    post->grade = grade;
+    post->gradeDirty = true;
+}
+
+// Set scene resolution scale, the scene is rendered at scale times the target size on each axis
+// NOTE: With dynamic resolution the controller moves on from this scale
+void SetPostScale(PostProcess *post, float scale)
+{
+    if (post == NULL) return;
+
+    post->scale = fminf(fmaxf(scale, POST_SCALE_STEP), 1.0f);
+    post->scaleWidth = (int)(post->width*post->scale + 0.5f);
+    post->scaleHeight = (int)(post->height*post->scale + 0.5f);
+    if (post->scaleWidth < 1) post->scaleWidth = 1;
+    if (post->scaleHeight < 1) post->scaleHeight = 1;
+    post->scaleDirty = true;
+
+    // GPU times measured at another scale do not predict this one
+    post->sceneTime = 0.0;
+    post->sceneSamples = 0;
+}
+
+// Set sharpening of upscaled scenes, full resolution scenes are never sharpened
+void SetPostSharpness(PostProcess *post, float sharpness)
+{
+    if (post == NULL) return;
+
+    post->sharpness = sharpness;
+    post->scaleDirty = true;
+}
+
+// Scale scene resolution to hold its GPU time under budget seconds, minScale limits the scale down
+// NOTE: Measures the time between BeginPostScene() and EndPostScene(), budget 0 keeps the current scale
+void SetPostDynamicResolution(PostProcess *post, double budget, float minScale)
+{
+    if (post == NULL) return;
+
+    post->budget = budget;
+    post->minScale = fminf(fmaxf(minScale, POST_SCALE_STEP), 1.0f);
+
+    TraceLog(LOG_INFO, "POST: Dynamic resolution %s (budget %.2f ms, scale %.2f..1.00)", (budget > 0.0)? "enabled" : "disabled", budget*1000.0, post->minScale);
+}
+
+// Get scene resolution and measured GPU time
+PostResolution GetPostResolution(const PostProcess *post)
+{
+    PostResolution resolution = { 1.0f, 0, 0, 0.0, 0.0 };
+    if (post == NULL) return resolution;
+
+    resolution.scale = post->scale;
+    resolution.width = post->scaleWidth;
+    resolution.height = post->scaleHeight;
+    resolution.sceneTime = post->sceneTime;
+    resolution.budget = post->budget;
+
+    return resolution;
+}
+
+// Render to the HDR scene target, clear it with ClearBackground()
+// NOTE: The framebuffer and viewport bound before are restored by EndPostScene(),
+// so the scene can be rendered while a render texture is active. The viewport and rlgl
+// framebuffer size are the scaled scene size
+void BeginPostScene(PostProcess *post)
+{
+    if (post == NULL) return;
+
+#if defined(PLATFORM_DESKTOP)
+    rlDrawRenderBatchActive();      // Flush pending draws to the current framebuffer
+
+    UpdatePostScale(post);
+
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &post->previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, post->previousViewport);
+    post->previousSize[0] = rlGetFramebufferWidth();
+    post->previousSize[1] = rlGetFramebufferHeight();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, (post->samples > 1)? post->msaaFramebuffer : post->framebuffer);
+    rlViewport(0, 0, post->scaleWidth, post->scaleHeight);
+    rlSetFramebufferWidth(post->scaleWidth);
+    rlSetFramebufferHeight(post->scaleHeight);
+
+    int slot = post->frame%POST_SCALE_LATENCY;
+    glQueryCounter(post->queries[slot][0], GL_TIMESTAMP);
+    post->queryScale[slot] = post->scale;
+#endif
+}
+
+// Resolve multisampled scene into the target and return to the previous framebuffer
+void EndPostScene(PostProcess *post)
+{
+    if (post == NULL) return;
+
+#if defined(PLATFORM_DESKTOP)
+    rlDrawRenderBatchActive();
+
+    if (post->samples > 1)
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, post->msaaFramebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, post->framebuffer);
+        glBlitFramebuffer(0, 0, post->scaleWidth, post->scaleHeight, 0, 0, post->scaleWidth, post->scaleHeight, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    }
+
+    glQueryCounter(post->queries[post->frame%POST_SCALE_LATENCY][1], GL_TIMESTAMP);
+    post->frame++;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, post->previousFramebuffer);
+    rlViewport(post->previousViewport[0], post->previousViewport[1], post->previousViewport[2], post->previousViewport[3]);
+    rlSetFramebufferWidth(post->previousSize[0]);
+    rlSetFramebufferHeight(post->previousSize[1]);
+#endif
+}
+
+// Draw scene target through the effect chain into the current framebuffer, width x height pixels
+// NOTE: One textured quad, the chain runs once per pixel. Scaled scenes are stretched over the
+// quad and sharpened. Without a chain shader the target is copied as is and depth is not written
+void DrawPostProcess(PostProcess *post)
+{
+    if (post == NULL) return;
+
+    if (post->gradeDirty && (post->shader.id != 0))
+    {
+        float tint[3] = { post->grade.tint.x, post->grade.tint.y, post->grade.tint.z };
+        SetShaderValue(post->shader, post->exposureLoc, &post->grade.exposure, SHADER_UNIFORM_FLOAT);
+        SetShaderValue(post->shader, post->tintLoc, tint, SHADER_UNIFORM_VEC3);
+        SetShaderValue(post->shader, post->saturationLoc, &post->grade.saturation, SHADER_UNIFORM_FLOAT);
+        SetShaderValue(post->shader, post->contrastLoc, &post->grade.contrast, SHADER_UNIFORM_FLOAT);
+        post->gradeDirty = false;
+    }
+
+    if (post->scaleDirty && (post->shader.id != 0))
+    {
+        // Texel size and the last texel center of the scene, bilinear taps must not reach past it
+        float texel[4] = { 1.0f/post->width, 1.0f/post->height, (post->scaleWidth - 0.5f)/post->width, (post->scaleHeight - 0.5f)/post->height };
+        float sharpness = (post->scale < 1.0f)? post->sharpness : 0.0f;
+        SetShaderValue(post->shader, post->texelLoc, texel, SHADER_UNIFORM_VEC4);
+        SetShaderValue(post->shader, post->sharpnessLoc, &sharpness, SHADER_UNIFORM_FLOAT);
+        post->scaleDirty = false;
+    }
+
+    Texture2D scene = { post->texture, post->width, post->height, 1, PIXELFORMAT_UNCOMPRESSED_R16G16B16A16 };
+    Rectangle source = { 0.0f, 0.0f, (float)post->scaleWidth, -(float)post->scaleHeight };     // Render targets are upside down
+
+    // Scene depth is written for every pixel of the quad, whatever the framebuffer held before
+    bool writeDepth = (post->shader.id != 0) && (post->depthLoc != -1);
+
+#if defined(PLATFORM_DESKTOP)
+    if (writeDepth)
+    {
+        rlDrawRenderBatchActive();
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, post->depth);
+        glActiveTexture(GL_TEXTURE0);
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_ALWAYS);
+    }
+#endif
+
+    if (post->shader.id != 0) BeginShaderMode(post->shader);
+    DrawTexturePro(scene, source, (Rectangle){ 0.0f, 0.0f, (float)post->width, (float)post->height }, (Vector2){ 0.0f, 0.0f }, 0.0f, WHITE);
+    if (post->shader.id != 0) EndShaderMode();
+
+#if defined(PLATFORM_DESKTOP)
+    if (writeDepth)
+    {
+        // EndShaderMode() drew the quad, restore the rlgl 2D depth state
+        glDepthFunc(GL_LEQUAL);
+        glDisable(GL_DEPTH_TEST);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE0);
+    }
+#endif
+}
+
+//----------------------------------------------------------------------------------
+// Module Internal Functions Definition
+//----------------------------------------------------------------------------------
+
+// Read the scene GPU time written POST_SCALE_LATENCY frames ago and move the scale towards the budget
+// NOTE: Time is taken as proportional to the scene pixels, so the scale goes down in one step to
+// fit the budget with headroom, and up one step at a time
+static void UpdatePostScale(PostProcess *post)
+{
+#if defined(PLATFORM_DESKTOP)
+    int slot = post->frame%POST_SCALE_LATENCY;
+
+    if (post->queryScale[slot] > 0.0f)
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(post->queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+        // Times of frames rendered at a previous scale are dropped, also when the GPU is too far behind
+        if (available && (post->queryScale[slot] == post->scale))
+        {
+            GLuint64 begin = 0;
+            GLuint64 end = 0;
+            glGetQueryObjectui64v(post->queries[slot][0], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(post->queries[slot][1], GL_QUERY_RESULT, &end);
+
+            double time = (end > begin)? (end - begin)/1e9 : 0.0;
+            post->sceneTime = (post->sceneSamples > 0)? post->sceneTime*0.8 + time*0.2 : time;
+            post->sceneSamples++;
+        }
+
+        post->queryScale[slot] = 0.0f;
+    }
+
+    if ((post->budget <= 0.0) || (post->sceneSamples < POST_SCALE_SAMPLES) || (post->sceneTime <= 0.0)) return;
+
+    float scale = post->scale;
+    float up = post->scale + POST_SCALE_STEP;
+
+    if (post->sceneTime > post->budget) scale = floorf(post->scale*sqrtf((float)(post->budget*POST_SCALE_HEADROOM/post->sceneTime))/POST_SCALE_STEP)*POST_SCALE_STEP;
+    else if ((up <= 1.0f + POST_SCALE_STEP*0.5f) && (post->sceneTime*(up*up)/(post->scale*post->scale) < post->budget*POST_SCALE_HEADROOM)) scale = up;
+
+    scale = fminf(fmaxf(roundf(scale/POST_SCALE_STEP)*POST_SCALE_STEP, post->minScale), 1.0f);
+    if (fabsf(scale - post->scale) < POST_SCALE_STEP*0.5f) return;
+
+    double sceneTime = post->sceneTime;
+    float previous = post->scale;
+    SetPostScale(post, scale);
+
+    TraceLog(LOG_INFO, "POST: Resolution scale %.2f -> %.2f (%ix%i), scene GPU time %.2f ms, budget %.2f ms", previous, post->scale, post->scaleWidth, post->scaleHeight, sceneTime*1000.0, post->budget*1000.0);
+#endif
+}
+
+#endif // RPOST_IMPLEMENTATION
@@ -0,0 +1,670 @@
+/**********************************************************************************************
+*
+*   raylib.prof - Hierarchical CPU/GPU frame profiler with overlay and Chrome trace export
+*
+*   CPU scopes nest per thread: ProfBeginScope() pushes a start time on the calling thread
+*   stack and ProfEndScope() writes the finished scope into that thread ring buffer. Every
+*   thread owns its ring (allocated on first use) and is the only writer, the reader only
+*   loads the published head, so recording takes no locks: a scope costs two clock reads
+*   and one store. Rings keep the last PROF_THREAD_EVENTS scopes of every thread, readers
+*   drop entries the writer may have overwritten while they were copied.
+*
+*   GPU scopes write GL_TIMESTAMP queries at begin and end, so they nest and can overlap
+*   GL_TIME_ELAPSED queries (see rbench.h). Results are read PROF_GPU_LATENCY frames later,
+*   only when available, so the profiler never waits on the GPU. GPU times are moved onto
+*   the CPU clock with an offset measured every frame.
+*
+*   Counters (draw calls, triangles, state changes, ...) are added with atomics from any
+*   thread and kept per frame for the last PROF_HISTORY frames.
+*
+*   DrawProfiler() draws a frame time histogram, a flame graph of one frame (every thread
+*   and the GPU) and the counters. ProfExportTrace() writes the rings as Chrome trace event
+*   JSON, load it in chrome://tracing or ui.perfetto.dev.
+*
+*   CONFIGURATION:
+*
+*   #define RPROF_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+*   NOTE: Scope and counter names are not copied, use string literals.
+*   rjobs.h records a "Job" scope around every job when this header is included before it
+*
+**********************************************************************************************/
+
+#ifndef RPROF_H
+#define RPROF_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define PROF_MAX_THREADS        16          // Threads recording scopes
+#define PROF_THREAD_EVENTS      8192        // Scopes kept per thread, power of two
+#define PROF_MAX_DEPTH          32          // Nesting depth per thread, deeper scopes are not recorded
+#define PROF_MAX_GPU_SCOPES     32          // GPU scopes per frame
+#define PROF_GPU_LATENCY        4           // Frames before GPU results are read
+#define PROF_MAX_COUNTERS       16          // Per-frame counters
+#define PROF_HISTORY            240         // Frames kept for the histogram and counters
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Frame timings and counters of a finished frame
+typedef struct ProfFrame {
+    unsigned int index;
+    double cpuMs;               // ProfBeginFrame() to ProfEndFrame()
+    double gpuMs;               // Sum of top level GPU scopes, 0 until read back
+    int counters[PROF_MAX_COUNTERS];
+} ProfFrame;
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+void ProfInit(void);                                        // Init profiler on the main thread (requires GL context for GPU scopes)
+void ProfClose(void);                                       // Free thread rings and GPU queries
+void ProfSetThreadName(const char *name);                   // Name the calling thread in the overlay and traces
+
+void ProfBeginFrame(void);                                  // Start a frame, reads back GPU scopes of older frames
+void ProfEndFrame(void);                                    // Finish a frame, stores its counters
+void ProfBeginScope(const char *name);                      // Start a CPU scope on the calling thread
+void ProfEndScope(void);                                    // Finish the innermost CPU scope of the calling thread
+void ProfBeginGpuScope(const char *name);                   // Start a GPU scope (GL thread only)
+void ProfEndGpuScope(void);                                 // Finish the innermost GPU scope
+
+int ProfAddCounter(const char *name);                       // Register a per-frame counter, returns counter index
+void ProfCount(int counter, int value);                     // Add value to a counter of the current frame (any thread)
+ProfFrame ProfGetFrame(int framesAgo);                      // Get a finished frame, 0 is the last one
+
+void DrawProfiler(int posX, int posY, int width);           // Draw frame histogram, flame graph and counters
+bool ProfExportTrace(const char *fileName);                 // Export recorded scopes and counters as Chrome trace JSON
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RPROF_H
+
+
+/***********************************************************************************
+*
+*   RPROF IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RPROF_IMPLEMENTATION)
+
+#include "raylib.h"
+#include "rlgl.h"
+
+#if defined(PLATFORM_DESKTOP)
+    // NOTE: Timestamp queries are not exposed by rlgl, use the GL loader raylib is built with
+    #include "external/glad.h"
+    #define PROF_GPU_TIMERS
+#endif
+
+#include <stdatomic.h>          // Required for: atomic_int, atomic_load_explicit(), atomic_store_explicit(), atomic_fetch_add_explicit()
+#include <stdio.h>              // Required for: FILE, fopen(), fprintf(), fclose(), snprintf()
+#include <string.h>             // Required for: strncpy()
+#include <time.h>               // Required for: clock_gettime(), timespec_get()
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Finished scope, times in nanoseconds since ProfInit()
+typedef struct {
+    const char *name;
+    long long start;
+    long long end;
+    int depth;
+} ProfEvent;
+
+// Scope ring of one thread, only the owner thread writes it
+typedef struct {
+    char name[32];
+    atomic_uint head;           // Scopes written, published after the scope
+    int depth;
+    const char *stackNames[PROF_MAX_DEPTH];
+    long long stackStarts[PROF_MAX_DEPTH];
+    ProfEvent events[PROF_THREAD_EVENTS];
+} ProfThread;
+
+// GPU scope waiting for its timestamps
+typedef struct {
+    const char *name;
+    int depth;
+} ProfGpuScope;
+
+// Finished frame, times in nanoseconds since ProfInit()
+typedef struct {
+    unsigned int index;
+    long long start;
+    long long end;
+    long long gpuTime;
+    int counters[PROF_MAX_COUNTERS];
+} ProfFrameRecord;
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static _Thread_local ProfThread *profThread = NULL;     // Ring of the calling thread
+static _Thread_local bool profThreadFull = false;        // No ring left for the calling thread
+
+static struct {
+    bool ready;
+    long long epoch;            // Clock value at ProfInit()
+
+    atomic_int threadCount;
+    ProfThread *_Atomic threads[PROF_MAX_THREADS];
+    ProfThread *gpu;            // GPU scopes, written on the GL thread as results arrive
+
+    unsigned int frame;         // Current frame index
+    long long frameStart;
+    ProfFrameRecord history[PROF_HISTORY];
+
+    int counterCount;
+    const char *counterNames[PROF_MAX_COUNTERS];
+    atomic_int counters[PROF_MAX_COUNTERS];
+
+#if defined(PROF_GPU_TIMERS)
+    unsigned int queries[PROF_GPU_LATENCY][PROF_MAX_GPU_SCOPES*2];      // Begin and end timestamp per scope
+    ProfGpuScope gpuScopes[PROF_GPU_LATENCY][PROF_MAX_GPU_SCOPES];
+    int gpuScopeCount[PROF_GPU_LATENCY];
+    unsigned int gpuFrame[PROF_GPU_LATENCY];    // Frame that wrote every query set
+    int gpuStack[PROF_MAX_DEPTH];
+    int gpuDepth;
+    long long gpuOffset;        // CPU clock minus GL clock
+#endif
+
+    ProfEvent *scratch;         // Ring copy for readers
+} prof = { 0 };
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static long long GetProfTime(void);
+static ProfThread *GetProfThread(void);
+static void PushProfEvent(ProfThread *thread, const char *name, long long start, long long end, int depth);
+static int CopyProfEvents(ProfThread *thread, ProfEvent *events);
+static void ReadGpuScopes(int slot);
+static Color GetProfColor(const char *name);
+static int DrawProfLane(ProfThread *thread, long long start, long long end, int posX, int posY, int width);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Init profiler, the calling thread is named "Main"
+// NOTE: GPU scopes require an active GL context
+void ProfInit(void)
+{
+    if (prof.ready) return;
+
+    prof.epoch = GetProfTime();
+    prof.gpu = (ProfThread *)RL_CALLOC(1, sizeof(ProfThread));
+    strncpy(prof.gpu->name, "GPU", sizeof(prof.gpu->name) - 1);
+    prof.scratch = (ProfEvent *)RL_CALLOC(PROF_THREAD_EVENTS, sizeof(ProfEvent));
+
+#if defined(PROF_GPU_TIMERS)
+    for (int i = 0; i < PROF_GPU_LATENCY; i++) glGenQueries(PROF_MAX_GPU_SCOPES*2, prof.queries[i]);
+#else
+    TraceLog(LOG_WARNING, "PROF: GPU timer queries not available on this platform, GPU scopes are not recorded");
+#endif
+
+    prof.ready = true;
+    ProfSetThreadName("Main");
+
+    TraceLog(LOG_INFO, "PROF: Profiler initialized (%i scopes per thread | %i frames of history)", PROF_THREAD_EVENTS, PROF_HISTORY);
+}
+
+// Free thread rings and GPU queries
+// NOTE: Worker threads must not record scopes anymore
+void ProfClose(void)
+{
+    if (!prof.ready) return;
+
+#if defined(PROF_GPU_TIMERS)
+    for (int i = 0; i < PROF_GPU_LATENCY; i++) glDeleteQueries(PROF_MAX_GPU_SCOPES*2, prof.queries[i]);
+#endif
+
+    int count = atomic_load(&prof.threadCount);
+    for (int i = 0; (i < count) && (i < PROF_MAX_THREADS); i++) RL_FREE(atomic_load(&prof.threads[i]));
+
+    RL_FREE(prof.gpu);
+    RL_FREE(prof.scratch);
+
+    memset(&prof, 0, sizeof(prof));
+    profThread = NULL;
+}
+
+// Name the calling thread in the overlay and traces
+void ProfSetThreadName(const char *name)
+{
+    ProfThread *thread = GetProfThread();
+    if (thread != NULL) strncpy(thread->name, name, sizeof(thread->name) - 1);
+}
+
+// Start a frame, reads back GPU scopes written PROF_GPU_LATENCY frames ago
+void ProfBeginFrame(void)
+{
+    if (!prof.ready) return;
+
+    prof.frameStart = GetProfTime();
+
+#if defined(PROF_GPU_TIMERS)
+    // GL clock keeps running with the CPU one, the offset only drifts slowly
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    prof.gpuOffset = (GetProfTime() - prof.epoch) - gpuNow;
+
+    int slot = prof.frame%PROF_GPU_LATENCY;
+    ReadGpuScopes(slot);
+
+    prof.gpuScopeCount[slot] = 0;
+    prof.gpuFrame[slot] = prof.frame;
+    prof.gpuDepth = 0;
+#endif
+}
+
+// Finish a frame, stores its time and counters and clears the counters
+void ProfEndFrame(void)
+{
+    if (!prof.ready) return;
+
+    ProfFrameRecord *record = &prof.history[prof.frame%PROF_HISTORY];
+    record->index = prof.frame;
+    record->start = prof.frameStart - prof.epoch;
+    record->end = GetProfTime() - prof.epoch;
+    record->gpuTime = 0;
+
+    for (int i = 0; i < prof.counterCount; i++) record->counters[i] = atomic_exchange_explicit(&prof.counters[i], 0, memory_order_relaxed);
+
+    prof.frame++;
+}
+
+// Start a CPU scope on the calling thread
+void ProfBeginScope(const char *name)
+{
+    ProfThread *thread = GetProfThread();
+    if (thread == NULL) return;
+
+    if (thread->depth < PROF_MAX_DEPTH)
+    {
+        thread->stackNames[thread->depth] = name;
+        thread->stackStarts[thread->depth] = GetProfTime();
+    }
+
+    thread->depth++;
+}
+
+// Finish the innermost CPU scope of the calling thread
+void ProfEndScope(void)
+{
+    ProfThread *thread = profThread;
+    if ((thread == NULL) || (thread->depth == 0)) return;
+
+    thread->depth--;
+    if (thread->depth >= PROF_MAX_DEPTH) return;
+
+    PushProfEvent(thread, thread->stackNames[thread->depth], thread->stackStarts[thread->depth] - prof.epoch, GetProfTime() - prof.epoch, thread->depth);
+}
+
+// Start a GPU scope, pending batched draws are flushed so they stay outside
+void ProfBeginGpuScope(const char *name)
+{
+#if defined(PROF_GPU_TIMERS)
+    if (!prof.ready) return;
+
+    int slot = prof.frame%PROF_GPU_LATENCY;
+    int index = prof.gpuScopeCount[slot];
+
+    if (prof.gpuDepth < PROF_MAX_DEPTH) prof.gpuStack[prof.gpuDepth] = (index < PROF_MAX_GPU_SCOPES)? index : -1;
+    prof.gpuDepth++;
+
+    if ((index >= PROF_MAX_GPU_SCOPES) || (prof.gpuDepth > PROF_MAX_DEPTH)) return;
+
+    rlDrawRenderBatchActive();
+    glQueryCounter(prof.queries[slot][index*2], GL_TIMESTAMP);
+
+    prof.gpuScopes[slot][index] = (ProfGpuScope){ name, prof.gpuDepth - 1 };
+    prof.gpuScopeCount[slot]++;
+#endif
+}
+
+// Finish the innermost GPU scope, batched draws issued inside it are flushed first
+void ProfEndGpuScope(void)
+{
+#if defined(PROF_GPU_TIMERS)
+    if (!prof.ready || (prof.gpuDepth == 0)) return;
+
+    prof.gpuDepth--;
+    if (prof.gpuDepth >= PROF_MAX_DEPTH) return;
+
+    int index = prof.gpuStack[prof.gpuDepth];
+    if (index < 0) return;
+
+    rlDrawRenderBatchActive();
+    glQueryCounter(prof.queries[prof.frame%PROF_GPU_LATENCY][index*2 + 1], GL_TIMESTAMP);
+#endif
+}
+
+// Register a per-frame counter, returns counter index (-1 if no more counters available)
+int ProfAddCounter(const char *name)
+{
+    if (prof.counterCount >= PROF_MAX_COUNTERS) return -1;
+
+    prof.counterNames[prof.counterCount] = name;
+    return prof.counterCount++;
+}
+
+// Add value to a counter of the current frame, safe from any thread
+void ProfCount(int counter, int value)
+{
+    if ((counter < 0) || (counter >= prof.counterCount)) return;
+
+    atomic_fetch_add_explicit(&prof.counters[counter], value, memory_order_relaxed);
+}
+
+// Get a finished frame, 0 is the last one
+// NOTE: GPU time is 0 for the last PROF_GPU_LATENCY frames, their results are not read yet
+ProfFrame ProfGetFrame(int framesAgo)
+{
+    ProfFrame frame = { 0 };
+
+    if ((framesAgo < 0) || (framesAgo >= PROF_HISTORY) || ((unsigned int)framesAgo >= prof.frame)) return frame;
+
+    const ProfFrameRecord *record = &prof.history[(prof.frame - 1 - framesAgo)%PROF_HISTORY];
+    frame.index = record->index;
+    frame.cpuMs = (record->end - record->start)/1000000.0;
+    frame.gpuMs = record->gpuTime/1000000.0;
+    for (int i = 0; i < PROF_MAX_COUNTERS; i++) frame.counters[i] = record->counters[i];
+
+    return frame;
+}
+
+// Draw frame time histogram, a flame graph and the counters of the newest frame with GPU results
+// NOTE: Histogram bars are CPU frame times, full height is 33 ms, the line marks 16.7 ms
+void DrawProfiler(int posX, int posY, int width)
+{
+    if (!prof.ready || (prof.frame <= PROF_GPU_LATENCY)) return;
+
+    const int histogramHeight = 60;
+    int frames = (prof.frame < PROF_HISTORY)? (int)prof.frame : PROF_HISTORY;
+    int y = posY;
+
+    // Frame time histogram, newest frame on the right
+    DrawRectangle(posX, y, width, histogramHeight + 14, Fade(BLACK, 0.7f));
+    float barWidth = (float)width/PROF_HISTORY;
+    double cpuSum = 0.0;
+    double gpuSum = 0.0;
+    int gpuFrames = 0;
+
+    for (int i = 0; i < frames; i++)
+    {
+        ProfFrame frame = ProfGetFrame(i);
+        float height = (float)(frame.cpuMs/33.3*histogramHeight);
+        if (height > histogramHeight) height = (float)histogramHeight;
+
+        Color color = (frame.cpuMs > 16.7)? ORANGE : LIME;
+        DrawRectangleRec((Rectangle){ posX + width - (i + 1)*barWidth, y + 14 + histogramHeight - height, barWidth, height }, color);
+
+        cpuSum += frame.cpuMs;
+        if (frame.gpuMs > 0.0) { gpuSum += frame.gpuMs; gpuFrames++; }
+    }
+
+    DrawLine(posX, y + 14 + histogramHeight/2, posX + width, y + 14 + histogramHeight/2, Fade(WHITE, 0.5f));
+    DrawText(TextFormat("CPU %.2f ms | GPU %.2f ms (mean of %i frames)", cpuSum/frames, (gpuFrames > 0)? gpuSum/gpuFrames : 0.0, frames), posX + 4, y + 2, 10, RAYWHITE);
+    y += histogramHeight + 14;
+
+    // Flame graph of the newest frame with GPU results, every thread and the GPU on one time axis
+    const ProfFrameRecord *record = &prof.history[(prof.frame - 1 - PROF_GPU_LATENCY)%PROF_HISTORY];
+    long long start = record->start;
+    long long end = record->end;
+    if (end <= start) end = start + 1;
+
+    DrawRectangle(posX, y, width, 14, Fade(BLACK, 0.7f));
+    DrawText(TextFormat("Frame %u: %.2f ms", record->index, (end - start)/1000000.0), posX + 4, y + 2, 10, RAYWHITE);
+    y += 14;
+
+    int count = atomic_load_explicit(&prof.threadCount, memory_order_acquire);
+    for (int i = 0; (i < count) && (i < PROF_MAX_THREADS); i++)
+    {
+        ProfThread *thread = atomic_load_explicit(&prof.threads[i], memory_order_acquire);
+        if (thread != NULL) y += DrawProfLane(thread, start, end, posX, y, width);
+    }
+
+    y += DrawProfLane(prof.gpu, start, end, posX, y, width);
+
+    // Counters of the same frame
+    int rows = (prof.counterCount + 1)/2;
+    DrawRectangle(posX, y, width, rows*12 + 4, Fade(BLACK, 0.7f));
+
+    for (int i = 0; i < prof.counterCount; i++)
+    {
+        DrawText(TextFormat("%s: %i", prof.counterNames[i], record->counters[i]), posX + 4 + (i%2)*width/2, y + 2 + (i/2)*12, 10, RAYWHITE);
+    }
+}
+
+// Export recorded scopes and counters as Chrome trace event JSON
+// NOTE: Only what the rings still hold is written, the last PROF_THREAD_EVENTS scopes of every thread
+bool ProfExportTrace(const char *fileName)
+{
+    if (!prof.ready) return false;
+
+    FILE *file = fopen(fileName, "wt");
+    if (file == NULL)
+    {
+        TraceLog(LOG_WARNING, "PROF: [%s] Failed to export trace", fileName);
+        return false;
+    }
+
+    int events = 0;
+    int count = atomic_load_explicit(&prof.threadCount, memory_order_acquire);
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"raylib\"}}");
+
+    // Thread ids follow registration order, the GPU lane gets id PROF_MAX_THREADS
+    int laneCount = (count < PROF_MAX_THREADS)? count : PROF_MAX_THREADS;
+
+    for (int lane = 0; lane <= laneCount; lane++)
+    {
+        ProfThread *thread = (lane < laneCount)? atomic_load_explicit(&prof.threads[lane], memory_order_acquire) : prof.gpu;
+        int tid = (lane < laneCount)? lane : PROF_MAX_THREADS;
+        if (thread == NULL) continue;
+
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"%s\"}}", tid, thread->name);
+
+        int copied = CopyProfEvents(thread, prof.scratch);
+        for (int e = 0; e < copied; e++)
+        {
+            const ProfEvent *event = &prof.scratch[e];
+            fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%i}",
+                event->name, (thread == prof.gpu)? "gpu" : "cpu", event->start/1000.0, (event->end - event->start)/1000.0, tid);
+        }
+
+        events += copied;
+    }
+
+    // Counters and frame times of the frames in history
+    int frames = (prof.frame < PROF_HISTORY)? (int)prof.frame : PROF_HISTORY;
+    for (int f = frames - 1; f >= 0; f--)
+    {
+        const ProfFrameRecord *record = &prof.history[(prof.frame - 1 - f)%PROF_HISTORY];
+
+        fprintf(file, ",\n{\"name\":\"frame\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"args\":{\"cpu_ms\":%.3f,\"gpu_ms\":%.3f}}",
+            record->start/1000.0, (record->end - record->start)/1000000.0, record->gpuTime/1000000.0);
+
+        for (int i = 0; i < prof.counterCount; i++)
+        {
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"args\":{\"value\":%i}}", prof.counterNames[i], record->start/1000.0, record->counters[i]);
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    TraceLog(LOG_INFO, "PROF: [%s] Trace exported successfully (%i scopes, %i frames)", fileName, events, frames);
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Get monotonic time in nanoseconds
+// NOTE: vDSO call on Linux, no system call per scope
+static long long GetProfTime(void)
+{
+    struct timespec ts = { 0 };
+
+#if defined(_WIN32)
+    timespec_get(&ts, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+
+    return (long long)ts.tv_sec*1000000000LL + ts.tv_nsec;
+}
+
+// Get ring of the calling thread, allocated and registered on first use
+// NOTE: NULL before ProfInit() and once PROF_MAX_THREADS threads have a ring
+static ProfThread *GetProfThread(void)
+{
+    if (profThread != NULL) return profThread;
+    if (!prof.ready || profThreadFull) return NULL;
+
+    int index = atomic_fetch_add(&prof.threadCount, 1);
+    if (index >= PROF_MAX_THREADS)
+    {
+        profThreadFull = true;
+        return NULL;
+    }
+
+    ProfThread *thread = (ProfThread *)RL_CALLOC(1, sizeof(ProfThread));
+    snprintf(thread->name, sizeof(thread->name), "Thread %i", index);
+
+    atomic_store_explicit(&prof.threads[index], thread, memory_order_release);
+    profThread = thread;
+
+    return thread;
+}
+
+// Write a finished scope and publish it
+static void PushProfEvent(ProfThread *thread, const char *name, long long start, long long end, int depth)
+{
+    unsigned int head = atomic_load_explicit(&thread->head, memory_order_relaxed);
+
+    thread->events[head & (PROF_THREAD_EVENTS - 1)] = (ProfEvent){ name, start, end, depth };
+    atomic_store_explicit(&thread->head, head + 1, memory_order_release);
+}
+
+// Copy the scopes a ring holds, oldest first, returns scopes copied
+// NOTE: Scopes the writer may have overwritten during the copy are dropped
+static int CopyProfEvents(ProfThread *thread, ProfEvent *events)
+{
+    unsigned int head = atomic_load_explicit(&thread->head, memory_order_acquire);
+    unsigned int first = (head > PROF_THREAD_EVENTS)? head - PROF_THREAD_EVENTS : 0;
+
+    for (unsigned int i = first; i < head; i++) events[i - first] = thread->events[i & (PROF_THREAD_EVENTS - 1)];
+
+    // The writer overwrites index h - PROF_THREAD_EVENTS while writing index h
+    atomic_thread_fence(memory_order_acquire);
+    unsigned int written = atomic_load_explicit(&thread->head, memory_order_relaxed);
+    unsigned int valid = (written >= PROF_THREAD_EVENTS)? written - PROF_THREAD_EVENTS + 1 : 0;
+    unsigned int skip = (valid > first)? valid - first : 0;
+    if (skip > head - first) skip = head - first;
+
+    for (unsigned int i = skip; i < head - first; i++) events[i - skip] = events[i];
+
+    return (int)(head - first - skip);
+}
+
+// Read GPU scopes of a query set into the GPU ring, when the GPU finished them
+// NOTE: Timestamps complete in order, the last end query tells if all are available
+static void ReadGpuScopes(int slot)
+{
+#if defined(PROF_GPU_TIMERS)
+    int count = prof.gpuScopeCount[slot];
+    if (count == 0) return;
+
+    GLint available = 0;
+    glGetQueryObjectiv(prof.queries[slot][count*2 - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;         // GPU is more than PROF_GPU_LATENCY frames behind, results are dropped
+
+    long long total = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        GLuint64 begin = 0;
+        GLuint64 end = 0;
+        glGetQueryObjectui64v(prof.queries[slot][i*2], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(prof.queries[slot][i*2 + 1], GL_QUERY_RESULT, &end);
+        if (end < begin) continue;  // Scope never ended
+
+        PushProfEvent(prof.gpu, prof.gpuScopes[slot][i].name, (long long)begin + prof.gpuOffset, (long long)end + prof.gpuOffset, prof.gpuScopes[slot][i].depth);
+        if (prof.gpuScopes[slot][i].depth == 0) total += (long long)(end - begin);
+    }
+
+    ProfFrameRecord *record = &prof.history[prof.gpuFrame[slot]%PROF_HISTORY];
+    if (record->index == prof.gpuFrame[slot]) record->gpuTime = total;
+#endif
+}
+
+// Get a stable color for a scope name
+static Color GetProfColor(const char *name)
+{
+    unsigned int hash = 2166136261u;
+    for (const char *c = name; *c != '\0'; c++) hash = (hash ^ (unsigned char)*c)*16777619u;
+
+    return ColorFromHSV((float)(hash%360), 0.55f, 0.85f);
+}
+
+// Draw the scopes of one thread inside a time window, one row per depth, returns lane height
+static int DrawProfLane(ProfThread *thread, long long start, long long end, int posX, int posY, int width)
+{
+    const int rowHeight = 12;
+    const int labelWidth = 60;
+    int rows = 1;
+
+    // Newest scopes first, scopes end in order so the walk stops at the first one ending before the window
+    unsigned int head = atomic_load_explicit(&thread->head, memory_order_acquire);
+    unsigned int first = (head > PROF_THREAD_EVENTS)? head - PROF_THREAD_EVENTS + 1 : 0;
+
+    for (unsigned int i = head; i > first; i--)
+    {
+        ProfEvent event = thread->events[(i - 1) & (PROF_THREAD_EVENTS - 1)];
+        if (event.end < start) break;
+        if ((event.start > end) || (event.depth + 1 > 8)) continue;
+        if (event.depth + 1 > rows) rows = event.depth + 1;
+    }
+
+    DrawRectangle(posX, posY, width, rows*rowHeight + 2, Fade(BLACK, 0.7f));
+    DrawText(thread->name, posX + 4, posY + 2, 10, RAYWHITE);
+
+    float scale = (float)(width - labelWidth)/(float)(end - start);
+
+    for (unsigned int i = head; i > first; i--)
+    {
+        ProfEvent event = thread->events[(i - 1) & (PROF_THREAD_EVENTS - 1)];
+        if (event.end < start) break;
+        if ((event.start > end) || (event.depth >= rows)) continue;
+
+        long long from = (event.start > start)? event.start : start;
+        long long to = (event.end < end)? event.end : end;
+        Rectangle box = { posX + labelWidth + (from - start)*scale, (float)(posY + 1 + event.depth*rowHeight), (to - from)*scale, (float)(rowHeight - 1) };
+        if (box.width < 1.0f) box.width = 1.0f;
+
+        DrawRectangleRec(box, GetProfColor(event.name));
+        if (MeasureText(event.name, 10) + 4 < box.width) DrawText(event.name, (int)box.x + 2, (int)box.y + 1, 10, BLACK);
+    }
+
+    return rows*rowHeight + 2;
+}
+
+#endif // RPROF_IMPLEMENTATION
@@ -0,0 +1,631 @@
+/**********************************************************************************************
+*
+*   raylib.shader - Shader program binary cache and source hot reload
+*
+*   LoadShaderCached() keys a program on a 64 bit FNV-1a hash of both shader sources, the
+*   defines block and the GL vendor/renderer/version strings. On a hit the linked program
+*   is restored with glProgramBinary() and nothing is compiled; on a miss the sources are
+*   compiled and linked as LoadShader() would, then the program binary is written to the
+*   cache directory. An edited source, other defines or a driver update give another key,
+*   so stale binaries are never loaded; a binary the driver rejects is rebuilt.
+*
+*   ReloadShaderChanged() watches the source files of a shader loaded this way and only
+*   recompiles that program when one of them changed (through the cache, so reverting an
+*   edit is a hit). A program that fails to compile keeps the previous one running.
+*
+*   Shader variants are permutations of one source pair: every variant is keyed by a caller
+*   defined feature mask and compiled once with the #define block that mask stands for, so
+*   shaders pick features at compile time instead of branching on uniforms. Materials with
+*   the same features share one program.
+*
+*   CONFIGURATION:
+*
+*   #define RSHADER_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+*   NOTE: Program binaries require GL 4.1 or ARB_get_program_binary, without them shaders
+*   are compiled every time as before
+*
+**********************************************************************************************/
+
+#ifndef RSHADER_H
+#define RSHADER_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define SHADER_CACHE_FILE_EXT   ".rsb"          // Program binary cache file extension
+#define SHADER_CACHE_VERSION    1               // Increase when the file layout changes
+#define WATCHED_SHADERS_CAPACITY 32             // Initial shaders watched for hot reload, the table doubles when full
+#define SHADER_VARIANTS_CAPACITY 16             // Initial variants per source pair, the table doubles when full
+#define SHADER_RELOAD_INTERVAL  0.25            // Seconds between source modification checks
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Set locations and constant uniforms of a newly loaded program
+typedef void (*ShaderSetupCallback)(Shader shader);
+
+// Shader variants of one source pair
+typedef struct ShaderVariants {
+    char vsFileName[256];
+    char fsFileName[256];
+    ShaderSetupCallback setup;  // Called for every new program, also after reloads
+    int count;
+    int capacity;
+    unsigned int *keys;         // Feature key of every loaded variant
+    Shader *shaders;
+} ShaderVariants;
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+void SetShaderCacheDirectory(const char *dirPath);                                      // Set program binary cache directory (NULL to disable)
+Shader LoadShaderCached(const char *vsFileName, const char *fsFileName, const char *defines);   // Load shader from files through the binary cache, defines are inserted after #version
+bool ReloadShaderChanged(Shader *shader);                                               // Recompile shader if its sources changed, true if shader was replaced
+void UnloadShaderCached(Shader shader);                                                 // Unload shader and stop watching its sources
+
+ShaderVariants *LoadShaderVariants(const char *vsFileName, const char *fsFileName, ShaderSetupCallback setup);   // Create variant set, programs load on first use
+void UnloadShaderVariants(ShaderVariants *variants);                                    // Unload every variant program
+Shader GetShaderVariant(ShaderVariants *variants, unsigned int key, const char *defines);  // Get variant for a feature key, loaded with defines on first use
+int ReloadShaderVariants(ShaderVariants *variants, Material *materials, int materialCount);  // Reload changed variants and update material copies, returns reloaded count
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RSHADER_H
+
+
+/***********************************************************************************
+*
+*   RSHADER IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RSHADER_IMPLEMENTATION)
+
+#include "raylib.h"
+#include "rlgl.h"
+
+#if defined(PLATFORM_DESKTOP)
+    // NOTE: Program binaries are not exposed by rlgl
+    #include "external/glad.h"
+#endif
+
+#include <string.h>             // Required for: memcpy(), strlen(), strchr(), strncmp()
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define SHADER_CACHE_MAGIC      0x42535352      // "RSSB"
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int format;        // Driver binary format
+    int size;                   // Binary size following the header
+} ShaderCacheHeader;
+
+// Shader sources watched for hot reload
+typedef struct {
+    unsigned int id;            // Program currently loaded from these sources
+    char vsFileName[256];
+    char fsFileName[256];
+    char *defines;
+    long vsModTime;
+    long fsModTime;
+    double lastCheck;
+} WatchedShader;
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static char shaderCacheDirectory[512] = { 0 };  // Empty when the cache is disabled
+static WatchedShader *watchedShaders = NULL;    // Freed slots have id 0 and are reused
+static int watchedCount = 0;
+static int watchedCapacity = 0;
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static unsigned int LoadShaderProgramCached(const char *vsFileName, const char *fsFileName, const char *defines);
+static char *LoadShaderSource(const char *fileName, const char *defines);
+static unsigned long long HashShaderText(unsigned long long hash, const char *text);
+static bool IsProgramBinarySupported(void);
+static unsigned int LoadProgramBinary(const char *fileName);
+static unsigned int LoadProgramRetrievable(const char *vsCode, const char *fsCode);
+static bool SaveProgramBinary(unsigned int id, const char *fileName);
+static void SetShaderDefaultLocations(Shader *shader);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Set program binary cache directory, created if missing
+void SetShaderCacheDirectory(const char *dirPath)
+{
+    shaderCacheDirectory[0] = '\0';
+    if (dirPath == NULL) return;
+
+    if (!DirectoryExists(dirPath)) MakeDirectory(dirPath);
+    if (DirectoryExists(dirPath)) TextCopy(shaderCacheDirectory, dirPath);
+}
+
+// Load shader from files through the binary cache
+// NOTE: defines (may be NULL) is a block of #define lines inserted after the #version line
+Shader LoadShaderCached(const char *vsFileName, const char *fsFileName, const char *defines)
+{
+    Shader shader = { 0 };
+
+    shader.id = LoadShaderProgramCached(vsFileName, fsFileName, defines);
+    if (shader.id == 0) return shader;
+
+    shader.locs = (int *)RL_CALLOC(RL_MAX_SHADER_LOCATIONS, sizeof(int));
+    SetShaderDefaultLocations(&shader);
+
+    // Watch the sources for hot reload, reusing a slot freed by UnloadShaderCached()
+    int slot = 0;
+    while ((slot < watchedCount) && (watchedShaders[slot].id != 0)) slot++;
+
+    if (slot == watchedCapacity)
+    {
+        if (watchedCapacity > 0) TraceLog(LOG_WARNING, "SHADER: More than %i shaders watched, table grown", watchedCapacity);
+
+        int capacity = (watchedCapacity > 0)? watchedCapacity*2 : WATCHED_SHADERS_CAPACITY;
+
+        watchedShaders = (WatchedShader *)RL_REALLOC(watchedShaders, capacity*sizeof(WatchedShader));
+        watchedCapacity = capacity;
+    }
+
+    if (slot == watchedCount) watchedCount++;
+
+    WatchedShader *watched = &watchedShaders[slot];
+    *watched = (WatchedShader){ 0 };
+    watched->id = shader.id;
+    TextCopy(watched->vsFileName, vsFileName);
+    TextCopy(watched->fsFileName, fsFileName);
+    if (defines != NULL)
+    {
+        watched->defines = (char *)RL_MALLOC(strlen(defines) + 1);
+        memcpy(watched->defines, defines, strlen(defines) + 1);
+    }
+    watched->vsModTime = GetFileModTime(vsFileName);
+    watched->fsModTime = GetFileModTime(fsFileName);
+    watched->lastCheck = GetTime();
+
+    return shader;
+}
+
+// Recompile shader if one of its sources changed since it was loaded
+// NOTE: Program id and uniform values change, set uniforms again and update material copies
+// when this returns true. Shader locations are refreshed in place.
+bool ReloadShaderChanged(Shader *shader)
+{
+    WatchedShader *watched = NULL;
+
+    for (int i = 0; i < watchedCount; i++)
+    {
+        if ((shader->id != 0) && (watchedShaders[i].id == shader->id)) watched = &watchedShaders[i];
+    }
+
+    if ((watched == NULL) || (GetTime() - watched->lastCheck < SHADER_RELOAD_INTERVAL)) return false;
+    watched->lastCheck = GetTime();
+
+    long vsModTime = GetFileModTime(watched->vsFileName);
+    long fsModTime = GetFileModTime(watched->fsFileName);
+    if ((vsModTime == watched->vsModTime) && (fsModTime == watched->fsModTime)) return false;
+
+    // Times are stored even on failure, the next save triggers another attempt
+    watched->vsModTime = vsModTime;
+    watched->fsModTime = fsModTime;
+
+    double start = GetTime();
+    unsigned int id = LoadShaderProgramCached(watched->vsFileName, watched->fsFileName, watched->defines);
+
+    if (id == 0)
+    {
+        TraceLog(LOG_WARNING, "SHADER: [%s] Reload failed, keeping previous program", watched->fsFileName);
+        return false;
+    }
+
+    rlUnloadShaderProgram(shader->id);
+    shader->id = id;
+    watched->id = id;
+    SetShaderDefaultLocations(shader);
+
+    TraceLog(LOG_INFO, "SHADER: [ID %i] Reloaded %s and %s in %.2f ms", id, watched->vsFileName, watched->fsFileName, (GetTime() - start)*1000.0);
+
+    return true;
+}
+
+// Unload shader and stop watching its sources
+void UnloadShaderCached(Shader shader)
+{
+    for (int i = 0; i < watchedCount; i++)
+    {
+        if ((shader.id == 0) || (watchedShaders[i].id != shader.id)) continue;
+
+        RL_FREE(watchedShaders[i].defines);
+        watchedShaders[i] = (WatchedShader){ 0 };
+    }
+
+    // Release the table once the last watched shader is gone
+    while ((watchedCount > 0) && (watchedShaders[watchedCount - 1].id == 0)) watchedCount--;
+    if (watchedCount == 0)
+    {
+        RL_FREE(watchedShaders);
+        watchedShaders = NULL;
+        watchedCapacity = 0;
+    }
+
+    UnloadShader(shader);
+}
+
+// Create variant set, programs load on first use
+ShaderVariants *LoadShaderVariants(const char *vsFileName, const char *fsFileName, ShaderSetupCallback setup)
+{
+    ShaderVariants *variants = (ShaderVariants *)RL_CALLOC(1, sizeof(ShaderVariants));
+
+    TextCopy(variants->vsFileName, vsFileName);
+    TextCopy(variants->fsFileName, fsFileName);
+    variants->setup = setup;
+
+    return variants;
+}
+
+// Unload every variant program
+void UnloadShaderVariants(ShaderVariants *variants)
+{
+    if (variants == NULL) return;
+
+    for (int i = 0; i < variants->count; i++) UnloadShaderCached(variants->shaders[i]);
+
+    RL_FREE(variants->keys);
+    RL_FREE(variants->shaders);
+    RL_FREE(variants);
+}
+
+// Get variant for a feature key, loaded with defines on first use
+// NOTE: defines must only depend on key, it is not compared for loaded variants
+Shader GetShaderVariant(ShaderVariants *variants, unsigned int key, const char *defines)
+{
+    for (int i = 0; i < variants->count; i++)
+    {
+        if (variants->keys[i] == key) return variants->shaders[i];
+    }
+
+    Shader shader = LoadShaderCached(variants->vsFileName, variants->fsFileName, defines);
+
+    if (shader.id == 0)
+    {
+        TraceLog(LOG_WARNING, "SHADER: [%s] Variant 0x%x failed to load", variants->fsFileName, key);
+        return (variants->count > 0)? variants->shaders[0] : shader;
+    }
+
+    if (variants->setup != NULL) variants->setup(shader);
+
+    if (variants->count == variants->capacity)
+    {
+        // NOTE: Every variant is a program compiled at first use, a growing table usually means
+        // the feature key holds values that should be uniforms
+        if (variants->capacity > 0) TraceLog(LOG_WARNING, "SHADER: [%s] More than %i variants, table grown", variants->fsFileName, variants->capacity);
+
+        int capacity = (variants->capacity > 0)? variants->capacity*2 : SHADER_VARIANTS_CAPACITY;
+
+        variants->keys = (unsigned int *)RL_REALLOC(variants->keys, capacity*sizeof(unsigned int));
+        variants->shaders = (Shader *)RL_REALLOC(variants->shaders, capacity*sizeof(Shader));
+        variants->capacity = capacity;
+    }
+
+    variants->keys[variants->count] = key;
+    variants->shaders[variants->count] = shader;
+    variants->count++;
+
+    return shader;
+}
+
+// Reload variants whose sources changed and update the material copies using them
+int ReloadShaderVariants(ShaderVariants *variants, Material *materials, int materialCount)
+{
+    int reloaded = 0;
+
+    for (int i = 0; i < variants->count; i++)
+    {
+        unsigned int id = variants->shaders[i].id;
+        if (!ReloadShaderChanged(&variants->shaders[i])) continue;
+
+        if (variants->setup != NULL) variants->setup(variants->shaders[i]);
+
+        for (int m = 0; m < materialCount; m++)
+        {
+            if (materials[m].shader.id == id) materials[m].shader = variants->shaders[i];
+        }
+
+        reloaded++;
+    }
+
+    return reloaded;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Load program from the binary cache or compile it, returns 0 on failure
+static unsigned int LoadShaderProgramCached(const char *vsFileName, const char *fsFileName, const char *defines)
+{
+    char *vsCode = LoadShaderSource(vsFileName, defines);
+    char *fsCode = LoadShaderSource(fsFileName, defines);
+    unsigned int id = 0;
+
+    if ((vsCode == NULL) || (fsCode == NULL))
+    {
+        RL_FREE(vsCode);
+        RL_FREE(fsCode);
+        return 0;
+    }
+
+    char cacheFileName[512] = { 0 };    // Empty when the cache is not used
+
+#if defined(PLATFORM_DESKTOP)
+    if ((shaderCacheDirectory[0] != '\0') && IsProgramBinarySupported())
+    {
+        // Key on everything the compiled program depends on
+        unsigned long long hash = 14695981039346656037ULL;
+        hash = HashShaderText(hash, vsCode);
+        hash = HashShaderText(hash, fsCode);
+        hash = HashShaderText(hash, (const char *)glGetString(GL_VENDOR));
+        hash = HashShaderText(hash, (const char *)glGetString(GL_RENDERER));
+        hash = HashShaderText(hash, (const char *)glGetString(GL_VERSION));
+
+        TextCopy(cacheFileName, TextFormat("%s/%016llx%s", shaderCacheDirectory, hash, SHADER_CACHE_FILE_EXT));
+        id = LoadProgramBinary(cacheFileName);
+
+        if (id != 0) TraceLog(LOG_INFO, "SHADER: [ID %i] Program loaded from binary cache (%s)", id, GetFileName(cacheFileName));
+    }
+#endif
+
+    if (id == 0)
+    {
+        // NOTE: Programs saved to the cache are linked here, the binary must be requested before linking
+        if (cacheFileName[0] != '\0') id = LoadProgramRetrievable(vsCode, fsCode);
+        else id = rlLoadShaderCode(vsCode, fsCode);
+
+        // NOTE: rlgl falls back to the default shader when linking fails
+        if (id == rlGetShaderIdDefault()) id = 0;
+
+        if ((id != 0) && (cacheFileName[0] != '\0') && SaveProgramBinary(id, cacheFileName))
+        {
+            TraceLog(LOG_INFO, "SHADER: [ID %i] Program binary cached (%s)", id, GetFileName(cacheFileName));
+        }
+    }
+
+    RL_FREE(vsCode);
+    RL_FREE(fsCode);
+
+    return id;
+}
+
+// Load shader source text with the defines block inserted after the #version line
+static char *LoadShaderSource(const char *fileName, const char *defines)
+{
+    char *text = LoadFileText(fileName);
+    if (text == NULL) return NULL;
+
+    int definesLength = (defines != NULL)? (int)strlen(defines) : 0;
+    int textLength = (int)strlen(text);
+
+    // Source text is always copied so it can be released with RL_FREE()
+    char *source = (char *)RL_MALLOC(textLength + definesLength + 2);
+    int split = 0;
+
+    if (strncmp(text, "#version", 8) == 0)
+    {
+        const char *lineEnd = strchr(text, '\n');
+        split = (lineEnd != NULL)? (int)(lineEnd - text) + 1 : textLength;
+    }
+
+    memcpy(source, text, split);
+    memcpy(source + split, defines, definesLength);
+    int length = split + definesLength;
+    if ((definesLength > 0) && (defines[definesLength - 1] != '\n')) source[length++] = '\n';
+    memcpy(source + length, text + split, textLength - split + 1);
+
+    UnloadFileText(text);
+
+    return source;
+}
+
+// Hash text with 64 bit FNV-1a, the terminator is included so concatenations differ
+static unsigned long long HashShaderText(unsigned long long hash, const char *text)
+{
+    if (text == NULL) text = "";
+
+    do
+    {
+        hash ^= (unsigned char)*text;
+        hash *= 1099511628211ULL;
+    } while (*text++ != '\0');
+
+    return hash;
+}
+
+// Check driver can save and restore program binaries
+static bool IsProgramBinarySupported(void)
+{
+#if defined(PLATFORM_DESKTOP)
+    int formats = 0;
+    if ((glGetProgramBinary == NULL) || (glProgramBinary == NULL)) return false;
+
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+
+    return (formats > 0);
+#else
+    return false;
+#endif
+}
+
+// Load program from a cache file, returns 0 if missing or rejected by the driver
+static unsigned int LoadProgramBinary(const char *fileName)
+{
+    unsigned int id = 0;
+
+#if defined(PLATFORM_DESKTOP)
+    if (!FileExists(fileName)) return 0;
+
+    int dataSize = 0;
+    unsigned char *data = LoadFileData(fileName, &dataSize);
+    if (data == NULL) return 0;
+
+    ShaderCacheHeader header = { 0 };
+    if (dataSize >= (int)sizeof(header)) memcpy(&header, data, sizeof(header));
+
+    if ((header.magic == SHADER_CACHE_MAGIC) && (header.version == SHADER_CACHE_VERSION) &&
+        (header.size > 0) && (header.size <= dataSize - (int)sizeof(header)))
+    {
+        id = glCreateProgram();
+        glProgramBinary(id, header.format, data + sizeof(header), header.size);
+
+        int linked = 0;
+        glGetProgramiv(id, GL_LINK_STATUS, &linked);
+
+        if (!linked)
+        {
+            // NOTE: Drivers may reject binaries after an update that kept the version string
+            TraceLog(LOG_WARNING, "SHADER: [%s] Program binary rejected by driver, compiling", GetFileName(fileName));
+            glDeleteProgram(id);
+            id = 0;
+        }
+    }
+
+    UnloadFileData(data);
+#else
+    (void)fileName;
+#endif
+
+    return id;
+}
+
+// Compile and link program with its binary retrievable, same attribute locations as rlLoadShaderProgram()
+// NOTE: Drivers may return no binary or a slower one when GL_PROGRAM_BINARY_RETRIEVABLE_HINT is not set at link time
+static unsigned int LoadProgramRetrievable(const char *vsCode, const char *fsCode)
+{
+    unsigned int id = 0;
+
+#if defined(PLATFORM_DESKTOP)
+    unsigned int vsId = rlCompileShader(vsCode, RL_VERTEX_SHADER);
+    unsigned int fsId = rlCompileShader(fsCode, RL_FRAGMENT_SHADER);
+
+    if ((vsId != 0) && (fsId != 0))
+    {
+        id = glCreateProgram();
+        glAttachShader(id, vsId);
+        glAttachShader(id, fsId);
+
+        glBindAttribLocation(id, RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, RL_DEFAULT_SHADER_ATTRIB_NAME_POSITION);
+        glBindAttribLocation(id, RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD, RL_DEFAULT_SHADER_ATTRIB_NAME_TEXCOORD);
+        glBindAttribLocation(id, RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, RL_DEFAULT_SHADER_ATTRIB_NAME_NORMAL);
+        glBindAttribLocation(id, RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, RL_DEFAULT_SHADER_ATTRIB_NAME_COLOR);
+        glBindAttribLocation(id, RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT, RL_DEFAULT_SHADER_ATTRIB_NAME_TANGENT);
+        glBindAttribLocation(id, RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD2, RL_DEFAULT_SHADER_ATTRIB_NAME_TEXCOORD2);
+#if defined(RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS)
+        glBindAttribLocation(id, RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEIDS, RL_DEFAULT_SHADER_ATTRIB_NAME_BONEIDS);
+        glBindAttribLocation(id, RL_DEFAULT_SHADER_ATTRIB_LOCATION_BONEWEIGHTS, RL_DEFAULT_SHADER_ATTRIB_NAME_BONEWEIGHTS);
+#endif
+
+        glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(id);
+        glDetachShader(id, vsId);
+        glDetachShader(id, fsId);
+
+        int linked = 0;
+        glGetProgramiv(id, GL_LINK_STATUS, &linked);
+
+        if (!linked)
+        {
+            char log[1024] = { 0 };
+            glGetProgramInfoLog(id, sizeof(log), NULL, log);
+            TraceLog(LOG_WARNING, "SHADER: [ID %i] Failed to link shader program: %s", id, log);
+            glDeleteProgram(id);
+            id = 0;
+        }
+        else TraceLog(LOG_INFO, "SHADER: [ID %i] Program shader loaded successfully", id);
+    }
+
+    if (vsId != 0) glDeleteShader(vsId);
+    if (fsId != 0) glDeleteShader(fsId);
+#else
+    (void)vsCode;
+    (void)fsCode;
+#endif
+
+    return id;
+}
+
+// Save linked program binary to a cache file
+static bool SaveProgramBinary(unsigned int id, const char *fileName)
+{
+    bool success = false;
+
+#if defined(PLATFORM_DESKTOP)
+    int size = 0;
+    glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size <= 0) return false;
+
+    unsigned char *data = (unsigned char *)RL_MALLOC(sizeof(ShaderCacheHeader) + size);
+    ShaderCacheHeader header = { SHADER_CACHE_MAGIC, SHADER_CACHE_VERSION, 0, 0 };
+    int length = 0;
+
+    glGetProgramBinary(id, size, &length, &header.format, data + sizeof(header));
+    header.size = length;
+    memcpy(data, &header, sizeof(header));
+
+    if (length > 0) success = SaveFileData(fileName, data, (int)sizeof(header) + length);
+
+    RL_FREE(data);
+#else
+    (void)id;
+    (void)fileName;
+#endif
+
+    return success;
+}
+
+// Set default shader locations, same as LoadShaderFromMemory()
+static void SetShaderDefaultLocations(Shader *shader)
+{
+    for (int i = 0; i < RL_MAX_SHADER_LOCATIONS; i++) shader->locs[i] = -1;
+
+    shader->locs[SHADER_LOC_VERTEX_POSITION] = rlGetLocationAttrib(shader->id, RL_DEFAULT_SHADER_ATTRIB_NAME_POSITION);
+    shader->locs[SHADER_LOC_VERTEX_TEXCOORD01] = rlGetLocationAttrib(shader->id, RL_DEFAULT_SHADER_ATTRIB_NAME_TEXCOORD);
+    shader->locs[SHADER_LOC_VERTEX_TEXCOORD02] = rlGetLocationAttrib(shader->id, RL_DEFAULT_SHADER_ATTRIB_NAME_TEXCOORD2);
+    shader->locs[SHADER_LOC_VERTEX_NORMAL] = rlGetLocationAttrib(shader->id, RL_DEFAULT_SHADER_ATTRIB_NAME_NORMAL);
+    shader->locs[SHADER_LOC_VERTEX_TANGENT] = rlGetLocationAttrib(shader->id, RL_DEFAULT_SHADER_ATTRIB_NAME_TANGENT);
+    shader->locs[SHADER_LOC_VERTEX_COLOR] = rlGetLocationAttrib(shader->id, RL_DEFAULT_SHADER_ATTRIB_NAME_COLOR);
+    shader->locs[SHADER_LOC_VERTEX_BONEIDS] = rlGetLocationAttrib(shader->id, RL_DEFAULT_SHADER_ATTRIB_NAME_BONEIDS);
+    shader->locs[SHADER_LOC_VERTEX_BONEWEIGHTS] = rlGetLocationAttrib(shader->id, RL_DEFAULT_SHADER_ATTRIB_NAME_BONEWEIGHTS);
+
+    shader->locs[SHADER_LOC_MATRIX_MVP] = rlGetLocationUniform(shader->id, RL_DEFAULT_SHADER_UNIFORM_NAME_MVP);
+    shader->locs[SHADER_LOC_MATRIX_VIEW] = rlGetLocationUniform(shader->id, RL_DEFAULT_SHADER_UNIFORM_NAME_VIEW);
+    shader->locs[SHADER_LOC_MATRIX_PROJECTION] = rlGetLocationUniform(shader->id, RL_DEFAULT_SHADER_UNIFORM_NAME_PROJECTION);
+    shader->locs[SHADER_LOC_MATRIX_MODEL] = rlGetLocationUniform(shader->id, RL_DEFAULT_SHADER_UNIFORM_NAME_MODEL);
+    shader->locs[SHADER_LOC_MATRIX_NORMAL] = rlGetLocationUniform(shader->id, RL_DEFAULT_SHADER_UNIFORM_NAME_NORMAL);
+    shader->locs[SHADER_LOC_BONE_MATRICES] = rlGetLocationUniform(shader->id, RL_DEFAULT_SHADER_UNIFORM_NAME_BONE_MATRICES);
+
+    shader->locs[SHADER_LOC_COLOR_DIFFUSE] = rlGetLocationUniform(shader->id, RL_DEFAULT_SHADER_UNIFORM_NAME_COLOR);
+    shader->locs[SHADER_LOC_MAP_DIFFUSE] = rlGetLocationUniform(shader->id, RL_DEFAULT_SHADER_SAMPLER2D_NAME_TEXTURE0);
+    shader->locs[SHADER_LOC_MAP_SPECULAR] = rlGetLocationUniform(shader->id, RL_DEFAULT_SHADER_SAMPLER2D_NAME_TEXTURE1);
+    shader->locs[SHADER_LOC_MAP_NORMAL] = rlGetLocationUniform(shader->id, RL_DEFAULT_SHADER_SAMPLER2D_NAME_TEXTURE2);
+}
+
+#endif // RSHADER_IMPLEMENTATION
@@ -0,0 +1,1554 @@
+/**********************************************************************************************
+*
+*   raylib.soft - Multithreaded SIMD CPU reference renderer
+*
+*   Draws the same meshes and materials as the GL path on the CPU, with the math of pbr.frag
+*   (GGX distribution, Smith geometry, Schlick Fresnel) or lighting.frag (Phong) evaluated for
+*   every pixel. It gives reference images to compare GPU changes against and a renderer for
+*   machines without a usable GPU (headless tools, CI).
+*
+*   Pipeline: vertices of every draw are transformed in parallel (pbr.vert / lighting.vert),
+*   triangles are set up in chunks of SOFT_CHUNK_TRIANGLES, each chunk clips its triangles
+*   against the near and far planes and a guard band, culls back faces and bins the rest into
+*   SOFT_TILE_SIZE square tiles. Tiles are then rendered by one job per worker: the tile range
+*   is split evenly, a worker out of tiles steals the back half of the range of the busiest one.
+*
+*   Every tile is rendered in three passes:
+*       1. Opaque and alpha tested triangles fill a visibility buffer (depth, triangle)
+*       2. Every visible pixel is shaded once, by the triangle that kept it
+*       3. Blended triangles, sorted back to front by draw, are depth tested, shaded and blended
+*
+*   Pixels are processed SOFT_LANES at a time along the rows: edge functions, depth, perspective
+*   correct barycentrics and the lighting run in SIMD registers (AVX2 8 wide, SSE2 or NEON 4 wide,
+*   one lane without them). Texture fetches and the final pow() run per active lane.
+*
+*   Rules follow GL: pixel centers at half pixel, top-left fill rule on 1/256 snapped vertices,
+*   counter clockwise front faces, LEQUAL depth, SRC_ALPHA / ONE_MINUS_SRC_ALPHA blending and
+*   bilinear REPEAT texture filtering. Differences with the GL path: textures are sampled at level
+*   0 (no mipmaps, anisotropy or compressed formats), no shadows, clustered light grid, MSAA or
+*   post-processing, and the output is the non HDR_OUTPUT shader result.
+*
+*   Everything runs on the CPU, no GL context is required.
+*
+*   CONFIGURATION:
+*
+*   #define RSOFT_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+*   NOTE: AVX2 is used when the compiler targets it (-mavx2 or -march=native), x64 builds get
+*   SSE2 otherwise. Images are the same bit for bit at every width when floating point
+*   contraction is off (-ffp-contract=off), fused multiply-adds move triangle edges slightly
+*
+*   DEPENDENCIES:
+*       rjobs.h     - JobPool used to transform, set up and render tiles in parallel
+*
+**********************************************************************************************/
+
+#ifndef RSOFT_H
+#define RSOFT_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define SOFT_TILE_SIZE          32      // Tile side in pixels, a tile is rendered by one worker at a time
+#define SOFT_MAX_LIGHTS         128     // Lights read by the shading, same as MAX_LIGHTS (rlights.h)
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Shader reproduced by the material
+typedef enum {
+    SOFT_SHADING_PBR = 0,       // pbr.vert and pbr.frag
+    SOFT_SHADING_PHONG          // lighting.vert and lighting.frag
+} SoftShading;
+
+// Light type, same values as LightType (rlights.h)
+typedef enum {
+    SOFT_LIGHT_DIRECTIONAL = 0,
+    SOFT_LIGHT_POINT
+} SoftLightType;
+
+// Light, same values the shader light uniforms hold
+typedef struct SoftLight {
+    int type;                   // SoftLightType
+    bool enabled;
+    Vector3 position;
+    Vector3 target;
+    Vector3 color;              // Normalized color
+    float intensity;            // Scales the color with PBR shading, unused by Phong
+    float radius;               // Point light range with PBR shading, 0 for no cutoff
+} SoftLight;
+
+// Material, same inputs as the shader uniforms and samplers
+// NOTE: Maps must be PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, maps without data are not sampled (no HAS_*_MAP)
+typedef struct SoftMaterial {
+    int shading;                // SoftShading
+    Image albedoMap;            // albedoMap (PBR), texture0 (Phong, white without it)
+    Image mraMap;               // glTF metallic-roughness map: occlusion r, roughness g, metalness b (PBR)
+    Image normalMap;            // Tangent space normals (PBR)
+    Image emissiveMap;          // Emission in green (PBR)
+    Vector4 albedoColor;        // albedoColor (PBR), colDiffuse (Phong)
+    Vector4 emissiveColor;
+    Vector2 tiling;
+    Vector2 offset;
+    float metallicValue;
+    float roughnessValue;
+    float aoValue;
+    float emissivePower;
+    Vector3 ambientColor;       // ambientColor (PBR), ambient.rgb (Phong)
+    float ambient;              // ambient (PBR), ambient.a (Phong)
+    float alphaCutoff;          // Discard below this albedo alpha (ALPHA_TEST), 0 disables the test
+    bool blend;                 // Blended over the opaque surfaces without depth writes
+} SoftMaterial;
+
+// Frame statistics
+typedef struct SoftStats {
+    int draws;                  // Draws submitted
+    int triangles;              // Triangles submitted
+    int trianglesRasterized;    // Front facing and on screen after clipping
+    int tiles;                  // Tiles rendered
+    int steals;                 // Tile ranges taken from other workers
+    int workers;                // Workers rendering tiles
+    int lanes;                  // Pixels per SIMD register
+    long long fragments;        // Pixels shaded
+    double setupTime;           // Seconds transforming vertices and binning triangles
+    double rasterTime;          // Seconds rendering tiles
+    double renderTime;          // Seconds for the whole frame
+} SoftStats;
+
+typedef struct SoftRenderer SoftRenderer;
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+SoftRenderer *LoadSoftRenderer(int width, int height);                          // Create color target and tile lists
+void UnloadSoftRenderer(SoftRenderer *renderer);                                // Unload target and draw lists
+void SetSoftLights(SoftRenderer *renderer, const SoftLight *lights, int count); // Set lights used by the next renders
+void ClearSoftDraws(SoftRenderer *renderer);                                    // Remove all draws, call once per frame before adding them
+void AddSoftDraw(SoftRenderer *renderer, Mesh mesh, const SoftMaterial *material, Matrix transform);  // Add mesh draw, mesh arrays and material are read when rendering
+SoftStats RenderSoft(SoftRenderer *renderer, Camera camera, Color background, JobPool *pool);   // Render draws seen from camera over background
+Image GetSoftImage(const SoftRenderer *renderer);                               // Get rendered color as R8G8B8A8 image, top row first
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RSOFT_H
+
+
+/***********************************************************************************
+*
+*   RSOFT IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RSOFT_IMPLEMENTATION)
+
+#include "raylib.h"
+#include "rlgl.h"               // Required for: RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR
+#include "raymath.h"            // Required for: MatrixLookAt(), MatrixPerspective(), MatrixInvert()
+
+#include <stdlib.h>             // Required for: qsort()
+#include <string.h>             // Required for: memcpy()
+#include <math.h>               // Required for: floorf(), ceilf(), roundf(), sqrtf(), powf()
+#include <float.h>              // Required for: FLT_MIN
+#include <time.h>               // Required for: clock_gettime(), timespec_get()
+#include <stdatomic.h>          // Required for: atomic_ullong
+
+#if defined(__AVX2__)
+    #include <immintrin.h>      // Required for: AVX2 intrinsics
+    #define RSOFT_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #include <emmintrin.h>      // Required for: SSE2 intrinsics
+    #define RSOFT_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    #include <arm_neon.h>       // Required for: NEON intrinsics
+    #define RSOFT_NEON
+#endif
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define SOFT_CHUNK_TRIANGLES    2048    // Triangles set up and binned by one job
+#define SOFT_CLIP_VERTICES      9       // Polygon vertices after clipping a triangle against 6 planes
+#define SOFT_CHUNK_OUTPUT       (SOFT_CHUNK_TRIANGLES*(SOFT_CLIP_VERTICES - 2))  // Triangle ids per chunk
+#define SOFT_VERTEX_GRAIN       1024    // Vertices transformed by one job
+#define SOFT_GUARD_BAND         2.0f    // Triangles are only clipped at the sides beyond this many screens
+#define SOFT_SUBPIXEL           256.0f  // Vertex positions snap to 1/256 pixel
+#define SOFT_TILE_PIXELS        (SOFT_TILE_SIZE*SOFT_TILE_SIZE)
+
+//----------------------------------------------------------------------------------
+// SIMD lanes: SoftFloat holds SOFT_LANES floats, SoftMask the result of a comparison
+//----------------------------------------------------------------------------------
+#if defined(RSOFT_AVX2)
+    #define SOFT_LANES 8
+    #define SOFT_SIMD_NAME "AVX2"
+
+    typedef __m256 SoftFloat;
+    typedef __m256 SoftMask;
+    typedef __m256i SoftInt;
+
+    static inline SoftFloat SoftSet(float value) { return _mm256_set1_ps(value); }
+    static inline SoftFloat SoftLoad(const float *values) { return _mm256_loadu_ps(values); }
+    static inline void SoftStore(float *values, SoftFloat v) { _mm256_storeu_ps(values, v); }
+    static inline SoftFloat SoftAdd(SoftFloat a, SoftFloat b) { return _mm256_add_ps(a, b); }
+    static inline SoftFloat SoftSub(SoftFloat a, SoftFloat b) { return _mm256_sub_ps(a, b); }
+    static inline SoftFloat SoftMul(SoftFloat a, SoftFloat b) { return _mm256_mul_ps(a, b); }
+    static inline SoftFloat SoftDiv(SoftFloat a, SoftFloat b) { return _mm256_div_ps(a, b); }
+    static inline SoftFloat SoftMin(SoftFloat a, SoftFloat b) { return _mm256_min_ps(a, b); }
+    static inline SoftFloat SoftMax(SoftFloat a, SoftFloat b) { return _mm256_max_ps(a, b); }
+    static inline SoftFloat SoftSqrt(SoftFloat a) { return _mm256_sqrt_ps(a); }
+    static inline SoftMask SoftGreaterEqual(SoftFloat a, SoftFloat b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+    static inline SoftMask SoftLessEqual(SoftFloat a, SoftFloat b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    static inline SoftMask SoftLess(SoftFloat a, SoftFloat b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static inline SoftMask SoftGreater(SoftFloat a, SoftFloat b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static inline SoftMask SoftMaskAnd(SoftMask a, SoftMask b) { return _mm256_and_ps(a, b); }
+    static inline int SoftMaskBits(SoftMask m) { return _mm256_movemask_ps(m); }
+    static inline SoftFloat SoftSelect(SoftMask m, SoftFloat a, SoftFloat b) { return _mm256_blendv_ps(b, a, m); }
+    static inline SoftInt SoftIntSet(int value) { return _mm256_set1_epi32(value); }
+    static inline SoftInt SoftIntLoad(const int *values) { return _mm256_loadu_si256((const __m256i *)values); }
+    static inline void SoftIntStore(int *values, SoftInt v) { _mm256_storeu_si256((__m256i *)values, v); }
+    static inline SoftMask SoftIntEqual(SoftInt a, SoftInt b) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)); }
+    static inline SoftInt SoftIntSelect(SoftMask m, SoftInt a, SoftInt b) { return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(b), _mm256_castsi256_ps(a), m)); }
+#elif defined(RSOFT_SSE2)
+    #define SOFT_LANES 4
+    #define SOFT_SIMD_NAME "SSE2"
+
+    typedef __m128 SoftFloat;
+    typedef __m128 SoftMask;
+    typedef __m128i SoftInt;
+
+    static inline SoftFloat SoftSet(float value) { return _mm_set1_ps(value); }
+    static inline SoftFloat SoftLoad(const float *values) { return _mm_loadu_ps(values); }
+    static inline void SoftStore(float *values, SoftFloat v) { _mm_storeu_ps(values, v); }
+    static inline SoftFloat SoftAdd(SoftFloat a, SoftFloat b) { return _mm_add_ps(a, b); }
+    static inline SoftFloat SoftSub(SoftFloat a, SoftFloat b) { return _mm_sub_ps(a, b); }
+    static inline SoftFloat SoftMul(SoftFloat a, SoftFloat b) { return _mm_mul_ps(a, b); }
+    static inline SoftFloat SoftDiv(SoftFloat a, SoftFloat b) { return _mm_div_ps(a, b); }
+    static inline SoftFloat SoftMin(SoftFloat a, SoftFloat b) { return _mm_min_ps(a, b); }
+    static inline SoftFloat SoftMax(SoftFloat a, SoftFloat b) { return _mm_max_ps(a, b); }
+    static inline SoftFloat SoftSqrt(SoftFloat a) { return _mm_sqrt_ps(a); }
+    static inline SoftMask SoftGreaterEqual(SoftFloat a, SoftFloat b) { return _mm_cmpge_ps(a, b); }
+    static inline SoftMask SoftLessEqual(SoftFloat a, SoftFloat b) { return _mm_cmple_ps(a, b); }
+    static inline SoftMask SoftLess(SoftFloat a, SoftFloat b) { return _mm_cmplt_ps(a, b); }
+    static inline SoftMask SoftGreater(SoftFloat a, SoftFloat b) { return _mm_cmpgt_ps(a, b); }
+    static inline SoftMask SoftMaskAnd(SoftMask a, SoftMask b) { return _mm_and_ps(a, b); }
+    static inline int SoftMaskBits(SoftMask m) { return _mm_movemask_ps(m); }
+    static inline SoftFloat SoftSelect(SoftMask m, SoftFloat a, SoftFloat b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+    static inline SoftInt SoftIntSet(int value) { return _mm_set1_epi32(value); }
+    static inline SoftInt SoftIntLoad(const int *values) { return _mm_loadu_si128((const __m128i *)values); }
+    static inline void SoftIntStore(int *values, SoftInt v) { _mm_storeu_si128((__m128i *)values, v); }
+    static inline SoftMask SoftIntEqual(SoftInt a, SoftInt b) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, b)); }
+    static inline SoftInt SoftIntSelect(SoftMask m, SoftInt a, SoftInt b) { __m128i mi = _mm_castps_si128(m); return _mm_or_si128(_mm_and_si128(mi, a), _mm_andnot_si128(mi, b)); }
+#elif defined(RSOFT_NEON)
+    #define SOFT_LANES 4
+    #define SOFT_SIMD_NAME "NEON"
+
+    typedef float32x4_t SoftFloat;
+    typedef uint32x4_t SoftMask;
+    typedef int32x4_t SoftInt;
+
+    static inline SoftFloat SoftSet(float value) { return vdupq_n_f32(value); }
+    static inline SoftFloat SoftLoad(const float *values) { return vld1q_f32(values); }
+    static inline void SoftStore(float *values, SoftFloat v) { vst1q_f32(values, v); }
+    static inline SoftFloat SoftAdd(SoftFloat a, SoftFloat b) { return vaddq_f32(a, b); }
+    static inline SoftFloat SoftSub(SoftFloat a, SoftFloat b) { return vsubq_f32(a, b); }
+    static inline SoftFloat SoftMul(SoftFloat a, SoftFloat b) { return vmulq_f32(a, b); }
+    static inline SoftFloat SoftDiv(SoftFloat a, SoftFloat b) { return vdivq_f32(a, b); }
+    static inline SoftFloat SoftMin(SoftFloat a, SoftFloat b) { return vminq_f32(a, b); }
+    static inline SoftFloat SoftMax(SoftFloat a, SoftFloat b) { return vmaxq_f32(a, b); }
+    static inline SoftFloat SoftSqrt(SoftFloat a) { return vsqrtq_f32(a); }
+    static inline SoftMask SoftGreaterEqual(SoftFloat a, SoftFloat b) { return vcgeq_f32(a, b); }
+    static inline SoftMask SoftLessEqual(SoftFloat a, SoftFloat b) { return vcleq_f32(a, b); }
+    static inline SoftMask SoftLess(SoftFloat a, SoftFloat b) { return vcltq_f32(a, b); }
+    static inline SoftMask SoftGreater(SoftFloat a, SoftFloat b) { return vcgtq_f32(a, b); }
+    static inline SoftMask SoftMaskAnd(SoftMask a, SoftMask b) { return vandq_u32(a, b); }
+    static inline int SoftMaskBits(SoftMask m) { static const uint32_t weights[4] = { 1, 2, 4, 8 }; return (int)vaddvq_u32(vandq_u32(m, vld1q_u32(weights))); }
+    static inline SoftFloat SoftSelect(SoftMask m, SoftFloat a, SoftFloat b) { return vbslq_f32(m, a, b); }
+    static inline SoftInt SoftIntSet(int value) { return vdupq_n_s32(value); }
+    static inline SoftInt SoftIntLoad(const int *values) { return vld1q_s32(values); }
+    static inline void SoftIntStore(int *values, SoftInt v) { vst1q_s32(values, v); }
+    static inline SoftMask SoftIntEqual(SoftInt a, SoftInt b) { return vceqq_s32(a, b); }
+    static inline SoftInt SoftIntSelect(SoftMask m, SoftInt a, SoftInt b) { return vbslq_s32(m, a, b); }
+#else
+    #define SOFT_LANES 1
+    #define SOFT_SIMD_NAME "scalar"
+
+    typedef float SoftFloat;
+    typedef int SoftMask;
+    typedef int SoftInt;
+
+    static inline SoftFloat SoftSet(float value) { return value; }
+    static inline SoftFloat SoftLoad(const float *values) { return values[0]; }
+    static inline void SoftStore(float *values, SoftFloat v) { values[0] = v; }
+    static inline SoftFloat SoftAdd(SoftFloat a, SoftFloat b) { return a + b; }
+    static inline SoftFloat SoftSub(SoftFloat a, SoftFloat b) { return a - b; }
+    static inline SoftFloat SoftMul(SoftFloat a, SoftFloat b) { return a*b; }
+    static inline SoftFloat SoftDiv(SoftFloat a, SoftFloat b) { return a/b; }
+    static inline SoftFloat SoftMin(SoftFloat a, SoftFloat b) { return (a < b)? a : b; }
+    static inline SoftFloat SoftMax(SoftFloat a, SoftFloat b) { return (a > b)? a : b; }
+    static inline SoftFloat SoftSqrt(SoftFloat a) { return sqrtf(a); }
+    static inline SoftMask SoftGreaterEqual(SoftFloat a, SoftFloat b) { return a >= b; }
+    static inline SoftMask SoftLessEqual(SoftFloat a, SoftFloat b) { return a <= b; }
+    static inline SoftMask SoftLess(SoftFloat a, SoftFloat b) { return a < b; }
+    static inline SoftMask SoftGreater(SoftFloat a, SoftFloat b) { return a > b; }
+    static inline SoftMask SoftMaskAnd(SoftMask a, SoftMask b) { return a & b; }
+    static inline int SoftMaskBits(SoftMask m) { return m; }
+    static inline SoftFloat SoftSelect(SoftMask m, SoftFloat a, SoftFloat b) { return m? a : b; }
+    static inline SoftInt SoftIntSet(int value) { return value; }
+    static inline SoftInt SoftIntLoad(const int *values) { return values[0]; }
+    static inline void SoftIntStore(int *values, SoftInt v) { values[0] = v; }
+    static inline SoftMask SoftIntEqual(SoftInt a, SoftInt b) { return a == b; }
+    static inline SoftInt SoftIntSelect(SoftMask m, SoftInt a, SoftInt b) { return m? a : b; }
+#endif
+
+// Pixel center offsets of the lanes along a row
+static const float softLaneCenters[8] = { 0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f };
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Vertex shader outputs
+typedef struct {
+    float clip[4];              // gl_Position
+    float position[3];          // fragPosition, world space
+    float normal[3];            // fragNormal
+    float tangent[3];           // TBN columns (PBR)
+    float binormal[3];
+    float texcoord[2];          // fragTexCoord
+    float color[4];             // fragColor (Phong)
+} SoftVertex;
+
+// Mesh instance
+typedef struct {
+    Mesh mesh;
+    const SoftMaterial *material;
+    Matrix transform;
+    Vector3 center;             // Mesh bounds center, blended draws are sorted by its distance
+    int order;                  // Submission order
+    float distance;             // View distance of the center, set by RenderSoft()
+    Matrix mvp;                 // Set by RenderSoft()
+    Matrix normalMatrix;        // transpose(inverse(transform))
+    int firstVertex;            // Offset in the transformed vertices
+    int firstTriangle;          // Offset in the submitted triangles
+    int triangleCount;
+} SoftDraw;
+
+// Triangle ready to rasterize
+typedef struct {
+    float edgeA[3], edgeB[3], edgeC[3];     // Edge functions a*x + b*y + c, edge i is opposite to vertex i
+    float edgeBias[3];                      // Pixels on an edge are inside when it is a top or left edge
+    float depthA, depthB, depthC;           // Window depth plane
+    float invW[3];                          // Perspective correction of the barycentrics
+    int vertices[3];                        // Transformed vertex, clipped vertex of the chunk when negative: -(i + 1)
+    int draw;
+    int minX, minY, maxX, maxY;             // Pixel bounds
+} SoftTriangle;
+
+// Triangle list of one chunk in one tile
+typedef struct {
+    int count;
+    int capacity;
+    int *items;                 // Triangle indices in the chunk
+} SoftBin;
+
+// Triangles set up by one job
+typedef struct {
+    int triangleCount;
+    int triangleCapacity;
+    SoftTriangle *triangles;
+    int clipCount;
+    int clipCapacity;
+    SoftVertex *clipVertices;   // Vertices created by clipping
+} SoftChunk;
+
+// Tile worker, the tile range is the part of the work stealing shared with other workers
+typedef struct {
+    atomic_ullong range;        // Tiles left: first in the low 32 bits, end in the high 32 bits
+    int steals;
+    int tiles;
+    long long fragments;
+    float depth[SOFT_TILE_PIXELS];
+    int triangle[SOFT_TILE_PIXELS];         // Visible triangle id, -1 for background
+    float color[4][SOFT_TILE_PIXELS];
+} SoftWorker;
+
+struct SoftRenderer {
+    int width;
+    int height;
+    int tilesX;
+    int tilesY;
+    unsigned char *pixels;      // R8G8B8A8, top row first
+
+    SoftLight lights[SOFT_MAX_LIGHTS];
+    int lightCount;
+
+    // Frame state, set by RenderSoft()
+    Vector3 viewPosition;
+    float background[4];
+
+    int drawCount;
+    int drawCapacity;
+    SoftDraw *draws;
+    int vertexCount;
+    int vertexCapacity;
+    SoftVertex *vertices;
+    int triangleCount;
+    int chunkCount;
+    int chunkCapacity;
+    SoftChunk *chunks;
+    int binCapacity;
+    SoftBin *bins;              // chunkCount*tileCount, chunk major
+    int workerCount;
+    int workerCapacity;
+    SoftWorker *workers;
+};
+
+// Vector of one value per lane
+typedef struct {
+    SoftFloat x, y, z;
+} SoftVector3;
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static double GetSoftTime(void);
+static int CompareSoftDraws(const void *a, const void *b);
+static int FindSoftDraw(const SoftRenderer *renderer, int value, bool triangles);
+static void TransformSoftVertices(int start, int end, void *data);
+static void SetupSoftChunks(int start, int end, void *data);
+static void ClipSoftTriangle(SoftRenderer *renderer, int chunk, int draw, const int *indices);
+static void AddSoftTriangle(SoftRenderer *renderer, int chunk, int draw, const SoftVertex *const *vertices, const int *indices);
+static void RenderSoftWorkers(int start, int end, void *data);
+static bool TakeSoftTile(SoftRenderer *renderer, int worker, int *tile);
+static void RenderSoftTile(SoftRenderer *renderer, SoftWorker *worker, int tile);
+static void RasterizeSoftTriangle(const SoftRenderer *renderer, SoftWorker *worker, int chunk, int item, int tileX, int tileY, int pass);
+static void ShadeSoftLanes(const SoftRenderer *renderer, const SoftMaterial *material, const SoftVertex *const *vertices, const SoftFloat *lambda, int lanes, SoftFloat *color);
+static void SampleSoftTexture(const Image *map, const SoftFloat *u, const SoftFloat *v, int lanes, SoftFloat *texel);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Create color target and tile lists
+SoftRenderer *LoadSoftRenderer(int width, int height)
+{
+    SoftRenderer *renderer = (SoftRenderer *)RL_CALLOC(1, sizeof(SoftRenderer));
+
+    renderer->width = (width > 0)? width : 1;
+    renderer->height = (height > 0)? height : 1;
+    renderer->tilesX = (renderer->width + SOFT_TILE_SIZE - 1)/SOFT_TILE_SIZE;
+    renderer->tilesY = (renderer->height + SOFT_TILE_SIZE - 1)/SOFT_TILE_SIZE;
+    renderer->pixels = (unsigned char *)RL_CALLOC(renderer->width*renderer->height, 4);
+
+    TraceLog(LOG_INFO, "SOFT: Renderer created (%ix%i, %i tiles, %s %i wide)", renderer->width, renderer->height, renderer->tilesX*renderer->tilesY, SOFT_SIMD_NAME, SOFT_LANES);
+
+    return renderer;
+}
+
+// Unload target and draw lists
+void UnloadSoftRenderer(SoftRenderer *renderer)
+{
+    if (renderer == NULL) return;
+
+    for (int c = 0; c < renderer->chunkCapacity; c++)
+    {
+        RL_FREE(renderer->chunks[c].triangles);
+        RL_FREE(renderer->chunks[c].clipVertices);
+    }
+    for (int b = 0; b < renderer->binCapacity; b++) RL_FREE(renderer->bins[b].items);
+
+    RL_FREE(renderer->chunks);
+    RL_FREE(renderer->bins);
+    RL_FREE(renderer->workers);
+    RL_FREE(renderer->vertices);
+    RL_FREE(renderer->draws);
+    RL_FREE(renderer->pixels);
+    RL_FREE(renderer);
+}
+
+// Set lights used by the next renders, like the light uniforms of the shaders
+void SetSoftLights(SoftRenderer *renderer, const SoftLight *lights, int count)
+{
+    if (count > SOFT_MAX_LIGHTS) count = SOFT_MAX_LIGHTS;
+    if (count < 0) count = 0;
+
+    if (count > 0) memcpy(renderer->lights, lights, count*sizeof(SoftLight));
+    renderer->lightCount = count;
+}
+
+// Remove all draws
+void ClearSoftDraws(SoftRenderer *renderer)
+{
+    renderer->drawCount = 0;
+}
+
+// Add mesh draw, mesh arrays and material are read when rendering
+// NOTE: Mesh needs CPU vertices, normals and texcoords (and tangents with a PBR normal map)
+void AddSoftDraw(SoftRenderer *renderer, Mesh mesh, const SoftMaterial *material, Matrix transform)
+{
+    if ((mesh.vertices == NULL) || (mesh.vertexCount <= 0) || (material == NULL)) return;
+
+    if (renderer->drawCount == renderer->drawCapacity)
+    {
+        renderer->drawCapacity = (renderer->drawCapacity > 0)? renderer->drawCapacity*2 : 64;
+        renderer->draws = (SoftDraw *)RL_REALLOC(renderer->draws, renderer->drawCapacity*sizeof(SoftDraw));
+    }
+
+    BoundingBox bounds = GetMeshBoundingBox(mesh);
+
+    SoftDraw *draw = &renderer->draws[renderer->drawCount];
+    draw->mesh = mesh;
+    draw->material = material;
+    draw->transform = transform;
+    draw->center = Vector3Scale(Vector3Add(bounds.min, bounds.max), 0.5f);
+    draw->order = renderer->drawCount;
+    draw->triangleCount = (mesh.indices != NULL)? mesh.triangleCount : mesh.vertexCount/3;
+    renderer->drawCount++;
+}
+
+// Render draws seen from camera over background
+// NOTE: Same projection as BeginMode3D() with the renderer aspect, the pool can be NULL (one worker)
+SoftStats RenderSoft(SoftRenderer *renderer, Camera camera, Color background, JobPool *pool)
+{
+    SoftStats stats = { 0 };
+    double start = GetSoftTime();
+
+    float aspect = (float)renderer->width/(float)renderer->height;
+    Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+    Matrix projection = { 0 };
+
+    if (camera.projection == CAMERA_PERSPECTIVE) projection = MatrixPerspective(camera.fovy*DEG2RAD, aspect, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+    else
+    {
+        float top = camera.fovy/2.0f;
+        float right = top*aspect;
+        projection = MatrixOrtho(-right, right, -top, top, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+    }
+
+    Matrix viewProjection = MatrixMultiply(view, projection);
+    renderer->viewPosition = camera.position;
+    renderer->background[0] = background.r/255.0f;
+    renderer->background[1] = background.g/255.0f;
+    renderer->background[2] = background.b/255.0f;
+    renderer->background[3] = background.a/255.0f;
+
+    // Opaque draws keep their order, blended ones follow back to front
+    for (int d = 0; d < renderer->drawCount; d++)
+    {
+        SoftDraw *draw = &renderer->draws[d];
+        draw->distance = Vector3Distance(Vector3Transform(draw->center, draw->transform), camera.position);
+    }
+    qsort(renderer->draws, renderer->drawCount, sizeof(SoftDraw), CompareSoftDraws);
+
+    // Offsets of every draw in the transformed vertices and the submitted triangles
+    renderer->vertexCount = 0;
+    renderer->triangleCount = 0;
+    for (int d = 0; d < renderer->drawCount; d++)
+    {
+        SoftDraw *draw = &renderer->draws[d];
+        draw->mvp = MatrixMultiply(draw->transform, viewProjection);
+        draw->normalMatrix = MatrixTranspose(MatrixInvert(draw->transform));
+        draw->firstVertex = renderer->vertexCount;
+        draw->firstTriangle = renderer->triangleCount;
+        renderer->vertexCount += draw->mesh.vertexCount;
+        renderer->triangleCount += draw->triangleCount;
+    }
+
+    if (renderer->vertexCount > renderer->vertexCapacity)
+    {
+        renderer->vertexCapacity = renderer->vertexCount;
+        renderer->vertices = (SoftVertex *)RL_REALLOC(renderer->vertices, renderer->vertexCapacity*sizeof(SoftVertex));
+    }
+
+    int tileCount = renderer->tilesX*renderer->tilesY;
+    renderer->chunkCount = (renderer->triangleCount + SOFT_CHUNK_TRIANGLES - 1)/SOFT_CHUNK_TRIANGLES;
+
+    if (renderer->chunkCount > renderer->chunkCapacity)
+    {
+        renderer->chunks = (SoftChunk *)RL_REALLOC(renderer->chunks, renderer->chunkCount*sizeof(SoftChunk));
+        memset(renderer->chunks + renderer->chunkCapacity, 0, (renderer->chunkCount - renderer->chunkCapacity)*sizeof(SoftChunk));
+        renderer->chunkCapacity = renderer->chunkCount;
+    }
+
+    if (renderer->chunkCount*tileCount > renderer->binCapacity)
+    {
+        renderer->bins = (SoftBin *)RL_REALLOC(renderer->bins, renderer->chunkCount*tileCount*sizeof(SoftBin));
+        memset(renderer->bins + renderer->binCapacity, 0, (renderer->chunkCount*tileCount - renderer->binCapacity)*sizeof(SoftBin));
+        renderer->binCapacity = renderer->chunkCount*tileCount;
+    }
+
+    ParallelFor(pool, renderer->vertexCount, SOFT_VERTEX_GRAIN, TransformSoftVertices, renderer);
+    ParallelFor(pool, renderer->chunkCount, 1, SetupSoftChunks, renderer);
+
+    double setupEnd = GetSoftTime();
+
+    // Tiles split evenly between the workers, a worker out of tiles steals from the others
+    int workerCount = GetJobPoolThreadCount(pool) + 1;
+    if (workerCount > tileCount) workerCount = tileCount;
+
+    if (workerCount > renderer->workerCapacity)
+    {
+        RL_FREE(renderer->workers);
+        renderer->workers = (SoftWorker *)RL_CALLOC(workerCount, sizeof(SoftWorker));
+        renderer->workerCapacity = workerCount;
+    }
+
+    renderer->workerCount = workerCount;
+    for (int w = 0; w < workerCount; w++)
+    {
+        unsigned long long first = (unsigned long long)(tileCount*w/workerCount);
+        unsigned long long end = (unsigned long long)(tileCount*(w + 1)/workerCount);
+
+        atomic_store(&renderer->workers[w].range, (end << 32) | first);
+        renderer->workers[w].steals = 0;
+        renderer->workers[w].tiles = 0;
+        renderer->workers[w].fragments = 0;
+    }
+
+    ParallelFor(pool, workerCount, 1, RenderSoftWorkers, renderer);
+
+    double end = GetSoftTime();
+
+    stats.draws = renderer->drawCount;
+    stats.triangles = renderer->triangleCount;
+    stats.workers = workerCount;
+    stats.lanes = SOFT_LANES;
+    for (int c = 0; c < renderer->chunkCount; c++) stats.trianglesRasterized += renderer->chunks[c].triangleCount;
+    for (int w = 0; w < workerCount; w++)
+    {
+        stats.tiles += renderer->workers[w].tiles;
+        stats.steals += renderer->workers[w].steals;
+        stats.fragments += renderer->workers[w].fragments;
+    }
+    stats.setupTime = setupEnd - start;
+    stats.rasterTime = end - setupEnd;
+    stats.renderTime = end - start;
+
+    return stats;
+}
+
+// Get rendered color as R8G8B8A8 image, top row first
+Image GetSoftImage(const SoftRenderer *renderer)
+{
+    Image image = { 0 };
+    int size = renderer->width*renderer->height*4;
+
+    image.data = RL_MALLOC(size);
+    memcpy(image.data, renderer->pixels, size);
+    image.width = renderer->width;
+    image.height = renderer->height;
+    image.mipmaps = 1;
+    image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+
+    return image;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Get monotonic time in seconds, GetTime() needs a window
+static double GetSoftTime(void)
+{
+    struct timespec ts = { 0 };
+#if defined(_WIN32)
+    timespec_get(&ts, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (double)ts.tv_sec + (double)ts.tv_nsec*1e-9;
+}
+
+// Opaque draws first in submission order, blended draws after them, far to near
+static int CompareSoftDraws(const void *a, const void *b)
+{
+    const SoftDraw *drawA = (const SoftDraw *)a;
+    const SoftDraw *drawB = (const SoftDraw *)b;
+
+    if (drawA->material->blend != drawB->material->blend) return drawA->material->blend? 1 : -1;
+    if (drawA->material->blend && (drawA->distance != drawB->distance)) return (drawA->distance > drawB->distance)? -1 : 1;
+
+    return drawA->order - drawB->order;
+}
+
+// Find last draw starting at or before a vertex (or triangle), draws are sorted by both offsets
+static int FindSoftDraw(const SoftRenderer *renderer, int value, bool triangles)
+{
+    int low = 0;
+    int high = renderer->drawCount - 1;
+
+    while (low < high)
+    {
+        int middle = (low + high + 1)/2;
+        int first = triangles? renderer->draws[middle].firstTriangle : renderer->draws[middle].firstVertex;
+
+        if (first <= value) low = middle;
+        else high = middle - 1;
+    }
+
+    return low;
+}
+
+// Vertex shaders of a vertex range, pbr.vert or lighting.vert by material
+static void TransformSoftVertices(int start, int end, void *data)
+{
+    SoftRenderer *renderer = (SoftRenderer *)data;
+    int d = FindSoftDraw(renderer, start, false);
+
+    for (int v = start; v < end; v++)
+    {
+        while (v >= renderer->draws[d].firstVertex + renderer->draws[d].mesh.vertexCount) d++;
+
+        const SoftDraw *draw = &renderer->draws[d];
+        const Mesh *mesh = &draw->mesh;
+        const Matrix *mvp = &draw->mvp;
+        const Matrix *model = &draw->transform;
+        const Matrix *nm = &draw->normalMatrix;
+        SoftVertex *vertex = &renderer->vertices[v];
+        int i = v - draw->firstVertex;
+
+        float px = mesh->vertices[i*3 + 0];
+        float py = mesh->vertices[i*3 + 1];
+        float pz = mesh->vertices[i*3 + 2];
+
+        vertex->clip[0] = mvp->m0*px + mvp->m4*py + mvp->m8*pz + mvp->m12;
+        vertex->clip[1] = mvp->m1*px + mvp->m5*py + mvp->m9*pz + mvp->m13;
+        vertex->clip[2] = mvp->m2*px + mvp->m6*py + mvp->m10*pz + mvp->m14;
+        vertex->clip[3] = mvp->m3*px + mvp->m7*py + mvp->m11*pz + mvp->m15;
+        vertex->position[0] = model->m0*px + model->m4*py + model->m8*pz + model->m12;
+        vertex->position[1] = model->m1*px + model->m5*py + model->m9*pz + model->m13;
+        vertex->position[2] = model->m2*px + model->m6*py + model->m10*pz + model->m14;
+
+        Vector3 normal = { 0 };
+        if (mesh->normals != NULL)
+        {
+            Vector3 n = { mesh->normals[i*3 + 0], mesh->normals[i*3 + 1], mesh->normals[i*3 + 2] };
+            normal = Vector3Normalize((Vector3){ nm->m0*n.x + nm->m4*n.y + nm->m8*n.z, nm->m1*n.x + nm->m5*n.y + nm->m9*n.z, nm->m2*n.x + nm->m6*n.y + nm->m10*n.z });
+        }
+
+        // pbr.vert: tangent made orthogonal to the normal, binormal from both flipped by the tangent w sign
+        Vector3 tangent = { 0 };
+        Vector3 binormal = { 0 };
+        if ((draw->material->shading == SOFT_SHADING_PBR) && (mesh->tangents != NULL))
+        {
+            Vector3 t = { mesh->tangents[i*4 + 0], mesh->tangents[i*4 + 1], mesh->tangents[i*4 + 2] };
+            tangent = Vector3Normalize((Vector3){ nm->m0*t.x + nm->m4*t.y + nm->m8*t.z, nm->m1*t.x + nm->m5*t.y + nm->m9*t.z, nm->m2*t.x + nm->m6*t.y + nm->m10*t.z });
+            tangent = Vector3Normalize(Vector3Subtract(tangent, Vector3Scale(normal, Vector3DotProduct(tangent, normal))));
+            binormal = Vector3Scale(Vector3CrossProduct(normal, tangent), (mesh->tangents[i*4 + 3] < 0.0f)? -1.0f : 1.0f);
+        }
+
+        memcpy(vertex->normal, &normal, sizeof(vertex->normal));
+        memcpy(vertex->tangent, &tangent, sizeof(vertex->tangent));
+        memcpy(vertex->binormal, &binormal, sizeof(vertex->binormal));
+
+        // pbr.vert doubles the texture coordinates
+        float scale = (draw->material->shading == SOFT_SHADING_PBR)? 2.0f : 1.0f;
+        vertex->texcoord[0] = (mesh->texcoords != NULL)? mesh->texcoords[i*2 + 0]*scale : 0.0f;
+        vertex->texcoord[1] = (mesh->texcoords != NULL)? mesh->texcoords[i*2 + 1]*scale : 0.0f;
+
+        // Meshes without colors get the white default attribute
+        for (int c = 0; c < 4; c++) vertex->color[c] = (mesh->colors != NULL)? mesh->colors[i*4 + c]/255.0f : 1.0f;
+    }
+}
+
+// Set up and bin the triangles of a chunk range
+static void SetupSoftChunks(int start, int end, void *data)
+{
+    SoftRenderer *renderer = (SoftRenderer *)data;
+    int tileCount = renderer->tilesX*renderer->tilesY;
+
+    for (int c = start; c < end; c++)
+    {
+        SoftChunk *chunk = &renderer->chunks[c];
+        chunk->triangleCount = 0;
+        chunk->clipCount = 0;
+        for (int t = 0; t < tileCount; t++) renderer->bins[c*tileCount + t].count = 0;
+
+        int first = c*SOFT_CHUNK_TRIANGLES;
+        int last = (first + SOFT_CHUNK_TRIANGLES < renderer->triangleCount)? first + SOFT_CHUNK_TRIANGLES : renderer->triangleCount;
+        int d = FindSoftDraw(renderer, first, true);
+
+        for (int t = first; t < last; t++)
+        {
+            while (t >= renderer->draws[d].firstTriangle + renderer->draws[d].triangleCount) d++;
+
+            const SoftDraw *draw = &renderer->draws[d];
+            int i = t - draw->firstTriangle;
+            int indices[3] = { 0 };
+            bool valid = true;
+
+            for (int k = 0; k < 3; k++)
+            {
+                int index = (draw->mesh.indices != NULL)? draw->mesh.indices[i*3 + k] : i*3 + k;
+                valid = valid && (index < draw->mesh.vertexCount);
+                indices[k] = draw->firstVertex + index;
+            }
+
+            if (valid) ClipSoftTriangle(renderer, c, d, indices);
+        }
+    }
+}
+
+// Clip triangle against near and far planes and the guard band, add the resulting triangles
+static void ClipSoftTriangle(SoftRenderer *renderer, int chunk, int draw, const int *indices)
+{
+    const SoftVertex *v[3] = { &renderer->vertices[indices[0]], &renderer->vertices[indices[1]], &renderer->vertices[indices[2]] };
+    int outside[3] = { 0 };
+
+    // Distance to each plane, negative outside: near, far, left, right, bottom, top
+    for (int k = 0; k < 3; k++)
+    {
+        const float *p = v[k]->clip;
+        float distance[6] = { p[3] + p[2], p[3] - p[2], SOFT_GUARD_BAND*p[3] + p[0], SOFT_GUARD_BAND*p[3] - p[0], SOFT_GUARD_BAND*p[3] + p[1], SOFT_GUARD_BAND*p[3] - p[1] };
+        for (int plane = 0; plane < 6; plane++) if (distance[plane] < 0.0f) outside[k] |= (1 << plane);
+    }
+
+    if ((outside[0] & outside[1] & outside[2]) != 0) return;     // All outside one plane
+    if ((outside[0] | outside[1] | outside[2]) == 0)
+    {
+        AddSoftTriangle(renderer, chunk, draw, v, indices);
+        return;
+    }
+
+    // Sutherland-Hodgman against every plane crossed, new vertices have index 0
+    SoftVertex polygons[2][SOFT_CLIP_VERTICES];
+    int polygonIndices[2][SOFT_CLIP_VERTICES];
+    int count = 3;
+    int current = 0;
+    int crossed = outside[0] | outside[1] | outside[2];
+    int floats = sizeof(SoftVertex)/sizeof(float);
+
+    for (int k = 0; k < 3; k++)
+    {
+        polygons[0][k] = *v[k];
+        polygonIndices[0][k] = indices[k] + 1;
+    }
+
+    for (int plane = 0; (plane < 6) && (count >= 3); plane++)
+    {
+        if (!(crossed & (1 << plane))) continue;
+
+        const SoftVertex *in = polygons[current];
+        SoftVertex *out = polygons[1 - current];
+        const int *inIndices = polygonIndices[current];
+        int *outIndices = polygonIndices[1 - current];
+        int outCount = 0;
+
+        for (int k = 0; k < count; k++)
+        {
+            const SoftVertex *a = &in[k];
+            const SoftVertex *b = &in[(k + 1)%count];
+            float sign = (plane & 1)? -1.0f : 1.0f;
+            int axis = (plane < 2)? 2 : (plane < 4)? 0 : 1;
+            float band = (plane < 2)? 1.0f : SOFT_GUARD_BAND;
+            float da = band*a->clip[3] + sign*a->clip[axis];
+            float db = band*b->clip[3] + sign*b->clip[axis];
+
+            if (da >= 0.0f)
+            {
+                out[outCount] = *a;
+                outIndices[outCount++] = inIndices[k];
+            }
+
+            if ((da >= 0.0f) != (db >= 0.0f))
+            {
+                float t = da/(da - db);
+                const float *fa = (const float *)a;
+                const float *fb = (const float *)b;
+                float *fo = (float *)&out[outCount];
+
+                for (int f = 0; f < floats; f++) fo[f] = fa[f] + (fb[f] - fa[f])*t;
+                outIndices[outCount++] = 0;
+            }
+        }
+
+        count = outCount;
+        current = 1 - current;
+    }
+
+    if (count < 3) return;
+
+    // New vertices are kept by the chunk
+    SoftChunk *target = &renderer->chunks[chunk];
+    int fanIndices[SOFT_CLIP_VERTICES] = { 0 };
+
+    for (int k = 0; k < count; k++)
+    {
+        if (polygonIndices[current][k] > 0) fanIndices[k] = polygonIndices[current][k] - 1;
+        else
+        {
+            if (target->clipCount == target->clipCapacity)
+            {
+                target->clipCapacity = (target->clipCapacity > 0)? target->clipCapacity*2 : 64;
+                target->clipVertices = (SoftVertex *)RL_REALLOC(target->clipVertices, target->clipCapacity*sizeof(SoftVertex));
+            }
+
+            target->clipVertices[target->clipCount] = polygons[current][k];
+            fanIndices[k] = -(++target->clipCount);
+        }
+    }
+
+    for (int k = 1; k < count - 1; k++)
+    {
+        const SoftVertex *fan[3] = { &polygons[current][0], &polygons[current][k], &polygons[current][k + 1] };
+        int fanTriangle[3] = { fanIndices[0], fanIndices[k], fanIndices[k + 1] };
+
+        AddSoftTriangle(renderer, chunk, draw, fan, fanTriangle);
+    }
+}
+
+// Project and set up a clipped triangle, bin it into the tiles it touches
+static void AddSoftTriangle(SoftRenderer *renderer, int chunk, int draw, const SoftVertex *const *vertices, const int *indices)
+{
+    float x[3], y[3], z[3], invW[3];
+
+    for (int k = 0; k < 3; k++)
+    {
+        invW[k] = 1.0f/vertices[k]->clip[3];
+        x[k] = roundf((vertices[k]->clip[0]*invW[k]*0.5f + 0.5f)*renderer->width*SOFT_SUBPIXEL)/SOFT_SUBPIXEL;
+        y[k] = roundf((vertices[k]->clip[1]*invW[k]*0.5f + 0.5f)*renderer->height*SOFT_SUBPIXEL)/SOFT_SUBPIXEL;
+        z[k] = vertices[k]->clip[2]*invW[k]*0.5f + 0.5f;
+    }
+
+    // Counter clockwise is front facing, back faces and degenerate triangles are culled
+    float area = (x[1] - x[0])*(y[2] - y[0]) - (x[2] - x[0])*(y[1] - y[0]);
+    if (!(area > 0.0f)) return;
+
+    // Pixel centers inside the bounds
+    int minX = (int)ceilf(fminf(x[0], fminf(x[1], x[2])) - 0.5f);
+    int minY = (int)ceilf(fminf(y[0], fminf(y[1], y[2])) - 0.5f);
+    int maxX = (int)floorf(fmaxf(x[0], fmaxf(x[1], x[2])) - 0.5f);
+    int maxY = (int)floorf(fmaxf(y[0], fmaxf(y[1], y[2])) - 0.5f);
+
+    if (minX < 0) minX = 0;
+    if (minY < 0) minY = 0;
+    if (maxX > renderer->width - 1) maxX = renderer->width - 1;
+    if (maxY > renderer->height - 1) maxY = renderer->height - 1;
+    if ((minX > maxX) || (minY > maxY)) return;
+
+    SoftTriangle triangle = { 0 };
+    float invArea = 1.0f/area;
+
+    for (int i = 0; i < 3; i++)
+    {
+        int a = (i + 1)%3;
+        int b = (i + 2)%3;
+
+        triangle.edgeA[i] = y[a] - y[b];
+        triangle.edgeB[i] = x[b] - x[a];
+        triangle.edgeC[i] = x[a]*y[b] - x[b]*y[a];
+
+        // Top-left rule: pixels exactly on other edges belong to the neighbor triangle
+        bool topLeft = (triangle.edgeA[i] > 0.0f) || ((triangle.edgeA[i] == 0.0f) && (triangle.edgeB[i] < 0.0f));
+        triangle.edgeBias[i] = topLeft? 0.0f : FLT_MIN;
+        triangle.invW[i] = invW[i];
+        triangle.vertices[i] = indices[i];
+    }
+
+    triangle.depthA = (triangle.edgeA[0]*z[0] + triangle.edgeA[1]*z[1] + triangle.edgeA[2]*z[2])*invArea;
+    triangle.depthB = (triangle.edgeB[0]*z[0] + triangle.edgeB[1]*z[1] + triangle.edgeB[2]*z[2])*invArea;
+    triangle.depthC = (triangle.edgeC[0]*z[0] + triangle.edgeC[1]*z[1] + triangle.edgeC[2]*z[2])*invArea;
+    triangle.draw = draw;
+    triangle.minX = minX;
+    triangle.minY = minY;
+    triangle.maxX = maxX;
+    triangle.maxY = maxY;
+
+    SoftChunk *target = &renderer->chunks[chunk];
+    if (target->triangleCount == target->triangleCapacity)
+    {
+        target->triangleCapacity = (target->triangleCapacity > 0)? target->triangleCapacity*2 : 256;
+        target->triangles = (SoftTriangle *)RL_REALLOC(target->triangles, target->triangleCapacity*sizeof(SoftTriangle));
+    }
+
+    int item = target->triangleCount++;
+    target->triangles[item] = triangle;
+
+    // Bin into the tiles whose pixel centers can be inside every edge
+    int tileCount = renderer->tilesX*renderer->tilesY;
+    for (int ty = minY/SOFT_TILE_SIZE; ty <= maxY/SOFT_TILE_SIZE; ty++)
+    {
+        for (int tx = minX/SOFT_TILE_SIZE; tx <= maxX/SOFT_TILE_SIZE; tx++)
+        {
+            bool touched = true;
+
+            for (int i = 0; (i < 3) && touched; i++)
+            {
+                float cornerX = (triangle.edgeA[i] > 0.0f)? (tx + 1)*SOFT_TILE_SIZE - 0.5f : tx*SOFT_TILE_SIZE + 0.5f;
+                float cornerY = (triangle.edgeB[i] > 0.0f)? (ty + 1)*SOFT_TILE_SIZE - 0.5f : ty*SOFT_TILE_SIZE + 0.5f;
+                touched = (triangle.edgeA[i]*cornerX + triangle.edgeB[i]*cornerY + triangle.edgeC[i] >= 0.0f);
+            }
+
+            if (!touched) continue;
+
+            SoftBin *bin = &renderer->bins[chunk*tileCount + ty*renderer->tilesX + tx];
+            if (bin->count == bin->capacity)
+            {
+                bin->capacity = (bin->capacity > 0)? bin->capacity*2 : 64;
+                bin->items = (int *)RL_REALLOC(bin->items, bin->capacity*sizeof(int));
+            }
+            bin->items[bin->count++] = item;
+        }
+    }
+}
+
+// Render tiles until none is left, one job per worker
+static void RenderSoftWorkers(int start, int end, void *data)
+{
+    SoftRenderer *renderer = (SoftRenderer *)data;
+
+    for (int w = start; w < end; w++)
+    {
+        int tile = 0;
+        while (TakeSoftTile(renderer, w, &tile)) RenderSoftTile(renderer, &renderer->workers[w], tile);
+    }
+}
+
+// Take next tile of the worker range, when it is empty steal the back half of the largest range left
+static bool TakeSoftTile(SoftRenderer *renderer, int worker, int *tile)
+{
+    SoftWorker *self = &renderer->workers[worker];
+    unsigned long long range = atomic_load(&self->range);
+
+    while ((unsigned int)range < (unsigned int)(range >> 32))
+    {
+        unsigned int first = (unsigned int)range;
+        if (atomic_compare_exchange_weak(&self->range, &range, range + 1))
+        {
+            *tile = (int)first;
+            return true;
+        }
+    }
+
+    while (true)
+    {
+        int victim = -1;
+        unsigned int most = 0;
+
+        for (int w = 0; w < renderer->workerCount; w++)
+        {
+            unsigned long long other = atomic_load(&renderer->workers[w].range);
+            unsigned int left = ((unsigned int)other < (unsigned int)(other >> 32))? (unsigned int)(other >> 32) - (unsigned int)other : 0;
+
+            if ((w != worker) && (left > most))
+            {
+                most = left;
+                victim = w;
+            }
+        }
+
+        if (victim < 0) return false;
+
+        SoftWorker *other = &renderer->workers[victim];
+        unsigned long long stolen = atomic_load(&other->range);
+        unsigned int first = (unsigned int)stolen;
+        unsigned int end = (unsigned int)(stolen >> 32);
+
+        if (first >= end) continue;
+
+        unsigned int split = end - (end - first + 1)/2;
+        if (atomic_compare_exchange_strong(&other->range, &stolen, ((unsigned long long)split << 32) | first))
+        {
+            atomic_store(&self->range, ((unsigned long long)end << 32) | (split + 1));
+            self->steals++;
+            *tile = (int)split;
+            return true;
+        }
+    }
+}
+
+// Render one tile: visibility, shading of visible pixels, blending, then write it to the target
+static void RenderSoftTile(SoftRenderer *renderer, SoftWorker *worker, int tile)
+{
+    int tileCount = renderer->tilesX*renderer->tilesY;
+    int tileX = (tile%renderer->tilesX)*SOFT_TILE_SIZE;
+    int tileY = (tile/renderer->tilesX)*SOFT_TILE_SIZE;
+
+    for (int p = 0; p < SOFT_TILE_PIXELS; p++)
+    {
+        worker->depth[p] = 1.0f;
+        worker->triangle[p] = -1;
+        for (int c = 0; c < 4; c++) worker->color[c][p] = renderer->background[c];
+    }
+
+    // Pass 0 keeps the closest opaque triangle, pass 1 shades it, pass 2 blends the others in draw order
+    for (int pass = 0; pass < 3; pass++)
+    {
+        for (int c = 0; c < renderer->chunkCount; c++)
+        {
+            const SoftBin *bin = &renderer->bins[c*tileCount + tile];
+            const SoftChunk *chunk = &renderer->chunks[c];
+
+            for (int i = 0; i < bin->count; i++)
+            {
+                bool blend = renderer->draws[chunk->triangles[bin->items[i]].draw].material->blend;
+                if (blend == (pass == 2)) RasterizeSoftTriangle(renderer, worker, c, bin->items[i], tileX, tileY, pass);
+            }
+        }
+    }
+
+    int x1 = (tileX + SOFT_TILE_SIZE < renderer->width)? tileX + SOFT_TILE_SIZE : renderer->width;
+    int y1 = (tileY + SOFT_TILE_SIZE < renderer->height)? tileY + SOFT_TILE_SIZE : renderer->height;
+
+    for (int y = tileY; y < y1; y++)
+    {
+        unsigned char *row = renderer->pixels + (renderer->height - 1 - y)*renderer->width*4;
+        for (int x = tileX; x < x1; x++)
+        {
+            int p = (y - tileY)*SOFT_TILE_SIZE + (x - tileX);
+            for (int c = 0; c < 4; c++) row[x*4 + c] = (unsigned char)(Clamp(worker->color[c][p], 0.0f, 1.0f)*255.0f + 0.5f);
+        }
+    }
+
+    worker->tiles++;
+}
+
+// Scan the triangle pixels in the tile, SOFT_LANES at a time
+static void RasterizeSoftTriangle(const SoftRenderer *renderer, SoftWorker *worker, int chunk, int item, int tileX, int tileY, int pass)
+{
+    const SoftChunk *source = &renderer->chunks[chunk];
+    const SoftTriangle *triangle = &source->triangles[item];
+    const SoftMaterial *material = renderer->draws[triangle->draw].material;
+    const SoftVertex *vertices[3] = { 0 };
+    int id = chunk*SOFT_CHUNK_OUTPUT + item;
+
+    for (int k = 0; k < 3; k++)
+    {
+        int index = triangle->vertices[k];
+        vertices[k] = (index >= 0)? &renderer->vertices[index] : &source->clipVertices[-index - 1];
+    }
+
+    int x1 = (tileX + SOFT_TILE_SIZE < renderer->width)? tileX + SOFT_TILE_SIZE : renderer->width;
+    int rowStart = (triangle->minY > tileY)? triangle->minY : tileY;
+    int rowEnd = (triangle->maxY < tileY + SOFT_TILE_SIZE - 1)? triangle->maxY : tileY + SOFT_TILE_SIZE - 1;
+    int colStart = ((triangle->minX > tileX)? triangle->minX - tileX : 0) & ~(SOFT_LANES - 1);
+    int colEnd = (triangle->maxX < x1 - 1)? triangle->maxX - tileX : x1 - 1 - tileX;
+    bool alphaTest = (material->alphaCutoff > 0.0f) && (pass != 1);
+
+    SoftFloat edgeA[3], edgeB[3], edgeC[3], edgeBias[3], invW[3];
+    for (int i = 0; i < 3; i++)
+    {
+        edgeA[i] = SoftSet(triangle->edgeA[i]);
+        edgeB[i] = SoftSet(triangle->edgeB[i]);
+        edgeC[i] = SoftSet(triangle->edgeC[i]);
+        edgeBias[i] = SoftSet(triangle->edgeBias[i]);
+        invW[i] = SoftSet(triangle->invW[i]);
+    }
+
+    SoftFloat depthA = SoftSet(triangle->depthA);
+    SoftFloat depthB = SoftSet(triangle->depthB);
+    SoftFloat depthC = SoftSet(triangle->depthC);
+    SoftFloat right = SoftSet((float)x1);
+    SoftFloat centers = SoftLoad(softLaneCenters);
+    SoftInt triangleId = SoftIntSet(id);
+
+    for (int y = rowStart; y <= rowEnd; y++)
+    {
+        SoftFloat pixelY = SoftSet(y + 0.5f);
+
+        for (int col = colStart; col <= colEnd; col += SOFT_LANES)
+        {
+            int p = (y - tileY)*SOFT_TILE_SIZE + col;
+            SoftFloat pixelX = SoftAdd(SoftSet((float)(tileX + col)), centers);
+            SoftFloat edges[3];
+            SoftMask inside = SoftLess(pixelX, right);
+
+            for (int i = 0; i < 3; i++)
+            {
+                edges[i] = SoftAdd(SoftMul(edgeA[i], pixelX), SoftAdd(SoftMul(edgeB[i], pixelY), edgeC[i]));
+                inside = SoftMaskAnd(inside, SoftGreaterEqual(edges[i], edgeBias[i]));
+            }
+
+            if (pass == 1) inside = SoftMaskAnd(inside, SoftIntEqual(SoftIntLoad(&worker->triangle[p]), triangleId));
+            if (SoftMaskBits(inside) == 0) continue;
+
+            SoftFloat depth = SoftAdd(SoftMul(depthA, pixelX), SoftAdd(SoftMul(depthB, pixelY), depthC));
+            SoftFloat stored = SoftLoad(&worker->depth[p]);
+
+            if (pass != 1) inside = SoftMaskAnd(inside, SoftLessEqual(depth, stored));
+            int lanes = SoftMaskBits(inside);
+            if (lanes == 0) continue;
+
+            // Perspective correct barycentrics
+            SoftFloat lambda[3];
+            for (int i = 0; i < 3; i++) lambda[i] = SoftMul(edges[i], invW[i]);
+            SoftFloat sum = SoftDiv(SoftSet(1.0f), SoftAdd(SoftAdd(lambda[0], lambda[1]), lambda[2]));
+            for (int i = 0; i < 3; i++) lambda[i] = SoftMul(lambda[i], sum);
+
+            if (alphaTest)
+            {
+                // ALPHA_TEST in pbr.frag, the untiled texture coordinates
+                SoftFloat alpha = SoftSet(material->albedoColor.w);
+
+                if (material->albedoMap.data != NULL)
+                {
+                    SoftFloat u = SoftAdd(SoftAdd(SoftMul(lambda[0], SoftSet(vertices[0]->texcoord[0])), SoftMul(lambda[1], SoftSet(vertices[1]->texcoord[0]))), SoftMul(lambda[2], SoftSet(vertices[2]->texcoord[0])));
+                    SoftFloat v = SoftAdd(SoftAdd(SoftMul(lambda[0], SoftSet(vertices[0]->texcoord[1])), SoftMul(lambda[1], SoftSet(vertices[1]->texcoord[1]))), SoftMul(lambda[2], SoftSet(vertices[2]->texcoord[1])));
+                    SoftFloat texel[4];
+
+                    SampleSoftTexture(&material->albedoMap, &u, &v, lanes, texel);
+                    alpha = SoftMul(texel[3], alpha);
+                }
+
+                inside = SoftMaskAnd(inside, SoftGreaterEqual(alpha, SoftSet(material->alphaCutoff)));
+                lanes = SoftMaskBits(inside);
+                if (lanes == 0) continue;
+            }
+
+            if (pass == 0)
+            {
+                SoftStore(&worker->depth[p], SoftSelect(inside, depth, stored));
+                SoftIntStore(&worker->triangle[p], SoftIntSelect(inside, triangleId, SoftIntLoad(&worker->triangle[p])));
+                continue;
+            }
+
+            SoftFloat color[4];
+            ShadeSoftLanes(renderer, material, vertices, lambda, lanes, color);
+
+            for (int bits = lanes; bits != 0; bits &= bits - 1) worker->fragments++;
+
+            if (pass == 1)
+            {
+                for (int c = 0; c < 4; c++) SoftStore(&worker->color[c][p], SoftSelect(inside, color[c], SoftLoad(&worker->color[c][p])));
+            }
+            else
+            {
+                // SRC_ALPHA, ONE_MINUS_SRC_ALPHA, alpha blended the same way
+                SoftFloat alpha = color[3];
+                SoftFloat keep = SoftSub(SoftSet(1.0f), alpha);
+
+                for (int c = 0; c < 4; c++)
+                {
+                    SoftFloat target = SoftLoad(&worker->color[c][p]);
+                    SoftFloat blended = SoftAdd(SoftMul(color[c], alpha), SoftMul(target, keep));
+                    SoftStore(&worker->color[c][p], SoftSelect(inside, blended, target));
+                }
+            }
+        }
+    }
+}
+
+// Interpolate a vertex attribute with the barycentrics
+static inline SoftFloat SoftInterpolate(const SoftFloat *lambda, float a, float b, float c)
+{
+    return SoftAdd(SoftAdd(SoftMul(lambda[0], SoftSet(a)), SoftMul(lambda[1], SoftSet(b))), SoftMul(lambda[2], SoftSet(c)));
+}
+
+static inline SoftFloat SoftDot(SoftVector3 a, SoftVector3 b)
+{
+    return SoftAdd(SoftAdd(SoftMul(a.x, b.x), SoftMul(a.y, b.y)), SoftMul(a.z, b.z));
+}
+
+static inline SoftVector3 SoftNormalize(SoftVector3 v)
+{
+    SoftFloat length = SoftSqrt(SoftDot(v, v));
+    return (SoftVector3){ SoftDiv(v.x, length), SoftDiv(v.y, length), SoftDiv(v.z, length) };
+}
+
+static inline SoftVector3 SoftSplat(Vector3 v)
+{
+    return (SoftVector3){ SoftSet(v.x), SoftSet(v.y), SoftSet(v.z) };
+}
+
+static inline SoftVector3 SoftSubtract(SoftVector3 a, SoftVector3 b)
+{
+    return (SoftVector3){ SoftSub(a.x, b.x), SoftSub(a.y, b.y), SoftSub(a.z, b.z) };
+}
+
+static inline SoftFloat SoftClamp(SoftFloat value, float min, float max)
+{
+    return SoftMin(SoftMax(value, SoftSet(min)), SoftSet(max));
+}
+
+// Light reflected towards the viewer, ComputeLight() of pbr.frag
+static inline void ComputeSoftLight(SoftVector3 n, SoftVector3 v, SoftVector3 l, const SoftFloat *albedo, const SoftFloat *baseRefl, SoftFloat metallic, SoftFloat roughness, const SoftFloat *radiance, SoftFloat *result)
+{
+    SoftFloat one = SoftSet(1.0f);
+    SoftVector3 h = SoftNormalize((SoftVector3){ SoftAdd(v.x, l.x), SoftAdd(v.y, l.y), SoftAdd(v.z, l.z) });
+
+    SoftFloat nDotV = SoftMax(SoftDot(n, v), SoftSet(0.0000001f));
+    SoftFloat nDotL = SoftMax(SoftDot(n, l), SoftSet(0.0000001f));
+    SoftFloat hDotV = SoftMax(SoftDot(h, v), SoftSet(0.0f));
+    SoftFloat nDotH = SoftMax(SoftDot(n, h), SoftSet(0.0f));
+
+    // GgxDistribution()
+    SoftFloat a = SoftMul(SoftMul(roughness, roughness), SoftMul(roughness, roughness));
+    SoftFloat d = SoftAdd(SoftMul(SoftMul(nDotH, nDotH), SoftSub(a, one)), one);
+    d = SoftMul(SoftMul(SoftSet(PI), d), d);
+    SoftFloat distribution = SoftDiv(a, SoftMax(d, SoftSet(0.0000001f)));
+
+    // GeomSmith()
+    SoftFloat r = SoftAdd(roughness, one);
+    SoftFloat k = SoftDiv(SoftMul(r, r), SoftSet(8.0f));
+    SoftFloat ik = SoftSub(one, k);
+    SoftFloat geometry = SoftMul(SoftDiv(nDotV, SoftAdd(SoftMul(nDotV, ik), k)), SoftDiv(nDotL, SoftAdd(SoftMul(nDotL, ik), k)));
+
+    // SchlickFresnel(), pow(1 - hDotV, 5)
+    SoftFloat t = SoftSub(one, hDotV);
+    SoftFloat t2 = SoftMul(t, t);
+    SoftFloat t5 = SoftMul(SoftMul(t2, t2), t);
+
+    SoftFloat specular = SoftDiv(SoftMul(distribution, geometry), SoftMul(SoftMul(SoftSet(4.0f), nDotV), nDotL));
+    SoftFloat diffuse = SoftSub(one, metallic);
+
+    for (int c = 0; c < 3; c++)
+    {
+        SoftFloat fresnel = SoftAdd(baseRefl[c], SoftMul(SoftSub(one, baseRefl[c]), t5));
+        SoftFloat kD = SoftMul(SoftSub(one, fresnel), diffuse);
+        SoftFloat brdf = SoftAdd(SoftDiv(SoftMul(kD, albedo[c]), SoftSet(PI)), SoftMul(specular, fresnel));
+        result[c] = SoftAdd(result[c], SoftMul(SoftMul(brdf, radiance[c]), nDotL));
+    }
+}
+
+// Fragment shader of the material for the active lanes, outputs clamped to [0..1]
+static void ShadeSoftLanes(const SoftRenderer *renderer, const SoftMaterial *material, const SoftVertex *const *vertices, const SoftFloat *lambda, int lanes, SoftFloat *color)
+{
+    const SoftVertex *v0 = vertices[0];
+    const SoftVertex *v1 = vertices[1];
+    const SoftVertex *v2 = vertices[2];
+    SoftFloat zero = SoftSet(0.0f);
+
+    SoftVector3 position = {
+        SoftInterpolate(lambda, v0->position[0], v1->position[0], v2->position[0]),
+        SoftInterpolate(lambda, v0->position[1], v1->position[1], v2->position[1]),
+        SoftInterpolate(lambda, v0->position[2], v1->position[2], v2->position[2])
+    };
+    SoftVector3 normal = SoftNormalize((SoftVector3){
+        SoftInterpolate(lambda, v0->normal[0], v1->normal[0], v2->normal[0]),
+        SoftInterpolate(lambda, v0->normal[1], v1->normal[1], v2->normal[1]),
+        SoftInterpolate(lambda, v0->normal[2], v1->normal[2], v2->normal[2])
+    });
+    SoftFloat texU = SoftInterpolate(lambda, v0->texcoord[0], v1->texcoord[0], v2->texcoord[0]);
+    SoftFloat texV = SoftInterpolate(lambda, v0->texcoord[1], v1->texcoord[1], v2->texcoord[1]);
+    SoftVector3 view = SoftNormalize(SoftSubtract(SoftSplat(renderer->viewPosition), position));
+    float output[4][SOFT_LANES];
+
+    if (material->shading == SOFT_SHADING_PBR)
+    {
+        SoftFloat u = SoftAdd(SoftMul(texU, SoftSet(material->tiling.x)), SoftSet(material->offset.x));
+        SoftFloat v = SoftAdd(SoftMul(texV, SoftSet(material->tiling.y)), SoftSet(material->offset.y));
+        SoftFloat texel[4];
+
+        SoftFloat albedo[3] = { SoftSet(material->albedoColor.x), SoftSet(material->albedoColor.y), SoftSet(material->albedoColor.z) };
+        if (material->albedoMap.data != NULL)
+        {
+            SampleSoftTexture(&material->albedoMap, &u, &v, lanes, texel);
+            for (int c = 0; c < 3; c++) albedo[c] = SoftMul(texel[c], albedo[c]);
+        }
+
+        SoftFloat metallic = SoftClamp(SoftSet(material->metallicValue), 0.0f, 1.0f);
+        SoftFloat roughness = SoftClamp(SoftSet(material->roughnessValue), 0.0f, 1.0f);
+        SoftFloat occlusion = SoftClamp(SoftSet(material->aoValue), 0.0f, 1.0f);
+        if (material->mraMap.data != NULL)
+        {
+            SampleSoftTexture(&material->mraMap, &u, &v, lanes, texel);
+            metallic = SoftClamp(SoftAdd(texel[2], SoftSet(material->metallicValue)), 0.04f, 1.0f);
+            roughness = SoftClamp(SoftAdd(texel[1], SoftSet(material->roughnessValue)), 0.04f, 1.0f);
+            occlusion = SoftMul(SoftAdd(texel[0], SoftSet(material->aoValue)), SoftSet(0.5f));
+        }
+
+        if (material->normalMap.data != NULL)
+        {
+            // pbr.frag offsets both normal map coordinates by offset.y
+            SoftFloat nu = SoftAdd(SoftMul(texU, SoftSet(material->tiling.x)), SoftSet(material->offset.y));
+            SoftFloat two = SoftSet(2.0f);
+            SoftFloat one = SoftSet(1.0f);
+
+            SampleSoftTexture(&material->normalMap, &nu, &v, lanes, texel);
+            SoftFloat nx = SoftSub(SoftMul(SoftMul(texel[0], texel[3]), two), one);
+            SoftFloat ny = SoftSub(SoftMul(texel[1], two), one);
+            SoftFloat nz = SoftSqrt(SoftMax(SoftSub(one, SoftAdd(SoftMul(nx, nx), SoftMul(ny, ny))), zero));
+
+            // TBN columns interpolated as they are, not normalized
+            SoftVector3 t = { SoftInterpolate(lambda, v0->tangent[0], v1->tangent[0], v2->tangent[0]), SoftInterpolate(lambda, v0->tangent[1], v1->tangent[1], v2->tangent[1]), SoftInterpolate(lambda, v0->tangent[2], v1->tangent[2], v2->tangent[2]) };
+            SoftVector3 b = { SoftInterpolate(lambda, v0->binormal[0], v1->binormal[0], v2->binormal[0]), SoftInterpolate(lambda, v0->binormal[1], v1->binormal[1], v2->binormal[1]), SoftInterpolate(lambda, v0->binormal[2], v1->binormal[2], v2->binormal[2]) };
+            SoftVector3 n = { SoftInterpolate(lambda, v0->normal[0], v1->normal[0], v2->normal[0]), SoftInterpolate(lambda, v0->normal[1], v1->normal[1], v2->normal[1]), SoftInterpolate(lambda, v0->normal[2], v1->normal[2], v2->normal[2]) };
+
+            normal = SoftNormalize((SoftVector3){
+                SoftAdd(SoftAdd(SoftMul(t.x, nx), SoftMul(b.x, ny)), SoftMul(n.x, nz)),
+                SoftAdd(SoftAdd(SoftMul(t.y, nx), SoftMul(b.y, ny)), SoftMul(n.y, nz)),
+                SoftAdd(SoftAdd(SoftMul(t.z, nx), SoftMul(b.z, ny)), SoftMul(n.z, nz))
+            });
+        }
+
+        SoftFloat emissive[3] = { zero, zero, zero };
+        if (material->emissiveMap.data != NULL)
+        {
+            SampleSoftTexture(&material->emissiveMap, &u, &v, lanes, texel);
+            emissive[0] = SoftMul(texel[1], SoftSet(material->emissiveColor.x*material->emissivePower));
+            emissive[1] = SoftMul(texel[1], SoftSet(material->emissiveColor.y*material->emissivePower));
+            emissive[2] = SoftMul(texel[1], SoftSet(material->emissiveColor.z*material->emissivePower));
+        }
+
+        SoftFloat baseRefl[3];
+        for (int c = 0; c < 3; c++) baseRefl[c] = SoftAdd(SoftSet(0.04f), SoftMul(SoftSub(albedo[c], SoftSet(0.04f)), metallic));
+
+        SoftFloat lightAccum[3] = { zero, zero, zero };
+        for (int i = 0; i < renderer->lightCount; i++)
+        {
+            const SoftLight *light = &renderer->lights[i];
+            if (!light->enabled) continue;
+
+            float color[3] = { light->color.x*light->intensity, light->color.y*light->intensity, light->color.z*light->intensity };
+            SoftFloat radiance[3];
+            SoftVector3 l;
+
+            if (light->type == SOFT_LIGHT_DIRECTIONAL)
+            {
+                l = SoftSplat(Vector3Normalize(Vector3Subtract(light->position, light->target)));
+                for (int c = 0; c < 3; c++) radiance[c] = SoftSet(color[c]);
+            }
+            else
+            {
+                // GetPointRadiance()
+                SoftVector3 toLight = SoftSubtract(SoftSplat(light->position), position);
+                SoftFloat distance = SoftSqrt(SoftDot(toLight, toLight));
+                SoftFloat attenuation = SoftDiv(SoftSet(1.0f), SoftMul(SoftMul(distance, distance), SoftSet(0.23f)));
+
+                if (light->radius > 0.0f)
+                {
+                    SoftFloat ratio = SoftDiv(distance, SoftSet(light->radius));
+                    SoftFloat ratio2 = SoftMul(ratio, ratio);
+                    SoftFloat falloff = SoftClamp(SoftSub(SoftSet(1.0f), SoftMul(ratio2, ratio2)), 0.0f, 1.0f);
+                    attenuation = SoftMul(attenuation, SoftMul(falloff, falloff));
+                }
+
+                l = SoftNormalize(toLight);
+                for (int c = 0; c < 3; c++) radiance[c] = SoftMul(SoftSet(color[c]), attenuation);
+            }
+
+            ComputeSoftLight(normal, view, l, albedo, baseRefl, metallic, roughness, radiance, lightAccum);
+        }
+
+        for (int c = 0; c < 3; c++)
+        {
+            float ambientColor = (c == 0)? material->ambientColor.x : (c == 1)? material->ambientColor.y : material->ambientColor.z;
+            SoftFloat ambientFinal = SoftMul(SoftMul(SoftAdd(SoftSet(ambientColor), albedo[c]), SoftSet(material->ambient)), SoftSet(0.5f));
+            SoftStore(output[c], SoftAdd(SoftAdd(ambientFinal, SoftMul(lightAccum[c], occlusion)), emissive[c]));
+        }
+
+        // Tonemap and gamma correction of the LDR output, per lane
+        for (int lane = 0; lane < SOFT_LANES; lane++)
+        {
+            if (!(lanes & (1 << lane))) continue;
+
+            for (int c = 0; c < 3; c++)
+            {
+                float value = fmaxf(output[c][lane], 0.0f);
+                output[c][lane] = powf(powf(value, value + 1.0f), 1.0f/2.2f);
+            }
+            output[3][lane] = material->albedoColor.w;
+        }
+    }
+    else
+    {
+        SoftFloat texel[4] = { SoftSet(1.0f), SoftSet(1.0f), SoftSet(1.0f), SoftSet(1.0f) };
+        if (material->albedoMap.data != NULL) SampleSoftTexture(&material->albedoMap, &texU, &texV, lanes, texel);
+
+        const float diffuse[4] = { material->albedoColor.x, material->albedoColor.y, material->albedoColor.z, material->albedoColor.w };
+        const float ambient[4] = { material->ambientColor.x, material->ambientColor.y, material->ambientColor.z, material->ambient };
+        SoftFloat tint[4];
+        for (int c = 0; c < 4; c++) tint[c] = SoftMul(SoftSet(diffuse[c]), SoftInterpolate(lambda, v0->color[c], v1->color[c], v2->color[c]));
+
+        SoftFloat lightDot[3] = { zero, zero, zero };
+        SoftFloat specular = zero;
+
+        for (int i = 0; i < renderer->lightCount; i++)
+        {
+            const SoftLight *light = &renderer->lights[i];
+            if (!light->enabled) continue;
+
+            SoftVector3 l;
+            if (light->type == SOFT_LIGHT_DIRECTIONAL) l = SoftSplat(Vector3Negate(Vector3Normalize(Vector3Subtract(light->target, light->position))));
+            else l = SoftNormalize(SoftSubtract(SoftSplat(light->position), position));
+
+            SoftFloat nDotL = SoftMax(SoftDot(normal, l), zero);
+            lightDot[0] = SoftAdd(lightDot[0], SoftMul(SoftSet(light->color.x), nDotL));
+            lightDot[1] = SoftAdd(lightDot[1], SoftMul(SoftSet(light->color.y), nDotL));
+            lightDot[2] = SoftAdd(lightDot[2], SoftMul(SoftSet(light->color.z), nDotL));
+
+            // reflect(-light, normal), shininess 16
+            SoftFloat twice = SoftMul(SoftSet(2.0f), SoftDot(normal, l));
+            SoftVector3 reflected = { SoftSub(SoftMul(twice, normal.x), l.x), SoftSub(SoftMul(twice, normal.y), l.y), SoftSub(SoftMul(twice, normal.z), l.z) };
+            SoftFloat s = SoftMax(SoftDot(view, reflected), zero);
+            s = SoftMul(s, s);
+            s = SoftMul(s, s);
+            s = SoftMul(s, s);
+            s = SoftMul(s, s);
+            specular = SoftAdd(specular, SoftSelect(SoftGreater(nDotL, zero), s, zero));
+        }
+
+        for (int c = 0; c < 4; c++)
+        {
+            SoftFloat lit = (c < 3)? SoftMul(SoftAdd(tint[c], specular), lightDot[c]) : SoftAdd(tint[c], SoftSet(1.0f));
+            SoftFloat ambientTerm = SoftMul(SoftSet(ambient[c]/10.0f), tint[c]);
+            SoftStore(output[c], SoftAdd(SoftMul(texel[c], lit), SoftMul(texel[c], ambientTerm)));
+        }
+
+        // Gamma correction, alpha included
+        for (int lane = 0; lane < SOFT_LANES; lane++)
+        {
+            if (!(lanes & (1 << lane))) continue;
+            for (int c = 0; c < 4; c++) output[c][lane] = powf(fmaxf(output[c][lane], 0.0f), 1.0f/2.2f);
+        }
+    }
+
+    for (int c = 0; c < 4; c++) color[c] = SoftClamp(SoftLoad(output[c]), 0.0f, 1.0f);
+}
+
+// Sample R8G8B8A8 image for the active lanes: bilinear, repeat wrapping, level 0 (GL_LINEAR without mipmaps)
+static void SampleSoftTexture(const Image *map, const SoftFloat *u, const SoftFloat *v, int lanes, SoftFloat *texel)
+{
+    float us[SOFT_LANES], vs[SOFT_LANES];
+    float result[4][SOFT_LANES] = { 0 };
+    const unsigned char *pixels = (const unsigned char *)map->data;
+    int width = map->width;
+    int height = map->height;
+
+    SoftStore(us, *u);
+    SoftStore(vs, *v);
+
+    for (int lane = 0; lane < SOFT_LANES; lane++)
+    {
+        if (!(lanes & (1 << lane))) continue;
+
+        float x = us[lane]*width - 0.5f;
+        float y = vs[lane]*height - 0.5f;
+        if (!(fabsf(x) < 1e7f) || !(fabsf(y) < 1e7f)) continue;     // Also NaN
+
+        float fx = floorf(x);
+        float fy = floorf(y);
+        float tx = x - fx;
+        float ty = y - fy;
+
+        int x0 = (int)fmodf(fx, (float)width);
+        int y0 = (int)fmodf(fy, (float)height);
+        if (x0 < 0) x0 += width;
+        if (y0 < 0) y0 += height;
+        int x1 = (x0 + 1 < width)? x0 + 1 : 0;
+        int y1 = (y0 + 1 < height)? y0 + 1 : 0;
+
+        const unsigned char *p00 = pixels + (y0*width + x0)*4;
+        const unsigned char *p10 = pixels + (y0*width + x1)*4;
+        const unsigned char *p01 = pixels + (y1*width + x0)*4;
+        const unsigned char *p11 = pixels + (y1*width + x1)*4;
+
+        for (int c = 0; c < 4; c++)
+        {
+            float bottom = p00[c] + (p10[c] - p00[c])*tx;
+            float top = p01[c] + (p11[c] - p01[c])*tx;
+            result[c][lane] = (bottom + (top - bottom)*ty)/255.0f;
+        }
+    }
+
+    for (int c = 0; c < 4; c++) texel[c] = SoftLoad(result[c]);
+}
+
+#endif // RSOFT_IMPLEMENTATION
@@ -0,0 +1,20 @@
+#version 330
+
+// Depth only pass, no color attachment or color writes disabled: nothing to write
+// Variant defines, set by the loader (see main.c):
+// ALPHA_TEST: discard fragments below the material alpha cutoff, same test as pbr.frag
+
+#if defined(ALPHA_TEST)
+in vec2 fragTexCoord;
+
+uniform sampler2D texture0;     // Albedo map
+uniform vec4 colDiffuse;        // Albedo color
+uniform float alphaCutoff;
+#endif
+
+void main()
+{
+#if defined(ALPHA_TEST)
+    if (texture(texture0, fragTexCoord).a*colDiffuse.a < alphaCutoff) discard;
+#endif
+}
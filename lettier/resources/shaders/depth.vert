@@ -0,0 +1,42 @@
+#version 330
+
+// Depth only pass: shadow maps (see rshadow.h) and the depth pre-pass (see rqueue.h)
+// Variant defines, set by the loader (see main.c):
+// QUANTIZED_VERTICES: scene file vertices are quantized (see rscene.h), decoded before use
+// ALPHA_TEST: pass the texture coordinates for the alpha test in depth.frag
+
+// Input vertex attributes
+#if defined(QUANTIZED_VERTICES)
+in vec4 vertexPosition;         // Normalized in the batch bounds
+#else
+in vec3 vertexPosition;
+#endif
+#if defined(ALPHA_TEST)
+in vec2 vertexTexCoord;
+#endif
+
+// Input uniform values
+uniform mat4 mvp;
+uniform vec3 positionDequant[2];    // Offset and scale of quantized positions
+
+#if defined(ALPHA_TEST)
+out vec2 fragTexCoord;
+#endif
+
+// Pre-pass depth has to match the shading pass exactly, see pbr.vert
+invariant gl_Position;
+
+void main()
+{
+#if defined(QUANTIZED_VERTICES)
+    vec3 position = positionDequant[0] + vertexPosition.xyz*positionDequant[1];
+#else
+    vec3 position = vertexPosition;
+#endif
+
+#if defined(ALPHA_TEST)
+    fragTexCoord = vertexTexCoord*2.0;  // Same as pbr.vert
+#endif
+
+    gl_Position = mvp*vec4(position, 1.0);
+}
@@ -0,0 +1,25 @@
+#version 330
+
+// Input uniform values
+uniform sampler2D oitAccum;     // rgb: sum of color*alpha*weight, a: revealage
+uniform sampler2D oitWeight;    // r: sum of alpha*weight
+
+// Output fragment color
+out vec4 finalColor;
+
+// NOTE: Targets are the scene framebuffer size, the fragment reads its own pixel
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    vec4 accum = texelFetch(oitAccum, pixel, 0);
+
+    // No transparent surface in this pixel
+    if (accum.a >= 1.0) discard;
+
+    float weight = texelFetch(oitWeight, pixel, 0).r;
+    vec3 color = accum.rgb/clamp(weight, 1e-4, 5e4);
+
+    // Weighted average color covering 1 - revealage, alpha blended over the scene
+    finalColor = vec4(color, 1.0 - accum.a);
+}
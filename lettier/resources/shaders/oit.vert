@@ -0,0 +1,10 @@
+#version 330
+
+// NOTE: Composite triangle drawn by EndTransparency() without vertex buffers (see roit.h),
+// the vertex index gives the corners (-1, -1), (3, -1) and (-1, 3), covering the viewport
+
+void main()
+{
+    vec2 position = vec2(float((gl_VertexID & 1)*4 - 1), float((gl_VertexID & 2)*2 - 1));
+    gl_Position = vec4(position, 0.0, 1.0);
+}
@@ -1,17 +1,41 @@
 #version 330
 
-#define MAX_LIGHTS              4
+#define MAX_LIGHTS              128     // Must match MAX_LIGHTS in rlights.h
 #define LIGHT_DIRECTIONAL       0
 #define LIGHT_POINT             1
 #define PI 3.14159265358979323846
 
+// Variant defines, set per material by the loader (see main.c):
+// HAS_ALBEDO_MAP, HAS_NORMAL_MAP, HAS_MRA_MAP, HAS_EMISSIVE_MAP: sample the map
+// ALPHA_TEST: discard fragments below the material alpha cutoff, same test as depth.frag
+// LIGHT_COUNT: lights in the light buffer, gives the light loop a constant bound
+// SHADOW_POINTS, SHADOW_CASCADES, SHADOW_PCF: shadow maps sampled and taps per lookup (see rshadow.h)
+// HDR_OUTPUT: write linear color to the HDR scene target, tonemap and gamma run once per pixel (see rpost.h)
+// OIT_OUTPUT: blended material drawn into the weighted blended transparency targets (see roit.h)
+
+// Must match the CLUSTER_* defines in rcluster.h
+#define CLUSTER_GRID_X          16
+#define CLUSTER_GRID_Y          9
+#define CLUSTER_GRID_Z          24
+
+// Shadow lookups: SHADOW_PCF taps on a square grid, every tap is a hardware 2x2 PCF
+#if defined(SHADOW_PCF) && (SHADOW_PCF >= 16)
+    #define SHADOW_PCF_SIDE     4
+#elif defined(SHADOW_PCF) && (SHADOW_PCF >= 4)
+    #define SHADOW_PCF_SIDE     2
+#else
+    #define SHADOW_PCF_SIDE     1
+#endif
+
+// std140 layout, matches LightData in rlights.h
 struct Light {
     int enabled;
     int type;
-    vec3 position;
-    vec3 target;
-    vec4 color;
     float intensity;
+    float radius;
+    vec4 position;
+    vec4 target;
+    vec4 color;
 };
 
 // Input vertex attributes (from vertex shader)
@@ -19,14 +43,18 @@ in vec3 fragPosition;
 in vec2 fragTexCoord;
 in vec4 fragColor;
 in vec3 fragNormal;
-in vec4 shadowPos;
+in vec4 shadowPos;              // xyz: offset world position, w: view depth
 in mat3 TBN;
 
 // Output fragment color
+#if defined(OIT_OUTPUT)
+layout(location = 0) out vec4 finalColor;   // rgb: color*alpha*weight, a: alpha, blended into the revealage
+layout(location = 1) out float oitWeight;   // alpha*weight
+#else
 out vec4 finalColor;
+#endif
 
 // Input uniform values
-uniform int numOfLights;
 uniform sampler2D albedoMap;
 uniform sampler2D mraMap;
 uniform sampler2D normalMap;
@@ -35,11 +63,6 @@ uniform sampler2D emissiveMap; // r: Hight g:emissive
 uniform vec2 tiling;
 uniform vec2 offset;
 
-uniform int useTexAlbedo;
-uniform int useTexNormal;
-uniform int useTexMRA;
-uniform int useTexEmissive;
-
 uniform vec4  albedoColor;
 uniform vec4  emissiveColor;
 uniform float normalValue;
@@ -47,10 +70,46 @@ uniform float metallicValue;
 uniform float roughnessValue;
 uniform float aoValue;
 uniform float emissivePower;
+uniform float alphaCutoff;
 
 // Input lighting values
-uniform Light lights[MAX_LIGHTS];
+layout(std140) uniform LightBlock {
+    int lightCount;
+    Light lights[MAX_LIGHTS];
+};
 uniform vec3 viewPos;
+uniform mat4 matView;
+
+// Clustered point lights, see rcluster.h
+uniform int useClusters;
+uniform samplerBuffer clusterLights;    // 2 texels per light: position and radius, color times intensity
+uniform usamplerBuffer clusterGrid;     // Per froxel: offset and count in clusterIndices
+uniform usamplerBuffer clusterIndices;
+uniform vec4 clusterParams;             // x: near, y: slices/log(far/near), zw: 1/framebuffer size
+
+// Shadow maps, see rshadow.h
+// NOTE: Separate cube samplers, GLSL 330 cannot index sampler arrays with a non constant
+#if defined(SHADOW_POINTS) && (SHADOW_POINTS > 0)
+uniform samplerCubeShadow shadowCube0;
+#endif
+#if defined(SHADOW_POINTS) && (SHADOW_POINTS > 1)
+uniform samplerCubeShadow shadowCube1;
+#endif
+#if defined(SHADOW_POINTS) && (SHADOW_POINTS > 2)
+uniform samplerCubeShadow shadowCube2;
+#endif
+#if defined(SHADOW_POINTS) && (SHADOW_POINTS > 3)
+uniform samplerCubeShadow shadowCube3;
+#endif
+#if defined(SHADOW_CASCADES)
+uniform sampler2DArrayShadow shadowCascades;
+uniform mat4 shadowCascadeMatrices[SHADOW_CASCADES];   // World to light clip space
+uniform float shadowCascadeSplits[SHADOW_CASCADES];    // View depth where every cascade ends
+#endif
+uniform int shadowPointLights[4];       // Light buffer index of every cube map, -1 unused
+uniform float shadowPointFar[4];
+uniform int shadowDirectionalLight;     // Light buffer index of the cascaded light, -1 unused
+uniform vec4 shadowParams;              // x: point near plane, y: cube texel size at unit distance, z: cascade texel size
 
 uniform vec3 ambientColor;
 uniform float ambient;
@@ -80,67 +139,210 @@ float GeomSmith(float nDotV,float nDotL,float roughness)
     return ggx1*ggx2;
 }
 
-vec3 ComputePBR()
+// Input radiance of a point light, light energy comming in
+vec3 GetPointRadiance(vec3 lightPos, float radius, vec3 color)
 {
-    vec3 albedo = texture(albedoMap,vec2(fragTexCoord.x*tiling.x + offset.x, fragTexCoord.y*tiling.y + offset.y)).rgb;
-    albedo = vec3(albedoColor.x*albedo.x, albedoColor.y*albedo.y, albedoColor.z*albedo.z);
+    float dist = length(lightPos - fragPosition);       // Compute distance to light
+    float attenuation = 1.0/(dist*dist*0.23);           // Compute attenuation
 
-    float metallic = clamp(metallicValue, 0.0, 1.0);
-    float roughness = clamp(roughnessValue, 0.0, 1.0);
-    float ao = clamp(aoValue, 0.0, 1.0);
+    // Fade to zero at the light radius so lights can be binned by range
+    if (radius > 0.0)
+    {
+        float falloff = clamp(1.0 - pow(dist/radius, 4.0), 0.0, 1.0);
+        attenuation *= falloff*falloff;
+    }
 
-    if (useTexMRA == 1)
+    return color*attenuation;
+}
+
+// Light reflected towards the viewer, L points to the light
+vec3 ComputeLight(vec3 N, vec3 V, vec3 albedo, vec3 baseRefl, float metallic, float roughness, vec3 L, vec3 radiance)
+{
+    vec3 H = normalize(V + L);                          // Compute halfway bisecting vector
+
+    // Cook-Torrance BRDF distribution function
+    float nDotV = max(dot(N,V), 0.0000001);
+    float nDotL = max(dot(N,L), 0.0000001);
+    float hDotV = max(dot(H,V), 0.0);
+    float nDotH = max(dot(N,H), 0.0);
+    float D = GgxDistribution(nDotH, roughness);    // Larger the more micro-facets aligned to H
+    float G = GeomSmith(nDotV, nDotL, roughness);   // Smaller the more micro-facets shadow
+    vec3 F = SchlickFresnel(hDotV, baseRefl);       // Fresnel proportion of specular reflectance
+
+    vec3 spec = (D*G*F)/(4.0*nDotV*nDotL);
+
+    // Difuse and spec light can't be above 1.0
+    // kD = 1.0 - kS  diffuse component is equal 1.0 - spec comonent
+    vec3 kD = vec3(1.0) - F;
+
+    // Mult kD by the inverse of metallnes, only non-metals should have diffuse light
+    kD *= 1.0 - metallic;
+
+    return (kD*albedo/PI + spec)*radiance*nDotL;    // Angle of light has impact on result
+}
+
+#if defined(SHADOW_POINTS) && (SHADOW_POINTS > 0)
+// Visible fraction of a point light from its cube map
+float GetPointShadow(samplerCubeShadow map, vec3 lightPos, float far)
+{
+    vec3 v = shadowPos.xyz - lightPos;
+    vec3 a = abs(v);
+    float z = max(a.x, max(a.y, a.z));      // Depth in the face the lookup lands in
+    float near = shadowParams.x;
+
+    if (z >= far) return 1.0;
+
+    // Same depth the face projection wrote
+    float depth = ((far + near)/(far - near) - 2.0*far*near/((far - near)*z))*0.5 + 0.5;
+
+    // Taps on a grid perpendicular to the lookup direction, one texel apart
+    vec3 tangent = normalize(cross(v, (a.y < 0.9*z)? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+    vec3 bitangent = normalize(cross(v, tangent));
+    float texel = z*shadowParams.y;
+    float lit = 0.0;
+
+    for (int y = 0; y < SHADOW_PCF_SIDE; y++)
     {
-        vec4 mra = texture(mraMap, vec2(fragTexCoord.x*tiling.x + offset.x, fragTexCoord.y*tiling.y + offset.y));
-        metallic = clamp(mra.r + metallicValue, 0.04, 1.0);
-        roughness = clamp(mra.g + roughnessValue, 0.04, 1.0);
-        ao = (mra.b + aoValue)*0.5;
+        for (int x = 0; x < SHADOW_PCF_SIDE; x++)
+        {
+            vec2 offset = (vec2(x, y) - 0.5*float(SHADOW_PCF_SIDE - 1))*texel;
+            lit += texture(map, vec4(v + tangent*offset.x + bitangent*offset.y, depth));
+        }
     }
 
-    vec3 N = normalize(fragNormal);
-    if (useTexNormal == 1)
+    return lit/float(SHADOW_PCF_SIDE*SHADOW_PCF_SIDE);
+}
+#endif
+
+#if defined(SHADOW_CASCADES)
+// Visible fraction of the directional light from the cascade covering the fragment depth
+float GetCascadeShadow()
+{
+    if (shadowPos.w >= shadowCascadeSplits[SHADOW_CASCADES - 1]) return 1.0;
+
+    int cascade = 0;
+    for (int c = 0; c < SHADOW_CASCADES - 1; c++) if (shadowPos.w >= shadowCascadeSplits[c]) cascade = c + 1;
+
+    vec4 clip = shadowCascadeMatrices[cascade]*vec4(shadowPos.xyz, 1.0);
+    vec3 coord = clip.xyz/clip.w*0.5 + 0.5;
+    float lit = 0.0;
+
+    for (int y = 0; y < SHADOW_PCF_SIDE; y++)
     {
-        N = texture(normalMap, vec2(fragTexCoord.x*tiling.x + offset.y, fragTexCoord.y*tiling.y + offset.y)).rgb;
-        N = normalize(N*2.0 - 1.0);
-        N = normalize(N*TBN);
+        for (int x = 0; x < SHADOW_PCF_SIDE; x++)
+        {
+            vec2 offset = (vec2(x, y) - 0.5*float(SHADOW_PCF_SIDE - 1))*shadowParams.z;
+            lit += texture(shadowCascades, vec4(coord.xy + offset, float(cascade), coord.z));
+        }
     }
 
+    return lit/float(SHADOW_PCF_SIDE*SHADOW_PCF_SIDE);
+}
+#endif
+
+// Visible fraction of a light buffer light, 1.0 for lights without a shadow map
+float GetLightShadow(int light)
+{
+#if defined(SHADOW_CASCADES)
+    if (light == shadowDirectionalLight) return GetCascadeShadow();
+#endif
+#if defined(SHADOW_POINTS) && (SHADOW_POINTS > 0)
+    if (light == shadowPointLights[0]) return GetPointShadow(shadowCube0, lights[light].position.xyz, shadowPointFar[0]);
+#endif
+#if defined(SHADOW_POINTS) && (SHADOW_POINTS > 1)
+    if (light == shadowPointLights[1]) return GetPointShadow(shadowCube1, lights[light].position.xyz, shadowPointFar[1]);
+#endif
+#if defined(SHADOW_POINTS) && (SHADOW_POINTS > 2)
+    if (light == shadowPointLights[2]) return GetPointShadow(shadowCube2, lights[light].position.xyz, shadowPointFar[2]);
+#endif
+#if defined(SHADOW_POINTS) && (SHADOW_POINTS > 3)
+    if (light == shadowPointLights[3]) return GetPointShadow(shadowCube3, lights[light].position.xyz, shadowPointFar[3]);
+#endif
+
+    return 1.0;
+}
+
+vec3 ComputePBR()
+{
+    vec2 uv = vec2(fragTexCoord.x*tiling.x + offset.x, fragTexCoord.y*tiling.y + offset.y);
+
+#if defined(HAS_ALBEDO_MAP)
+    vec3 albedo = texture(albedoMap, uv).rgb*albedoColor.rgb;
+#else
+    vec3 albedo = albedoColor.rgb;
+#endif
+
+#if defined(HAS_MRA_MAP)
+    // glTF metallic-roughness map: occlusion in r (white when not packed), roughness in g, metalness in b
+    vec4 mra = texture(mraMap, uv);
+    float metallic = clamp(mra.b + metallicValue, 0.04, 1.0);
+    float roughness = clamp(mra.g + roughnessValue, 0.04, 1.0);
+    float ao = (mra.r + aoValue)*0.5;
+#else
+    float metallic = clamp(metallicValue, 0.0, 1.0);
+    float roughness = clamp(roughnessValue, 0.0, 1.0);
+    float ao = clamp(aoValue, 0.0, 1.0);
+#endif
+
+    vec3 N = normalize(fragNormal);
+#if defined(HAS_NORMAL_MAP)
+    // NOTE: Compressed normal maps store X in alpha and 1 in red (DXT5nm), plain ones have alpha 1
+    vec4 packedNormal = texture(normalMap, vec2(fragTexCoord.x*tiling.x + offset.y, fragTexCoord.y*tiling.y + offset.y));
+    N.xy = vec2(packedNormal.r*packedNormal.a, packedNormal.g)*2.0 - 1.0;
+    N.z = sqrt(max(1.0 - dot(N.xy, N.xy), 0.0));
+    N = normalize(N*TBN);
+#endif
+
     vec3 V = normalize(viewPos - fragPosition);
 
-    vec3 emissive = vec3(0);
-    emissive = (texture(emissiveMap, vec2(fragTexCoord.x*tiling.x + offset.x, fragTexCoord.y*tiling.y + offset.y)).rgb).g*emissiveColor.rgb*emissivePower*useTexEmissive;
+#if defined(HAS_EMISSIVE_MAP)
+    vec3 emissive = texture(emissiveMap, uv).g*emissiveColor.rgb*emissivePower;
+#else
+    vec3 emissive = vec3(0.0);
+#endif
 
     // return N;//vec3(metallic,metallic,metallic);
     // If  dia-electric use base reflectivity of 0.04 otherwise ut is a metal use albedo as base reflectivity
     vec3 baseRefl = mix(vec3(0.04), albedo.rgb, metallic);
     vec3 lightAccum = vec3(0.0);  // Acumulate lighting lum
 
-    for (int i = 0; i < numOfLights; i++)
+#if defined(LIGHT_COUNT)
+    for (int i = 0; i < LIGHT_COUNT; i++)   // Constant bound, compilers unroll it
+#else
+    for (int i = 0; i < lightCount; i++)
+#endif
     {
-        vec3 L = normalize(lights[i].position - fragPosition);      // Compute light vector
-        vec3 H = normalize(V + L);                                  // Compute halfway bisecting vector
-        float dist = length(lights[i].position - fragPosition);     // Compute distance to light
-        float attenuation = 1.0/(dist*dist*0.23);                   // Compute attenuation
-        vec3 radiance = lights[i].color.rgb*lights[i].intensity*attenuation; // Compute input radiance, light energy comming in
-
-        // Cook-Torrance BRDF distribution function
-        float nDotV = max(dot(N,V), 0.0000001);
-        float nDotL = max(dot(N,L), 0.0000001);
-        float hDotV = max(dot(H,V), 0.0);
-        float nDotH = max(dot(N,H), 0.0);
-        float D = GgxDistribution(nDotH, roughness);    // Larger the more micro-facets aligned to H
-        float G = GeomSmith(nDotV, nDotL, roughness);   // Smaller the more micro-facets shadow
-        vec3 F = SchlickFresnel(hDotV, baseRefl);       // Fresnel proportion of specular reflectance
-
-        vec3 spec = (D*G*F)/(4.0*nDotV*nDotL);
-
-        // Difuse and spec light can't be above 1.0
-        // kD = 1.0 - kS  diffuse component is equal 1.0 - spec comonent
-        vec3 kD = vec3(1.0) - F;
-
-        // Mult kD by the inverse of metallnes, only non-metals should have diffuse light
-        kD *= 1.0 - metallic;
-        lightAccum += ((kD*albedo.rgb/PI + spec)*radiance*nDotL)*lights[i].enabled; // Angle of light has impact on result
+        if (lights[i].enabled == 0) continue;
+
+        vec3 color = lights[i].color.rgb*lights[i].intensity;
+        vec3 L = normalize(lights[i].position.xyz - fragPosition);
+        vec3 radiance = GetPointRadiance(lights[i].position.xyz, lights[i].radius, color);
+
+        // Directional lights shine from position towards target and do not fade
+        if (lights[i].type == LIGHT_DIRECTIONAL)
+        {
+            L = normalize(lights[i].position.xyz - lights[i].target.xyz);
+            radiance = color;
+        }
+
+        lightAccum += ComputeLight(N, V, albedo, baseRefl, metallic, roughness, L, radiance)*GetLightShadow(i);
+    }
+
+    if (useClusters == 1)
+    {
+        // Find the fragment froxel: screen tile and exponential depth slice
+        float depth = -(matView*vec4(fragPosition, 1.0)).z;
+        int slice = int(clamp(floor(log(max(depth, clusterParams.x)/clusterParams.x)*clusterParams.y), 0.0, float(CLUSTER_GRID_Z - 1)));
+        ivec2 tile = clamp(ivec2(gl_FragCoord.xy*clusterParams.zw*vec2(CLUSTER_GRID_X, CLUSTER_GRID_Y)), ivec2(0), ivec2(CLUSTER_GRID_X - 1, CLUSTER_GRID_Y - 1));
+        uvec2 range = texelFetch(clusterGrid, (slice*CLUSTER_GRID_Y + tile.y)*CLUSTER_GRID_X + tile.x).rg;
+
+        for (uint i = 0u; i < range.y; i++)
+        {
+            int light = int(texelFetch(clusterIndices, int(range.x + i)).r);
+            vec4 positionRadius = texelFetch(clusterLights, light*2);
+            vec3 color = texelFetch(clusterLights, light*2 + 1).rgb;
+            lightAccum += ComputeLight(N, V, albedo, baseRefl, metallic, roughness, normalize(positionRadius.xyz - fragPosition), GetPointRadiance(positionRadius.xyz, positionRadius.w, color));
+        }
     }
 
     vec3 ambientFinal = (ambientColor + albedo)*ambient*0.5;
@@ -150,13 +352,31 @@ vec3 ComputePBR()
 
 void main()
 {
+#if defined(ALPHA_TEST)
+    // Needed without the depth pre-pass, after it cut out fragments already fail the depth test
+    if (texture(albedoMap, fragTexCoord).a*albedoColor.a < alphaCutoff) discard;
+#endif
+
     vec3 color = ComputePBR();
 
+#if !defined(HDR_OUTPUT)
     // HDR tonemapping
     color = pow(color, color + vec3(1.0));
 
     // Gamma correction
     color = pow(color, vec3(1.0/2.2));
+#endif
+
+#if defined(OIT_OUTPUT)
+    // Nearer surfaces weigh more where transparent surfaces overlap, the composite divides the
+    // color sum by the weight sum. Weights stay in half float range (McGuire and Bavoil, eq. 9)
+    float alpha = albedoColor.a;
+    float distance = length(viewPos - fragPosition);
+    float weight = alpha*clamp(10.0/(1e-5 + pow(distance/5.0, 2.0) + pow(distance/200.0, 6.0)), 1e-2, 3e3);
 
-    finalColor = vec4(color, 1.0);
+    finalColor = vec4(color*alpha*weight, alpha);
+    oitWeight = alpha*weight;
+#else
+    finalColor = vec4(color, albedoColor.a);     // Blended materials keep their albedo alpha
+#endif
 }
\ No newline at end of file
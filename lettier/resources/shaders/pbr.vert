@@ -1,48 +1,89 @@
 #version 330
 
+// Variant defines, set by the loader (see main.c):
+// QUANTIZED_VERTICES: scene file vertices are quantized (see rscene.h), decoded before use
+
 // Input vertex attributes
+#if defined(QUANTIZED_VERTICES)
+in vec4 vertexPosition;         // Normalized in the batch bounds, w keeps the bitangent sign
+in vec2 vertexTexCoord;         // Half floats
+in vec2 vertexNormal;           // Octahedral
+in vec2 vertexTangent;          // Octahedral
+#else
 in vec3 vertexPosition;
 in vec2 vertexTexCoord;
 in vec3 vertexNormal;
-in vec3 vertexTangent;
+in vec4 vertexTangent;          // w: bitangent sign
+#endif
 in vec4 vertexColor;
 
 // Input uniform values
 uniform mat4 mvp;
 uniform mat4 matModel;
 uniform mat4 matNormal;
+uniform mat4 matView;
 uniform vec3 lightPos;
 uniform vec4 difColor;
+uniform vec3 positionDequant[2];    // Offset and scale of quantized positions
 
 // Output vertex attributes (to fragment shader)
 out vec3 fragPosition;
 out vec2 fragTexCoord;
 out vec4 fragColor;
 out vec3 fragNormal;
+out vec4 shadowPos;             // Shadow lookup position: world position offset along the normal, view depth
 out mat3 TBN;
 
-const float normalOffset = 0.1;
+// Depth pre-pass draws the same positions with depth.vert, shading tests them for equality (see rqueue.h)
+invariant gl_Position;
+
+const float normalOffset = 0.02;    // Keeps lit surfaces off their own shadow map texels
+
+#if defined(QUANTIZED_VERTICES)
+// Decode octahedral coordinates to a unit vector
+vec3 DecodeOctahedral(vec2 encoded)
+{
+    vec3 v = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    if (v.z < 0.0) v.xy = (1.0 - abs(v.yx))*vec2((v.x >= 0.0)? 1.0 : -1.0, (v.y >= 0.0)? 1.0 : -1.0);
+
+    return normalize(v);
+}
+#endif
 
 void main()
 {
+#if defined(QUANTIZED_VERTICES)
+    vec3 position = positionDequant[0] + vertexPosition.xyz*positionDequant[1];
+    vec3 normal = DecodeOctahedral(vertexNormal);
+    vec3 tangent = DecodeOctahedral(vertexTangent);
+    float tangentSign = vertexPosition.w*2.0 - 1.0;     // Stored as 0 or 1
+#else
+    vec3 position = vertexPosition;
+    vec3 normal = vertexNormal;
+    vec3 tangent = vertexTangent.xyz;
+    float tangentSign = (vertexTangent.w < 0.0)? -1.0 : 1.0;
+#endif
+
     // Compute binormal from vertex normal and tangent
-    vec3 vertexBinormal = cross(vertexNormal, vertexTangent);
+    vec3 vertexBinormal = cross(normal, tangent);
 
     // Compute fragment normal based on normal transformations
     mat3 normalMatrix = transpose(inverse(mat3(matModel)));
 
     // Compute fragment position based on model transformations
-    fragPosition = vec3(matModel*vec4(vertexPosition, 1.0));
+    fragPosition = vec3(matModel*vec4(position, 1.0));
 
     fragTexCoord = vertexTexCoord*2.0;
-    fragNormal = normalize(normalMatrix*vertexNormal);
-    vec3 fragTangent = normalize(normalMatrix*vertexTangent);
+    fragNormal = normalize(normalMatrix*normal);
+    vec3 fragTangent = normalize(normalMatrix*tangent);
     fragTangent = normalize(fragTangent - dot(fragTangent, fragNormal)*fragNormal);
     vec3 fragBinormal = normalize(normalMatrix*vertexBinormal);
-    fragBinormal = cross(fragNormal, fragTangent);
+    fragBinormal = cross(fragNormal, fragTangent)*tangentSign;    // Mirrored UVs flip the bitangent
 
     TBN = transpose(mat3(fragTangent, fragBinormal, fragNormal));
 
+    shadowPos = vec4(fragPosition + fragNormal*normalOffset, -(matView*vec4(fragPosition, 1.0)).z);
+
     // Calculate final vertex position
-    gl_Position = mvp*vec4(vertexPosition, 1.0);
+    gl_Position = mvp*vec4(position, 1.0);
 }
\ No newline at end of file
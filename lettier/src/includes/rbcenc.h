@@ -0,0 +1,594 @@
+/**********************************************************************************************
+*
+*   raylib.bcenc - CPU block compression encoder (BC1/DXT1, BC3/DXT5, BC4 alpha)
+*
+*   Encodes 8 bit per channel images, including their mip chain, into the S3TC formats
+*   raylib can upload (PIXELFORMAT_COMPRESSED_DXT1_RGB, PIXELFORMAT_COMPRESSED_DXT5_RGBA).
+*
+*   Color endpoints are fitted along the principal axis of the block colors, inset, and
+*   refined once with a least squares solve over the chosen indices. Index selection
+*   projects every texel on the endpoint segment, 4 texels at a time with SSE2 when
+*   available. Alpha (BC4) blocks use the 8 value mode with the block min/max.
+*
+*   Normal maps can be stored as "DXT5nm": X in alpha, Y in green, red set to 1 and Z
+*   reconstructed in the shader (x = r*a decodes both DXT5nm and plain RGB normal maps).
+*   X and Y get independent endpoints, which gives BC5-like quality with a format raylib
+*   knows how to upload.
+*
+*   CONFIGURATION:
+*
+*   #define RBCENC_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+*   DEPENDENCIES:
+*       rjobs.h     - JobPool used to encode block rows in parallel (pool can be NULL)
+*
+**********************************************************************************************/
+
+#ifndef RBCENC_H
+#define RBCENC_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define BC_FLAG_NORMAL_XY       1       // Store normal map X in alpha and Y in green (DXT5 only)
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+void EncodeBlockBC1(const unsigned char *rgba, unsigned char *block);       // Encode 4x4 RGBA texels into 8 bytes
+void EncodeBlockBC3(const unsigned char *rgba, unsigned char *block);       // Encode 4x4 RGBA texels into 16 bytes
+void EncodeBlockBC4(const unsigned char *values, int stride, unsigned char *block);    // Encode 16 single channel values into 8 bytes
+void DecodeBlockBC1(const unsigned char *block, unsigned char *rgba);       // Decode 8 bytes into 4x4 RGBA texels
+void DecodeBlockBC3(const unsigned char *block, unsigned char *rgba);       // Decode 16 bytes into 4x4 RGBA texels
+
+bool IsImageBCCompressible(Image image);                                    // Check image can be block compressed
+void ImageCompressBC(Image *image, int format, int flags, JobPool *pool);    // Compress image and its mipmaps (pool is optional)
+Image ImageDecompressBC(Image image);                                       // Decompress first level into R8G8B8A8
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RBCENC_H
+
+
+/***********************************************************************************
+*
+*   RBCENC IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RBCENC_IMPLEMENTATION)
+
+#include "raylib.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #include <emmintrin.h>      // Required for: SSE2 intrinsics
+    #define BCENC_SSE2
+#endif
+
+#include <string.h>             // Required for: memcpy(), memset()
+#include <math.h>               // Required for: sqrtf(), fabsf()
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Block rows of one mip level to encode
+typedef struct {
+    const unsigned char *src;   // Level texels, 8 bits per channel
+    int channels;
+    int width;
+    int height;
+    unsigned char *dst;         // Level blocks
+    int blockSize;              // 8 (DXT1) or 16 (DXT5)
+    int flags;
+} BCEncodeLevel;
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static int GetImageChannels(int format);
+static void FetchBlock(const BCEncodeLevel *level, int bx, int by, unsigned char *rgba);
+static void EncodeColorBlock(const unsigned char *rgba, unsigned char *block);
+static void FindColorIndices(const unsigned char *rgba, const float *c0, const float *c1, int *indices);
+static float GetColorBlockError(const unsigned char *rgba, unsigned short c0, unsigned short c1, const int *indices);
+static unsigned short PackColor565(const float *color);
+static void UnpackColor565(unsigned short packed, float *color);
+static void EncodeLevelRows(int start, int end, void *data);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Encode 4x4 RGBA texels into a BC1 block (alpha is ignored)
+void EncodeBlockBC1(const unsigned char *rgba, unsigned char *block)
+{
+    EncodeColorBlock(rgba, block);
+}
+
+// Encode 4x4 RGBA texels into a BC3 block: BC4 alpha followed by BC1 color
+void EncodeBlockBC3(const unsigned char *rgba, unsigned char *block)
+{
+    EncodeBlockBC4(rgba + 3, 4, block);
+    EncodeColorBlock(rgba, block + 8);
+}
+
+// Encode 16 single channel values into a BC4 block, 8 value mode
+void EncodeBlockBC4(const unsigned char *values, int stride, unsigned char *block)
+{
+    int min = 255;
+    int max = 0;
+
+    for (int i = 0; i < 16; i++)
+    {
+        int v = values[i*stride];
+        if (v < min) min = v;
+        if (v > max) max = v;
+    }
+
+    block[0] = (unsigned char)max;
+    block[1] = (unsigned char)min;
+
+    unsigned long long bits = 0;
+
+    if (max > min)
+    {
+        // NOTE: Index 0 is max, 1 is min, 2..7 interpolate from max to min
+        static const int remap[8] = { 0, 2, 3, 4, 5, 6, 7, 1 };
+        int range = max - min;
+
+        for (int i = 0; i < 16; i++)
+        {
+            int t = ((max - values[i*stride])*14 + range)/(2*range);    // round((max - v)*7/range)
+            bits |= (unsigned long long)remap[t] << (3*i);
+        }
+    }
+
+    for (int i = 0; i < 6; i++) block[2 + i] = (unsigned char)(bits >> (8*i));
+}
+
+// Decode a BC1 block into 4x4 RGBA texels
+// NOTE: Only the 4 color mode is used by the encoder, 3 color mode is decoded for completeness
+void DecodeBlockBC1(const unsigned char *block, unsigned char *rgba)
+{
+    unsigned short c0 = (unsigned short)(block[0] | (block[1] << 8));
+    unsigned short c1 = (unsigned short)(block[2] | (block[3] << 8));
+    unsigned int bits = (unsigned int)block[4] | ((unsigned int)block[5] << 8) | ((unsigned int)block[6] << 16) | ((unsigned int)block[7] << 24);
+
+    float e0[3] = { 0 };
+    float e1[3] = { 0 };
+    UnpackColor565(c0, e0);
+    UnpackColor565(c1, e1);
+
+    unsigned char palette[4][4] = { 0 };
+    for (int c = 0; c < 3; c++)
+    {
+        palette[0][c] = (unsigned char)e0[c];
+        palette[1][c] = (unsigned char)e1[c];
+
+        if (c0 > c1)
+        {
+            palette[2][c] = (unsigned char)((2.0f*e0[c] + e1[c])/3.0f + 0.5f);
+            palette[3][c] = (unsigned char)((e0[c] + 2.0f*e1[c])/3.0f + 0.5f);
+        }
+        else palette[2][c] = (unsigned char)((e0[c] + e1[c])/2.0f + 0.5f);
+    }
+    palette[0][3] = palette[1][3] = palette[2][3] = 255;
+    palette[3][3] = (c0 > c1)? 255 : 0;
+
+    for (int i = 0; i < 16; i++) memcpy(rgba + i*4, palette[(bits >> (2*i)) & 3], 4);
+}
+
+// Decode a BC3 block into 4x4 RGBA texels
+void DecodeBlockBC3(const unsigned char *block, unsigned char *rgba)
+{
+    DecodeBlockBC1(block + 8, rgba);
+
+    int a0 = block[0];
+    int a1 = block[1];
+    unsigned long long bits = 0;
+    for (int i = 0; i < 6; i++) bits |= (unsigned long long)block[2 + i] << (8*i);
+
+    int palette[8] = { a0, a1, 0 };
+    for (int i = 2; i < 8; i++)
+    {
+        if (a0 > a1) palette[i] = ((8 - i)*a0 + (i - 1)*a1 + 3)/7;
+        else if (i < 6) palette[i] = ((6 - i)*a0 + (i - 1)*a1 + 2)/5;
+        else palette[i] = (i == 6)? 0 : 255;
+    }
+
+    for (int i = 0; i < 16; i++) rgba[i*4 + 3] = (unsigned char)palette[(bits >> (3*i)) & 7];
+}
+
+// Check image can be block compressed: 8 bits per channel and size multiple of 4
+bool IsImageBCCompressible(Image image)
+{
+    return (image.data != NULL) && (GetImageChannels(image.format) > 0) && ((image.width%4) == 0) && ((image.height%4) == 0);
+}
+
+// Compress image and its mipmaps to PIXELFORMAT_COMPRESSED_DXT1_RGB or PIXELFORMAT_COMPRESSED_DXT5_RGBA
+// NOTE: Mip levels whose size is not a multiple of 4 are dropped, raylib computes compressed
+// level sizes from width*height, which is only exact for whole blocks
+void ImageCompressBC(Image *image, int format, int flags, JobPool *pool)
+{
+    if (!IsImageBCCompressible(*image)) return;
+    if ((format != PIXELFORMAT_COMPRESSED_DXT1_RGB) && (format != PIXELFORMAT_COMPRESSED_DXT5_RGBA)) return;
+
+    int channels = GetImageChannels(image->format);
+    int blockSize = (format == PIXELFORMAT_COMPRESSED_DXT1_RGB)? 8 : 16;
+
+    int mipmaps = 0;
+    long long dataSize = 0;
+    for (int w = image->width, h = image->height; (mipmaps < image->mipmaps) && ((w%4) == 0) && ((h%4) == 0); mipmaps++)
+    {
+        dataSize += (long long)(w/4)*(h/4)*blockSize;
+        w /= 2;
+        h /= 2;
+    }
+
+    unsigned char *data = (unsigned char *)RL_MALLOC((size_t)dataSize);
+    if (data == NULL) return;
+
+    const unsigned char *src = (const unsigned char *)image->data;
+    unsigned char *dst = data;
+
+    for (int i = 0, w = image->width, h = image->height; i < mipmaps; i++)
+    {
+        BCEncodeLevel level = { src, channels, w, h, dst, blockSize, flags };
+        ParallelFor(pool, h/4, 4, EncodeLevelRows, &level);
+
+        src += (long long)w*h*channels;
+        dst += (long long)(w/4)*(h/4)*blockSize;
+        w /= 2;
+        h /= 2;
+    }
+
+    RL_FREE(image->data);
+    image->data = data;
+    image->format = format;
+    image->mipmaps = mipmaps;
+}
+
+// Decompress first level of a DXT1/DXT5 image into R8G8B8A8
+Image ImageDecompressBC(Image image)
+{
+    Image result = { 0 };
+
+    if ((image.data == NULL) || ((image.format != PIXELFORMAT_COMPRESSED_DXT1_RGB) && (image.format != PIXELFORMAT_COMPRESSED_DXT5_RGBA))) return result;
+
+    int blockSize = (image.format == PIXELFORMAT_COMPRESSED_DXT1_RGB)? 8 : 16;
+    int blocksX = image.width/4;
+
+    result.data = RL_MALLOC((size_t)image.width*image.height*4);
+    result.width = image.width;
+    result.height = image.height;
+    result.mipmaps = 1;
+    result.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+
+    for (int by = 0; by < image.height/4; by++)
+    {
+        for (int bx = 0; bx < blocksX; bx++)
+        {
+            const unsigned char *block = (const unsigned char *)image.data + ((long long)by*blocksX + bx)*blockSize;
+            unsigned char rgba[64] = { 0 };
+
+            if (blockSize == 8) DecodeBlockBC1(block, rgba);
+            else DecodeBlockBC3(block, rgba);
+
+            for (int y = 0; y < 4; y++) memcpy((unsigned char *)result.data + (((long long)by*4 + y)*image.width + bx*4)*4, rgba + y*16, 16);
+        }
+    }
+
+    return result;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Get number of 8 bit channels for a pixel format, 0 if not supported
+static int GetImageChannels(int format)
+{
+    switch (format)
+    {
+        case PIXELFORMAT_UNCOMPRESSED_GRAYSCALE: return 1;
+        case PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA: return 2;
+        case PIXELFORMAT_UNCOMPRESSED_R8G8B8: return 3;
+        case PIXELFORMAT_UNCOMPRESSED_R8G8B8A8: return 4;
+        default: return 0;
+    }
+}
+
+// Fetch 4x4 texels expanded to RGBA, grayscale is replicated and missing alpha is opaque
+static void FetchBlock(const BCEncodeLevel *level, int bx, int by, unsigned char *rgba)
+{
+    for (int y = 0; y < 4; y++)
+    {
+        const unsigned char *row = level->src + ((long long)(by*4 + y)*level->width + bx*4)*level->channels;
+
+        for (int x = 0; x < 4; x++)
+        {
+            const unsigned char *p = row + x*level->channels;
+            unsigned char *out = rgba + (y*4 + x)*4;
+
+            switch (level->channels)
+            {
+                case 1: out[0] = out[1] = out[2] = p[0]; out[3] = 255; break;
+                case 2: out[0] = out[1] = out[2] = p[0]; out[3] = p[1]; break;
+                case 3: out[0] = p[0]; out[1] = p[1]; out[2] = p[2]; out[3] = 255; break;
+                default: memcpy(out, p, 4); break;
+            }
+
+            if (level->flags & BC_FLAG_NORMAL_XY)
+            {
+                // DXT5nm: X goes to alpha (BC4 block), Y to green, red is 1 so r*a gives X back
+                out[3] = out[0];
+                out[0] = 255;
+                out[2] = 0;
+            }
+        }
+    }
+}
+
+// Encode BC1 color block in 4 color mode
+static void EncodeColorBlock(const unsigned char *rgba, unsigned char *block)
+{
+    // Mean color and covariance
+    float mean[3] = { 0 };
+    for (int i = 0; i < 16; i++) for (int c = 0; c < 3; c++) mean[c] += rgba[i*4 + c];
+    for (int c = 0; c < 3; c++) mean[c] /= 16.0f;
+
+    float cov[6] = { 0 };       // xx, xy, xz, yy, yz, zz
+    for (int i = 0; i < 16; i++)
+    {
+        float d[3] = { rgba[i*4] - mean[0], rgba[i*4 + 1] - mean[1], rgba[i*4 + 2] - mean[2] };
+        cov[0] += d[0]*d[0]; cov[1] += d[0]*d[1]; cov[2] += d[0]*d[2];
+        cov[3] += d[1]*d[1]; cov[4] += d[1]*d[2]; cov[5] += d[2]*d[2];
+    }
+
+    // Principal axis by power iteration
+    float axis[3] = { 0.9f, 1.0f, 0.7f };
+    for (int k = 0; k < 8; k++)
+    {
+        float v[3] = {
+            cov[0]*axis[0] + cov[1]*axis[1] + cov[2]*axis[2],
+            cov[1]*axis[0] + cov[3]*axis[1] + cov[4]*axis[2],
+            cov[2]*axis[0] + cov[4]*axis[1] + cov[5]*axis[2]
+        };
+        float length = fabsf(v[0]) + fabsf(v[1]) + fabsf(v[2]);
+        if (length < 1e-6f) break;
+
+        for (int c = 0; c < 3; c++) axis[c] = v[c]/length;
+    }
+
+    // Endpoints: extreme projections on the axis, inset by 1/16 of the range
+    float minDot = 1e30f;
+    float maxDot = -1e30f;
+    for (int i = 0; i < 16; i++)
+    {
+        float d = (rgba[i*4] - mean[0])*axis[0] + (rgba[i*4 + 1] - mean[1])*axis[1] + (rgba[i*4 + 2] - mean[2])*axis[2];
+        if (d < minDot) minDot = d;
+        if (d > maxDot) maxDot = d;
+    }
+
+    float axisLengthSqr = axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2];
+    if (axisLengthSqr < 1e-12f) axisLengthSqr = 1.0f;
+
+    float inset = (maxDot - minDot)/16.0f;
+    float e0[3] = { 0 };
+    float e1[3] = { 0 };
+    for (int c = 0; c < 3; c++)
+    {
+        e0[c] = mean[c] + axis[c]*(maxDot - inset)/axisLengthSqr;
+        e1[c] = mean[c] + axis[c]*(minDot + inset)/axisLengthSqr;
+    }
+
+    unsigned short c0 = PackColor565(e0);
+    unsigned short c1 = PackColor565(e1);
+    int indices[16] = { 0 };
+
+    UnpackColor565(c0, e0);
+    UnpackColor565(c1, e1);
+    FindColorIndices(rgba, e0, e1, indices);
+
+    // Refine endpoints with a least squares fit over the chosen indices
+    static const float weights[4] = { 0.0f, 1.0f, 1.0f/3.0f, 2.0f/3.0f };   // Position from c0 to c1 per index
+    float a = 0.0f, b = 0.0f, d = 0.0f;
+    float x0[3] = { 0 };
+    float x1[3] = { 0 };
+    for (int i = 0; i < 16; i++)
+    {
+        float w = weights[indices[i]];
+        a += (1.0f - w)*(1.0f - w);
+        b += (1.0f - w)*w;
+        d += w*w;
+        for (int c = 0; c < 3; c++)
+        {
+            x0[c] += (1.0f - w)*rgba[i*4 + c];
+            x1[c] += w*rgba[i*4 + c];
+        }
+    }
+
+    float det = a*d - b*b;
+    if (fabsf(det) > 1e-6f)
+    {
+        float r0[3] = { 0 };
+        float r1[3] = { 0 };
+        for (int c = 0; c < 3; c++)
+        {
+            r0[c] = (d*x0[c] - b*x1[c])/det;
+            r1[c] = (a*x1[c] - b*x0[c])/det;
+        }
+
+        unsigned short rc0 = PackColor565(r0);
+        unsigned short rc1 = PackColor565(r1);
+        int refined[16] = { 0 };
+
+        UnpackColor565(rc0, r0);
+        UnpackColor565(rc1, r1);
+        FindColorIndices(rgba, r0, r1, refined);
+
+        if (GetColorBlockError(rgba, rc0, rc1, refined) < GetColorBlockError(rgba, c0, c1, indices))
+        {
+            c0 = rc0;
+            c1 = rc1;
+            memcpy(indices, refined, sizeof(indices));
+        }
+    }
+
+    // 4 color mode requires c0 > c1, swapping endpoints swaps indices 0<->1 and 2<->3
+    if (c0 < c1)
+    {
+        unsigned short t = c0; c0 = c1; c1 = t;
+        for (int i = 0; i < 16; i++) indices[i] ^= 1;
+    }
+    else if (c0 == c1) memset(indices, 0, sizeof(indices));
+
+    unsigned int bits = 0;
+    for (int i = 0; i < 16; i++) bits |= (unsigned int)indices[i] << (2*i);
+
+    block[0] = (unsigned char)(c0 & 0xff);
+    block[1] = (unsigned char)(c0 >> 8);
+    block[2] = (unsigned char)(c1 & 0xff);
+    block[3] = (unsigned char)(c1 >> 8);
+    block[4] = (unsigned char)(bits & 0xff);
+    block[5] = (unsigned char)((bits >> 8) & 0xff);
+    block[6] = (unsigned char)((bits >> 16) & 0xff);
+    block[7] = (unsigned char)(bits >> 24);
+}
+
+// Pick palette index for every texel by projecting it on the c0-c1 segment
+static void FindColorIndices(const unsigned char *rgba, const float *c0, const float *c1, int *indices)
+{
+    static const int remap[4] = { 0, 2, 3, 1 };     // Projection step to palette index
+
+    float dir[3] = { c1[0] - c0[0], c1[1] - c0[1], c1[2] - c0[2] };
+    float lengthSqr = dir[0]*dir[0] + dir[1]*dir[1] + dir[2]*dir[2];
+
+    if (lengthSqr < 1e-6f)
+    {
+        for (int i = 0; i < 16; i++) indices[i] = 0;
+        return;
+    }
+
+    // Projection step t = dot(p - c0, dir)*3/|dir|^2, rounded
+    float scale = 3.0f/lengthSqr;
+    float axis[3] = { dir[0]*scale, dir[1]*scale, dir[2]*scale };
+    float offset = 0.5f - (c0[0]*axis[0] + c0[1]*axis[1] + c0[2]*axis[2]);
+
+#if defined(BCENC_SSE2)
+    const __m128 dr = _mm_set1_ps(axis[0]);
+    const __m128 dg = _mm_set1_ps(axis[1]);
+    const __m128 db = _mm_set1_ps(axis[2]);
+    const __m128 off = _mm_set1_ps(offset);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 three = _mm_set1_ps(3.0f);
+
+    for (int i = 0; i < 16; i += 4)
+    {
+        __m128 r = _mm_set_ps(rgba[(i + 3)*4], rgba[(i + 2)*4], rgba[(i + 1)*4], rgba[i*4]);
+        __m128 g = _mm_set_ps(rgba[(i + 3)*4 + 1], rgba[(i + 2)*4 + 1], rgba[(i + 1)*4 + 1], rgba[i*4 + 1]);
+        __m128 b = _mm_set_ps(rgba[(i + 3)*4 + 2], rgba[(i + 2)*4 + 2], rgba[(i + 1)*4 + 2], rgba[i*4 + 2]);
+
+        __m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r, dr), _mm_mul_ps(g, dg)), _mm_add_ps(_mm_mul_ps(b, db), off));
+        t = _mm_min_ps(_mm_max_ps(t, zero), three);
+
+        int steps[4];
+        _mm_storeu_si128((__m128i *)steps, _mm_cvttps_epi32(t));
+        for (int k = 0; k < 4; k++) indices[i + k] = remap[(steps[k] > 3)? 3 : steps[k]];
+    }
+#else
+    for (int i = 0; i < 16; i++)
+    {
+        float t = (rgba[i*4]*axis[0] + rgba[i*4 + 1]*axis[1]) + (rgba[i*4 + 2]*axis[2] + offset);
+        int step = (t <= 0.0f)? 0 : (t >= 3.0f)? 3 : (int)t;
+        indices[i] = remap[step];
+    }
+#endif
+}
+
+// Get squared error of a color block against its decoded palette
+static float GetColorBlockError(const unsigned char *rgba, unsigned short c0, unsigned short c1, const int *indices)
+{
+    float e0[3] = { 0 };
+    float e1[3] = { 0 };
+    UnpackColor565(c0, e0);
+    UnpackColor565(c1, e1);
+
+    float palette[4][3] = { 0 };
+    for (int c = 0; c < 3; c++)
+    {
+        palette[0][c] = e0[c];
+        palette[1][c] = e1[c];
+        palette[2][c] = (2.0f*e0[c] + e1[c])/3.0f;
+        palette[3][c] = (e0[c] + 2.0f*e1[c])/3.0f;
+    }
+
+    float error = 0.0f;
+    for (int i = 0; i < 16; i++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            float d = rgba[i*4 + c] - palette[indices[i]][c];
+            error += d*d;
+        }
+    }
+
+    return error;
+}
+
+// Quantize color to R5G6B5
+static unsigned short PackColor565(const float *color)
+{
+    int r = (int)(color[0]*31.0f/255.0f + 0.5f);
+    int g = (int)(color[1]*63.0f/255.0f + 0.5f);
+    int b = (int)(color[2]*31.0f/255.0f + 0.5f);
+
+    r = (r < 0)? 0 : (r > 31)? 31 : r;
+    g = (g < 0)? 0 : (g > 63)? 63 : g;
+    b = (b < 0)? 0 : (b > 31)? 31 : b;
+
+    return (unsigned short)((r << 11) | (g << 5) | b);
+}
+
+// Expand R5G6B5 color to 0..255 per channel
+static void UnpackColor565(unsigned short packed, float *color)
+{
+    int r = (packed >> 11) & 31;
+    int g = (packed >> 5) & 63;
+    int b = packed & 31;
+
+    color[0] = (float)((r << 3) | (r >> 2));
+    color[1] = (float)((g << 2) | (g >> 4));
+    color[2] = (float)((b << 3) | (b >> 2));
+}
+
+// Encode a range of block rows of one level
+static void EncodeLevelRows(int start, int end, void *data)
+{
+    const BCEncodeLevel *level = (const BCEncodeLevel *)data;
+    int blocksX = level->width/4;
+
+    for (int by = start; by < end; by++)
+    {
+        for (int bx = 0; bx < blocksX; bx++)
+        {
+            unsigned char rgba[64] = { 0 };
+            unsigned char *block = level->dst + ((long long)by*blocksX + bx)*level->blockSize;
+
+            FetchBlock(level, bx, by, rgba);
+
+            if (level->blockSize == 8) EncodeBlockBC1(rgba, block);
+            else EncodeBlockBC3(rgba, block);
+        }
+    }
+}
+
+#endif // RBCENC_IMPLEMENTATION
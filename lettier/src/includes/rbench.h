@@ -0,0 +1,507 @@
+/**********************************************************************************************
+*
+*   raylib.bench - Frame timing capture for headless benchmark runs
+*
+*   Records per-frame CPU time plus CPU and GPU time for each named render pass, and any
+*   per-frame counters (draw calls, culled meshes, ...), then writes them to CSV or JSON
+*   together with mean/p50/p95/p99 summaries.
+*
+*   GPU times come from GL_TIME_ELAPSED queries. One query object is allocated per pass
+*   per recorded frame and results are only read back when the report is exported, so the
+*   capture never stalls the pipeline waiting on the GPU.
+*
+*   BenchInitCpu() records CPU times only, without queries or batch flushes, for runs with no
+*   GL context (CPU renderers, tools). Times come from BenchGetTime() in both modes.
+*
+*   CONFIGURATION:
+*
+*   #define RBENCH_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+*   NOTE: Passes can not be nested, GL only allows one active GL_TIME_ELAPSED query at a time
+*
+**********************************************************************************************/
+
+#ifndef RBENCH_H
+#define RBENCH_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define BENCH_MAX_PASSES        16      // Max render passes timed per frame
+#define BENCH_MAX_COUNTERS      32      // Max integer counters recorded per frame
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+bool BenchInit(int frameCount, int warmupFrames);   // Allocate sample storage and GPU queries (requires GL context)
+bool BenchInitCpu(int frameCount, int warmupFrames); // Allocate sample storage, CPU times only (no GL context required)
+void BenchClose(void);                              // Free sample storage and GPU queries
+int BenchAddPass(const char *name);                 // Register a timed pass, returns pass index
+int BenchAddCounter(const char *name);              // Register a per-frame counter, returns counter index
+
+void BenchBeginFrame(void);                         // Start CPU timing for current frame
+void BenchEndFrame(void);                           // Stop CPU timing for current frame and advance
+void BenchBeginPass(int pass);                      // Start CPU and GPU timing for a pass
+void BenchEndPass(int pass);                        // Stop CPU and GPU timing for a pass
+void BenchSetCounter(int counter, int value);       // Set counter value for current frame
+
+int BenchGetFrame(void);                            // Get current frame index (warmup frames included)
+int BenchGetFrameCount(void);                       // Get total frames to run (warmup frames included)
+bool BenchIsFinished(void);                         // Check if all frames have been run
+
+bool BenchExportReport(const char *fileName);       // Export samples and summary (.csv or .json)
+double BenchGetTime(void);                          // Get monotonic time in seconds (no window required)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RBENCH_H
+
+
+/***********************************************************************************
+*
+*   RBENCH IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RBENCH_IMPLEMENTATION)
+
+#include "raylib.h"
+#include "rlgl.h"
+
+#if defined(PLATFORM_DESKTOP)
+    // NOTE: Timer queries are not exposed by rlgl, use the GL loader raylib is built with
+    #include "external/glad.h"
+    #define BENCH_GPU_TIMERS
+#endif
+
+#include <stdio.h>              // Required for: FILE, fopen(), fprintf(), fclose()
+#include <stdlib.h>             // Required for: qsort()
+#include <string.h>             // Required for: memset()
+#include <time.h>               // Required for: clock_gettime(), timespec_get()
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Samples recorded for one frame
+typedef struct {
+    double frameMs;                         // Time since previous frame start
+    double cpuMs;                           // Time between BenchBeginFrame() and BenchEndFrame()
+    double passCpuMs[BENCH_MAX_PASSES];
+    double passGpuMs[BENCH_MAX_PASSES];
+    int counters[BENCH_MAX_COUNTERS];
+} BenchSample;
+
+// Summary statistics for one column
+typedef struct {
+    double mean;
+    double p50;
+    double p95;
+    double p99;
+    double max;
+} BenchStats;
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static struct {
+    int frameCount;                         // Frames recorded into samples
+    int warmupFrames;                       // Frames run before recording starts
+    int frame;                              // Current frame, warmup included
+    BenchSample *samples;
+
+    int passCount;
+    const char *passNames[BENCH_MAX_PASSES];
+    double passStart[BENCH_MAX_PASSES];
+
+    int counterCount;
+    const char *counterNames[BENCH_MAX_COUNTERS];
+
+    double frameStart;
+    double prevFrameStart;
+    bool gpuTimers;                         // GPU queries and batch flushes, off with BenchInitCpu()
+
+#if defined(BENCH_GPU_TIMERS)
+    unsigned int *queries;                  // frameCount*BENCH_MAX_PASSES query objects
+    bool *queryUsed;
+#endif
+} bench = { 0 };
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static BenchSample *GetCurrentSample(void);
+static int CompareDouble(const void *a, const void *b);
+static BenchStats ComputeStats(double *values, int count);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Allocate sample storage and GPU queries
+// NOTE: Requires an active GL context
+bool BenchInit(int frameCount, int warmupFrames)
+{
+    if (frameCount <= 0) return false;
+
+    bench.frameCount = frameCount;
+    bench.warmupFrames = (warmupFrames > 0)? warmupFrames : 0;
+    bench.frame = 0;
+    bench.samples = (BenchSample *)RL_CALLOC(frameCount, sizeof(BenchSample));
+
+    bench.gpuTimers = true;
+
+#if defined(BENCH_GPU_TIMERS)
+    bench.queries = (unsigned int *)RL_CALLOC(frameCount*BENCH_MAX_PASSES, sizeof(unsigned int));
+    bench.queryUsed = (bool *)RL_CALLOC(frameCount*BENCH_MAX_PASSES, sizeof(bool));
+    glGenQueries(frameCount*BENCH_MAX_PASSES, bench.queries);
+#else
+    TraceLog(LOG_WARNING, "BENCH: GPU timer queries not available on this platform, GPU times will be 0");
+#endif
+
+    TraceLog(LOG_INFO, "BENCH: Recording %i frames (+%i warmup)", bench.frameCount, bench.warmupFrames);
+
+    return (bench.samples != NULL);
+}
+
+// Allocate sample storage, passes get CPU times only
+// NOTE: No GL context required, nothing is flushed or queried on GL
+bool BenchInitCpu(int frameCount, int warmupFrames)
+{
+    if (frameCount <= 0) return false;
+
+    bench.frameCount = frameCount;
+    bench.warmupFrames = (warmupFrames > 0)? warmupFrames : 0;
+    bench.frame = 0;
+    bench.samples = (BenchSample *)RL_CALLOC(frameCount, sizeof(BenchSample));
+    bench.gpuTimers = false;
+
+    TraceLog(LOG_INFO, "BENCH: Recording %i frames (+%i warmup), CPU times only", bench.frameCount, bench.warmupFrames);
+
+    return (bench.samples != NULL);
+}
+
+// Free sample storage and GPU queries
+void BenchClose(void)
+{
+#if defined(BENCH_GPU_TIMERS)
+    if (bench.queries != NULL) glDeleteQueries(bench.frameCount*BENCH_MAX_PASSES, bench.queries);
+    RL_FREE(bench.queries);
+    RL_FREE(bench.queryUsed);
+#endif
+    RL_FREE(bench.samples);
+
+    memset(&bench, 0, sizeof(bench));
+}
+
+// Register a timed pass, returns pass index (-1 if no more passes available)
+int BenchAddPass(const char *name)
+{
+    if (bench.passCount >= BENCH_MAX_PASSES) return -1;
+
+    bench.passNames[bench.passCount] = name;
+    return bench.passCount++;
+}
+
+// Register a per-frame counter, returns counter index (-1 if no more counters available)
+int BenchAddCounter(const char *name)
+{
+    if (bench.counterCount >= BENCH_MAX_COUNTERS) return -1;
+
+    bench.counterNames[bench.counterCount] = name;
+    return bench.counterCount++;
+}
+
+// Start CPU timing for current frame
+void BenchBeginFrame(void)
+{
+    bench.prevFrameStart = bench.frameStart;
+    bench.frameStart = BenchGetTime();
+}
+
+// Stop CPU timing for current frame and advance
+void BenchEndFrame(void)
+{
+    BenchSample *sample = GetCurrentSample();
+
+    if (sample != NULL)
+    {
+        sample->cpuMs = (BenchGetTime() - bench.frameStart)*1000.0;
+        sample->frameMs = (bench.prevFrameStart > 0.0)? (bench.frameStart - bench.prevFrameStart)*1000.0 : sample->cpuMs;
+    }
+
+    bench.frame++;
+}
+
+// Start CPU and GPU timing for a pass
+void BenchBeginPass(int pass)
+{
+    if ((pass < 0) || (pass >= bench.passCount)) return;
+
+    // Flush pending batched draws so they are not accounted to this pass
+    if (bench.gpuTimers) rlDrawRenderBatchActive();
+
+    bench.passStart[pass] = BenchGetTime();
+
+#if defined(BENCH_GPU_TIMERS)
+    int recorded = bench.frame - bench.warmupFrames;
+    if (bench.gpuTimers && (recorded >= 0) && (recorded < bench.frameCount))
+    {
+        int index = recorded*BENCH_MAX_PASSES + pass;
+        glBeginQuery(GL_TIME_ELAPSED, bench.queries[index]);
+        bench.queryUsed[index] = true;
+    }
+#endif
+}
+
+// Stop CPU and GPU timing for a pass
+void BenchEndPass(int pass)
+{
+    if ((pass < 0) || (pass >= bench.passCount)) return;
+
+    // Flush batched draws issued inside the pass before closing the query
+    if (bench.gpuTimers) rlDrawRenderBatchActive();
+
+    BenchSample *sample = GetCurrentSample();
+    if (sample == NULL) return;
+
+    sample->passCpuMs[pass] = (BenchGetTime() - bench.passStart[pass])*1000.0;
+
+#if defined(BENCH_GPU_TIMERS)
+    if (bench.gpuTimers) glEndQuery(GL_TIME_ELAPSED);
+#endif
+}
+
+// Set counter value for current frame
+void BenchSetCounter(int counter, int value)
+{
+    BenchSample *sample = GetCurrentSample();
+
+    if ((sample != NULL) && (counter >= 0) && (counter < bench.counterCount)) sample->counters[counter] = value;
+}
+
+// Get current frame index (warmup frames included)
+int BenchGetFrame(void)
+{
+    return bench.frame;
+}
+
+// Get total frames to run (warmup frames included)
+int BenchGetFrameCount(void)
+{
+    return bench.warmupFrames + bench.frameCount;
+}
+
+// Check if all frames have been run
+bool BenchIsFinished(void)
+{
+    return (bench.frame >= (bench.warmupFrames + bench.frameCount));
+}
+
+// Export samples and summary, format is selected by file extension (.json, anything else is CSV)
+// NOTE: Reading back the GPU queries waits for all pending GPU work to complete
+bool BenchExportReport(const char *fileName)
+{
+    if (bench.samples == NULL) return false;
+
+    int recorded = bench.frame - bench.warmupFrames;
+    if (recorded > bench.frameCount) recorded = bench.frameCount;
+    if (recorded <= 0) return false;
+
+#if defined(BENCH_GPU_TIMERS)
+    for (int i = 0; (i < recorded) && bench.gpuTimers; i++)
+    {
+        for (int p = 0; p < bench.passCount; p++)
+        {
+            int index = i*BENCH_MAX_PASSES + p;
+            if (!bench.queryUsed[index]) continue;
+
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(bench.queries[index], GL_QUERY_RESULT, &elapsed);
+            bench.samples[i].passGpuMs[p] = (double)elapsed/1000000.0;
+        }
+    }
+#endif
+
+    // Gather columns: frame, cpu, pass cpu/gpu times and counters
+    int columnCount = 2 + bench.passCount*2 + bench.counterCount;
+    const char **names = (const char **)RL_CALLOC(columnCount, sizeof(const char *));
+    double *values = (double *)RL_CALLOC(columnCount*recorded, sizeof(double));
+
+    for (int i = 0; i < recorded; i++)
+    {
+        const BenchSample *sample = &bench.samples[i];
+        double *row = values + i*columnCount;
+        int c = 0;
+
+        row[c++] = sample->frameMs;
+        row[c++] = sample->cpuMs;
+        for (int p = 0; p < bench.passCount; p++)
+        {
+            row[c++] = sample->passCpuMs[p];
+            row[c++] = sample->passGpuMs[p];
+        }
+        for (int k = 0; k < bench.counterCount; k++) row[c++] = (double)sample->counters[k];
+    }
+
+    char nameBuffer[BENCH_MAX_PASSES*2 + BENCH_MAX_COUNTERS + 2][64] = { 0 };
+    int n = 0;
+    snprintf(nameBuffer[n++], 64, "frame_ms");
+    snprintf(nameBuffer[n++], 64, "cpu_ms");
+    for (int p = 0; p < bench.passCount; p++)
+    {
+        snprintf(nameBuffer[n++], 64, "%s_cpu_ms", bench.passNames[p]);
+        snprintf(nameBuffer[n++], 64, "%s_gpu_ms", bench.passNames[p]);
+    }
+    for (int k = 0; k < bench.counterCount; k++) snprintf(nameBuffer[n++], 64, "%s", bench.counterNames[k]);
+    for (int c = 0; c < columnCount; c++) names[c] = nameBuffer[c];
+
+    // Compute summaries per column
+    BenchStats *stats = (BenchStats *)RL_CALLOC(columnCount, sizeof(BenchStats));
+    double *column = (double *)RL_CALLOC(recorded, sizeof(double));
+    for (int c = 0; c < columnCount; c++)
+    {
+        for (int i = 0; i < recorded; i++) column[i] = values[i*columnCount + c];
+        stats[c] = ComputeStats(column, recorded);
+    }
+    RL_FREE(column);
+
+    bool success = false;
+    FILE *file = fopen(fileName, "wt");
+
+    if (file != NULL)
+    {
+        if (IsFileExtension(fileName, ".json"))
+        {
+            fprintf(file, "{\n  \"frames\": %i,\n  \"warmup\": %i,\n  \"summary\": {\n", recorded, bench.warmupFrames);
+            for (int c = 0; c < columnCount; c++)
+            {
+                fprintf(file, "    \"%s\": { \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+                    names[c], stats[c].mean, stats[c].p50, stats[c].p95, stats[c].p99, stats[c].max, (c < columnCount - 1)? "," : "");
+            }
+            fprintf(file, "  },\n  \"columns\": [");
+            for (int c = 0; c < columnCount; c++) fprintf(file, "\"%s\"%s", names[c], (c < columnCount - 1)? ", " : "");
+            fprintf(file, "],\n  \"samples\": [\n");
+            for (int i = 0; i < recorded; i++)
+            {
+                fprintf(file, "    [");
+                for (int c = 0; c < columnCount; c++) fprintf(file, "%.4f%s", values[i*columnCount + c], (c < columnCount - 1)? ", " : "");
+                fprintf(file, "]%s\n", (i < recorded - 1)? "," : "");
+            }
+            fprintf(file, "  ]\n}\n");
+        }
+        else
+        {
+            // CSV: one row per frame, followed by summary rows keyed by statistic name
+            fprintf(file, "frame");
+            for (int c = 0; c < columnCount; c++) fprintf(file, ",%s", names[c]);
+            fprintf(file, "\n");
+
+            for (int i = 0; i < recorded; i++)
+            {
+                fprintf(file, "%i", i);
+                for (int c = 0; c < columnCount; c++) fprintf(file, ",%.4f", values[i*columnCount + c]);
+                fprintf(file, "\n");
+            }
+
+            const char *statNames[5] = { "mean", "p50", "p95", "p99", "max" };
+            for (int s = 0; s < 5; s++)
+            {
+                fprintf(file, "%s", statNames[s]);
+                for (int c = 0; c < columnCount; c++)
+                {
+                    double v = (s == 0)? stats[c].mean : (s == 1)? stats[c].p50 : (s == 2)? stats[c].p95 : (s == 3)? stats[c].p99 : stats[c].max;
+                    fprintf(file, ",%.4f", v);
+                }
+                fprintf(file, "\n");
+            }
+        }
+
+        fclose(file);
+        success = true;
+    }
+
+    // Print a short summary to the log as well
+    for (int c = 0; c < columnCount; c++)
+    {
+        TraceLog(LOG_INFO, "BENCH: %-24s mean: %8.3f | p50: %8.3f | p95: %8.3f | p99: %8.3f",
+            names[c], stats[c].mean, stats[c].p50, stats[c].p95, stats[c].p99);
+    }
+
+    if (success) TraceLog(LOG_INFO, "BENCH: [%s] Report exported successfully", fileName);
+    else TraceLog(LOG_WARNING, "BENCH: [%s] Failed to export report", fileName);
+
+    RL_FREE(stats);
+    RL_FREE(values);
+    RL_FREE(names);
+
+    return success;
+}
+
+// Get monotonic time in seconds
+// NOTE: Unlike GetTime() it does not require a window, used by CPU only reports
+double BenchGetTime(void)
+{
+    struct timespec ts = { 0 };
+
+#if defined(_WIN32)
+    timespec_get(&ts, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec*1e-9;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Get sample for the current frame, NULL while in warmup or after the last frame
+static BenchSample *GetCurrentSample(void)
+{
+    int recorded = bench.frame - bench.warmupFrames;
+
+    if ((bench.samples == NULL) || (recorded < 0) || (recorded >= bench.frameCount)) return NULL;
+
+    return &bench.samples[recorded];
+}
+
+static int CompareDouble(const void *a, const void *b)
+{
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+
+    return (da > db) - (da < db);
+}
+
+// Compute mean and nearest-rank percentiles
+// NOTE: Values array is sorted in place
+static BenchStats ComputeStats(double *values, int count)
+{
+    BenchStats stats = { 0 };
+    if (count <= 0) return stats;
+
+    double sum = 0.0;
+    for (int i = 0; i < count; i++) sum += values[i];
+    stats.mean = sum/count;
+
+    qsort(values, count, sizeof(double), CompareDouble);
+
+    stats.p50 = values[(int)(0.50*(count - 1) + 0.5)];
+    stats.p95 = values[(int)(0.95*(count - 1) + 0.5)];
+    stats.p99 = values[(int)(0.99*(count - 1) + 0.5)];
+    stats.max = values[count - 1];
+
+    return stats;
+}
+
+#endif // RBENCH_IMPLEMENTATION
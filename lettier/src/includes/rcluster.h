@@ -0,0 +1,492 @@
+/**********************************************************************************************
+*
+*   raylib.cluster - Clustered forward lighting
+*
+*   The view frustum is split into a grid of froxels: CLUSTER_GRID_X x CLUSTER_GRID_Y
+*   screen tiles and CLUSTER_GRID_Z depth slices spaced exponentially between CLUSTER_NEAR
+*   and CLUSTER_FAR (the last slice reaches to infinity). Every frame the lights are binned
+*   on the CPU: each light gets a conservative froxel range from its view space bounding
+*   sphere, then every froxel in that range tests the sphere against its own view space box.
+*   Slices are binned in parallel on a JobPool, every slice writes only its own froxels.
+*
+*   The result goes to the GPU as three texture buffers: light data (2 RGBA32F texels per
+*   light: position and radius, color times intensity), one RG32UI texel per froxel
+*   (offset and count in the index list) and the compact R16UI light index list. A fragment
+*   finds its froxel from gl_FragCoord and view depth and only shades the lights listed.
+*
+*   CONFIGURATION:
+*
+*   #define RCLUSTER_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+*   DEPENDENCIES:
+*       rlights.h   - Light data
+*       rjobs.h     - JobPool used to bin depth slices
+*
+*   NOTE: Grid size and depth range must match the CLUSTER_* defines in the shader
+*
+**********************************************************************************************/
+
+#ifndef RCLUSTER_H
+#define RCLUSTER_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define CLUSTER_GRID_X          16          // Screen tiles horizontally
+#define CLUSTER_GRID_Y          9           // Screen tiles vertically
+#define CLUSTER_GRID_Z          24          // Depth slices
+#define CLUSTER_COUNT           (CLUSTER_GRID_X*CLUSTER_GRID_Y*CLUSTER_GRID_Z)
+#define CLUSTER_NEAR            0.1f        // First slice boundary, closer depths use slice 0
+#define CLUSTER_FAR             20.0f       // Last slice boundary, further depths use the last slice
+#define CLUSTER_MAX_LIGHTS      4096        // Lights binned per frame
+#define CLUSTER_MAX_CLUSTER_LIGHTS 256      // Lights listed per froxel
+#define CLUSTER_MAX_INDICES     65536       // Index list size, minimum GL_MAX_TEXTURE_BUFFER_SIZE
+#define CLUSTER_TEXTURE_SLOT    6           // First texture unit used, material slots from MATERIAL_MAP_HEIGHT up are not sampled by pbr.frag
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Binning statistics
+typedef struct ClusterStats {
+    int lights;                 // Lights passed in
+    int visibleLights;          // Lights touching the view frustum
+    int indices;                // Light indices written
+    int maxClusterLights;       // Most lights listed in one froxel
+    int droppedIndices;         // Indices lost to full froxels or a full index list
+    double binTime;             // CPU binning time in seconds
+    double uploadTime;          // Buffer upload time in seconds
+} ClusterStats;
+
+typedef struct LightClusters LightClusters;
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+LightClusters *LoadLightClusters(void);                                         // Allocate binning storage and texture buffers (requires GL context)
+void UnloadLightClusters(LightClusters *clusters);                              // Unload binning storage and texture buffers
+ClusterStats UpdateLightClusters(LightClusters *clusters, const Light *lights, int count, Camera camera, float aspect, JobPool *pool);  // Bin point lights for camera and upload
+void SetShaderLightClusters(Shader shader);                                     // Set shader cluster sampler units, clustered lights off
+void BindLightClusters(LightClusters *clusters, Shader shader);                 // Bind cluster buffers and enable clustered lights in shader
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RCLUSTER_H
+
+
+/***********************************************************************************
+*
+*   RCLUSTER IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RCLUSTER_IMPLEMENTATION)
+
+#include "raylib.h"
+#include "rlgl.h"
+#include "raymath.h"            // Required for: MatrixLookAt(), Vector3Transform()
+
+#if defined(PLATFORM_DESKTOP)
+    // NOTE: Texture buffers are not exposed by rlgl
+    #include "external/glad.h"
+#endif
+
+#include <string.h>             // Required for: memcpy(), memset()
+#include <math.h>               // Required for: tanf(), logf(), powf(), floorf()
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Light bounds in view space and the froxel range they touch
+typedef struct {
+    Vector3 position;
+    float radius;
+    int minX, maxX;
+    int minY, maxY;
+    int minZ, maxZ;
+} ClusterLightRange;
+
+struct LightClusters {
+    unsigned int lightBuffer, gridBuffer, indexBuffer;          // Texture buffer storage
+    unsigned int lightTexture, gridTexture, indexTexture;       // Buffer textures
+
+    float fovy;                 // Projection the froxel bounds were built for
+    float aspect;
+    BoundingBox *bounds;        // View space froxel bounds
+
+    int rangeCount;
+    ClusterLightRange *ranges;  // Visible lights, index list entries point here
+    float *lightData;           // Packed visible lights, 8 floats each
+
+    int *counts;                // Lights per froxel
+    unsigned short *lists;      // CLUSTER_MAX_CLUSTER_LIGHTS entries per froxel
+    int dropped[CLUSTER_GRID_Z];    // Lights dropped per slice
+
+    unsigned int *grid;         // Offset and count per froxel
+    unsigned short *indices;    // Compact index list
+};
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static void BuildClusterBounds(LightClusters *clusters, float fovy, float aspect);
+static int GetClusterSlice(float depth);
+static float GetClusterSliceDepth(int slice);
+static bool GetLightClusterRange(ClusterLightRange *range, float tanX, float tanY);
+static void BinClusterSlices(int start, int end, void *data);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Allocate binning storage and texture buffers
+LightClusters *LoadLightClusters(void)
+{
+    LightClusters *clusters = (LightClusters *)RL_CALLOC(1, sizeof(LightClusters));
+
+    clusters->bounds = (BoundingBox *)RL_CALLOC(CLUSTER_COUNT, sizeof(BoundingBox));
+    clusters->ranges = (ClusterLightRange *)RL_CALLOC(CLUSTER_MAX_LIGHTS, sizeof(ClusterLightRange));
+    clusters->lightData = (float *)RL_CALLOC(CLUSTER_MAX_LIGHTS*8, sizeof(float));
+    clusters->counts = (int *)RL_CALLOC(CLUSTER_COUNT, sizeof(int));
+    clusters->lists = (unsigned short *)RL_CALLOC(CLUSTER_COUNT*CLUSTER_MAX_CLUSTER_LIGHTS, sizeof(unsigned short));
+    clusters->grid = (unsigned int *)RL_CALLOC(CLUSTER_COUNT*2, sizeof(unsigned int));
+    clusters->indices = (unsigned short *)RL_CALLOC(CLUSTER_MAX_INDICES, sizeof(unsigned short));
+
+#if defined(PLATFORM_DESKTOP)
+    unsigned int buffers[3] = { 0 };
+    unsigned int textures[3] = { 0 };
+    int sizes[3] = { CLUSTER_MAX_LIGHTS*8*(int)sizeof(float), CLUSTER_COUNT*2*(int)sizeof(unsigned int), CLUSTER_MAX_INDICES*(int)sizeof(unsigned short) };
+    int formats[3] = { GL_RGBA32F, GL_RG32UI, GL_R16UI };
+
+    glGenBuffers(3, buffers);
+    glGenTextures(3, textures);
+
+    for (int i = 0; i < 3; i++)
+    {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+        glBufferData(GL_TEXTURE_BUFFER, sizes[i], NULL, GL_STREAM_DRAW);
+        glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        glTexBuffer(GL_TEXTURE_BUFFER, formats[i], buffers[i]);
+    }
+
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    clusters->lightBuffer = buffers[0];
+    clusters->gridBuffer = buffers[1];
+    clusters->indexBuffer = buffers[2];
+    clusters->lightTexture = textures[0];
+    clusters->gridTexture = textures[1];
+    clusters->indexTexture = textures[2];
+
+    TraceLog(LOG_INFO, "CLUSTER: Light clusters loaded (%ix%ix%i froxels | %i lights max)", CLUSTER_GRID_X, CLUSTER_GRID_Y, CLUSTER_GRID_Z, CLUSTER_MAX_LIGHTS);
+#else
+    TraceLog(LOG_WARNING, "CLUSTER: Texture buffers not supported on this platform");
+#endif
+
+    return clusters;
+}
+
+// Unload binning storage and texture buffers
+void UnloadLightClusters(LightClusters *clusters)
+{
+    if (clusters == NULL) return;
+
+#if defined(PLATFORM_DESKTOP)
+    unsigned int buffers[3] = { clusters->lightBuffer, clusters->gridBuffer, clusters->indexBuffer };
+    unsigned int textures[3] = { clusters->lightTexture, clusters->gridTexture, clusters->indexTexture };
+    glDeleteTextures(3, textures);
+    glDeleteBuffers(3, buffers);
+#endif
+
+    RL_FREE(clusters->bounds);
+    RL_FREE(clusters->ranges);
+    RL_FREE(clusters->lightData);
+    RL_FREE(clusters->counts);
+    RL_FREE(clusters->lists);
+    RL_FREE(clusters->grid);
+    RL_FREE(clusters->indices);
+    RL_FREE(clusters);
+}
+
+// Bin enabled point lights into the camera froxels and upload the result
+// NOTE: Lights need a radius, lights with radius 0 are skipped
+ClusterStats UpdateLightClusters(LightClusters *clusters, const Light *lights, int count, Camera camera, float aspect, JobPool *pool)
+{
+    ClusterStats stats = { 0 };
+    double start = GetTime();
+
+    if (count > CLUSTER_MAX_LIGHTS) count = CLUSTER_MAX_LIGHTS;
+    stats.lights = count;
+
+    if ((clusters->fovy != camera.fovy) || (clusters->aspect != aspect)) BuildClusterBounds(clusters, camera.fovy, aspect);
+
+    // Light ranges in view space, lights outside the frustum are dropped here
+    Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+    float tanY = tanf(camera.fovy*0.5f*DEG2RAD);
+    float tanX = tanY*aspect;
+
+    clusters->rangeCount = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (!lights[i].enabled || (lights[i].type != LIGHT_POINT) || (lights[i].radius <= 0.0f)) continue;
+
+        ClusterLightRange *range = &clusters->ranges[clusters->rangeCount];
+        range->position = Vector3Transform(lights[i].position, view);
+        range->radius = lights[i].radius;
+
+        if (!GetLightClusterRange(range, tanX, tanY)) continue;
+
+        float *data = &clusters->lightData[clusters->rangeCount*8];
+        data[0] = lights[i].position.x;
+        data[1] = lights[i].position.y;
+        data[2] = lights[i].position.z;
+        data[3] = lights[i].radius;
+        data[4] = lights[i].color.r/255.0f*lights[i].intensity;
+        data[5] = lights[i].color.g/255.0f*lights[i].intensity;
+        data[6] = lights[i].color.b/255.0f*lights[i].intensity;
+        data[7] = 0.0f;
+
+        clusters->rangeCount++;
+    }
+
+    stats.visibleLights = clusters->rangeCount;
+
+    // Bin slices in parallel, each slice only writes its own froxels
+    ParallelFor(pool, CLUSTER_GRID_Z, 1, BinClusterSlices, clusters);
+
+    // Compact froxel lists into one index list
+    int offset = 0;
+
+    for (int i = 0; i < CLUSTER_COUNT; i++)
+    {
+        int listed = clusters->counts[i];
+        if (offset + listed > CLUSTER_MAX_INDICES) listed = CLUSTER_MAX_INDICES - offset;
+
+        memcpy(&clusters->indices[offset], &clusters->lists[i*CLUSTER_MAX_CLUSTER_LIGHTS], listed*sizeof(unsigned short));
+        clusters->grid[i*2] = (unsigned int)offset;
+        clusters->grid[i*2 + 1] = (unsigned int)listed;
+
+        if (clusters->counts[i] > stats.maxClusterLights) stats.maxClusterLights = clusters->counts[i];
+        stats.droppedIndices += clusters->counts[i] - listed;
+        offset += listed;
+    }
+
+    for (int z = 0; z < CLUSTER_GRID_Z; z++) stats.droppedIndices += clusters->dropped[z];
+
+    stats.indices = offset;
+    stats.binTime = GetTime() - start;
+
+    // Upload: orphan the buffers, then write the used part
+    start = GetTime();
+
+#if defined(PLATFORM_DESKTOP)
+    glBindBuffer(GL_TEXTURE_BUFFER, clusters->lightBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, CLUSTER_MAX_LIGHTS*8*sizeof(float), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, clusters->rangeCount*8*sizeof(float), clusters->lightData);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, clusters->gridBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, CLUSTER_COUNT*2*sizeof(unsigned int), clusters->grid, GL_STREAM_DRAW);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, clusters->indexBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, CLUSTER_MAX_INDICES*sizeof(unsigned short), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, offset*sizeof(unsigned short), clusters->indices);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+#endif
+
+    stats.uploadTime = GetTime() - start;
+
+    return stats;
+}
+
+// Set shader cluster sampler units, clustered lights off
+// NOTE: Required even when clusters are not used, unset samplers would share unit 0 with a sampler2D
+void SetShaderLightClusters(Shader shader)
+{
+    int slots[3] = { CLUSTER_TEXTURE_SLOT, CLUSTER_TEXTURE_SLOT + 1, CLUSTER_TEXTURE_SLOT + 2 };
+    int useClusters = 0;
+
+    SetShaderValue(shader, GetShaderLocation(shader, "clusterLights"), &slots[0], SHADER_UNIFORM_INT);
+    SetShaderValue(shader, GetShaderLocation(shader, "clusterGrid"), &slots[1], SHADER_UNIFORM_INT);
+    SetShaderValue(shader, GetShaderLocation(shader, "clusterIndices"), &slots[2], SHADER_UNIFORM_INT);
+    SetShaderValue(shader, GetShaderLocation(shader, "useClusters"), &useClusters, SHADER_UNIFORM_INT);
+}
+
+// Bind cluster buffers and enable clustered lights in shader
+// NOTE: Call inside the render target the scene is drawn to, tiles follow the framebuffer size
+void BindLightClusters(LightClusters *clusters, Shader shader)
+{
+    int useClusters = 1;
+    float params[4] = { CLUSTER_NEAR, CLUSTER_GRID_Z/logf(CLUSTER_FAR/CLUSTER_NEAR), 1.0f/rlGetFramebufferWidth(), 1.0f/rlGetFramebufferHeight() };
+
+    SetShaderValue(shader, GetShaderLocation(shader, "useClusters"), &useClusters, SHADER_UNIFORM_INT);
+    SetShaderValue(shader, GetShaderLocation(shader, "clusterParams"), params, SHADER_UNIFORM_VEC4);
+
+#if defined(PLATFORM_DESKTOP)
+    unsigned int textures[3] = { clusters->lightTexture, clusters->gridTexture, clusters->indexTexture };
+
+    for (int i = 0; i < 3; i++)
+    {
+        glActiveTexture(GL_TEXTURE0 + CLUSTER_TEXTURE_SLOT + i);
+        glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+#endif
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Build view space bounds of every froxel for a projection
+static void BuildClusterBounds(LightClusters *clusters, float fovy, float aspect)
+{
+    float tanY = tanf(fovy*0.5f*DEG2RAD);
+    float tanX = tanY*aspect;
+
+    for (int z = 0; z < CLUSTER_GRID_Z; z++)
+    {
+        // Slice 0 reaches to the camera, the last slice to infinity (large enough here)
+        float nearDepth = (z == 0)? 0.0f : GetClusterSliceDepth(z);
+        float farDepth = (z == CLUSTER_GRID_Z - 1)? 1.0e6f : GetClusterSliceDepth(z + 1);
+
+        for (int y = 0; y < CLUSTER_GRID_Y; y++)
+        {
+            float y0 = ((float)y/CLUSTER_GRID_Y*2.0f - 1.0f)*tanY;
+            float y1 = ((float)(y + 1)/CLUSTER_GRID_Y*2.0f - 1.0f)*tanY;
+
+            for (int x = 0; x < CLUSTER_GRID_X; x++)
+            {
+                float x0 = ((float)x/CLUSTER_GRID_X*2.0f - 1.0f)*tanX;
+                float x1 = ((float)(x + 1)/CLUSTER_GRID_X*2.0f - 1.0f)*tanX;
+
+                // Tile edges scale with depth, extremes are at the near or far depth
+                BoundingBox *box = &clusters->bounds[(z*CLUSTER_GRID_Y + y)*CLUSTER_GRID_X + x];
+                box->min.x = fminf(x0*nearDepth, x0*farDepth);
+                box->max.x = fmaxf(x1*nearDepth, x1*farDepth);
+                box->min.y = fminf(y0*nearDepth, y0*farDepth);
+                box->max.y = fmaxf(y1*nearDepth, y1*farDepth);
+                box->min.z = -farDepth;
+                box->max.z = -nearDepth;
+            }
+        }
+    }
+
+    clusters->fovy = fovy;
+    clusters->aspect = aspect;
+}
+
+// Get depth slice of a positive view depth
+static int GetClusterSlice(float depth)
+{
+    if (depth <= CLUSTER_NEAR) return 0;
+
+    int slice = (int)floorf(logf(depth/CLUSTER_NEAR)*(CLUSTER_GRID_Z/logf(CLUSTER_FAR/CLUSTER_NEAR)));
+
+    return (slice < CLUSTER_GRID_Z - 1)? slice : CLUSTER_GRID_Z - 1;
+}
+
+// Get view depth where a slice starts
+static float GetClusterSliceDepth(int slice)
+{
+    return CLUSTER_NEAR*powf(CLUSTER_FAR/CLUSTER_NEAR, (float)slice/CLUSTER_GRID_Z);
+}
+
+// Get froxel range touched by a view space light sphere, false if it misses the frustum
+// NOTE: x/depth is monotonic in both, so the extremes of the sphere bounding box are at its corners
+static bool GetLightClusterRange(ClusterLightRange *range, float tanX, float tanY)
+{
+    float nearDepth = -range->position.z - range->radius;
+    float farDepth = -range->position.z + range->radius;
+
+    if (farDepth <= 0.0f) return false;
+
+    range->minZ = GetClusterSlice(nearDepth);
+    range->maxZ = GetClusterSlice(farDepth);
+
+    if (nearDepth <= CLUSTER_NEAR*0.01f)
+    {
+        // Sphere reaches the camera plane, every tile can see it
+        range->minX = 0; range->maxX = CLUSTER_GRID_X - 1;
+        range->minY = 0; range->maxY = CLUSTER_GRID_Y - 1;
+        return true;
+    }
+
+    float minX = 1.0e30f, maxX = -1.0e30f;
+    float minY = 1.0e30f, maxY = -1.0e30f;
+
+    for (int i = 0; i < 4; i++)
+    {
+        float depth = (i & 1)? farDepth : nearDepth;
+        float offset = (i & 2)? range->radius : -range->radius;
+        float x = (range->position.x + offset)/(depth*tanX);
+        float y = (range->position.y + offset)/(depth*tanY);
+
+        minX = fminf(minX, x); maxX = fmaxf(maxX, x);
+        minY = fminf(minY, y); maxY = fmaxf(maxY, y);
+    }
+
+    if ((minX > 1.0f) || (maxX < -1.0f) || (minY > 1.0f) || (maxY < -1.0f)) return false;
+
+    range->minX = (int)Clamp(floorf((minX*0.5f + 0.5f)*CLUSTER_GRID_X), 0.0f, CLUSTER_GRID_X - 1);
+    range->maxX = (int)Clamp(floorf((maxX*0.5f + 0.5f)*CLUSTER_GRID_X), 0.0f, CLUSTER_GRID_X - 1);
+    range->minY = (int)Clamp(floorf((minY*0.5f + 0.5f)*CLUSTER_GRID_Y), 0.0f, CLUSTER_GRID_Y - 1);
+    range->maxY = (int)Clamp(floorf((maxY*0.5f + 0.5f)*CLUSTER_GRID_Y), 0.0f, CLUSTER_GRID_Y - 1);
+
+    return true;
+}
+
+// Bin visible lights into the froxels of slices [start, end)
+static void BinClusterSlices(int start, int end, void *data)
+{
+    LightClusters *clusters = (LightClusters *)data;
+
+    for (int z = start; z < end; z++)
+    {
+        int *counts = &clusters->counts[z*CLUSTER_GRID_X*CLUSTER_GRID_Y];
+        memset(counts, 0, CLUSTER_GRID_X*CLUSTER_GRID_Y*sizeof(int));
+        clusters->dropped[z] = 0;
+
+        for (int i = 0; i < clusters->rangeCount; i++)
+        {
+            const ClusterLightRange *range = &clusters->ranges[i];
+            if ((z < range->minZ) || (z > range->maxZ)) continue;
+
+            Vector3 p = range->position;
+            float radiusSqr = range->radius*range->radius;
+
+            for (int y = range->minY; y <= range->maxY; y++)
+            {
+                for (int x = range->minX; x <= range->maxX; x++)
+                {
+                    int cluster = (z*CLUSTER_GRID_Y + y)*CLUSTER_GRID_X + x;
+                    const BoundingBox *box = &clusters->bounds[cluster];
+
+                    // Sphere against froxel box, squared distance to the closest box point
+                    float dx = fmaxf(fmaxf(box->min.x - p.x, 0.0f), p.x - box->max.x);
+                    float dy = fmaxf(fmaxf(box->min.y - p.y, 0.0f), p.y - box->max.y);
+                    float dz = fmaxf(fmaxf(box->min.z - p.z, 0.0f), p.z - box->max.z);
+                    if (dx*dx + dy*dy + dz*dz > radiusSqr) continue;
+
+                    int local = cluster - z*CLUSTER_GRID_X*CLUSTER_GRID_Y;
+
+                    if (counts[local] < CLUSTER_MAX_CLUSTER_LIGHTS) clusters->lists[cluster*CLUSTER_MAX_CLUSTER_LIGHTS + counts[local]++] = (unsigned short)i;
+                    else clusters->dropped[z]++;
+                }
+            }
+        }
+    }
+}
+
+#endif // RCLUSTER_IMPLEMENTATION
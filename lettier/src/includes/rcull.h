@@ -0,0 +1,408 @@
+/**********************************************************************************************
+*
+*   raylib.cull - Bounding volume hierarchy and frustum culling
+*
+*   A BVH over axis aligned boxes with 4 children per node. Child bounds are stored as
+*   structure of arrays (minX[4], minY[4], ...), so one node is tested against a frustum
+*   plane with a single 4 wide multiply-add: with SSE every node costs 6 plane tests no
+*   matter how many children it has, the scalar fallback runs the same arithmetic.
+*
+*   The tree is built top down, splitting at the centroid median of the longest axis twice
+*   per node. Traversal keeps a plane mask: children fully inside the frustum accept their
+*   whole subtree without further tests, which keeps the cost close to the number of boxes
+*   crossing the frustum border rather than the number of boxes in the scene.
+*
+*   CONFIGURATION:
+*
+*   #define RCULL_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+**********************************************************************************************/
+
+#ifndef RCULL_H
+#define RCULL_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define BVH_WIDTH               4       // Children per node
+#define BVH_MAX_DEPTH           64      // Traversal stack size
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// BVH node, child bounds in structure of arrays layout
+typedef struct BvhNode {
+    float minX[BVH_WIDTH], minY[BVH_WIDTH], minZ[BVH_WIDTH];
+    float maxX[BVH_WIDTH], maxY[BVH_WIDTH], maxZ[BVH_WIDTH];
+    int child[BVH_WIDTH];       // Inner node index if >= 0, leaf item ~child if < 0
+    int childCount;
+    int firstItem;              // Subtree range in bvh.items
+    int itemCount;
+} BvhNode;
+
+// Bounding volume hierarchy over a box array
+typedef struct Bvh {
+    int nodeCount;
+    BvhNode *nodes;             // nodes[0] is the root
+    int itemCount;
+    int *items;                 // Box indices in subtree order
+} Bvh;
+
+// Frustum planes (a, b, c, d), inside when a*x + b*y + c*z + d >= 0
+typedef struct Frustum {
+    Vector4 planes[6];
+} Frustum;
+
+// Culling statistics
+typedef struct CullStats {
+    int nodesTested;            // 4 wide node tests
+    int itemsTested;            // Items whose own box was tested
+    int itemsVisible;
+} CullStats;
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+Bvh LoadBvh(const BoundingBox *boxes, int count);                               // Build BVH over boxes
+void UnloadBvh(Bvh bvh);                                                        // Unload BVH nodes
+Frustum GetFrustumFromMatrix(Matrix clip);                                      // Extract frustum planes from a model-view-projection matrix
+CullStats CullBvh(Bvh bvh, Frustum frustum, unsigned char *visible);            // Set visible[i] for every box i inside or crossing the frustum
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RCULL_H
+
+
+/***********************************************************************************
+*
+*   RCULL IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RCULL_IMPLEMENTATION)
+
+#include "raylib.h"
+
+#include <string.h>             // Required for: memset()
+#include <float.h>              // Required for: FLT_MAX
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1))
+    #include <xmmintrin.h>      // Required for: SSE intrinsics
+    #define RCULL_SSE
+#endif
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct {
+    int node;
+    int planeMask;              // Planes the node still crosses
+} BvhStackEntry;
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static int BuildBvhNode(Bvh *bvh, const BoundingBox *boxes, const Vector3 *centers, int first, int count);
+static void SelectMedian(int *items, const Vector3 *centers, int count, int axis, int k);
+static int SplitItems(int *items, const Vector3 *centers, int count);
+static void TestNodePlanes(const BvhNode *node, const Frustum *frustum, int planeMask, int *outside, int *crossing);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Build BVH over boxes, items keep their index in the box array
+Bvh LoadBvh(const BoundingBox *boxes, int count)
+{
+    Bvh bvh = { 0 };
+    if (count <= 0) return bvh;
+
+    // Every inner node has at least 2 children, so count nodes are enough
+    bvh.nodes = (BvhNode *)RL_CALLOC(count, sizeof(BvhNode));
+    bvh.items = (int *)RL_MALLOC(count*sizeof(int));
+    bvh.itemCount = count;
+
+    Vector3 *centers = (Vector3 *)RL_MALLOC(count*sizeof(Vector3));
+
+    for (int i = 0; i < count; i++)
+    {
+        bvh.items[i] = i;
+        centers[i] = (Vector3){ (boxes[i].min.x + boxes[i].max.x)*0.5f, (boxes[i].min.y + boxes[i].max.y)*0.5f, (boxes[i].min.z + boxes[i].max.z)*0.5f };
+    }
+
+    BuildBvhNode(&bvh, boxes, centers, 0, count);
+
+    RL_FREE(centers);
+
+    return bvh;
+}
+
+// Unload BVH nodes
+void UnloadBvh(Bvh bvh)
+{
+    RL_FREE(bvh.nodes);
+    RL_FREE(bvh.items);
+}
+
+// Extract frustum planes from a model-view-projection matrix
+// NOTE: Planes are in the space the matrix transforms from, boxes are tested as is
+Frustum GetFrustumFromMatrix(Matrix clip)
+{
+    Frustum frustum = { 0 };
+
+    // Matrix rows, raylib stores columns in m0..m3, m4..m7, ...
+    Vector4 row0 = { clip.m0, clip.m4, clip.m8, clip.m12 };
+    Vector4 row1 = { clip.m1, clip.m5, clip.m9, clip.m13 };
+    Vector4 row2 = { clip.m2, clip.m6, clip.m10, clip.m14 };
+    Vector4 row3 = { clip.m3, clip.m7, clip.m11, clip.m15 };
+
+    frustum.planes[0] = (Vector4){ row3.x + row0.x, row3.y + row0.y, row3.z + row0.z, row3.w + row0.w };     // Left
+    frustum.planes[1] = (Vector4){ row3.x - row0.x, row3.y - row0.y, row3.z - row0.z, row3.w - row0.w };     // Right
+    frustum.planes[2] = (Vector4){ row3.x + row1.x, row3.y + row1.y, row3.z + row1.z, row3.w + row1.w };     // Bottom
+    frustum.planes[3] = (Vector4){ row3.x - row1.x, row3.y - row1.y, row3.z - row1.z, row3.w - row1.w };     // Top
+    frustum.planes[4] = (Vector4){ row3.x + row2.x, row3.y + row2.y, row3.z + row2.z, row3.w + row2.w };     // Near
+    frustum.planes[5] = (Vector4){ row3.x - row2.x, row3.y - row2.y, row3.z - row2.z, row3.w - row2.w };     // Far
+
+    return frustum;
+}
+
+// Set visible[i] to 1 for every box i inside or crossing the frustum, 0 otherwise
+CullStats CullBvh(Bvh bvh, Frustum frustum, unsigned char *visible)
+{
+    CullStats stats = { 0 };
+
+    memset(visible, 0, bvh.itemCount);
+    if (bvh.nodeCount == 0) return stats;
+
+    BvhStackEntry stack[BVH_MAX_DEPTH*(BVH_WIDTH - 1) + 1];
+    int stackSize = 0;
+    stack[stackSize++] = (BvhStackEntry){ 0, 0x3f };
+
+    while (stackSize > 0)
+    {
+        BvhStackEntry entry = stack[--stackSize];
+        const BvhNode *node = &bvh.nodes[entry.node];
+        int outside = 0;
+        int crossing[BVH_WIDTH] = { 0 };
+
+        TestNodePlanes(node, &frustum, entry.planeMask, &outside, crossing);
+        stats.nodesTested++;
+
+        for (int i = 0; i < node->childCount; i++)
+        {
+            int child = node->child[i];
+
+            if (child < 0)
+            {
+                // Leaf items are tested as part of their parent node
+                stats.itemsTested++;
+                if (!(outside & (1 << i))) visible[~child] = 1;
+            }
+            else if (outside & (1 << i)) continue;
+            else if (crossing[i] == 0)
+            {
+                // Fully inside, accept the whole subtree
+                const BvhNode *inside = &bvh.nodes[child];
+                for (int j = 0; j < inside->itemCount; j++) visible[bvh.items[inside->firstItem + j]] = 1;
+            }
+            else stack[stackSize++] = (BvhStackEntry){ child, crossing[i] };
+        }
+    }
+
+    for (int i = 0; i < bvh.itemCount; i++) stats.itemsVisible += visible[i];
+
+    return stats;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Build node over items[first, first + count), returns node index
+static int BuildBvhNode(Bvh *bvh, const BoundingBox *boxes, const Vector3 *centers, int first, int count)
+{
+    int index = bvh->nodeCount++;
+    int *items = bvh->items + first;
+
+    // Split in up to 4 groups: halves, then halves of halves while they hold more than one item
+    int groupFirst[BVH_WIDTH] = { 0 };
+    int groupCount[BVH_WIDTH] = { 0 };
+    int groups = 0;
+
+    if (count <= BVH_WIDTH)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            groupFirst[groups] = i;
+            groupCount[groups++] = 1;
+        }
+    }
+    else
+    {
+        int half = SplitItems(items, centers, count);
+        int quarter0 = SplitItems(items, centers, half);
+        int quarter1 = SplitItems(items + half, centers, count - half);
+
+        groupFirst[0] = 0;              groupCount[0] = quarter0;
+        groupFirst[1] = quarter0;       groupCount[1] = half - quarter0;
+        groupFirst[2] = half;           groupCount[2] = quarter1;
+        groupFirst[3] = half + quarter1; groupCount[3] = count - half - quarter1;
+        groups = 4;
+    }
+
+    // Children are appended after this node, its slot is filled once they exist
+    int child[BVH_WIDTH] = { 0 };
+    for (int g = 0; g < groups; g++)
+    {
+        if (groupCount[g] == 1) child[g] = ~items[groupFirst[g]];
+        else child[g] = BuildBvhNode(bvh, boxes, centers, first + groupFirst[g], groupCount[g]);
+    }
+
+    BvhNode *node = &bvh->nodes[index];
+    node->childCount = groups;
+    node->firstItem = first;
+    node->itemCount = count;
+
+    for (int g = 0; g < BVH_WIDTH; g++)
+    {
+        // Unused slots get empty bounds, they are never read past childCount
+        BoundingBox bounds = { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+
+        for (int i = 0; (g < groups) && (i < groupCount[g]); i++)
+        {
+            const BoundingBox *box = &boxes[items[groupFirst[g] + i]];
+            if (box->min.x < bounds.min.x) bounds.min.x = box->min.x;
+            if (box->min.y < bounds.min.y) bounds.min.y = box->min.y;
+            if (box->min.z < bounds.min.z) bounds.min.z = box->min.z;
+            if (box->max.x > bounds.max.x) bounds.max.x = box->max.x;
+            if (box->max.y > bounds.max.y) bounds.max.y = box->max.y;
+            if (box->max.z > bounds.max.z) bounds.max.z = box->max.z;
+        }
+
+        node->child[g] = (g < groups)? child[g] : 0;
+        node->minX[g] = bounds.min.x; node->minY[g] = bounds.min.y; node->minZ[g] = bounds.min.z;
+        node->maxX[g] = bounds.max.x; node->maxY[g] = bounds.max.y; node->maxZ[g] = bounds.max.z;
+    }
+
+    return index;
+}
+
+// Partially sort items so items[k] holds the median center on axis (quickselect)
+static void SelectMedian(int *items, const Vector3 *centers, int count, int axis, int k)
+{
+    int left = 0;
+    int right = count - 1;
+
+    while (left < right)
+    {
+        const float *pivotCenter = (const float *)&centers[items[(left + right)/2]];
+        float pivot = pivotCenter[axis];
+        int i = left;
+        int j = right;
+
+        while (i <= j)
+        {
+            while (((const float *)&centers[items[i]])[axis] < pivot) i++;
+            while (((const float *)&centers[items[j]])[axis] > pivot) j--;
+
+            if (i <= j)
+            {
+                int swap = items[i];
+                items[i] = items[j];
+                items[j] = swap;
+                i++;
+                j--;
+            }
+        }
+
+        if (k <= j) right = j;
+        else if (k >= i) left = i;
+        else break;
+    }
+}
+
+// Split items at the centroid median of the longest axis, returns size of the first part
+static int SplitItems(int *items, const Vector3 *centers, int count)
+{
+    if (count < 2) return count;
+
+    Vector3 min = centers[items[0]];
+    Vector3 max = centers[items[0]];
+
+    for (int i = 1; i < count; i++)
+    {
+        Vector3 center = centers[items[i]];
+        if (center.x < min.x) min.x = center.x;
+        if (center.y < min.y) min.y = center.y;
+        if (center.z < min.z) min.z = center.z;
+        if (center.x > max.x) max.x = center.x;
+        if (center.y > max.y) max.y = center.y;
+        if (center.z > max.z) max.z = center.z;
+    }
+
+    Vector3 extent = { max.x - min.x, max.y - min.y, max.z - min.z };
+    int axis = ((extent.x >= extent.y) && (extent.x >= extent.z))? 0 : ((extent.y >= extent.z)? 1 : 2);
+
+    SelectMedian(items, centers, count, axis, count/2);
+
+    return count/2;
+}
+
+// Test the 4 child boxes of a node against the planes in planeMask
+// NOTE: outside gets a bit per child fully outside one plane, crossing[i] the planes child i crosses
+static void TestNodePlanes(const BvhNode *node, const Frustum *frustum, int planeMask, int *outside, int *crossing)
+{
+#if defined(RCULL_SSE)
+    __m128 minX = _mm_loadu_ps(node->minX), minY = _mm_loadu_ps(node->minY), minZ = _mm_loadu_ps(node->minZ);
+    __m128 maxX = _mm_loadu_ps(node->maxX), maxY = _mm_loadu_ps(node->maxY), maxZ = _mm_loadu_ps(node->maxZ);
+    __m128 zero = _mm_setzero_ps();
+#endif
+
+    for (int p = 0; p < 6; p++)
+    {
+        if (!(planeMask & (1 << p))) continue;
+
+        Vector4 plane = frustum->planes[p];
+
+        // Positive vertex: box corner farthest along the plane normal, negative vertex: nearest
+#if defined(RCULL_SSE)
+        __m128 a = _mm_set1_ps(plane.x), b = _mm_set1_ps(plane.y), c = _mm_set1_ps(plane.z), d = _mm_set1_ps(plane.w);
+        __m128 px = (plane.x > 0.0f)? maxX : minX, nx = (plane.x > 0.0f)? minX : maxX;
+        __m128 py = (plane.y > 0.0f)? maxY : minY, ny = (plane.y > 0.0f)? minY : maxY;
+        __m128 pz = (plane.z > 0.0f)? maxZ : minZ, nz = (plane.z > 0.0f)? minZ : maxZ;
+
+        __m128 positive = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(a, px), _mm_mul_ps(b, py)), _mm_mul_ps(c, pz)), d);
+        __m128 negative = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(a, nx), _mm_mul_ps(b, ny)), _mm_mul_ps(c, nz)), d);
+
+        int outsideMask = _mm_movemask_ps(_mm_cmplt_ps(positive, zero));
+        int crossingMask = _mm_movemask_ps(_mm_cmplt_ps(negative, zero));
+
+        *outside |= outsideMask;
+        for (int i = 0; i < BVH_WIDTH; i++) if (crossingMask & (1 << i)) crossing[i] |= (1 << p);
+#else
+        for (int i = 0; i < BVH_WIDTH; i++)
+        {
+            float px = (plane.x > 0.0f)? node->maxX[i] : node->minX[i], nx = (plane.x > 0.0f)? node->minX[i] : node->maxX[i];
+            float py = (plane.y > 0.0f)? node->maxY[i] : node->minY[i], ny = (plane.y > 0.0f)? node->minY[i] : node->maxY[i];
+            float pz = (plane.z > 0.0f)? node->maxZ[i] : node->minZ[i], nz = (plane.z > 0.0f)? node->minZ[i] : node->maxZ[i];
+
+            float positive = plane.x*px + plane.y*py + plane.z*pz + plane.w;
+            float negative = plane.x*nx + plane.y*ny + plane.z*nz + plane.w;
+
+            if (positive < 0.0f) *outside |= (1 << i);
+            if (negative < 0.0f) crossing[i] |= (1 << p);
+        }
+#endif
+    }
+}
+
+#endif // RCULL_IMPLEMENTATION
@@ -0,0 +1,421 @@
+/**********************************************************************************************
+*
+*   raylib.meshopt - Triangle and vertex order optimization
+*
+*   Exporters write triangles in whatever order their tools keep them. The GPU transforms a
+*   vertex again every time it falls out of the post-transform cache, shades pixels that a
+*   later triangle covers, and fetches vertices from all over the buffer. Three passes fix
+*   the order without changing the mesh:
+*
+*   OptimizeVertexCache() reorders triangles for the post-transform cache with Tom Forsyth's
+*   linear speed algorithm: vertices are scored by their position in a simulated LRU cache and
+*   by how many triangles still use them, the best scoring triangle next to the cache goes next.
+*
+*   OptimizeOverdraw() splits a cache optimized order into clusters where the cache starts cold
+*   anyway (triangles with three new vertices) and sorts the clusters so the ones facing away
+*   from the mesh center are drawn first, they are the most likely to occlude the rest
+*   (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+*
+*   OptimizeVertexFetch() renumbers vertices in the order triangles first use them, so vertex
+*   fetches walk the buffer forward. RemapVertexBuffer() moves the vertex data accordingly.
+*
+*   GetVertexCacheStats() simulates a FIFO cache and returns ACMR (transformed vertices per
+*   triangle, 0.5 is the ideal for large regular meshes, 3.0 the worst) and ATVR (transformed
+*   vertices per referenced vertex, 1.0 is ideal), so gains can be checked without a GPU.
+*
+*   CONFIGURATION:
+*
+*   #define RMESHOPT_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+**********************************************************************************************/
+
+#ifndef RMESHOPT_H
+#define RMESHOPT_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define MESHOPT_CACHE_SIZE          32          // LRU cache size the triangle order is scored for
+#define MESHOPT_FIFO_SIZE           16          // FIFO cache size of GetVertexCacheStats() reports
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Post-transform vertex cache efficiency of a triangle order
+typedef struct VertexCacheStats {
+    float acmr;                 // Average cache miss ratio: transformed vertices per triangle
+    float atvr;                 // Average transform to vertex ratio: transformed vertices per referenced vertex
+} VertexCacheStats;
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+void OptimizeVertexCache(unsigned int *destination, const unsigned int *indices, int indexCount, int vertexCount);     // Reorder triangles for the post-transform cache
+void OptimizeOverdraw(unsigned int *destination, const unsigned int *indices, int indexCount, const float *positions, int vertexCount, int stride);  // Reorder cache optimized clusters, outward facing first
+int OptimizeVertexFetch(unsigned int *remap, unsigned int *indices, int indexCount, int vertexCount);                 // Renumber vertices in first use order, indices are rewritten, returns used vertex count
+void RemapVertexBuffer(void *destination, const void *vertices, int vertexCount, int stride, const unsigned int *remap); // Move vertices to their remapped position
+VertexCacheStats GetVertexCacheStats(const unsigned int *indices, int indexCount, int vertexCount, int cacheSize);    // Simulate a FIFO cache of cacheSize vertices
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RMESHOPT_H
+
+
+/***********************************************************************************
+*
+*   RMESHOPT IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RMESHOPT_IMPLEMENTATION)
+
+#include "raylib.h"
+
+#include <string.h>             // Required for: memcpy(), memset()
+#include <stdlib.h>             // Required for: qsort()
+#include <math.h>               // Required for: powf(), sqrtf()
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define MESHOPT_MAX_VALENCE         32          // Valence scores above this use the last entry
+#define MESHOPT_LAST_TRIANGLE_SCORE 0.75f       // Vertices of the last triangle, using them again gives no reuse gain
+#define MESHOPT_DECAY_POWER         1.5f
+#define MESHOPT_VALENCE_SCALE       2.0f
+#define MESHOPT_VALENCE_POWER       0.5f
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Triangle cluster of an overdraw sort
+typedef struct {
+    int firstTriangle;
+    int triangleCount;
+    float sortKey;              // Facing of the cluster away from the mesh center
+} MeshCluster;
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static float GetVertexScore(int cachePosition, int liveTriangles);
+static const float *GetVertexPosition(const float *positions, int stride, unsigned int vertex);
+static int CompareClusters(const void *a, const void *b);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Reorder triangles for the post-transform vertex cache (Forsyth)
+// NOTE: destination and indices may not overlap
+void OptimizeVertexCache(unsigned int *destination, const unsigned int *indices, int indexCount, int vertexCount)
+{
+    int triangleCount = indexCount/3;
+    if (triangleCount <= 0) return;
+
+    // Live triangles of every vertex, CSR layout, removed triangles are swapped past liveCount
+    int *liveCount = (int *)RL_CALLOC(vertexCount + 1, sizeof(int));
+    int *offsets = (int *)RL_CALLOC(vertexCount + 1, sizeof(int));
+    int *triangles = (int *)RL_MALLOC(indexCount*sizeof(int));
+
+    for (int i = 0; i < indexCount; i++) liveCount[indices[i]]++;
+    for (int v = 1; v < vertexCount; v++) offsets[v] = offsets[v - 1] + liveCount[v - 1];
+
+    int *fill = (int *)RL_CALLOC(vertexCount + 1, sizeof(int));
+    for (int i = 0; i < indexCount; i++) triangles[offsets[indices[i]] + fill[indices[i]]++] = i/3;
+    RL_FREE(fill);
+
+    float *vertexScores = (float *)RL_MALLOC(vertexCount*sizeof(float));
+    unsigned char *emitted = (unsigned char *)RL_CALLOC(triangleCount, 1);
+
+    for (int v = 0; v < vertexCount; v++) vertexScores[v] = GetVertexScore(-1, liveCount[v]);
+
+    // Cache holds up to MESHOPT_CACHE_SIZE vertices plus the 3 of the triangle pushed in front
+    unsigned int cache[MESHOPT_CACHE_SIZE + 3] = { 0 };
+    unsigned int newCache[MESHOPT_CACHE_SIZE + 3] = { 0 };
+    int cacheCount = 0;
+    int bestTriangle = -1;
+    int cursor = 0;                 // Scan position for restarts, every triangle before it is emitted
+
+    for (int output = 0; output < triangleCount; output++)
+    {
+        // No candidate next to the cache: take the next triangle that is still left
+        if (bestTriangle < 0)
+        {
+            while (emitted[cursor]) cursor++;
+            bestTriangle = cursor;
+        }
+
+        const unsigned int *triangle = &indices[bestTriangle*3];
+        memcpy(&destination[output*3], triangle, 3*sizeof(unsigned int));
+        emitted[bestTriangle] = 1;
+
+        // Remove the triangle from the live lists of its vertices
+        for (int k = 0; k < 3; k++)
+        {
+            unsigned int v = triangle[k];
+            int *list = &triangles[offsets[v]];
+
+            for (int j = 0; j < liveCount[v]; j++)
+            {
+                if (list[j] != bestTriangle) continue;
+
+                list[j] = list[liveCount[v] - 1];
+                list[liveCount[v] - 1] = bestTriangle;
+                liveCount[v]--;
+                break;
+            }
+        }
+
+        // Triangle vertices move to the front, the other entries keep their order
+        int newCount = 0;
+        for (int k = 0; k < 3; k++) newCache[newCount++] = triangle[k];
+
+        for (int j = 0; j < cacheCount; j++)
+        {
+            unsigned int v = cache[j];
+            if ((v != triangle[0]) && (v != triangle[1]) && (v != triangle[2])) newCache[newCount++] = v;
+        }
+
+        // Vertices pushed out of the cache lose their position score
+        for (int j = MESHOPT_CACHE_SIZE; j < newCount; j++) vertexScores[newCache[j]] = GetVertexScore(-1, liveCount[newCache[j]]);
+
+        cacheCount = (newCount < MESHOPT_CACHE_SIZE)? newCount : MESHOPT_CACHE_SIZE;
+        memcpy(cache, newCache, cacheCount*sizeof(unsigned int));
+
+        for (int j = 0; j < cacheCount; j++) vertexScores[cache[j]] = GetVertexScore(j, liveCount[cache[j]]);
+
+        // Rescore the live triangles around the cache and pick the best one
+        float bestScore = -1.0f;
+        bestTriangle = -1;
+
+        for (int j = 0; j < cacheCount; j++)
+        {
+            unsigned int v = cache[j];
+
+            for (int l = 0; l < liveCount[v]; l++)
+            {
+                int t = triangles[offsets[v] + l];
+                float score = vertexScores[indices[t*3]] + vertexScores[indices[t*3 + 1]] + vertexScores[indices[t*3 + 2]];
+
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestTriangle = t;
+                }
+            }
+        }
+    }
+
+    RL_FREE(emitted);
+    RL_FREE(vertexScores);
+    RL_FREE(triangles);
+    RL_FREE(offsets);
+    RL_FREE(liveCount);
+}
+
+// Reorder clusters of a cache optimized triangle order to reduce overdraw
+// NOTE: Clusters start where the FIFO cache misses all three vertices, so the cache efficiency
+// stays about the same. destination and indices may not overlap
+void OptimizeOverdraw(unsigned int *destination, const unsigned int *indices, int indexCount, const float *positions, int vertexCount, int stride)
+{
+    int triangleCount = indexCount/3;
+    if (triangleCount <= 0) return;
+
+    MeshCluster *clusters = (MeshCluster *)RL_MALLOC(triangleCount*sizeof(MeshCluster));
+    unsigned int *stamps = (unsigned int *)RL_CALLOC(vertexCount, sizeof(unsigned int));
+    unsigned int misses = 0;
+    int clusterCount = 0;
+
+    for (int t = 0; t < triangleCount; t++)
+    {
+        int triangleMisses = 0;
+
+        for (int k = 0; k < 3; k++)
+        {
+            unsigned int v = indices[t*3 + k];
+
+            if ((stamps[v] == 0) || (misses - stamps[v] >= MESHOPT_FIFO_SIZE))
+            {
+                misses++;
+                stamps[v] = misses;
+                triangleMisses++;
+            }
+        }
+
+        if ((t == 0) || (triangleMisses == 3)) clusters[clusterCount++] = (MeshCluster){ t, 0, 0.0f };
+        clusters[clusterCount - 1].triangleCount++;
+    }
+
+    RL_FREE(stamps);
+
+    // Mesh centroid, area weighted
+    float meshCenter[3] = { 0 };
+    float meshArea = 0.0f;
+    float *clusterData = (float *)RL_CALLOC(clusterCount*7, sizeof(float));    // Center, area, normal per cluster
+
+    for (int c = 0; c < clusterCount; c++)
+    {
+        float *data = &clusterData[c*7];
+
+        for (int t = clusters[c].firstTriangle; t < clusters[c].firstTriangle + clusters[c].triangleCount; t++)
+        {
+            const float *p0 = GetVertexPosition(positions, stride, indices[t*3]);
+            const float *p1 = GetVertexPosition(positions, stride, indices[t*3 + 1]);
+            const float *p2 = GetVertexPosition(positions, stride, indices[t*3 + 2]);
+
+            float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            float normal[3] = { e1[1]*e2[2] - e1[2]*e2[1], e1[2]*e2[0] - e1[0]*e2[2], e1[0]*e2[1] - e1[1]*e2[0] };
+            float area = 0.5f*sqrtf(normal[0]*normal[0] + normal[1]*normal[1] + normal[2]*normal[2]);
+
+            for (int k = 0; k < 3; k++)
+            {
+                data[k] += area*(p0[k] + p1[k] + p2[k])/3.0f;
+                data[4 + k] += normal[k];       // Cross product length is twice the area, already weighted
+            }
+
+            data[3] += area;
+        }
+
+        for (int k = 0; k < 3; k++) meshCenter[k] += data[k];
+        meshArea += data[3];
+    }
+
+    for (int k = 0; k < 3; k++) meshCenter[k] = (meshArea > 0.0f)? meshCenter[k]/meshArea : 0.0f;
+
+    // Clusters facing away from the center occlude the rest, they go first
+    for (int c = 0; c < clusterCount; c++)
+    {
+        const float *data = &clusterData[c*7];
+        float normalLength = sqrtf(data[4]*data[4] + data[5]*data[5] + data[6]*data[6]);
+        float key = 0.0f;
+
+        if ((data[3] > 0.0f) && (normalLength > 0.0f))
+        {
+            for (int k = 0; k < 3; k++) key += (data[k]/data[3] - meshCenter[k])*data[4 + k]/normalLength;
+        }
+
+        clusters[c].sortKey = key;
+    }
+
+    RL_FREE(clusterData);
+
+    qsort(clusters, clusterCount, sizeof(MeshCluster), CompareClusters);
+
+    int output = 0;
+    for (int c = 0; c < clusterCount; c++)
+    {
+        memcpy(&destination[output], &indices[clusters[c].firstTriangle*3], clusters[c].triangleCount*3*sizeof(unsigned int));
+        output += clusters[c].triangleCount*3;
+    }
+
+    RL_FREE(clusters);
+}
+
+// Renumber vertices in the order triangles first use them, indices are rewritten in place
+// NOTE: remap (vertexCount entries) maps old to new vertex, unused vertices go after the used ones
+int OptimizeVertexFetch(unsigned int *remap, unsigned int *indices, int indexCount, int vertexCount)
+{
+    unsigned int next = 0;
+
+    memset(remap, 0xff, vertexCount*sizeof(unsigned int));
+
+    for (int i = 0; i < indexCount; i++)
+    {
+        unsigned int v = indices[i];
+        if (remap[v] == 0xffffffffu) remap[v] = next++;
+        indices[i] = remap[v];
+    }
+
+    int usedCount = (int)next;
+    for (int v = 0; v < vertexCount; v++) if (remap[v] == 0xffffffffu) remap[v] = next++;
+
+    return usedCount;
+}
+
+// Move vertices of stride bytes to their remapped position
+// NOTE: destination and vertices may not overlap
+void RemapVertexBuffer(void *destination, const void *vertices, int vertexCount, int stride, const unsigned int *remap)
+{
+    for (int v = 0; v < vertexCount; v++) memcpy((unsigned char *)destination + (size_t)remap[v]*stride, (const unsigned char *)vertices + (size_t)v*stride, stride);
+}
+
+// Simulate a FIFO post-transform cache of cacheSize vertices over a triangle order
+VertexCacheStats GetVertexCacheStats(const unsigned int *indices, int indexCount, int vertexCount, int cacheSize)
+{
+    VertexCacheStats stats = { 0 };
+    if ((indexCount < 3) || (vertexCount < 1)) return stats;
+
+    unsigned int *stamps = (unsigned int *)RL_CALLOC(vertexCount, sizeof(unsigned int));
+    unsigned int misses = 0;
+    int usedCount = 0;
+
+    for (int i = 0; i < indexCount; i++)
+    {
+        unsigned int v = indices[i];
+
+        if (stamps[v] == 0) usedCount++;
+        if ((stamps[v] == 0) || (misses - stamps[v] >= (unsigned int)cacheSize))
+        {
+            misses++;
+            stamps[v] = misses;
+        }
+    }
+
+    RL_FREE(stamps);
+
+    stats.acmr = (float)misses/(indexCount/3);
+    stats.atvr = (float)misses/usedCount;
+
+    return stats;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Get Forsyth score of a vertex from its LRU cache position (-1 outside) and live triangle count
+static float GetVertexScore(int cachePosition, int liveTriangles)
+{
+    if (liveTriangles == 0) return -1.0f;      // Nothing left to draw with this vertex
+
+    float score = 0.0f;
+
+    if (cachePosition >= 0)
+    {
+        if (cachePosition < 3) score = MESHOPT_LAST_TRIANGLE_SCORE;
+        else score = powf(1.0f - (float)(cachePosition - 3)/(MESHOPT_CACHE_SIZE - 3), MESHOPT_DECAY_POWER);
+    }
+
+    // Vertices with few triangles left are preferred, finishing them frees the cache
+    if (liveTriangles > MESHOPT_MAX_VALENCE) liveTriangles = MESHOPT_MAX_VALENCE;
+    score += MESHOPT_VALENCE_SCALE*powf((float)liveTriangles, -MESHOPT_VALENCE_POWER);
+
+    return score;
+}
+
+// Get vertex position from a strided vertex array
+static const float *GetVertexPosition(const float *positions, int stride, unsigned int vertex)
+{
+    return (const float *)((const unsigned char *)positions + (size_t)vertex*stride);
+}
+
+// Sort clusters by decreasing outward facing
+static int CompareClusters(const void *a, const void *b)
+{
+    float keyA = ((const MeshCluster *)a)->sortKey;
+    float keyB = ((const MeshCluster *)b)->sortKey;
+
+    return (keyA < keyB) - (keyA > keyB);
+}
+
+#endif // RMESHOPT_IMPLEMENTATION
@@ -0,0 +1,589 @@
+/**********************************************************************************************
+*
+*   raylib.occlude - Software occlusion culling
+*
+*   Frustum culling keeps everything in front of the camera, also what is hidden behind a wall.
+*   Here a few large, low poly occluders are rasterized on the CPU into a small depth buffer,
+*   a hierarchical depth pyramid (Hi-Z) is built from it and mesh bounds are tested against the
+*   pyramid before they are submitted: a box whose closest point is behind the farthest occluder
+*   depth of every texel it covers is hidden.
+*
+*   Depth is 1/w (one over the view distance), larger is closer: it is linear in screen space, so
+*   it is interpolated across triangles as is, and 0 (infinitely far) clears the buffer. Every Hi-Z
+*   level keeps the farthest (smallest) value of the 2x2 texels below it.
+*
+*   Rasterization: occluder vertices are transformed and triangles set up in parallel per occluder,
+*   then the buffer is split in bands of OCCLUSION_BAND_ROWS rows rasterized in parallel. Rows are
+*   scanned 4 pixels at a time with edge functions: with SSE every edge and the depth cost one
+*   4 wide add per block and the depth is written with a masked max, the scalar fallback tests the
+*   same pixel centers one by one. Back facing triangles and triangles reaching behind the near
+*   plane are skipped, which can only make culling less aggressive.
+*
+*   Boxes reaching behind the near plane or outside the screen are never occluded. Occluder
+*   triangles cover the pixels whose center they contain, so a box can still be hidden by less than
+*   a buffer pixel of occluder edge: keep the buffer a quarter of the screen size or larger.
+*
+*   Everything runs on the CPU, no GL context is required.
+*
+*   CONFIGURATION:
+*
+*   #define ROCCLUDE_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+*   DEPENDENCIES:
+*       rjobs.h     - JobPool used to rasterize in parallel
+*
+**********************************************************************************************/
+
+#ifndef ROCCLUDE_H
+#define ROCCLUDE_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define OCCLUSION_MAX_LEVELS    6       // Hi-Z levels, level 0 is the depth buffer
+#define OCCLUSION_BAND_ROWS     8       // Buffer rows rasterized by one job
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Occluder rasterization statistics
+typedef struct OcclusionStats {
+    int occluders;              // Occluder meshes added
+    int triangles;              // Occluder triangles set up
+    int trianglesRasterized;    // Front facing, in front of the near plane and on screen
+    double rasterTime;          // Seconds spent transforming, rasterizing and building the Hi-Z
+} OcclusionStats;
+
+typedef struct OcclusionBuffer OcclusionBuffer;
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+OcclusionBuffer *LoadOcclusionBuffer(int width, int height);                    // Create depth buffer and Hi-Z pyramid, a quarter of the screen size is enough
+void UnloadOcclusionBuffer(OcclusionBuffer *buffer);                            // Unload depth buffer and occluder lists
+void ClearOccluders(OcclusionBuffer *buffer);                                   // Remove all occluders, call once per frame before adding them
+void AddOccluder(OcclusionBuffer *buffer, const Vector3 *vertices, int vertexCount, const int *indices, int indexCount, Matrix transform);  // Add occluder triangles, arrays are read when rasterizing
+OcclusionStats RasterizeOccluders(OcclusionBuffer *buffer, Camera camera, float aspect, JobPool *pool);   // Rasterize occluders seen from camera (perspective) and build the Hi-Z
+bool IsBoxOccluded(const OcclusionBuffer *buffer, BoundingBox box, Matrix transform);   // Check transformed box is hidden behind the rasterized occluders
+Image GetOcclusionImage(const OcclusionBuffer *buffer);                         // Get depth buffer as grayscale image, closer is brighter
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ROCCLUDE_H
+
+
+/***********************************************************************************
+*
+*   ROCCLUDE IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(ROCCLUDE_IMPLEMENTATION)
+
+#include "raylib.h"
+#include "rlgl.h"               // Required for: RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR
+#include "raymath.h"            // Required for: MatrixLookAt(), MatrixPerspective(), MatrixMultiply()
+
+#include <string.h>             // Required for: memset()
+#include <math.h>               // Required for: floorf(), fminf(), fmaxf()
+#include <float.h>              // Required for: FLT_MAX
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1))
+    #include <xmmintrin.h>      // Required for: SSE intrinsics
+    #define ROCCLUDE_SSE
+#endif
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define OCCLUSION_PADDING       (1 << (OCCLUSION_MAX_LEVELS - 1))  // Level 0 size multiple, every level halves exactly
+#define OCCLUSION_DEPTH_BIAS    1.001f  // Boxes have to be this much farther than the Hi-Z to be hidden
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Occluder mesh instance
+typedef struct {
+    const Vector3 *vertices;
+    int vertexCount;
+    const int *indices;
+    int indexCount;
+    Matrix transform;
+    int firstVertex;            // Offset in the transformed vertices
+    int firstTriangle;          // Offset in the set up triangles
+} Occluder;
+
+// Vertex in buffer pixels
+typedef struct {
+    float x;
+    float y;
+    float depth;                // 1/w, 0 behind the near plane
+} OccluderVertex;
+
+// Triangle ready to rasterize
+typedef struct {
+    float edgeA[3], edgeB[3], edgeC[3];     // Edge functions a*x + b*y + c, inside when all >= 0
+    float depthA, depthB, depthC;           // Depth plane over the buffer
+    int minX, minY, maxX, maxY;             // Pixel bounds, empty when not rasterized
+} OccluderTriangle;
+
+struct OcclusionBuffer {
+    int width;                  // Pixels covering the screen
+    int height;
+    int levelWidth[OCCLUSION_MAX_LEVELS];   // Padded level sizes, also the row strides
+    int levelHeight[OCCLUSION_MAX_LEVELS];
+    float *levels[OCCLUSION_MAX_LEVELS];    // levels[0] is the depth buffer
+    Matrix viewProjection;      // Camera of the last rasterization
+    bool ready;                 // Rasterized with a perspective camera
+
+    int occluderCount;
+    int occluderCapacity;
+    Occluder *occluders;
+    int vertexCapacity;
+    OccluderVertex *vertices;
+    int triangleCount;
+    int triangleCapacity;
+    OccluderTriangle *triangles;
+};
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static void SetupOccluders(int start, int end, void *data);
+static void SetupTriangle(const OcclusionBuffer *buffer, OccluderVertex v0, OccluderVertex v1, OccluderVertex v2, OccluderTriangle *triangle);
+static void RasterizeBands(int start, int end, void *data);
+static void RasterizeTriangle(OcclusionBuffer *buffer, const OccluderTriangle *triangle, int rowStart, int rowEnd);
+static void BuildDepthPyramid(OcclusionBuffer *buffer);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Create depth buffer and Hi-Z pyramid
+// NOTE: Level 0 is padded to a multiple of OCCLUSION_PADDING, padding texels stay empty (far)
+OcclusionBuffer *LoadOcclusionBuffer(int width, int height)
+{
+    OcclusionBuffer *buffer = (OcclusionBuffer *)RL_CALLOC(1, sizeof(OcclusionBuffer));
+
+    buffer->width = (width > 0)? width : 1;
+    buffer->height = (height > 0)? height : 1;
+
+    int texels = 0;
+    for (int l = 0; l < OCCLUSION_MAX_LEVELS; l++)
+    {
+        buffer->levelWidth[l] = ((buffer->width + OCCLUSION_PADDING - 1)/OCCLUSION_PADDING)*OCCLUSION_PADDING >> l;
+        buffer->levelHeight[l] = ((buffer->height + OCCLUSION_PADDING - 1)/OCCLUSION_PADDING)*OCCLUSION_PADDING >> l;
+        texels += buffer->levelWidth[l]*buffer->levelHeight[l];
+    }
+
+    // All levels in one allocation
+    buffer->levels[0] = (float *)RL_CALLOC(texels, sizeof(float));
+    for (int l = 1; l < OCCLUSION_MAX_LEVELS; l++) buffer->levels[l] = buffer->levels[l - 1] + buffer->levelWidth[l - 1]*buffer->levelHeight[l - 1];
+
+    TraceLog(LOG_INFO, "OCCLUDE: Occlusion buffer created (%ix%i, %i Hi-Z levels, %i KB)", buffer->width, buffer->height, OCCLUSION_MAX_LEVELS, (int)(texels*sizeof(float)/1024));
+
+    return buffer;
+}
+
+// Unload depth buffer and occluder lists
+void UnloadOcclusionBuffer(OcclusionBuffer *buffer)
+{
+    if (buffer == NULL) return;
+
+    RL_FREE(buffer->levels[0]);
+    RL_FREE(buffer->occluders);
+    RL_FREE(buffer->vertices);
+    RL_FREE(buffer->triangles);
+    RL_FREE(buffer);
+}
+
+// Remove all occluders, call once per frame before adding them
+void ClearOccluders(OcclusionBuffer *buffer)
+{
+    buffer->occluderCount = 0;
+}
+
+// Add occluder triangles, transform goes from the vertices space to world space
+// NOTE: Vertices and indices are not copied, they are read by RasterizeOccluders()
+void AddOccluder(OcclusionBuffer *buffer, const Vector3 *vertices, int vertexCount, const int *indices, int indexCount, Matrix transform)
+{
+    if ((vertexCount <= 0) || (indexCount < 3)) return;
+
+    if (buffer->occluderCount == buffer->occluderCapacity)
+    {
+        buffer->occluderCapacity = (buffer->occluderCapacity > 0)? buffer->occluderCapacity*2 : 16;
+        buffer->occluders = (Occluder *)RL_REALLOC(buffer->occluders, buffer->occluderCapacity*sizeof(Occluder));
+    }
+
+    buffer->occluders[buffer->occluderCount++] = (Occluder){ vertices, vertexCount, indices, indexCount, transform, 0, 0 };
+}
+
+// Rasterize occluders seen from camera and build the Hi-Z, pool can be NULL
+// NOTE: Same projection as BeginMode3D(). Orthographic cameras leave the buffer empty, nothing is occluded
+OcclusionStats RasterizeOccluders(OcclusionBuffer *buffer, Camera camera, float aspect, JobPool *pool)
+{
+    OcclusionStats stats = { 0 };
+    double start = GetTime();
+
+    memset(buffer->levels[0], 0, buffer->levelWidth[0]*buffer->levelHeight[0]*sizeof(float));
+
+    buffer->ready = (camera.projection == CAMERA_PERSPECTIVE);
+    if (!buffer->ready) return stats;
+
+    Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+    Matrix projection = MatrixPerspective(camera.fovy*DEG2RAD, aspect, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+    buffer->viewProjection = MatrixMultiply(view, projection);
+
+    // Every occluder gets its ranges in the shared vertex and triangle arrays
+    int vertexCount = 0;
+    int triangleCount = 0;
+
+    for (int i = 0; i < buffer->occluderCount; i++)
+    {
+        buffer->occluders[i].firstVertex = vertexCount;
+        buffer->occluders[i].firstTriangle = triangleCount;
+        vertexCount += buffer->occluders[i].vertexCount;
+        triangleCount += buffer->occluders[i].indexCount/3;
+    }
+
+    if (vertexCount > buffer->vertexCapacity)
+    {
+        buffer->vertexCapacity = vertexCount;
+        buffer->vertices = (OccluderVertex *)RL_REALLOC(buffer->vertices, vertexCount*sizeof(OccluderVertex));
+    }
+
+    if (triangleCount > buffer->triangleCapacity)
+    {
+        buffer->triangleCapacity = triangleCount;
+        buffer->triangles = (OccluderTriangle *)RL_REALLOC(buffer->triangles, triangleCount*sizeof(OccluderTriangle));
+    }
+
+    buffer->triangleCount = triangleCount;
+
+    ParallelFor(pool, buffer->occluderCount, 1, SetupOccluders, buffer);
+
+    for (int i = 0; i < triangleCount; i++)
+    {
+        if (buffer->triangles[i].minX <= buffer->triangles[i].maxX) stats.trianglesRasterized++;
+    }
+
+    // Bands are disjoint rows, no two jobs write the same texel
+    int bandCount = (buffer->height + OCCLUSION_BAND_ROWS - 1)/OCCLUSION_BAND_ROWS;
+    ParallelFor(pool, bandCount, 1, RasterizeBands, buffer);
+
+    BuildDepthPyramid(buffer);
+
+    stats.occluders = buffer->occluderCount;
+    stats.triangles = triangleCount;
+    stats.rasterTime = GetTime() - start;
+
+    return stats;
+}
+
+// Check box, transformed to world space, is hidden behind the rasterized occluders
+// NOTE: The Hi-Z level is the finest one where the box covers at most 2x2 texels
+bool IsBoxOccluded(const OcclusionBuffer *buffer, BoundingBox box, Matrix transform)
+{
+    if (!buffer->ready) return false;
+
+    Matrix mvp = MatrixMultiply(transform, buffer->viewProjection);
+
+    float minX = FLT_MAX;
+    float minY = FLT_MAX;
+    float maxX = -FLT_MAX;
+    float maxY = -FLT_MAX;
+    float closest = 0.0f;
+
+    for (int i = 0; i < 8; i++)
+    {
+        Vector3 p = { (i & 1)? box.max.x : box.min.x, (i & 2)? box.max.y : box.min.y, (i & 4)? box.max.z : box.min.z };
+
+        float x = mvp.m0*p.x + mvp.m4*p.y + mvp.m8*p.z + mvp.m12;
+        float y = mvp.m1*p.x + mvp.m5*p.y + mvp.m9*p.z + mvp.m13;
+        float w = mvp.m3*p.x + mvp.m7*p.y + mvp.m11*p.z + mvp.m15;
+
+        // Boxes reaching behind the near plane can not be projected, they count as visible
+        if (w < RL_CULL_DISTANCE_NEAR) return false;
+
+        float invW = 1.0f/w;
+        float screenX = (x*invW*0.5f + 0.5f)*buffer->width;
+        float screenY = (y*invW*0.5f + 0.5f)*buffer->height;
+
+        minX = fminf(minX, screenX);
+        minY = fminf(minY, screenY);
+        maxX = fmaxf(maxX, screenX);
+        maxY = fmaxf(maxY, screenY);
+        closest = fmaxf(closest, invW);
+    }
+
+    // Outside the screen is left to frustum culling
+    if ((maxX < 0.0f) || (maxY < 0.0f) || (minX >= buffer->width) || (minY >= buffer->height)) return false;
+
+    int x0 = (int)fmaxf(minX, 0.0f);
+    int y0 = (int)fmaxf(minY, 0.0f);
+    int x1 = (int)fminf(maxX, buffer->width - 1.0f);
+    int y1 = (int)fminf(maxY, buffer->height - 1.0f);
+
+    int level = 0;
+    while ((level < OCCLUSION_MAX_LEVELS - 1) && ((((x1 >> level) - (x0 >> level)) > 1) || (((y1 >> level) - (y0 >> level)) > 1))) level++;
+
+    const float *depth = buffer->levels[level];
+    int stride = buffer->levelWidth[level];
+    float threshold = closest*OCCLUSION_DEPTH_BIAS;
+
+    for (int y = y0 >> level; y <= (y1 >> level); y++)
+    {
+        for (int x = x0 >> level; x <= (x1 >> level); x++)
+        {
+            if (depth[y*stride + x] <= threshold) return false;   // Uncovered or the box reaches in front
+        }
+    }
+
+    return true;
+}
+
+// Get depth buffer as grayscale image, closer is brighter (distance 10 is mid gray), top row first
+Image GetOcclusionImage(const OcclusionBuffer *buffer)
+{
+    Image image = { 0 };
+    unsigned char *pixels = (unsigned char *)RL_MALLOC(buffer->width*buffer->height);
+
+    for (int y = 0; y < buffer->height; y++)
+    {
+        const float *row = buffer->levels[0] + (buffer->height - 1 - y)*buffer->levelWidth[0];
+        for (int x = 0; x < buffer->width; x++) pixels[y*buffer->width + x] = (unsigned char)(255.0f*row[x]/(row[x] + 0.1f));
+    }
+
+    image.data = pixels;
+    image.width = buffer->width;
+    image.height = buffer->height;
+    image.mipmaps = 1;
+    image.format = PIXELFORMAT_UNCOMPRESSED_GRAYSCALE;
+
+    return image;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Transform the vertices of a range of occluders and set up their triangles
+static void SetupOccluders(int start, int end, void *data)
+{
+    OcclusionBuffer *buffer = (OcclusionBuffer *)data;
+
+    for (int i = start; i < end; i++)
+    {
+        const Occluder *occluder = &buffer->occluders[i];
+        Matrix mvp = MatrixMultiply(occluder->transform, buffer->viewProjection);
+        OccluderVertex *vertices = buffer->vertices + occluder->firstVertex;
+
+        for (int v = 0; v < occluder->vertexCount; v++)
+        {
+            Vector3 p = occluder->vertices[v];
+
+            float x = mvp.m0*p.x + mvp.m4*p.y + mvp.m8*p.z + mvp.m12;
+            float y = mvp.m1*p.x + mvp.m5*p.y + mvp.m9*p.z + mvp.m13;
+            float w = mvp.m3*p.x + mvp.m7*p.y + mvp.m11*p.z + mvp.m15;
+
+            if (w < RL_CULL_DISTANCE_NEAR)
+            {
+                vertices[v] = (OccluderVertex){ 0 };
+                continue;
+            }
+
+            float invW = 1.0f/w;
+            vertices[v].x = (x*invW*0.5f + 0.5f)*buffer->width;
+            vertices[v].y = (y*invW*0.5f + 0.5f)*buffer->height;
+            vertices[v].depth = invW;
+        }
+
+        OccluderTriangle *triangles = buffer->triangles + occluder->firstTriangle;
+
+        for (int t = 0; t < occluder->indexCount/3; t++)
+        {
+            const int *index = occluder->indices + t*3;
+            SetupTriangle(buffer, vertices[index[0]], vertices[index[1]], vertices[index[2]], &triangles[t]);
+        }
+    }
+}
+
+// Set up edge functions, depth plane and pixel bounds of a triangle
+// NOTE: Counter clockwise triangles (front facing in GL) have a positive area with y up
+static void SetupTriangle(const OcclusionBuffer *buffer, OccluderVertex v0, OccluderVertex v1, OccluderVertex v2, OccluderTriangle *triangle)
+{
+    triangle->minX = 1;
+    triangle->maxX = 0;
+
+    if ((v0.depth == 0.0f) || (v1.depth == 0.0f) || (v2.depth == 0.0f)) return;
+
+    float area = (v1.x - v0.x)*(v2.y - v0.y) - (v2.x - v0.x)*(v1.y - v0.y);
+    if (area <= 0.0f) return;       // Back facing or degenerate
+
+    // Bounds of the covered pixel centers, clipped to the buffer
+    triangle->minX = (int)fmaxf(floorf(fminf(v0.x, fminf(v1.x, v2.x))), 0.0f);
+    triangle->minY = (int)fmaxf(floorf(fminf(v0.y, fminf(v1.y, v2.y))), 0.0f);
+    triangle->maxX = (int)fminf(floorf(fmaxf(v0.x, fmaxf(v1.x, v2.x))), buffer->width - 1.0f);
+    triangle->maxY = (int)fminf(floorf(fmaxf(v0.y, fmaxf(v1.y, v2.y))), buffer->height - 1.0f);
+
+    if ((triangle->minX > triangle->maxX) || (triangle->minY > triangle->maxY))
+    {
+        triangle->minX = 1;
+        triangle->maxX = 0;
+        return;
+    }
+
+    // Edge i is opposite vertex i, its function over the area is the barycentric weight of vertex i
+    OccluderVertex v[3] = { v0, v1, v2 };
+    float invArea = 1.0f/area;
+
+    triangle->depthA = 0.0f;
+    triangle->depthB = 0.0f;
+    triangle->depthC = 0.0f;
+
+    for (int i = 0; i < 3; i++)
+    {
+        OccluderVertex a = v[(i + 1)%3];
+        OccluderVertex b = v[(i + 2)%3];
+
+        triangle->edgeA[i] = a.y - b.y;
+        triangle->edgeB[i] = b.x - a.x;
+        triangle->edgeC[i] = a.x*b.y - b.x*a.y;
+
+        float weight = v[i].depth*invArea;
+        triangle->depthA += triangle->edgeA[i]*weight;
+        triangle->depthB += triangle->edgeB[i]*weight;
+        triangle->depthC += triangle->edgeC[i]*weight;
+    }
+}
+
+// Rasterize every triangle into a range of bands
+static void RasterizeBands(int start, int end, void *data)
+{
+    OcclusionBuffer *buffer = (OcclusionBuffer *)data;
+
+    for (int band = start; band < end; band++)
+    {
+        int rowStart = band*OCCLUSION_BAND_ROWS;
+        int rowEnd = (rowStart + OCCLUSION_BAND_ROWS < buffer->height)? rowStart + OCCLUSION_BAND_ROWS : buffer->height;
+
+        for (int i = 0; i < buffer->triangleCount; i++)
+        {
+            const OccluderTriangle *triangle = &buffer->triangles[i];
+            if ((triangle->minX > triangle->maxX) || (triangle->maxY < rowStart) || (triangle->minY >= rowEnd)) continue;
+
+            RasterizeTriangle(buffer, triangle, (triangle->minY > rowStart)? triangle->minY : rowStart, (triangle->maxY + 1 < rowEnd)? triangle->maxY + 1 : rowEnd);
+        }
+    }
+}
+
+// Rasterize triangle rows [rowStart, rowEnd), keeping the closest depth
+static void RasterizeTriangle(OcclusionBuffer *buffer, const OccluderTriangle *triangle, int rowStart, int rowEnd)
+{
+    int stride = buffer->levelWidth[0];
+
+#if defined(ROCCLUDE_SSE)
+    // Blocks start 4 pixel aligned, padded rows keep the last block of a row inside it
+    int startX = triangle->minX & ~3;
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 pixelX = _mm_add_ps(_mm_set1_ps((float)startX), _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f));
+
+    const __m128 edgeA0 = _mm_set1_ps(triangle->edgeA[0]);
+    const __m128 edgeA1 = _mm_set1_ps(triangle->edgeA[1]);
+    const __m128 edgeA2 = _mm_set1_ps(triangle->edgeA[2]);
+    const __m128 depthA = _mm_set1_ps(triangle->depthA);
+    const __m128 step0 = _mm_set1_ps(4.0f*triangle->edgeA[0]);
+    const __m128 step1 = _mm_set1_ps(4.0f*triangle->edgeA[1]);
+    const __m128 step2 = _mm_set1_ps(4.0f*triangle->edgeA[2]);
+    const __m128 depthStep = _mm_set1_ps(4.0f*triangle->depthA);
+
+    for (int y = rowStart; y < rowEnd; y++)
+    {
+        float pixelY = y + 0.5f;
+        float *row = buffer->levels[0] + y*stride;
+
+        __m128 e0 = _mm_add_ps(_mm_mul_ps(edgeA0, pixelX), _mm_set1_ps(triangle->edgeB[0]*pixelY + triangle->edgeC[0]));
+        __m128 e1 = _mm_add_ps(_mm_mul_ps(edgeA1, pixelX), _mm_set1_ps(triangle->edgeB[1]*pixelY + triangle->edgeC[1]));
+        __m128 e2 = _mm_add_ps(_mm_mul_ps(edgeA2, pixelX), _mm_set1_ps(triangle->edgeB[2]*pixelY + triangle->edgeC[2]));
+        __m128 depth = _mm_add_ps(_mm_mul_ps(depthA, pixelX), _mm_set1_ps(triangle->depthB*pixelY + triangle->depthC));
+
+        for (int x = startX; x <= triangle->maxX; x += 4)
+        {
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+
+            if (_mm_movemask_ps(inside) != 0)
+            {
+                __m128 previous = _mm_loadu_ps(row + x);
+                __m128 closest = _mm_max_ps(previous, depth);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, closest), _mm_andnot_ps(inside, previous)));
+            }
+
+            e0 = _mm_add_ps(e0, step0);
+            e1 = _mm_add_ps(e1, step1);
+            e2 = _mm_add_ps(e2, step2);
+            depth = _mm_add_ps(depth, depthStep);
+        }
+    }
+#else
+    for (int y = rowStart; y < rowEnd; y++)
+    {
+        float pixelY = y + 0.5f;
+        float *row = buffer->levels[0] + y*stride;
+
+        for (int x = triangle->minX; x <= triangle->maxX; x++)
+        {
+            float pixelX = x + 0.5f;
+
+            if ((triangle->edgeA[0]*pixelX + (triangle->edgeB[0]*pixelY + triangle->edgeC[0]) < 0.0f) ||
+                (triangle->edgeA[1]*pixelX + (triangle->edgeB[1]*pixelY + triangle->edgeC[1]) < 0.0f) ||
+                (triangle->edgeA[2]*pixelX + (triangle->edgeB[2]*pixelY + triangle->edgeC[2]) < 0.0f)) continue;
+
+            float depth = triangle->depthA*pixelX + (triangle->depthB*pixelY + triangle->depthC);
+            if (depth > row[x]) row[x] = depth;
+        }
+    }
+#endif
+}
+
+// Build Hi-Z levels, every texel keeps the farthest of the 2x2 texels below
+static void BuildDepthPyramid(OcclusionBuffer *buffer)
+{
+    for (int l = 1; l < OCCLUSION_MAX_LEVELS; l++)
+    {
+        const float *source = buffer->levels[l - 1];
+        float *target = buffer->levels[l];
+        int sourceStride = buffer->levelWidth[l - 1];
+        int width = buffer->levelWidth[l];
+
+        for (int y = 0; y < buffer->levelHeight[l]; y++)
+        {
+            const float *row0 = source + 2*y*sourceStride;
+            const float *row1 = row0 + sourceStride;
+            float *row = target + y*width;
+            int x = 0;
+
+#if defined(ROCCLUDE_SSE)
+            // 4 texels from 8 columns of both source rows
+            for (; x + 4 <= width; x += 4)
+            {
+                __m128 low = _mm_min_ps(_mm_loadu_ps(row0 + 2*x), _mm_loadu_ps(row1 + 2*x));
+                __m128 high = _mm_min_ps(_mm_loadu_ps(row0 + 2*x + 4), _mm_loadu_ps(row1 + 2*x + 4));
+                _mm_storeu_ps(row + x, _mm_min_ps(_mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1))));
+            }
+#endif
+            for (; x < width; x++) row[x] = fminf(fminf(row0[2*x], row0[2*x + 1]), fminf(row1[2*x], row1[2*x + 1]));
+        }
+    }
+}
+
+#endif // ROCCLUDE_IMPLEMENTATION
@@ -0,0 +1,283 @@
+/**********************************************************************************************
+*
+*   raylib.oit - Weighted blended order independent transparency
+*
+*   Alpha blending needs transparent surfaces drawn back to front, sorting by object still gets
+*   overlapping and intersecting surfaces wrong and sorting triangles costs CPU time every frame.
+*   Weighted blended OIT (McGuire and Bavoil 2013) replaces the sort with two sums that are the
+*   same in any order: transparent fragments are blended into an accumulation target
+*
+*       rgb: sum of color*alpha*weight, a: revealage, product of (1 - alpha)
+*
+*   and a weight target (r: sum of alpha*weight). EndTransparency() composites the weighted
+*   average color over the scene with 1 - revealage as coverage. The weight falls with view
+*   distance, so nearer surfaces dominate where several overlap. Every transparent fragment costs
+*   one blend into each target, however many surfaces overlap and in whatever order they come.
+*
+*   Both sums blend with the same factors (rgb: ONE, ONE, alpha: ZERO, ONE_MINUS_SRC_ALPHA), so
+*   no per target blend state is needed. Transparent shaders write the accumulation to location 0
+*   and the weighted alpha to location 1 (see OIT_OUTPUT in pbr.frag).
+*
+*   The targets have their own depth buffer: BeginTransparency() copies the depth of the current
+*   framebuffer into it, transparent surfaces are depth tested against the opaque scene but do
+*   not write depth. Composite and depth copy cover the current viewport.
+*
+*   CONFIGURATION:
+*
+*   #define ROIT_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+*   NOTE: Float targets, multiple draw buffers and depth blits are not exposed by rlgl,
+*   on other platforms LoadTransparencyTarget() returns NULL. The scene framebuffer needs a
+*   GL_DEPTH_COMPONENT24 depth buffer, like rpost.h targets
+*
+**********************************************************************************************/
+
+#ifndef ROIT_H
+#define ROIT_H
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct TransparencyTarget TransparencyTarget;
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+TransparencyTarget *LoadTransparencyTarget(int width, int height);             // Load accumulation and weight targets (requires GL context)
+void UnloadTransparencyTarget(TransparencyTarget *target);                      // Unload targets
+void SetTransparencyShader(TransparencyTarget *target, Shader shader);          // Set composite shader, also after it was reloaded
+void BeginTransparency(TransparencyTarget *target);                             // Copy scene depth, clear the targets and blend transparent draws into them
+void EndTransparency(TransparencyTarget *target);                               // Return to the scene framebuffer and composite transparency over it
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ROIT_H
+
+
+/***********************************************************************************
+*
+*   ROIT IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(ROIT_IMPLEMENTATION)
+
+#include "raylib.h"
+#include "rlgl.h"
+
+#if defined(PLATFORM_DESKTOP)
+    // NOTE: Float color targets, draw buffers, blend factors and blits are not exposed by rlgl
+    #include "external/glad.h"
+#endif
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+struct TransparencyTarget {
+    int width;
+    int height;
+
+    unsigned int framebuffer;
+    unsigned int accumTexture;  // RGBA16F weighted color sum and revealage
+    unsigned int weightTexture; // R16F weighted alpha sum
+    unsigned int depth;         // Copy of the scene depth
+    unsigned int vaoId;         // Empty vertex array, the composite triangle comes from gl_VertexID
+
+    Shader shader;              // Composite shader (oit.vert/oit.frag)
+
+    int previousFramebuffer;    // Scene framebuffer bound at BeginTransparency()
+    int viewport[4];
+};
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static unsigned int LoadTransparencyTexture(int width, int height, int internalFormat, int format);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Load accumulation and weight targets of width x height pixels
+// NOTE: Without float targets NULL is returned, blended materials have to be sorted instead
+TransparencyTarget *LoadTransparencyTarget(int width, int height)
+{
+#if defined(PLATFORM_DESKTOP)
+    TransparencyTarget *target = (TransparencyTarget *)RL_CALLOC(1, sizeof(TransparencyTarget));
+
+    target->width = width;
+    target->height = height;
+    target->accumTexture = LoadTransparencyTexture(width, height, GL_RGBA16F, GL_RGBA);
+    target->weightTexture = LoadTransparencyTexture(width, height, GL_R16F, GL_RED);
+
+    glGenRenderbuffers(1, &target->depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, target->depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &target->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target->accumTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, target->weightTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target->depth);
+
+    GLenum buffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, buffers);
+
+    bool complete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!complete)
+    {
+        TraceLog(LOG_WARNING, "OIT: Float render targets not supported, transparency sorted instead");
+        UnloadTransparencyTarget(target);
+        return NULL;
+    }
+
+    target->vaoId = rlLoadVertexArray();
+    rlDisableVertexArray();
+
+    TraceLog(LOG_INFO, "OIT: Transparency targets loaded (%ix%i | RGBA16F + R16F | %.1f MB)", width, height, (long long)width*height*(8 + 2 + 4)/(1024.0*1024.0));
+
+    return target;
+#else
+    TraceLog(LOG_WARNING, "OIT: Float render targets not supported on this platform");
+    return NULL;
+#endif
+}
+
+// Unload targets
+// NOTE: The composite shader belongs to the caller
+void UnloadTransparencyTarget(TransparencyTarget *target)
+{
+    if (target == NULL) return;
+
+#if defined(PLATFORM_DESKTOP)
+    if (target->framebuffer != 0) glDeleteFramebuffers(1, &target->framebuffer);
+    if (target->depth != 0) glDeleteRenderbuffers(1, &target->depth);
+    if (target->accumTexture != 0) glDeleteTextures(1, &target->accumTexture);
+    if (target->weightTexture != 0) glDeleteTextures(1, &target->weightTexture);
+    if (target->vaoId != 0) rlUnloadVertexArray(target->vaoId);
+#endif
+
+    RL_FREE(target);
+}
+
+// Set composite shader, loaded from oit.vert/oit.frag
+// NOTE: Call again after the shader was reloaded, sampler units are set again
+void SetTransparencyShader(TransparencyTarget *target, Shader shader)
+{
+    if (target == NULL) return;
+
+    target->shader = shader;
+
+    int units[2] = { 0, 1 };
+    SetShaderValue(shader, GetShaderLocation(shader, "oitAccum"), &units[0], SHADER_UNIFORM_INT);
+    SetShaderValue(shader, GetShaderLocation(shader, "oitWeight"), &units[1], SHADER_UNIFORM_INT);
+}
+
+// Copy scene depth, clear the targets and blend transparent draws into them
+// NOTE: Depth writes are disabled, EndTransparency() enables them again
+void BeginTransparency(TransparencyTarget *target)
+{
+    if (target == NULL) return;
+
+#if defined(PLATFORM_DESKTOP)
+    rlDrawRenderBatchActive();      // Flush pending draws to the scene framebuffer
+
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target->previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, target->viewport);
+
+    int x0 = target->viewport[0];
+    int y0 = target->viewport[1];
+    int x1 = x0 + target->viewport[2];
+    int y1 = y0 + target->viewport[3];
+
+    // Multisampled scene depth is resolved by the blit, transparent edges test against one sample
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, target->previousFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target->framebuffer);
+    glBlitFramebuffer(x0, y0, x1, y1, x0, y0, x1, y1, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+
+    float accumClear[4] = { 0.0f, 0.0f, 0.0f, 1.0f };       // Nothing accumulated, fully revealed
+    float weightClear[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, accumClear);
+    glClearBufferfv(GL_COLOR, 1, weightClear);
+
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    glBlendEquation(GL_FUNC_ADD);
+    glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+#endif
+}
+
+// Return to the scene framebuffer and composite transparency over it
+// NOTE: One triangle over the viewport, pixels without transparent surfaces are discarded.
+// Blending is left at raylib default alpha blending
+void EndTransparency(TransparencyTarget *target)
+{
+    if (target == NULL) return;
+
+#if defined(PLATFORM_DESKTOP)
+    glBindFramebuffer(GL_FRAMEBUFFER, target->previousFramebuffer);
+
+    // Weighted average color over the scene, covering 1 - revealage
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    rlDisableDepthTest();
+
+    if (target->shader.id != 0)
+    {
+        rlEnableShader(target->shader.id);
+        rlActiveTextureSlot(0);
+        rlEnableTexture(target->accumTexture);
+        rlActiveTextureSlot(1);
+        rlEnableTexture(target->weightTexture);
+
+        rlEnableVertexArray(target->vaoId);
+        rlDrawVertexArray(0, 3);
+        rlDisableVertexArray();
+
+        rlDisableTexture();
+        rlActiveTextureSlot(0);
+        rlDisableTexture();
+        rlDisableShader();
+    }
+
+    rlEnableDepthTest();
+    glDepthMask(GL_TRUE);
+#endif
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Load render target texture, read with texelFetch() so no mipmaps and no filtering
+static unsigned int LoadTransparencyTexture(int width, int height, int internalFormat, int format)
+{
+    unsigned int id = 0;
+
+#if defined(PLATFORM_DESKTOP)
+    glGenTextures(1, &id);
+    glBindTexture(GL_TEXTURE_2D, id);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_HALF_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+#endif
+
+    return id;
+}
+
+#endif // ROIT_IMPLEMENTATION
@@ -0,0 +1,751 @@
+/**********************************************************************************************
+*
+*   raylib.queue - Sorted render queue
+*
+*   Draw items (an index range of a vertex array, a material and a transform) are collected
+*   from every scene drawn in a frame, then sorted by a 64 bit key and submitted in that order.
+*   The key packs pass, shader, texture set, material and view depth, so items sharing
+*   state end up next to each other and only the state that really differs is rebound:
+*
+*       opaque:  | pass:2 | shader:10 | textures:10 | material:12 | depth:24 (front to back) |
+*       blended: | pass:2 | depth:24 (back to front) | shader:10 | textures:10 | material:12 |
+*       transparent: same layout as opaque
+*
+*   Shader, texture set and material fields are ranks in tables rebuilt every frame, depth is
+*   the top of the float bits of the view space distance (positive floats sort as integers).
+*   Keys are sorted with an 8 bit LSD radix sort that skips digits equal in every key.
+*
+*   Materials with an albedo color alpha below 255 are blended: drawn after the opaque
+*   items, back to front, without depth writes. Alpha tested materials (see rscene.h) are opaque.
+*   With a transparency target (SetRenderQueueTransparency()) they are transparent instead: drawn
+*   last in state order, weighted blended into the target and composited over the scene (roit.h),
+*   no depth sort and runs of meshes are merged like opaque ones.
+*
+*   Depth pre-pass: DrawRenderQueueDepth() draws the opaque items depth only, with a position
+*   only shader, and an alpha test shader for alpha tested materials. DrawRenderQueue() then
+*   shades the opaque items with depth test GL_EQUAL and no depth writes, so every pixel runs
+*   the material shader once, whatever order the items are in.
+*   NOTE: Material vertex shaders must compute gl_Position exactly like the pre-pass shaders,
+*   declare it invariant in both.
+*
+*   CONFIGURATION:
+*
+*   #define RQUEUE_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+*   DEPENDENCIES:
+*       rscene.h    - Scene meshes, batches and culling
+*       roit.h      - Weighted blended transparency targets
+*
+**********************************************************************************************/
+
+#ifndef RQUEUE_H
+#define RQUEUE_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define RENDER_QUEUE_MAX_SHADERS        1024    // Shader ranks fitting the key field
+#define RENDER_QUEUE_MAX_TEXTURE_SETS   1024    // Texture set ranks fitting the key field
+#define RENDER_QUEUE_MAX_MATERIALS      4096    // Material ranks fitting the key field
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Render pass, first key field
+typedef enum {
+    RENDER_PASS_OPAQUE = 0,     // Front to back
+    RENDER_PASS_BLENDED,        // Back to front, no depth writes
+    RENDER_PASS_TRANSPARENT     // Weighted blended into the transparency target, any order
+} RenderPass;
+
+// State changes of the last DrawRenderQueue()
+typedef struct RenderQueueStats {
+    int items;
+    int drawCalls;
+    int triangles;
+    int shaderBinds;
+    int textureBinds;           // Texture units rebound, units already holding the texture are skipped
+    int materialBinds;          // Material uniform uploads
+    int transformBinds;         // Matrix uniform uploads
+    int vertexArrayBinds;
+    int depthDrawCalls;         // Depth pre-pass draws, 0 without pre-pass
+    int depthTriangles;
+    int transparentItems;       // Items drawn into the transparency target
+    double sortTime;            // Seconds spent sorting keys
+} RenderQueueStats;
+
+typedef struct RenderQueue RenderQueue;
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+RenderQueue *LoadRenderQueue(void);                                             // Create empty render queue, grows as needed
+void UnloadRenderQueue(RenderQueue *queue);                                     // Unload render queue
+void ClearRenderQueue(RenderQueue *queue);                                      // Remove all items, call once per frame
+void SetRenderQueueTransparency(RenderQueue *queue, TransparencyTarget *target); // Draw blended materials order independent into target (NULL sorts them, default)
+void AddSceneToRenderQueue(RenderQueue *queue, Scene scene, Matrix transform);  // Cull scene and add its visible mesh ranges (inside BeginMode3D)
+void DrawRenderQueueDepth(RenderQueue *queue, Shader shader, Shader alphaShader); // Sort items and draw opaque ones depth only, DrawRenderQueue() then shades with depth equal
+void DrawRenderQueue(RenderQueue *queue);                                       // Sort items and draw them, redundant binds are skipped
+RenderQueueStats GetRenderQueueStats(RenderQueue *queue);                       // Get state changes of the last draw
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RQUEUE_H
+
+
+/***********************************************************************************
+*
+*   RQUEUE IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RQUEUE_IMPLEMENTATION)
+
+#include "raylib.h"
+#include "rlgl.h"
+#include "raymath.h"            // Required for: MatrixMultiply(), MatrixInvert(), MatrixTranspose(), Vector3Transform()
+
+#if defined(PLATFORM_DESKTOP)
+    // NOTE: Depth test function is not exposed by rlgl
+    #include "external/glad.h"
+#endif
+
+#include <string.h>             // Required for: memcpy(), memcmp()
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define RENDER_QUEUE_MIN_CAPACITY       256     // Items allocated on first use
+
+#define RENDER_KEY_PASS_SHIFT           62
+#define RENDER_KEY_DEPTH_BITS           24
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Index range drawn with one call
+typedef struct {
+    unsigned int vaoId;
+    const float *positionDequant;   // Batch position dequantization, set with the vertex array
+    int firstIndex;
+    int indexCount;
+    int transform;              // Index into queue transforms
+    const Material *material;
+} RenderItem;
+
+struct RenderQueue {
+    int count;
+    int capacity;
+    RenderItem *items;
+    unsigned long long *keys;
+    unsigned int *order;        // Item indices, sorted with the keys
+    unsigned long long *tempKeys;
+    unsigned int *tempOrder;
+
+    int transformCount;
+    int transformCapacity;
+    Matrix *transforms;         // Model matrices, one per added scene
+
+    // Key field ranks, rebuilt every frame
+    int shaderCount;
+    unsigned int shaders[RENDER_QUEUE_MAX_SHADERS];
+    int textureSetCount;
+    unsigned int textureSets[RENDER_QUEUE_MAX_TEXTURE_SETS][MAX_MATERIAL_MAPS];
+    int materialCount;
+    const Material *materials[RENDER_QUEUE_MAX_MATERIALS];
+
+    bool sorted;                // Keys sorted since the last clear
+    bool depthPrepass;          // Opaque depth drawn since the last clear
+    TransparencyTarget *transparency;   // Blended materials are weighted blended when set
+    double sortTime;
+    RenderQueueStats stats;
+};
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static void AddRenderItem(RenderQueue *queue, RenderItem item, unsigned long long key);
+static int AddRenderTransform(RenderQueue *queue, Matrix transform);
+static void SortRenderQueue(RenderQueue *queue);
+static unsigned long long GetRenderKey(RenderPass pass, int shader, int textureSet, int material, float depth);
+static int GetShaderRank(RenderQueue *queue, unsigned int shaderId);
+static int GetTextureSetRank(RenderQueue *queue, const Material *material);
+static int GetMaterialRank(RenderQueue *queue, const Material *material);
+static void SortRenderKeys(unsigned long long *keys, unsigned int *values, unsigned long long *tempKeys, unsigned int *tempValues, int count);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Create empty render queue, item arrays grow as needed
+RenderQueue *LoadRenderQueue(void)
+{
+    return (RenderQueue *)RL_CALLOC(1, sizeof(RenderQueue));
+}
+
+// Unload render queue
+void UnloadRenderQueue(RenderQueue *queue)
+{
+    if (queue == NULL) return;
+
+    RL_FREE(queue->items);
+    RL_FREE(queue->keys);
+    RL_FREE(queue->order);
+    RL_FREE(queue->tempKeys);
+    RL_FREE(queue->tempOrder);
+    RL_FREE(queue->transforms);
+    RL_FREE(queue);
+}
+
+// Remove all items and key ranks, call once per frame before adding items
+void ClearRenderQueue(RenderQueue *queue)
+{
+    queue->count = 0;
+    queue->transformCount = 0;
+    queue->shaderCount = 0;
+    queue->textureSetCount = 0;
+    queue->materialCount = 0;
+    queue->sorted = false;
+    queue->depthPrepass = false;
+}
+
+// Draw blended materials weighted blended into target, in any order
+// NOTE: Set before items are added, their keys depend on it. Material shaders of blended
+// materials have to write the transparency outputs (see roit.h)
+void SetRenderQueueTransparency(RenderQueue *queue, TransparencyTarget *target)
+{
+    queue->transparency = target;
+}
+
+// Cull scene and add its visible mesh ranges
+// NOTE: Must be called inside BeginMode3D(), culling and depth use the current matrices.
+// Opaque and transparent runs of visible full detail meshes in a batch are one item like DrawScene()
+// draws them, sorted blended meshes are added one by one so they can be sorted back to front
+void AddSceneToRenderQueue(RenderQueue *queue, Scene scene, Matrix transform)
+{
+    CullScene(scene, transform);
+
+    Matrix matModel = MatrixMultiply(transform, rlGetMatrixTransform());
+    Matrix matModelView = MatrixMultiply(matModel, rlGetMatrixModelview());
+    int transformIndex = AddRenderTransform(queue, matModel);
+
+    for (int i = 0; i < scene.batchCount; i++)
+    {
+        const SceneBatch *batch = &scene.batches[i];
+        const Material *material = &scene.materials[batch->material];
+
+        bool blended = (material->maps[MATERIAL_MAP_ALBEDO].color.a < 255) && (material->params[SCENE_PARAM_ALPHA_CUTOFF] == 0.0f);
+        RenderPass pass = !blended? RENDER_PASS_OPAQUE : (queue->transparency != NULL)? RENDER_PASS_TRANSPARENT : RENDER_PASS_BLENDED;
+        int shader = GetShaderRank(queue, material->shader.id);
+        int textureSet = GetTextureSetRank(queue, material);
+        int materialRank = GetMaterialRank(queue, material);
+
+        for (int m = batch->firstMesh; m < batch->firstMesh + batch->meshCount; m++)
+        {
+            if (!scene.visible[m]) continue;
+
+            int last = m;
+            BoundingBox bounds = scene.meshes[m].bounds;
+
+            while ((pass != RENDER_PASS_BLENDED) && (scene.lod[m] == 0) && (last + 1 < batch->firstMesh + batch->meshCount) && scene.visible[last + 1] && (scene.lod[last + 1] == 0))
+            {
+                last++;
+                bounds.min = Vector3Min(bounds.min, scene.meshes[last].bounds.min);
+                bounds.max = Vector3Max(bounds.max, scene.meshes[last].bounds.max);
+            }
+
+            Vector3 center = Vector3Scale(Vector3Add(bounds.min, bounds.max), 0.5f);
+            float depth = -Vector3Transform(center, matModelView).z;
+
+            const SceneLod *lod = &scene.meshes[m].lods[scene.lod[m]];
+
+            RenderItem item = { 0 };
+            item.vaoId = batch->vaoId;
+            item.positionDequant = batch->positionDequant;
+            item.firstIndex = lod->firstIndex;
+            item.indexCount = (last > m)? scene.meshes[last].firstIndex + scene.meshes[last].indexCount - item.firstIndex : lod->indexCount;
+            item.transform = transformIndex;
+            item.material = material;
+
+            AddRenderItem(queue, item, GetRenderKey(pass, shader, textureSet, materialRank, depth));
+
+            m = last;
+        }
+    }
+}
+
+// Sort items by key and draw the opaque ones depth only, color writes are disabled
+// NOTE: Alpha tested materials are drawn with alphaShader: albedo texture at SHADER_LOC_MAP_DIFFUSE,
+// albedo color at SHADER_LOC_COLOR_DIFFUSE and cutoff at SHADER_LOC_ALPHA_CUTOFF, like the material shaders
+void DrawRenderQueueDepth(RenderQueue *queue, Shader shader, Shader alphaShader)
+{
+    SortRenderQueue(queue);
+
+    Matrix matView = rlGetMatrixModelview();
+    Matrix matProjection = rlGetMatrixProjection();
+
+    const int *locs = NULL;
+    const Material *material = NULL;
+    int transform = -1;
+    unsigned int vaoId = 0;
+    const float *positionDequant = NULL;
+    unsigned int albedoId = 0;
+    int drawCalls = 0;
+    int triangles = 0;
+
+    rlColorMask(false, false, false, false);
+
+    for (int i = 0; (i < queue->count) && ((queue->keys[i] >> RENDER_KEY_PASS_SHIFT) == RENDER_PASS_OPAQUE); i++)
+    {
+        const RenderItem *item = &queue->items[queue->order[i]];
+
+        bool alphaTest = (item->material->params[SCENE_PARAM_ALPHA_CUTOFF] > 0.0f);
+        const Shader *itemShader = alphaTest? &alphaShader : &shader;
+
+        if (itemShader->locs != locs)
+        {
+            locs = itemShader->locs;
+            rlEnableShader(itemShader->id);
+
+            int unit = MATERIAL_MAP_ALBEDO;
+            if (locs[SHADER_LOC_MAP_DIFFUSE] != -1) rlSetUniform(locs[SHADER_LOC_MAP_DIFFUSE], &unit, SHADER_UNIFORM_INT, 1);
+
+            material = NULL;
+            transform = -1;
+            positionDequant = NULL;
+        }
+
+        // Only the alpha test reads the material
+        if (alphaTest && (item->material != material))
+        {
+            material = item->material;
+
+            if (locs[SHADER_LOC_COLOR_DIFFUSE] != -1)
+            {
+                Color color = material->maps[MATERIAL_MAP_ALBEDO].color;
+                float values[4] = { color.r/255.0f, color.g/255.0f, color.b/255.0f, color.a/255.0f };
+                rlSetUniform(locs[SHADER_LOC_COLOR_DIFFUSE], values, SHADER_UNIFORM_VEC4, 1);
+            }
+
+            if (locs[SHADER_LOC_ALPHA_CUTOFF] != -1) rlSetUniform(locs[SHADER_LOC_ALPHA_CUTOFF], &material->params[SCENE_PARAM_ALPHA_CUTOFF], SHADER_UNIFORM_FLOAT, 1);
+
+            unsigned int id = material->maps[MATERIAL_MAP_ALBEDO].texture.id;
+            if ((id != 0) && (id != albedoId))
+            {
+                rlActiveTextureSlot(MATERIAL_MAP_ALBEDO);
+                rlEnableTexture(id);
+                albedoId = id;
+            }
+        }
+
+        if (item->transform != transform)
+        {
+            transform = item->transform;
+
+            Matrix matModelView = MatrixMultiply(queue->transforms[transform], matView);
+            if (locs[SHADER_LOC_MATRIX_MVP] != -1) rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_MVP], MatrixMultiply(matModelView, matProjection));
+        }
+
+        if (item->vaoId != vaoId)
+        {
+            vaoId = item->vaoId;
+            rlEnableVertexArray(vaoId);
+        }
+
+        if (item->positionDequant != positionDequant)
+        {
+            positionDequant = item->positionDequant;
+            if (locs[SHADER_LOC_POSITION_DEQUANT] != -1) rlSetUniform(locs[SHADER_LOC_POSITION_DEQUANT], positionDequant, SHADER_UNIFORM_VEC3, 2);
+        }
+
+        rlDrawVertexArrayElements(item->firstIndex, item->indexCount, 0);
+
+        drawCalls++;
+        triangles += item->indexCount/3;
+    }
+
+    if (albedoId != 0)
+    {
+        rlActiveTextureSlot(MATERIAL_MAP_ALBEDO);
+        rlDisableTexture();
+    }
+
+    rlDisableVertexArray();
+    rlDisableShader();
+    rlColorMask(true, true, true, true);
+
+    queue->depthPrepass = true;
+    queue->stats.depthDrawCalls = drawCalls;
+    queue->stats.depthTriangles = triangles;
+}
+
+// Sort items by key and draw them
+// NOTE: Same shader inputs as raylib DrawMesh(). Shader, textures, material uniforms,
+// matrices and vertex array are only set when they differ from the previous item.
+// After DrawRenderQueueDepth() opaque items only pass where they wrote the pre-pass depth.
+// Transparent items go to the transparency target, composited after the last one
+void DrawRenderQueue(RenderQueue *queue)
+{
+    SortRenderQueue(queue);
+
+    RenderQueueStats stats = { 0 };
+    stats.items = queue->count;
+    stats.sortTime = queue->sortTime;
+
+    if (queue->depthPrepass)
+    {
+        stats.depthDrawCalls = queue->stats.depthDrawCalls;
+        stats.depthTriangles = queue->stats.depthTriangles;
+
+        // Depth is complete, opaque items neither write it nor need to be drawn front to back
+        rlDisableDepthMask();
+#if defined(PLATFORM_DESKTOP)
+        glDepthFunc(GL_EQUAL);
+#endif
+    }
+
+    Matrix matView = rlGetMatrixModelview();
+    Matrix matProjection = rlGetMatrixProjection();
+
+    unsigned int shaderId = 0;
+    const int *locs = NULL;
+    const Material *material = NULL;
+    int transform = -1;
+    unsigned int vaoId = 0;
+    const float *positionDequant = NULL;
+    unsigned int textures[MAX_MATERIAL_MAPS] = { 0 };
+    bool blending = false;
+    bool transparent = false;
+
+    for (int i = 0; i < queue->count; i++)
+    {
+        const RenderItem *item = &queue->items[queue->order[i]];
+        RenderPass pass = (RenderPass)(queue->keys[i] >> RENDER_KEY_PASS_SHIFT);
+
+        // Blended and transparent items come last, they are depth tested but do not write depth
+        if (!blending && (pass != RENDER_PASS_OPAQUE))
+        {
+#if defined(PLATFORM_DESKTOP)
+            if (queue->depthPrepass) glDepthFunc(GL_LEQUAL);
+#endif
+            rlDisableDepthMask();
+            blending = true;
+        }
+
+        if (!transparent && (pass == RENDER_PASS_TRANSPARENT))
+        {
+            BeginTransparency(queue->transparency);
+            transparent = true;
+        }
+
+        if (transparent) stats.transparentItems++;
+
+        if (item->material->shader.id != shaderId)
+        {
+            shaderId = item->material->shader.id;
+            locs = item->material->shader.locs;
+            rlEnableShader(shaderId);
+
+            if (locs[SHADER_LOC_MATRIX_VIEW] != -1) rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_VIEW], matView);
+            if (locs[SHADER_LOC_MATRIX_PROJECTION] != -1) rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_PROJECTION], matProjection);
+
+            for (int m = 0; m < MAX_MATERIAL_MAPS; m++) rlSetUniform(locs[SHADER_LOC_MAP_DIFFUSE + m], &m, SHADER_UNIFORM_INT, 1);
+
+            // Scene files have no vertex colors, shaders reading them get white
+            if (locs[SHADER_LOC_VERTEX_COLOR] != -1)
+            {
+                float white[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+                rlSetVertexAttributeDefault(locs[SHADER_LOC_VERTEX_COLOR], white, SHADER_ATTRIB_VEC4, 4);
+            }
+
+            // Uniforms are per program, the new one needs material, matrices and dequantization again
+            material = NULL;
+            transform = -1;
+            positionDequant = NULL;
+            stats.shaderBinds++;
+        }
+
+        if (item->material != material)
+        {
+            material = item->material;
+
+            if (locs[SHADER_LOC_COLOR_DIFFUSE] != -1)
+            {
+                Color color = material->maps[MATERIAL_MAP_DIFFUSE].color;
+                float values[4] = { color.r/255.0f, color.g/255.0f, color.b/255.0f, color.a/255.0f };
+                rlSetUniform(locs[SHADER_LOC_COLOR_DIFFUSE], values, SHADER_UNIFORM_VEC4, 1);
+            }
+
+            if (locs[SHADER_LOC_COLOR_SPECULAR] != -1)
+            {
+                Color color = material->maps[MATERIAL_MAP_SPECULAR].color;
+                float values[4] = { color.r/255.0f, color.g/255.0f, color.b/255.0f, color.a/255.0f };
+                rlSetUniform(locs[SHADER_LOC_COLOR_SPECULAR], values, SHADER_UNIFORM_VEC4, 1);
+            }
+
+            if (locs[SHADER_LOC_ALPHA_CUTOFF] != -1) rlSetUniform(locs[SHADER_LOC_ALPHA_CUTOFF], &material->params[SCENE_PARAM_ALPHA_CUTOFF], SHADER_UNIFORM_FLOAT, 1);
+
+            // Units keep their texture across materials and shaders, only changed ones are rebound
+            for (int m = 0; m < MAX_MATERIAL_MAPS; m++)
+            {
+                unsigned int id = material->maps[m].texture.id;
+                if ((id == 0) || (id == textures[m])) continue;
+
+                rlActiveTextureSlot(m);
+                if ((m == MATERIAL_MAP_IRRADIANCE) || (m == MATERIAL_MAP_PREFILTER) || (m == MATERIAL_MAP_CUBEMAP)) rlEnableTextureCubemap(id);
+                else rlEnableTexture(id);
+
+                textures[m] = id;
+                stats.textureBinds++;
+            }
+
+            stats.materialBinds++;
+        }
+
+        if (item->transform != transform)
+        {
+            transform = item->transform;
+
+            Matrix matModel = queue->transforms[transform];
+            Matrix matModelView = MatrixMultiply(matModel, matView);
+
+            if (locs[SHADER_LOC_MATRIX_MODEL] != -1) rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_MODEL], matModel);
+            if (locs[SHADER_LOC_MATRIX_NORMAL] != -1) rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_NORMAL], MatrixTranspose(MatrixInvert(matModel)));
+            if (locs[SHADER_LOC_MATRIX_MVP] != -1) rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_MVP], MatrixMultiply(matModelView, matProjection));
+
+            stats.transformBinds++;
+        }
+
+        if (item->vaoId != vaoId)
+        {
+            vaoId = item->vaoId;
+            rlEnableVertexArray(vaoId);
+            stats.vertexArrayBinds++;
+        }
+
+        if (item->positionDequant != positionDequant)
+        {
+            positionDequant = item->positionDequant;
+            if (locs[SHADER_LOC_POSITION_DEQUANT] != -1) rlSetUniform(locs[SHADER_LOC_POSITION_DEQUANT], positionDequant, SHADER_UNIFORM_VEC3, 2);
+        }
+
+        rlDrawVertexArrayElements(item->firstIndex, item->indexCount, 0);
+
+        stats.drawCalls++;
+        stats.triangles += item->indexCount/3;
+    }
+
+    for (int m = 0; m < MAX_MATERIAL_MAPS; m++)
+    {
+        if (textures[m] == 0) continue;
+
+        rlActiveTextureSlot(m);
+        if ((m == MATERIAL_MAP_IRRADIANCE) || (m == MATERIAL_MAP_PREFILTER) || (m == MATERIAL_MAP_CUBEMAP)) rlDisableTextureCubemap();
+        else rlDisableTexture();
+    }
+
+    rlDisableVertexArray();
+    rlDisableShader();
+
+    if (transparent) EndTransparency(queue->transparency);
+
+#if defined(PLATFORM_DESKTOP)
+    if (queue->depthPrepass && !blending) glDepthFunc(GL_LEQUAL);
+#endif
+    if (blending || queue->depthPrepass) rlEnableDepthMask();
+
+    queue->stats = stats;
+}
+
+// Get state changes of the last DrawRenderQueue()
+RenderQueueStats GetRenderQueueStats(RenderQueue *queue)
+{
+    return queue->stats;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Add item with its sort key, arrays double when full
+static void AddRenderItem(RenderQueue *queue, RenderItem item, unsigned long long key)
+{
+    if (queue->count == queue->capacity)
+    {
+        int capacity = (queue->capacity > 0)? queue->capacity*2 : RENDER_QUEUE_MIN_CAPACITY;
+
+        queue->items = (RenderItem *)RL_REALLOC(queue->items, capacity*sizeof(RenderItem));
+        queue->keys = (unsigned long long *)RL_REALLOC(queue->keys, capacity*sizeof(unsigned long long));
+        queue->order = (unsigned int *)RL_REALLOC(queue->order, capacity*sizeof(unsigned int));
+        queue->tempKeys = (unsigned long long *)RL_REALLOC(queue->tempKeys, capacity*sizeof(unsigned long long));
+        queue->tempOrder = (unsigned int *)RL_REALLOC(queue->tempOrder, capacity*sizeof(unsigned int));
+        queue->capacity = capacity;
+    }
+
+    queue->items[queue->count] = item;
+    queue->keys[queue->count] = key;
+    queue->count++;
+}
+
+// Sort keys once per frame, the item order is shared by the depth pre-pass and the shading pass
+static void SortRenderQueue(RenderQueue *queue)
+{
+    if (queue->sorted) return;
+
+    double sortStart = GetTime();
+    for (int i = 0; i < queue->count; i++) queue->order[i] = i;
+    SortRenderKeys(queue->keys, queue->order, queue->tempKeys, queue->tempOrder, queue->count);
+    queue->sortTime = GetTime() - sortStart;
+
+    queue->sorted = true;
+}
+
+// Add model matrix, returns its index
+static int AddRenderTransform(RenderQueue *queue, Matrix transform)
+{
+    if (queue->transformCount == queue->transformCapacity)
+    {
+        queue->transformCapacity = (queue->transformCapacity > 0)? queue->transformCapacity*2 : 16;
+        queue->transforms = (Matrix *)RL_REALLOC(queue->transforms, queue->transformCapacity*sizeof(Matrix));
+    }
+
+    queue->transforms[queue->transformCount] = transform;
+
+    return queue->transformCount++;
+}
+
+// Pack key fields, see module description for the layout
+static unsigned long long GetRenderKey(RenderPass pass, int shader, int textureSet, int material, float depth)
+{
+    // Positive floats keep their order as integers, behind the camera counts as 0
+    unsigned int depthBits = 0;
+    if (depth > 0.0f) memcpy(&depthBits, &depth, sizeof(float));
+
+    unsigned long long depthKey = depthBits >> (31 - RENDER_KEY_DEPTH_BITS);
+    unsigned long long state = ((unsigned long long)shader << 22) | ((unsigned long long)textureSet << 12) | (unsigned long long)material;
+    unsigned long long key = (unsigned long long)pass << RENDER_KEY_PASS_SHIFT;
+
+    // Transparent items need no order, they are sorted by state like opaque ones
+    if (pass == RENDER_PASS_BLENDED)
+    {
+        depthKey = ((1ull << RENDER_KEY_DEPTH_BITS) - 1) - depthKey;    // Far items first
+        key |= (depthKey << 38) | (state << 6);
+    }
+    else key |= (state << 30) | (depthKey << 6);
+
+    return key;
+}
+
+// Get shader key rank, first seen shaders get the lower ranks
+static int GetShaderRank(RenderQueue *queue, unsigned int shaderId)
+{
+    for (int i = 0; i < queue->shaderCount; i++)
+    {
+        if (queue->shaders[i] == shaderId) return i;
+    }
+
+    if (queue->shaderCount == RENDER_QUEUE_MAX_SHADERS) return RENDER_QUEUE_MAX_SHADERS - 1;
+
+    queue->shaders[queue->shaderCount] = shaderId;
+
+    return queue->shaderCount++;
+}
+
+// Get texture set key rank, materials with the same textures share it
+static int GetTextureSetRank(RenderQueue *queue, const Material *material)
+{
+    unsigned int textures[MAX_MATERIAL_MAPS] = { 0 };
+    for (int m = 0; m < MAX_MATERIAL_MAPS; m++) textures[m] = material->maps[m].texture.id;
+
+    for (int i = 0; i < queue->textureSetCount; i++)
+    {
+        if (memcmp(queue->textureSets[i], textures, sizeof(textures)) == 0) return i;
+    }
+
+    if (queue->textureSetCount == RENDER_QUEUE_MAX_TEXTURE_SETS) return RENDER_QUEUE_MAX_TEXTURE_SETS - 1;
+
+    memcpy(queue->textureSets[queue->textureSetCount], textures, sizeof(textures));
+
+    return queue->textureSetCount++;
+}
+
+// Get material key rank
+static int GetMaterialRank(RenderQueue *queue, const Material *material)
+{
+    for (int i = 0; i < queue->materialCount; i++)
+    {
+        if (queue->materials[i] == material) return i;
+    }
+
+    if (queue->materialCount == RENDER_QUEUE_MAX_MATERIALS) return RENDER_QUEUE_MAX_MATERIALS - 1;
+
+    queue->materials[queue->materialCount] = material;
+
+    return queue->materialCount++;
+}
+
+// Sort keys and their item indices, LSD radix sort with 8 bit digits
+// NOTE: Histograms of all digits are built in one pass, a digit equal in every key is skipped
+static void SortRenderKeys(unsigned long long *keys, unsigned int *values, unsigned long long *tempKeys, unsigned int *tempValues, int count)
+{
+    if (count < 2) return;
+
+    int histograms[8][256] = { 0 };
+
+    for (int i = 0; i < count; i++)
+    {
+        for (int d = 0; d < 8; d++) histograms[d][(keys[i] >> (d*8)) & 0xff]++;
+    }
+
+    unsigned long long *srcKeys = keys;
+    unsigned int *srcValues = values;
+    unsigned long long *dstKeys = tempKeys;
+    unsigned int *dstValues = tempValues;
+
+    for (int d = 0; d < 8; d++)
+    {
+        int *histogram = histograms[d];
+        int shift = d*8;
+
+        if (histogram[(srcKeys[0] >> shift) & 0xff] == count) continue;
+
+        int offset = 0;
+        for (int b = 0; b < 256; b++)
+        {
+            int bucketCount = histogram[b];
+            histogram[b] = offset;
+            offset += bucketCount;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            int position = histogram[(srcKeys[i] >> shift) & 0xff]++;
+            dstKeys[position] = srcKeys[i];
+            dstValues[position] = srcValues[i];
+        }
+
+        unsigned long long *swapKeys = srcKeys;
+        srcKeys = dstKeys;
+        dstKeys = swapKeys;
+        unsigned int *swapValues = srcValues;
+        srcValues = dstValues;
+        dstValues = swapValues;
+    }
+
+    if (srcKeys != keys)
+    {
+        memcpy(keys, srcKeys, count*sizeof(unsigned long long));
+        memcpy(values, srcValues, count*sizeof(unsigned int));
+    }
+}
+
+#endif // RQUEUE_IMPLEMENTATION
@@ -0,0 +1,1981 @@
+/**********************************************************************************************
+*
+*   raylib.scene - Flattened binary scene files
+*
+*   LoadModel() parses the glTF JSON, resolves accessors into separate raylib Mesh arrays
+*   and uploads every attribute of every mesh on its own. A scene file is the result of
+*   that work, done once: node transforms are baked into the vertices, all meshes share
+*   one interleaved vertex stream and one 16 bit index stream, and materials and texture
+*   slots are stored as plain tables.
+*
+*   At runtime the file is memory mapped and both streams are handed to GL straight from
+*   the mapping (one vertex buffer, one index buffer), every mesh only gets a VAO pointing
+*   at its range. Textures still go through rtexload.h, decoded or mapped on a JobPool.
+*
+*   Vertex layout (48 bytes): position (3 floats), normal (3 floats), texcoord (2 floats),
+*   tangent (4 floats), bound to raylib default attribute locations.
+*
+*   Quantized vertex layout (20 bytes, default, see SetSceneQuantization()): position as 4 16 bit
+*   unsigned normalized values relative to the batch bounds (w keeps the bitangent sign), normal
+*   and tangent octahedral encoded in 2 16 bit signed normalized values each, texcoord as 2 half
+*   floats. Shaders decode them: the position with the vec3[2] uniform at the location slot
+*   SHADER_LOC_POSITION_DEQUANT (offset and scale, set per batch before drawing), normal and
+*   tangent with the octahedral decode.
+*
+*   Static batching: the converter sorts meshes by material and packs consecutive meshes
+*   of one material into batches of up to 65536 vertices, with indices relative to the
+*   batch. DrawScene() issues one draw per batch and only rebinds shader and textures when
+*   the material changes; meshes can still be drawn on their own through the batch VAO.
+*
+*   Culling: LoadScene() builds a BVH (rcull.h) over the world space mesh bounds. DrawScene()
+*   and DrawSceneMeshes() cull it against the current view frustum first; visible meshes of a
+*   batch that are next to each other in the index stream are still drawn with one call.
+*
+*   Triangle order: the converter reorders the triangles of every mesh for the post-transform
+*   vertex cache and for less overdraw, then its vertices for fetch locality (rmeshopt.h), and
+*   logs ACMR/ATVR of every mesh before and after.
+*
+*   LODs: the converter simplifies every mesh (rsimplify.h) to 1/2, 1/4 and 1/8 of its indices,
+*   in parallel across meshes. LOD index lists reuse the mesh vertices and are appended to the
+*   index stream. Culling picks a LOD per visible mesh from its projected size on screen, one
+*   level per halving below SCENE_LOD_PIXELS, with hysteresis so meshes near a threshold do not
+*   switch back and forth. Meshes drawn at a reduced LOD are drawn on their own.
+*
+*   Occlusion: LoadScene() keeps the positions of the largest opaque meshes, at the coarsest LOD
+*   within SCENE_OCCLUDER_LOD_ERROR, on the CPU as occluders (scene.occluderVertices/Indices). With an
+*   occlusion buffer set (SetSceneOcclusion()), culling tests the meshes left by the frustum against
+*   the occluders rasterized in it this frame (rocclude.h).
+*
+*   Alpha testing: glTF MASK materials keep their alpha cutoff in material.params[SCENE_PARAM_ALPHA_CUTOFF]
+*   (0 for opaque and blended materials), it is uploaded to the SHADER_LOC_ALPHA_CUTOFF slot with
+*   the other material uniforms.
+*
+*   Texture streaming: with a texture stream set (SetSceneTextureStream()), LoadScene() hands the
+*   textures to it instead of uploading them in full. Culling then writes the usage feedback of
+*   every material to scene.materialUsage: screen pixels per UV unit at the closest point of its
+*   visible meshes, from the UV density the converter stores per mesh. UpdateTextureStream()
+*   consumes it once per frame.
+*
+*   CPU copy: LoadSceneData() reads the same file without GL, batches become raylib meshes with
+*   float attributes (CPU arrays only) and material textures are decoded from their source images
+*   on a JobPool, for CPU rendering (rsoft.h).
+*
+*   CONFIGURATION:
+*
+*   #define RSCENE_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+*   DEPENDENCIES:
+*       rjobs.h     - JobPool used to decode textures
+*       rtexload.h  - Texture requests and batch loading
+*       rtexstream.h - Streamed textures
+*       rcull.h     - Mesh bounds BVH and frustum culling
+*       rocclude.h  - Software occlusion culling
+*       rsimplify.h - Mesh simplification, used by the converter
+*       rmeshopt.h  - Triangle and vertex order optimization, used by the converter
+*       cgltf       - Compiled into raylib, used by the converter
+*
+**********************************************************************************************/
+
+#ifndef RSCENE_H
+#define RSCENE_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define SCENE_FILE_EXT          ".rscn"         // Scene file extension
+#define SCENE_VERSION           8               // Increase when the file layout changes
+#define SCENE_VERTEX_STRIDE     48              // Interleaved vertex size in bytes
+#define SCENE_QUANTIZED_STRIDE  20              // Quantized vertex size in bytes
+
+#define SHADER_LOC_POSITION_DEQUANT 30          // Shader location slot (unused by raylib) of the position dequantization uniform
+#define SHADER_LOC_ALPHA_CUTOFF 31              // Shader location slot (unused by raylib) of the alpha test cutoff uniform
+#define SCENE_PARAM_ALPHA_CUTOFF 0              // Material params index of the alpha test cutoff, 0 without alpha test
+#define SCENE_MAX_BATCH_VERTICES 65536          // 16 bit indices address one batch
+
+#define SCENE_MAX_LODS          4               // Full mesh included
+#define SCENE_LOD_MIN_INDICES   96              // Smaller meshes are not simplified
+#define SCENE_LOD_ERROR         0.01f           // Simplification error of LOD 1 (relative to mesh size), doubles every level
+#define SCENE_LOD_PIXELS        128.0f          // Projected size below which LOD 1 and coarser are used
+#define SCENE_LOD_HYSTERESIS    0.25f           // Fraction of a level a mesh has to move past a threshold to switch
+
+#define SCENE_MAX_OCCLUDERS     16              // Occluder meshes kept per scene, the largest ones
+#define SCENE_OCCLUDER_SIZE     0.1f            // Smallest occluder bounds size relative to the scene size
+#define SCENE_OCCLUDER_LOD_ERROR 0.01f          // Largest simplification error of the occluder LOD, keeps silhouettes close to the mesh
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Index range of a simplified mesh, same vertices as the full mesh
+typedef struct SceneLod {
+    int firstIndex;
+    int indexCount;
+    float error;                // Simplification error relative to the mesh size
+} SceneLod;
+
+// Range of the scene vertex/index buffers drawn with one material
+typedef struct SceneMesh {
+    int batch;                  // Batch holding the mesh, indices are relative to the batch
+    int firstVertex;
+    int vertexCount;
+    int firstIndex;
+    int indexCount;
+    int material;               // Index into scene.materials
+    BoundingBox bounds;         // World space bounds (node transforms baked)
+    int lodCount;
+    SceneLod lods[SCENE_MAX_LODS];  // lods[0] is the full mesh
+    float uvDensity;            // UV units per scene unit, 0 without texture coordinates
+} SceneMesh;
+
+// Consecutive meshes sharing a material, drawn with one call
+typedef struct SceneBatch {
+    unsigned int vaoId;         // Vertex array pointing at the batch range
+    int firstVertex;
+    int vertexCount;
+    int firstIndex;
+    int indexCount;
+    int firstMesh;
+    int meshCount;
+    int material;
+    BoundingBox bounds;
+    float positionDequant[6];   // Offset and scale of quantized positions, the batch bounds
+} SceneBatch;
+
+// Scene loaded from a scene file
+typedef struct Scene {
+    int meshCount;
+    SceneMesh *meshes;
+    int batchCount;
+    SceneBatch *batches;
+    int materialCount;
+    Material *materials;        // materials[0] is the default material, like raylib models
+
+    Bvh bvh;                    // Mesh bounds hierarchy
+    unsigned char *visible;     // Per mesh visibility, written by culling
+    unsigned char *lod;         // Per mesh LOD, written by culling (kept between frames for hysteresis)
+    float *materialUsage;       // Per material screen pixels per UV unit, written by culling (max over draws, texture stream feedback)
+
+    int occluderVertexCount;
+    Vector3 *occluderVertices;  // Occluder mesh positions in scene space
+    int occluderIndexCount;
+    int *occluderIndices;       // Occluder triangles, front faces counter clockwise
+
+    unsigned int vboId;         // Interleaved vertices of all meshes
+    unsigned int eboId;         // Indices of all meshes
+    int vertexCount;
+    int indexCount;
+    int vertexStride;           // SCENE_VERTEX_STRIDE, or SCENE_QUANTIZED_STRIDE for quantized vertices
+} Scene;
+
+// Scene file decoded on the CPU, no GPU resources
+typedef struct SceneData {
+    int meshCount;
+    Mesh *meshes;               // One per batch, float attributes and batch relative indices, CPU arrays only
+    int *meshMaterial;          // Material of every mesh
+    int materialCount;
+    Material *materials;        // Colors, values and params like LoadScene(), no shaders or textures
+    Image *images;              // MAX_MATERIAL_MAPS per material, R8G8B8A8, no data for empty slots (shared by slots of one file)
+} SceneData;
+
+// Draw statistics accumulated since last ResetSceneStats()
+typedef struct SceneStats {
+    int drawCalls;
+    int materialBinds;          // Shader and texture rebinds
+    int triangles;
+    int nodesTested;            // BVH nodes tested against the frustum
+    int meshesTested;           // Meshes whose own bounds were tested
+    int meshesCulled;
+    int meshesOccluded;         // Meshes in the frustum hidden behind the occluders
+    int meshesDrawn;
+    int meshesLod;              // Visible meshes drawn at a reduced LOD
+} SceneStats;
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+bool BuildSceneFile(const char *gltfFileName, const char *sceneFileName, JobPool *pool);   // Flatten glTF into a scene file, LODs are built on pool (no GL context required)
+bool IsSceneFileCurrent(const char *sceneFileName, const char *gltfFileName);   // Check scene file exists, is newer than its source and has the current vertex format
+void SetSceneQuantization(bool enabled);                                        // Quantize vertices of scene files built from now on (default on)
+void SetSceneTextureStream(TextureStream *stream);                              // Stream textures of scenes loaded from now on (NULL uploads them in full)
+Scene LoadScene(const char *sceneFileName, JobPool *pool);                      // Map scene file and upload it, textures are decoded on pool
+void UnloadScene(Scene scene);                                                  // Unload buffers, vertex arrays and material textures
+SceneData LoadSceneData(const char *sceneFileName, JobPool *pool);              // Decode scene file on the CPU, images are decoded on pool (no GL context required)
+void UnloadSceneData(SceneData data);                                           // Unload meshes, materials and images
+
+void DrawScene(Scene scene, Matrix transform);                                  // Draw all scene batches, one call per batch
+void DrawSceneMeshes(Scene scene, Matrix transform);                            // Draw all scene meshes one by one (no batching)
+void DrawSceneMesh(Scene scene, int mesh, Matrix transform);                    // Draw one scene mesh with its material
+void DrawSceneDepth(Scene scene, Matrix transform, Shader shader, Shader alphaShader); // Draw scene depth (shadow maps), alpha tested batches with alphaShader
+void SetSceneCulling(bool enabled);                                             // Enable frustum culling in scene draw functions (default on)
+void SetSceneLod(bool enabled);                                                 // Enable LOD selection in scene draw functions (default on)
+void SetSceneOcclusion(OcclusionBuffer *buffer);                                // Test frustum culled meshes against the occluders rasterized in buffer (NULL disables, default)
+void CullScene(Scene scene, Matrix transform);                                  // Cull scene meshes against the current view frustum, fills scene.visible and scene.lod
+SceneStats GetSceneStats(void);                                                 // Get draw statistics
+void ResetSceneStats(void);                                                     // Reset draw statistics
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RSCENE_H
+
+
+/***********************************************************************************
+*
+*   RSCENE IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RSCENE_IMPLEMENTATION)
+
+#include "raylib.h"
+#include "rlgl.h"
+#include "raymath.h"            // Required for: MatrixMultiply(), MatrixInvert(), MatrixTranspose()
+#include "external/cgltf.h"     // glTF parser compiled into raylib
+
+#if !defined(_WIN32)
+    #include <fcntl.h>          // Required for: open()
+    #include <sys/mman.h>       // Required for: mmap(), munmap()
+    #include <sys/stat.h>       // Required for: fstat()
+    #include <unistd.h>         // Required for: close()
+#endif
+
+#include <stdio.h>              // Required for: FILE, fopen(), fwrite(), fclose()
+#include <string.h>             // Required for: memcpy(), memset()
+#include <stdlib.h>             // Required for: qsort()
+#include <math.h>               // Required for: sqrtf(), sqrt(), log2f(), floorf(), fabsf(), fabs(), lrintf()
+#include <float.h>              // Required for: FLT_MAX
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define SCENE_MAGIC             0x4e435352      // "RSCN"
+#define SCENE_HEADER_SIZE       128             // Header is padded so tables stay aligned
+#define SCENE_ALIGNMENT         64              // Alignment of tables and streams in the file
+
+// GL attribute types rlgl does not name
+#define SCENE_GL_SHORT          0x1402
+#define SCENE_GL_UNSIGNED_SHORT 0x1403
+#define SCENE_GL_HALF_FLOAT     0x140B
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    int meshCount;
+    int batchCount;
+    int materialCount;          // Default material included
+    int textureCount;           // Texture requests
+    int vertexStride;
+    int vertexCount;
+    int indexCount;
+    long long sourceModTime;    // Source glTF modification time
+    long long meshOffset;       // SceneFileMesh table
+    long long batchOffset;      // SceneFileBatch table
+    long long materialOffset;   // SceneFileMaterial table
+    long long textureOffset;    // TextureRequest table
+    long long vertexOffset;     // Interleaved vertex stream, float or quantized (vertexStride)
+    long long indexOffset;      // 16 bit index stream
+} SceneFileHeader;
+
+typedef struct {
+    int batch;
+    int firstVertex;
+    int vertexCount;
+    int firstIndex;
+    int indexCount;             // Indices are relative to the batch first vertex
+    int material;
+    float boundsMin[3];
+    float boundsMax[3];
+    int lodCount;               // LOD 0 is the mesh range itself
+    int lodFirstIndex[SCENE_MAX_LODS];
+    int lodIndexCount[SCENE_MAX_LODS];
+    float lodError[SCENE_MAX_LODS];
+    float uvDensity;            // Square root of UV area over scene space area
+} SceneFileMesh;
+
+typedef struct {
+    int firstVertex;
+    int vertexCount;
+    int firstIndex;
+    int indexCount;
+    int firstMesh;
+    int meshCount;
+    int material;
+    float boundsMin[3];
+    float boundsMax[3];
+} SceneFileBatch;
+
+// Triangle primitive found in the glTF node tree
+typedef struct {
+    const cgltf_node *node;
+    const cgltf_primitive *primitive;
+    const cgltf_accessor *positions;
+    int material;
+    int order;                  // Node tree order, keeps the material sort stable
+} ScenePrimitive;
+
+typedef struct {
+    unsigned char colors[MAX_MATERIAL_MAPS][4];
+    float values[MAX_MATERIAL_MAPS];
+    float alphaCutoff;          // glTF MASK cutoff, 0 for opaque and blended materials
+} SceneFileMaterial;
+
+// Mesh optimization and LOD build input and output, one job range covers some meshes
+typedef struct {
+    SceneFileMesh *meshes;
+    const SceneFileBatch *batches;
+    float *vertices;            // Vertices of every mesh are reordered in their range
+    unsigned short *indices;    // Mesh indices are rewritten in place
+    unsigned int **lodIndices;  // Per mesh, LOD 1.. index lists one after the other (mesh relative)
+    VertexCacheStats *cacheStats;   // Per mesh, before and after optimization
+} SceneMeshBuild;
+
+// CPU decoding input and output of LoadSceneData()
+typedef struct {
+    const TextureRequest *requests;
+    const int *firstRequest;    // First request of the same image file
+    Image *images;              // Per request, only first requests are decoded
+    const SceneFileBatch *batches;
+    const unsigned char *vertexData;
+    const unsigned short *indexData;
+    int vertexStride;
+    Mesh *meshes;               // Per batch
+} SceneDataDecode;
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static SceneStats sceneStats = { 0 };           // Draw statistics since last reset
+static bool sceneCulling = true;                // Cull meshes before drawing
+static bool sceneLod = true;                    // Select mesh LODs before drawing
+static bool sceneQuantization = true;           // Quantize vertices when building scene files
+static TextureStream *sceneTextureStream = NULL; // Stream textures of loaded scenes
+static OcclusionBuffer *sceneOcclusion = NULL;  // Occluders tested by culling
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static void *MapSceneFile(const char *fileName, long long *size);
+static void UnmapSceneFile(void *mapping, long long size);
+static bool ReadSceneHeader(const void *mapping, long long size, SceneFileHeader *header);
+static long long AlignOffset(long long offset);
+static bool WriteSection(FILE *file, long long *position, long long offset, const void *data, long long size);
+static void GetNormalMatrix(const float *world, float *normal);
+static int ComparePrimitives(const void *a, const void *b);
+static void WriteMeshVertices(const ScenePrimitive *primitive, float *vertices, SceneFileMesh *mesh);
+static void BuildMeshRange(int start, int end, void *data);
+static void OptimizeMeshOrder(SceneMeshBuild *build, int index);
+static void BuildMeshLods(SceneMeshBuild *build, int index);
+static float GetMeshUvDensity(const SceneMeshBuild *build, int index);
+static void QuantizeBatchVertices(const float *vertices, unsigned char *quantized, const SceneFileBatch *batch);
+static void EncodeOctahedral(const float *vector, short *encoded);
+static void DecodeOctahedral(const short *encoded, float *vector);
+static unsigned short FloatToHalf(float value);
+static float HalfToFloat(unsigned short value);
+static void DecodeSceneImages(int start, int end, void *data);
+static void DecodeSceneBatches(int start, int end, void *data);
+static int LoadSceneOccluders(Scene *scene, const unsigned char *vertexData, const unsigned short *indexData);
+static int GetMeshLod(const SceneMesh *mesh, int current, Matrix matModelView, float scale, float pixelScale);
+static float GetMeshTextureUsage(const SceneMesh *mesh, Matrix matModelView, float scale, float pixelScale);
+static void BeginSceneMaterial(const Material *material, Matrix transform);
+static void EndSceneMaterial(const Material *material);
+static void DrawSceneRange(const SceneBatch *batch, const int *locs, int firstIndex, int indexCount);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Flatten glTF into a scene file: bake node transforms, interleave vertices, batch meshes by material
+// NOTE: Material order matches raylib LoadModel(), materials[0] is the default material.
+// Meshes are optimized and simplified on pool, a NULL pool does it on the calling thread
+bool BuildSceneFile(const char *gltfFileName, const char *sceneFileName, JobPool *pool)
+{
+    cgltf_options options = { 0 };
+    cgltf_data *data = NULL;
+
+    if ((cgltf_parse_file(&options, gltfFileName, &data) != cgltf_result_success) ||
+        (cgltf_load_buffers(&options, data, gltfFileName) != cgltf_result_success))
+    {
+        TraceLog(LOG_WARNING, "SCENE: [%s] Failed to load glTF", gltfFileName);
+        if (data != NULL) cgltf_free(data);
+        return false;
+    }
+
+    // Collect triangle primitives of mesh nodes, every primitive becomes a scene mesh
+    int primitiveCount = 0;
+    for (unsigned int n = 0; n < data->nodes_count; n++) if (data->nodes[n].mesh != NULL) primitiveCount += (int)data->nodes[n].mesh->primitives_count;
+
+    ScenePrimitive *primitives = (ScenePrimitive *)RL_CALLOC(primitiveCount + 1, sizeof(ScenePrimitive));
+    int meshCount = 0;
+    long long vertexCount = 0;
+    long long indexCount = 0;
+
+    for (unsigned int n = 0; n < data->nodes_count; n++)
+    {
+        const cgltf_mesh *mesh = data->nodes[n].mesh;
+        if (mesh == NULL) continue;
+
+        for (unsigned int p = 0; p < mesh->primitives_count; p++)
+        {
+            const cgltf_primitive *primitive = &mesh->primitives[p];
+            const cgltf_accessor *positions = NULL;
+
+            for (unsigned int a = 0; a < primitive->attributes_count; a++)
+            {
+                if (primitive->attributes[a].type == cgltf_attribute_type_position) positions = primitive->attributes[a].data;
+            }
+
+            if ((primitive->type != cgltf_primitive_type_triangles) || (positions == NULL)) continue;
+
+            if (positions->count > SCENE_MAX_BATCH_VERTICES)
+            {
+                TraceLog(LOG_WARNING, "SCENE: [%s] Mesh %s has more than %i vertices, skipped", gltfFileName, (mesh->name != NULL)? mesh->name : "", SCENE_MAX_BATCH_VERTICES);
+                continue;
+            }
+
+            primitives[meshCount] = (ScenePrimitive){ &data->nodes[n], primitive, positions, (primitive->material != NULL)? (int)(primitive->material - data->materials) + 1 : 0, meshCount };
+            meshCount++;
+            vertexCount += positions->count;
+            indexCount += (primitive->indices != NULL)? primitive->indices->count : positions->count;
+        }
+    }
+
+    // Meshes sharing a material end up next to each other
+    qsort(primitives, meshCount, sizeof(ScenePrimitive), ComparePrimitives);
+
+    int materialCount = (int)data->materials_count + 1;
+
+    SceneFileMesh *meshes = (SceneFileMesh *)RL_CALLOC(meshCount + 1, sizeof(SceneFileMesh));
+    SceneFileBatch *batches = (SceneFileBatch *)RL_CALLOC(meshCount + 1, sizeof(SceneFileBatch));
+    SceneFileMaterial *materials = (SceneFileMaterial *)RL_CALLOC(materialCount, sizeof(SceneFileMaterial));
+    float *vertices = (float *)RL_CALLOC(vertexCount + 1, SCENE_VERTEX_STRIDE);
+    unsigned short *indices = (unsigned short *)RL_CALLOC(indexCount + 1, sizeof(unsigned short));
+    TextureRequest *textures = (TextureRequest *)RL_CALLOC(TEXLOAD_MAX_REQUESTS, sizeof(TextureRequest));
+    int textureCount = GetGltfTextureRequests(gltfFileName, textures, TEXLOAD_MAX_REQUESTS);
+
+    // Materials start from raylib LoadMaterialDefault() values, then take the glTF factors
+    for (int i = 0; i < materialCount; i++)
+    {
+        memset(materials[i].colors[MATERIAL_MAP_ALBEDO], 255, 4);
+        memset(materials[i].colors[MATERIAL_MAP_METALNESS], 255, 4);
+
+        if (i == 0) continue;
+
+        const cgltf_material *material = &data->materials[i - 1];
+
+        if (material->has_pbr_metallic_roughness)
+        {
+            for (int c = 0; c < 4; c++) materials[i].colors[MATERIAL_MAP_ALBEDO][c] = (unsigned char)(material->pbr_metallic_roughness.base_color_factor[c]*255.0f);
+            materials[i].values[MATERIAL_MAP_METALNESS] = material->pbr_metallic_roughness.metallic_factor;
+            materials[i].values[MATERIAL_MAP_ROUGHNESS] = material->pbr_metallic_roughness.roughness_factor;
+        }
+
+        for (int c = 0; c < 3; c++) materials[i].colors[MATERIAL_MAP_EMISSION][c] = (unsigned char)(material->emissive_factor[c]*255.0f);
+        materials[i].colors[MATERIAL_MAP_EMISSION][3] = 255;
+
+        // Alpha tested materials are drawn with the opaque ones, the base color alpha is only tested
+        if (material->alpha_mode == cgltf_alpha_mode_mask) materials[i].alphaCutoff = (material->alpha_cutoff > 0.0f)? material->alpha_cutoff : 1.0f/255.0f;
+    }
+
+    // Write meshes in material order, a new batch starts when the material changes
+    // or when the batch would not be addressable with 16 bit indices anymore
+    int batchCount = 0;
+    long long vertexBase = 0;
+    long long indexBase = 0;
+
+    for (int i = 0; i < meshCount; i++)
+    {
+        const ScenePrimitive *primitive = &primitives[i];
+        SceneFileMesh *mesh = &meshes[i];
+        SceneFileBatch *batch = (batchCount > 0)? &batches[batchCount - 1] : NULL;
+
+        if ((batch == NULL) || (batch->material != primitive->material) ||
+            (batch->vertexCount + (long long)primitive->positions->count > SCENE_MAX_BATCH_VERTICES))
+        {
+            batch = &batches[batchCount++];
+            batch->firstVertex = (int)vertexBase;
+            batch->firstIndex = (int)indexBase;
+            batch->firstMesh = i;
+            batch->material = primitive->material;
+        }
+
+        mesh->batch = batchCount - 1;
+        mesh->firstVertex = (int)vertexBase;
+        mesh->firstIndex = (int)indexBase;
+        mesh->material = primitive->material;
+        WriteMeshVertices(primitive, vertices + vertexBase*(SCENE_VERTEX_STRIDE/sizeof(float)), mesh);
+
+        // Indices are rebased on the batch first vertex
+        const cgltf_accessor *source = primitive->primitive->indices;
+        int rebase = mesh->firstVertex - batch->firstVertex;
+
+        for (int j = 0; j < mesh->indexCount; j++)
+        {
+            indices[indexBase + j] = (unsigned short)(rebase + (int)((source != NULL)? cgltf_accessor_read_index(source, j) : (cgltf_size)j));
+        }
+
+        for (int c = 0; c < 3; c++)
+        {
+            batch->boundsMin[c] = (batch->meshCount == 0)? mesh->boundsMin[c] : fminf(batch->boundsMin[c], mesh->boundsMin[c]);
+            batch->boundsMax[c] = (batch->meshCount == 0)? mesh->boundsMax[c] : fmaxf(batch->boundsMax[c], mesh->boundsMax[c]);
+        }
+
+        batch->vertexCount += mesh->vertexCount;
+        batch->indexCount += mesh->indexCount;
+        batch->meshCount++;
+
+        vertexBase += mesh->vertexCount;
+        indexBase += mesh->indexCount;
+    }
+
+    // Optimize triangle and vertex order and simplify meshes in parallel, then append LOD indices to the index stream
+    SceneMeshBuild meshBuild = { meshes, batches, vertices, indices, (unsigned int **)RL_CALLOC(meshCount + 1, sizeof(unsigned int *)),
+        (VertexCacheStats *)RL_CALLOC(2*meshCount + 2, sizeof(VertexCacheStats)) };
+
+    if (pool == NULL) BuildMeshRange(0, meshCount, &meshBuild);
+    else ParallelFor(pool, meshCount, 1, BuildMeshRange, &meshBuild);
+
+    // Vertex cache report, totals are weighted by triangles and vertices
+    double cacheTotals[4] = { 0 };
+
+    for (int i = 0; i < meshCount; i++)
+    {
+        VertexCacheStats before = meshBuild.cacheStats[2*i];
+        VertexCacheStats after = meshBuild.cacheStats[2*i + 1];
+
+        TraceLog(LOG_INFO, "SCENE: Mesh %2i: %6i triangles | ACMR %.3f -> %.3f | ATVR %.3f -> %.3f", i, meshes[i].indexCount/3, before.acmr, after.acmr, before.atvr, after.atvr);
+
+        cacheTotals[0] += before.acmr*meshes[i].indexCount/3;
+        cacheTotals[1] += after.acmr*meshes[i].indexCount/3;
+        cacheTotals[2] += before.atvr*meshes[i].vertexCount;
+        cacheTotals[3] += after.atvr*meshes[i].vertexCount;
+    }
+
+    if (meshCount > 0) TraceLog(LOG_INFO, "SCENE: [%s] Vertex cache (FIFO %i): ACMR %.3f -> %.3f | ATVR %.3f -> %.3f", gltfFileName, MESHOPT_FIFO_SIZE,
+        cacheTotals[0]/(indexCount/3), cacheTotals[1]/(indexCount/3), cacheTotals[2]/vertexCount, cacheTotals[3]/vertexCount);
+
+    RL_FREE(meshBuild.cacheStats);
+
+    long long lodIndexCount = 0;
+    for (int i = 0; i < meshCount; i++) for (int l = 1; l < meshes[i].lodCount; l++) lodIndexCount += meshes[i].lodIndexCount[l];
+
+    indices = (unsigned short *)RL_REALLOC(indices, (indexCount + lodIndexCount + 1)*sizeof(unsigned short));
+    long long levelIndices[SCENE_MAX_LODS] = { 0 };
+
+    for (int i = 0; i < meshCount; i++)
+    {
+        SceneFileMesh *mesh = &meshes[i];
+        const unsigned int *source = meshBuild.lodIndices[i];
+        int rebase = mesh->firstVertex - batches[mesh->batch].firstVertex;
+
+        for (int l = 0; l < SCENE_MAX_LODS; l++) levelIndices[l] += mesh->lodIndexCount[(l < mesh->lodCount)? l : mesh->lodCount - 1];
+
+        for (int l = 1; l < mesh->lodCount; l++)
+        {
+            mesh->lodFirstIndex[l] = (int)indexBase;
+            for (int j = 0; j < mesh->lodIndexCount[l]; j++) indices[indexBase + j] = (unsigned short)(rebase + (int)source[j]);
+
+            source += mesh->lodIndexCount[l];
+            indexBase += mesh->lodIndexCount[l];
+        }
+
+        RL_FREE(meshBuild.lodIndices[i]);
+    }
+
+    RL_FREE(meshBuild.lodIndices);
+    indexCount += lodIndexCount;
+
+    TraceLog(LOG_INFO, "SCENE: [%s] Mesh LODs built (triangles per level: %lli | %lli | %lli | %lli)", gltfFileName, levelIndices[0]/3, levelIndices[1]/3, levelIndices[2]/3, levelIndices[3]/3);
+
+    // Quantize vertices to the bounds of their batch, every draw stays within one batch
+    int vertexStride = sceneQuantization? SCENE_QUANTIZED_STRIDE : SCENE_VERTEX_STRIDE;
+    unsigned char *stream = (unsigned char *)vertices;
+
+    if (sceneQuantization)
+    {
+        stream = (unsigned char *)RL_CALLOC(vertexCount + 1, SCENE_QUANTIZED_STRIDE);
+        for (int i = 0; i < batchCount; i++) QuantizeBatchVertices(vertices, stream, &batches[i]);
+    }
+
+    // Layout: header, mesh table, material table, texture table, vertex stream, index stream
+    SceneFileHeader header = { 0 };
+    header.magic = SCENE_MAGIC;
+    header.version = SCENE_VERSION;
+    header.meshCount = meshCount;
+    header.batchCount = batchCount;
+    header.materialCount = materialCount;
+    header.textureCount = textureCount;
+    header.vertexStride = vertexStride;
+    header.vertexCount = (int)vertexCount;
+    header.indexCount = (int)indexCount;
+    header.sourceModTime = GetFileModTime(gltfFileName);
+    header.meshOffset = SCENE_HEADER_SIZE;
+    header.batchOffset = AlignOffset(header.meshOffset + (long long)meshCount*sizeof(SceneFileMesh));
+    header.materialOffset = AlignOffset(header.batchOffset + (long long)batchCount*sizeof(SceneFileBatch));
+    header.textureOffset = AlignOffset(header.materialOffset + (long long)materialCount*sizeof(SceneFileMaterial));
+    header.vertexOffset = AlignOffset(header.textureOffset + (long long)textureCount*sizeof(TextureRequest));
+    header.indexOffset = AlignOffset(header.vertexOffset + vertexCount*vertexStride);
+
+    unsigned char headerData[SCENE_HEADER_SIZE] = { 0 };
+    memcpy(headerData, &header, sizeof(header));
+
+    bool success = false;
+    FILE *file = fopen(sceneFileName, "wb");
+
+    if (file != NULL)
+    {
+        long long position = 0;
+
+        success = WriteSection(file, &position, 0, headerData, SCENE_HEADER_SIZE) &&
+                  WriteSection(file, &position, header.meshOffset, meshes, (long long)meshCount*sizeof(SceneFileMesh)) &&
+                  WriteSection(file, &position, header.batchOffset, batches, (long long)batchCount*sizeof(SceneFileBatch)) &&
+                  WriteSection(file, &position, header.materialOffset, materials, (long long)materialCount*sizeof(SceneFileMaterial)) &&
+                  WriteSection(file, &position, header.textureOffset, textures, (long long)textureCount*sizeof(TextureRequest)) &&
+                  WriteSection(file, &position, header.vertexOffset, stream, vertexCount*vertexStride) &&
+                  WriteSection(file, &position, header.indexOffset, indices, indexCount*sizeof(unsigned short));
+        fclose(file);
+
+        if (!success) remove(sceneFileName);
+    }
+
+    if (success) TraceLog(LOG_INFO, "SCENE: [%s] Scene file built (%i meshes | %i batches | %i vertices | %i indices | %i bytes per vertex)", sceneFileName, meshCount, batchCount, (int)vertexCount, (int)indexCount, vertexStride);
+    else TraceLog(LOG_WARNING, "SCENE: [%s] Failed to write scene file", sceneFileName);
+
+    if (stream != (unsigned char *)vertices) RL_FREE(stream);
+    RL_FREE(textures);
+    RL_FREE(indices);
+    RL_FREE(vertices);
+    RL_FREE(materials);
+    RL_FREE(batches);
+    RL_FREE(meshes);
+    RL_FREE(primitives);
+    cgltf_free(data);
+
+    return success;
+}
+
+// Check scene file exists, matches this version and vertex format and was built from the current source
+// NOTE: Only the glTF file time is checked, rebuild manually when only its buffers change
+bool IsSceneFileCurrent(const char *sceneFileName, const char *gltfFileName)
+{
+    long long size = 0;
+    void *mapping = MapSceneFile(sceneFileName, &size);
+    if (mapping == NULL) return false;
+
+    SceneFileHeader header = { 0 };
+    bool current = ReadSceneHeader(mapping, size, &header) && (header.sourceModTime == GetFileModTime(gltfFileName)) &&
+                   (header.vertexStride == (sceneQuantization? SCENE_QUANTIZED_STRIDE : SCENE_VERTEX_STRIDE));
+
+    UnmapSceneFile(mapping, size);
+
+    return current;
+}
+
+// Quantize vertices of scene files built from now on, disabled keeps float vertices
+void SetSceneQuantization(bool enabled)
+{
+    sceneQuantization = enabled;
+}
+
+// Stream textures of scenes loaded from now on, NULL uploads them in full
+// NOTE: The stream owns streamed textures, unload it before the scene
+void SetSceneTextureStream(TextureStream *stream)
+{
+    sceneTextureStream = stream;
+}
+
+// Map scene file and upload it, textures are decoded on pool
+// NOTE: Vertex and index streams are uploaded straight from the mapping, no copies involved
+Scene LoadScene(const char *sceneFileName, JobPool *pool)
+{
+    Scene scene = { 0 };
+    long long size = 0;
+    void *mapping = MapSceneFile(sceneFileName, &size);
+    SceneFileHeader header = { 0 };
+
+    if ((mapping == NULL) || !ReadSceneHeader(mapping, size, &header))
+    {
+        TraceLog(LOG_WARNING, "SCENE: [%s] Failed to load scene file", sceneFileName);
+        if (mapping != NULL) UnmapSceneFile(mapping, size);
+        return scene;
+    }
+
+    const unsigned char *base = (const unsigned char *)mapping;
+
+    // Start texture decoding first, it overlaps the geometry upload
+    TextureBatch *batch = LoadTextureBatchAsync(pool, (const TextureRequest *)(base + header.textureOffset), header.textureCount);
+
+    // Materials
+    const SceneFileMaterial *materials = (const SceneFileMaterial *)(base + header.materialOffset);
+    scene.materialCount = header.materialCount;
+    scene.materials = (Material *)RL_CALLOC(scene.materialCount, sizeof(Material));
+
+    for (int i = 0; i < scene.materialCount; i++)
+    {
+        scene.materials[i] = LoadMaterialDefault();
+
+        for (int m = 0; m < MAX_MATERIAL_MAPS; m++)
+        {
+            const unsigned char *color = materials[i].colors[m];
+            scene.materials[i].maps[m].color = (Color){ color[0], color[1], color[2], color[3] };
+            scene.materials[i].maps[m].value = materials[i].values[m];
+        }
+
+        scene.materials[i].params[SCENE_PARAM_ALPHA_CUTOFF] = materials[i].alphaCutoff;
+    }
+
+    // Geometry: one vertex buffer and one index buffer for the whole scene
+    rlDisableVertexArray();
+    scene.vertexCount = header.vertexCount;
+    scene.indexCount = header.indexCount;
+    scene.vertexStride = header.vertexStride;
+    scene.vboId = rlLoadVertexBuffer(base + header.vertexOffset, header.vertexCount*scene.vertexStride, false);
+    scene.eboId = rlLoadVertexBufferElement(base + header.indexOffset, header.indexCount*(int)sizeof(unsigned short), false);
+
+    // Batches: one VAO each, attributes point at the batch range so indices stay batch relative
+    const SceneFileBatch *batches = (const SceneFileBatch *)(base + header.batchOffset);
+    scene.batchCount = header.batchCount;
+    scene.batches = (SceneBatch *)RL_CALLOC(scene.batchCount, sizeof(SceneBatch));
+
+    for (int i = 0; i < scene.batchCount; i++)
+    {
+        SceneBatch *batch = &scene.batches[i];
+        batch->firstVertex = batches[i].firstVertex;
+        batch->vertexCount = batches[i].vertexCount;
+        batch->firstIndex = batches[i].firstIndex;
+        batch->indexCount = batches[i].indexCount;
+        batch->firstMesh = batches[i].firstMesh;
+        batch->meshCount = batches[i].meshCount;
+        batch->material = ((batches[i].material >= 0) && (batches[i].material < scene.materialCount))? batches[i].material : 0;
+        batch->bounds = (BoundingBox){
+            (Vector3){ batches[i].boundsMin[0], batches[i].boundsMin[1], batches[i].boundsMin[2] },
+            (Vector3){ batches[i].boundsMax[0], batches[i].boundsMax[1], batches[i].boundsMax[2] }
+        };
+
+        // Float vertices need no dequantization, offset 0 and scale 1 leave positions as they are
+        for (int c = 0; c < 3; c++)
+        {
+            batch->positionDequant[c] = (scene.vertexStride == SCENE_QUANTIZED_STRIDE)? batches[i].boundsMin[c] : 0.0f;
+            batch->positionDequant[3 + c] = (scene.vertexStride == SCENE_QUANTIZED_STRIDE)? batches[i].boundsMax[c] - batches[i].boundsMin[c] : 1.0f;
+        }
+
+        int stride = scene.vertexStride;
+        int offset = batch->firstVertex*stride;
+
+        batch->vaoId = rlLoadVertexArray();
+        rlEnableVertexArray(batch->vaoId);
+        rlEnableVertexBuffer(scene.vboId);
+
+        if (stride == SCENE_QUANTIZED_STRIDE)
+        {
+            rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 4, SCENE_GL_UNSIGNED_SHORT, true, stride, offset);
+            rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, 2, SCENE_GL_SHORT, true, stride, offset + 8);
+            rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT, 2, SCENE_GL_SHORT, true, stride, offset + 12);
+            rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD, 2, SCENE_GL_HALF_FLOAT, false, stride, offset + 16);
+        }
+        else
+        {
+            rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 3, RL_FLOAT, false, stride, offset);
+            rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL, 3, RL_FLOAT, false, stride, offset + 12);
+            rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD, 2, RL_FLOAT, false, stride, offset + 24);
+            rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT, 4, RL_FLOAT, false, stride, offset + 32);
+        }
+
+        rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION);
+        rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_NORMAL);
+        rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD);
+        rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TANGENT);
+        rlEnableVertexBufferElement(scene.eboId);
+        rlDisableVertexArray();
+    }
+
+    const SceneFileMesh *meshes = (const SceneFileMesh *)(base + header.meshOffset);
+    scene.meshCount = header.meshCount;
+    scene.meshes = (SceneMesh *)RL_CALLOC(scene.meshCount, sizeof(SceneMesh));
+
+    for (int i = 0; i < scene.meshCount; i++)
+    {
+        SceneMesh *mesh = &scene.meshes[i];
+        mesh->batch = ((meshes[i].batch >= 0) && (meshes[i].batch < scene.batchCount))? meshes[i].batch : 0;
+        mesh->firstVertex = meshes[i].firstVertex;
+        mesh->vertexCount = meshes[i].vertexCount;
+        mesh->firstIndex = meshes[i].firstIndex;
+        mesh->indexCount = meshes[i].indexCount;
+        mesh->material = scene.batches[mesh->batch].material;
+        mesh->bounds = (BoundingBox){
+            (Vector3){ meshes[i].boundsMin[0], meshes[i].boundsMin[1], meshes[i].boundsMin[2] },
+            (Vector3){ meshes[i].boundsMax[0], meshes[i].boundsMax[1], meshes[i].boundsMax[2] }
+        };
+
+        mesh->lodCount = ((meshes[i].lodCount >= 1) && (meshes[i].lodCount <= SCENE_MAX_LODS))? meshes[i].lodCount : 1;
+        mesh->lods[0] = (SceneLod){ mesh->firstIndex, mesh->indexCount, 0.0f };
+        for (int l = 1; l < mesh->lodCount; l++) mesh->lods[l] = (SceneLod){ meshes[i].lodFirstIndex[l], meshes[i].lodIndexCount[l], meshes[i].lodError[l] };
+        mesh->uvDensity = meshes[i].uvDensity;
+    }
+
+    int occluders = LoadSceneOccluders(&scene, base + header.vertexOffset, (const unsigned short *)(base + header.indexOffset));
+
+    UnmapSceneFile(mapping, size);
+
+    // Culling hierarchy over world space mesh bounds
+    BoundingBox *bounds = (BoundingBox *)RL_MALLOC((scene.meshCount + 1)*sizeof(BoundingBox));
+    for (int i = 0; i < scene.meshCount; i++) bounds[i] = scene.meshes[i].bounds;
+
+    scene.bvh = LoadBvh(bounds, scene.meshCount);
+    scene.visible = (unsigned char *)RL_CALLOC(scene.meshCount + 1, 1);
+    scene.lod = (unsigned char *)RL_CALLOC(scene.meshCount + 1, 1);
+    scene.materialUsage = (float *)RL_CALLOC(scene.materialCount + 1, sizeof(float));
+    RL_FREE(bounds);
+
+    int uploaded = UploadTextureBatchStreamed(batch, scene.materials, scene.materialCount, sceneTextureStream);
+
+    TraceLog(LOG_INFO, "SCENE: [%s] Scene loaded (%i meshes | %i batches | %i materials | %i textures)", sceneFileName, scene.meshCount, scene.batchCount, scene.materialCount, uploaded);
+    TraceLog(LOG_INFO, "SCENE: [%s] Vertices: %i bytes each, %.2f MB (%s)", sceneFileName, scene.vertexStride, scene.vertexCount*(double)scene.vertexStride/(1024.0*1024.0), (scene.vertexStride == SCENE_QUANTIZED_STRIDE)? "quantized" : "float");
+    TraceLog(LOG_INFO, "SCENE: [%s] Occluders: %i meshes, %i triangles", sceneFileName, occluders, scene.occluderIndexCount/3);
+
+    return scene;
+}
+
+// Unload buffers, vertex arrays and material textures
+// NOTE: Material shaders are not unloaded, they are usually shared and owned by the caller.
+// Streamed textures belong to the texture stream, UnloadTextureStream() clears their slots
+void UnloadScene(Scene scene)
+{
+    for (int i = 0; i < scene.batchCount; i++) rlUnloadVertexArray(scene.batches[i].vaoId);
+
+    rlUnloadVertexBuffer(scene.vboId);
+    rlUnloadVertexBuffer(scene.eboId);
+
+    UnloadMaterialTextures(scene.materials, scene.materialCount);
+    for (int i = 0; i < scene.materialCount; i++) RL_FREE(scene.materials[i].maps);
+
+    RL_FREE(scene.materials);
+    RL_FREE(scene.batches);
+    RL_FREE(scene.meshes);
+    RL_FREE(scene.visible);
+    RL_FREE(scene.lod);
+    RL_FREE(scene.materialUsage);
+    RL_FREE(scene.occluderVertices);
+    RL_FREE(scene.occluderIndices);
+    UnloadBvh(scene.bvh);
+}
+
+// Decode scene file on the CPU: batches become meshes with float attributes, material textures
+// are decoded from their source images on pool
+// NOTE: No GL context required. Slots using the same image file share its pixels
+SceneData LoadSceneData(const char *sceneFileName, JobPool *pool)
+{
+    SceneData data = { 0 };
+    long long size = 0;
+    void *mapping = MapSceneFile(sceneFileName, &size);
+    SceneFileHeader header = { 0 };
+
+    if ((mapping == NULL) || !ReadSceneHeader(mapping, size, &header))
+    {
+        TraceLog(LOG_WARNING, "SCENE: [%s] Failed to load scene data", sceneFileName);
+        if (mapping != NULL) UnmapSceneFile(mapping, size);
+        return data;
+    }
+
+    const unsigned char *base = (const unsigned char *)mapping;
+
+    // Materials, same values as LoadScene()
+    const SceneFileMaterial *materials = (const SceneFileMaterial *)(base + header.materialOffset);
+    data.materialCount = header.materialCount;
+    data.materials = (Material *)RL_CALLOC(data.materialCount, sizeof(Material));
+
+    for (int i = 0; i < data.materialCount; i++)
+    {
+        data.materials[i].maps = (MaterialMap *)RL_CALLOC(MAX_MATERIAL_MAPS, sizeof(MaterialMap));
+
+        for (int m = 0; m < MAX_MATERIAL_MAPS; m++)
+        {
+            const unsigned char *color = materials[i].colors[m];
+            data.materials[i].maps[m].color = (Color){ color[0], color[1], color[2], color[3] };
+            data.materials[i].maps[m].value = materials[i].values[m];
+        }
+
+        data.materials[i].params[SCENE_PARAM_ALPHA_CUTOFF] = materials[i].alphaCutoff;
+    }
+
+    // Every image file is decoded once, requests of the same file reuse it
+    const TextureRequest *requests = (const TextureRequest *)(base + header.textureOffset);
+    int *firstRequest = (int *)RL_MALLOC((header.textureCount + 1)*sizeof(int));
+    Image *decoded = (Image *)RL_CALLOC(header.textureCount + 1, sizeof(Image));
+
+    for (int i = 0; i < header.textureCount; i++)
+    {
+        firstRequest[i] = i;
+        for (int j = i - 1; j >= 0; j--)
+        {
+            if (TextIsEqual(requests[i].fileName, requests[j].fileName)) firstRequest[i] = j;
+        }
+    }
+
+    const SceneFileBatch *batches = (const SceneFileBatch *)(base + header.batchOffset);
+    data.meshCount = header.batchCount;
+    data.meshes = (Mesh *)RL_CALLOC(data.meshCount + 1, sizeof(Mesh));
+    data.meshMaterial = (int *)RL_CALLOC(data.meshCount + 1, sizeof(int));
+
+    for (int i = 0; i < data.meshCount; i++)
+    {
+        data.meshMaterial[i] = ((batches[i].material >= 0) && (batches[i].material < data.materialCount))? batches[i].material : 0;
+
+        // Ranges outside the streams leave the mesh empty
+        bool valid = (batches[i].firstVertex >= 0) && (batches[i].vertexCount >= 0) && (batches[i].firstVertex + batches[i].vertexCount <= header.vertexCount) &&
+                     (batches[i].firstIndex >= 0) && (batches[i].indexCount >= 0) && (batches[i].firstIndex + batches[i].indexCount <= header.indexCount);
+        data.meshes[i].vertexCount = valid? batches[i].vertexCount : 0;
+        data.meshes[i].triangleCount = valid? batches[i].indexCount/3 : 0;
+    }
+
+    SceneDataDecode decode = {
+        requests, firstRequest, decoded, batches,
+        base + header.vertexOffset, (const unsigned short *)(base + header.indexOffset), header.vertexStride, data.meshes
+    };
+
+    ParallelFor(pool, header.textureCount, 1, DecodeSceneImages, &decode);
+    ParallelFor(pool, data.meshCount, 1, DecodeSceneBatches, &decode);
+
+    data.images = (Image *)RL_CALLOC(data.materialCount*MAX_MATERIAL_MAPS + 1, sizeof(Image));
+    int imageCount = 0;
+
+    for (int i = 0; i < header.textureCount; i++)
+    {
+        const TextureRequest *request = &requests[i];
+        if ((request->material < 0) || (request->material >= data.materialCount) || (request->map < 0) || (request->map >= MAX_MATERIAL_MAPS)) continue;
+
+        if ((firstRequest[i] == i) && (decoded[i].data != NULL)) imageCount++;
+        data.images[request->material*MAX_MATERIAL_MAPS + request->map] = decoded[firstRequest[i]];
+    }
+
+    // Images no slot refers to
+    for (int i = 0; i < header.textureCount; i++)
+    {
+        bool used = false;
+        for (int s = 0; (s < data.materialCount*MAX_MATERIAL_MAPS) && !used; s++) used = (decoded[i].data != NULL) && (data.images[s].data == decoded[i].data);
+        if (!used) UnloadImage(decoded[i]);
+    }
+
+    RL_FREE(firstRequest);
+    RL_FREE(decoded);
+    UnmapSceneFile(mapping, size);
+
+    TraceLog(LOG_INFO, "SCENE: [%s] Scene data decoded (%i meshes | %i materials | %i images)", sceneFileName, data.meshCount, data.materialCount, imageCount);
+
+    return data;
+}
+
+// Unload meshes, materials and images
+// NOTE: Mesh arrays are freed directly, meshes decoded by LoadSceneData() were never uploaded
+void UnloadSceneData(SceneData data)
+{
+    for (int i = 0; i < data.meshCount; i++)
+    {
+        RL_FREE(data.meshes[i].vertices);
+        RL_FREE(data.meshes[i].normals);
+        RL_FREE(data.meshes[i].texcoords);
+        RL_FREE(data.meshes[i].tangents);
+        RL_FREE(data.meshes[i].indices);
+    }
+
+    // Slots of one image file share its pixels, free them once
+    int slotCount = data.materialCount*MAX_MATERIAL_MAPS;
+    for (int s = 0; s < slotCount; s++)
+    {
+        bool shared = false;
+        for (int t = 0; (t < s) && !shared; t++) shared = (data.images[t].data == data.images[s].data);
+        if ((data.images[s].data != NULL) && !shared) UnloadImage(data.images[s]);
+    }
+
+    for (int i = 0; i < data.materialCount; i++) RL_FREE(data.materials[i].maps);
+
+    RL_FREE(data.materials);
+    RL_FREE(data.images);
+    RL_FREE(data.meshMaterial);
+    RL_FREE(data.meshes);
+}
+
+// Draw all scene batches, one call per batch
+// NOTE: Batches are sorted by material, shader and textures are only bound when it changes.
+// With culling, every run of visible meshes in a batch is one call, a fully visible batch stays one call.
+// Meshes at a reduced LOD break the run, their indices are elsewhere in the index stream
+void DrawScene(Scene scene, Matrix transform)
+{
+    CullScene(scene, transform);
+
+    const Material *bound = NULL;
+
+    for (int i = 0; i < scene.batchCount; i++)
+    {
+        const SceneBatch *batch = &scene.batches[i];
+        const Material *material = &scene.materials[batch->material];
+
+        for (int m = batch->firstMesh; m < batch->firstMesh + batch->meshCount; m++)
+        {
+            if (!scene.visible[m]) continue;
+
+            // Extend the run while the next meshes are visible at full detail too, they follow in the index stream
+            int last = m;
+            while ((scene.lod[m] == 0) && (last + 1 < batch->firstMesh + batch->meshCount) && scene.visible[last + 1] && (scene.lod[last + 1] == 0)) last++;
+
+            if (material != bound)
+            {
+                if (bound != NULL) EndSceneMaterial(bound);
+                BeginSceneMaterial(material, transform);
+                bound = material;
+            }
+
+            const SceneLod *lod = &scene.meshes[m].lods[scene.lod[m]];
+            int firstIndex = lod->firstIndex;
+            DrawSceneRange(batch, material->shader.locs, firstIndex, (last > m)? scene.meshes[last].firstIndex + scene.meshes[last].indexCount - firstIndex : lod->indexCount);
+
+            m = last;
+        }
+    }
+
+    if (bound != NULL) EndSceneMaterial(bound);
+}
+
+// Draw all scene meshes one by one, binding the material for every mesh like DrawModel() does
+void DrawSceneMeshes(Scene scene, Matrix transform)
+{
+    CullScene(scene, transform);
+
+    for (int i = 0; i < scene.meshCount; i++)
+    {
+        if (scene.visible[i]) DrawSceneMesh(scene, i, transform);
+    }
+}
+
+// Enable frustum culling in DrawScene() and DrawSceneMeshes()
+void SetSceneCulling(bool enabled)
+{
+    sceneCulling = enabled;
+}
+
+// Enable LOD selection in DrawScene() and DrawSceneMeshes(), disabled draws every mesh at full detail
+void SetSceneLod(bool enabled)
+{
+    sceneLod = enabled;
+}
+
+// Test frustum culled meshes against the occluders rasterized in buffer
+// NOTE: The buffer has to be rasterized every frame with the camera the scenes are drawn with
+void SetSceneOcclusion(OcclusionBuffer *buffer)
+{
+    sceneOcclusion = buffer;
+}
+
+// Cull scene meshes against the current view frustum and the occluders, fills scene.visible and scene.lod
+// and raises scene.materialUsage to the texture usage of the visible meshes
+// NOTE: Mesh bounds are in scene space, the frustum is taken from the full model-view-projection.
+// LODs of culled meshes are kept, so hysteresis continues when they come back into view
+void CullScene(Scene scene, Matrix transform)
+{
+    Matrix matModel = MatrixMultiply(transform, rlGetMatrixTransform());
+    Matrix matModelView = MatrixMultiply(matModel, rlGetMatrixModelview());
+    Matrix matProjection = rlGetMatrixProjection();
+
+    if (!sceneCulling)
+    {
+        memset(scene.visible, 1, scene.meshCount);
+        sceneStats.meshesDrawn += scene.meshCount;
+    }
+    else
+    {
+        CullStats stats = CullBvh(scene.bvh, GetFrustumFromMatrix(MatrixMultiply(matModelView, matProjection)), scene.visible);
+
+        // Meshes left by the frustum, hidden behind occluders of any scene
+        int occluded = 0;
+        if (sceneOcclusion != NULL)
+        {
+            for (int i = 0; i < scene.meshCount; i++)
+            {
+                if (scene.visible[i] && IsBoxOccluded(sceneOcclusion, scene.meshes[i].bounds, matModel))
+                {
+                    scene.visible[i] = 0;
+                    occluded++;
+                }
+            }
+        }
+
+        sceneStats.nodesTested += stats.nodesTested;
+        sceneStats.meshesTested += stats.itemsTested;
+        sceneStats.meshesCulled += scene.meshCount - stats.itemsVisible;
+        sceneStats.meshesOccluded += occluded;
+        sceneStats.meshesDrawn += stats.itemsVisible - occluded;
+    }
+
+    // Largest axis scale of the transform, projected sizes in pixels of the screen height
+    float scale = sqrtf(fmaxf(matModel.m0*matModel.m0 + matModel.m1*matModel.m1 + matModel.m2*matModel.m2,
+                        fmaxf(matModel.m4*matModel.m4 + matModel.m5*matModel.m5 + matModel.m6*matModel.m6,
+                              matModel.m8*matModel.m8 + matModel.m9*matModel.m9 + matModel.m10*matModel.m10)));
+    float pixelScale = matProjection.m5*0.5f*GetScreenHeight();
+
+    // Texture streaming feedback, the closest visible mesh of a material decides its usage
+    if (scene.materialUsage != NULL)
+    {
+        for (int i = 0; i < scene.meshCount; i++)
+        {
+            if (!scene.visible[i]) continue;
+
+            float usage = GetMeshTextureUsage(&scene.meshes[i], matModelView, scale, pixelScale);
+            if (usage > scene.materialUsage[scene.meshes[i].material]) scene.materialUsage[scene.meshes[i].material] = usage;
+        }
+    }
+
+    if (!sceneLod)
+    {
+        memset(scene.lod, 0, scene.meshCount);
+        return;
+    }
+
+    for (int i = 0; i < scene.meshCount; i++)
+    {
+        if (!scene.visible[i] || (scene.meshes[i].lodCount < 2)) continue;
+
+        scene.lod[i] = (unsigned char)GetMeshLod(&scene.meshes[i], scene.lod[i], matModelView, scale, pixelScale);
+        if (scene.lod[i] > 0) sceneStats.meshesLod++;
+    }
+}
+
+// Draw one scene mesh with its material
+// NOTE: Same shader inputs as raylib DrawMesh(), so shaders work with both
+void DrawSceneMesh(Scene scene, int mesh, Matrix transform)
+{
+    const SceneMesh *sceneMesh = &scene.meshes[mesh];
+    const Material *material = &scene.materials[sceneMesh->material];
+
+    const SceneLod *lod = &sceneMesh->lods[scene.lod[mesh]];
+
+    BeginSceneMaterial(material, transform);
+    DrawSceneRange(&scene.batches[sceneMesh->batch], material->shader.locs, lod->firstIndex, lod->indexCount);
+    EndSceneMaterial(material);
+}
+
+// Draw scene depth, for shadow maps
+// NOTE: Culled against the current view frustum and drawn at full detail, scene.lod is left as culling set it.
+// Shaders need the mvp and, for quantized vertices, position dequantization locations. Batches with an alpha cutoff
+// are drawn with alphaShader: albedo texture at SHADER_LOC_MAP_DIFFUSE, albedo color at SHADER_LOC_COLOR_DIFFUSE and
+// cutoff at SHADER_LOC_ALPHA_CUTOFF, like DrawRenderQueueDepth(). Not counted in draw statistics
+void DrawSceneDepth(Scene scene, Matrix transform, Shader shader, Shader alphaShader)
+{
+    Matrix matModelView = MatrixMultiply(MatrixMultiply(transform, rlGetMatrixTransform()), rlGetMatrixModelview());
+    Matrix matMvp = MatrixMultiply(matModelView, rlGetMatrixProjection());
+
+    if (sceneCulling) CullBvh(scene.bvh, GetFrustumFromMatrix(matMvp), scene.visible);
+    else memset(scene.visible, 1, scene.meshCount);
+
+    const int *locs = NULL;
+    unsigned int albedoId = 0;
+
+    for (int i = 0; i < scene.batchCount; i++)
+    {
+        const SceneBatch *batch = &scene.batches[i];
+        const Material *material = &scene.materials[batch->material];
+        bool alphaTest = (material->params[SCENE_PARAM_ALPHA_CUTOFF] > 0.0f);
+        bool bound = false;
+
+        for (int m = batch->firstMesh; m < batch->firstMesh + batch->meshCount; m++)
+        {
+            if (!scene.visible[m]) continue;
+
+            // Runs of visible meshes are one call, full detail meshes follow each other in the index stream
+            int last = m;
+            while ((last + 1 < batch->firstMesh + batch->meshCount) && scene.visible[last + 1]) last++;
+
+            if (!bound)
+            {
+                const Shader *batchShader = alphaTest? &alphaShader : &shader;
+
+                if (batchShader->locs != locs)
+                {
+                    locs = batchShader->locs;
+                    rlEnableShader(batchShader->id);
+                    if (locs[SHADER_LOC_MATRIX_MVP] != -1) rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_MVP], matMvp);
+
+                    int unit = MATERIAL_MAP_ALBEDO;
+                    if (locs[SHADER_LOC_MAP_DIFFUSE] != -1) rlSetUniform(locs[SHADER_LOC_MAP_DIFFUSE], &unit, SHADER_UNIFORM_INT, 1);
+                }
+
+                if (alphaTest)
+                {
+                    if (locs[SHADER_LOC_COLOR_DIFFUSE] != -1)
+                    {
+                        Color color = material->maps[MATERIAL_MAP_ALBEDO].color;
+                        float values[4] = { color.r/255.0f, color.g/255.0f, color.b/255.0f, color.a/255.0f };
+                        rlSetUniform(locs[SHADER_LOC_COLOR_DIFFUSE], values, SHADER_UNIFORM_VEC4, 1);
+                    }
+
+                    if (locs[SHADER_LOC_ALPHA_CUTOFF] != -1) rlSetUniform(locs[SHADER_LOC_ALPHA_CUTOFF], &material->params[SCENE_PARAM_ALPHA_CUTOFF], SHADER_UNIFORM_FLOAT, 1);
+
+                    unsigned int id = material->maps[MATERIAL_MAP_ALBEDO].texture.id;
+                    if ((id != 0) && (id != albedoId))
+                    {
+                        rlActiveTextureSlot(MATERIAL_MAP_ALBEDO);
+                        rlEnableTexture(id);
+                        albedoId = id;
+                    }
+                }
+
+                rlEnableVertexArray(batch->vaoId);
+                if (locs[SHADER_LOC_POSITION_DEQUANT] != -1) rlSetUniform(locs[SHADER_LOC_POSITION_DEQUANT], batch->positionDequant, SHADER_UNIFORM_VEC3, 2);
+                bound = true;
+            }
+
+            int firstIndex = scene.meshes[m].firstIndex;
+            rlDrawVertexArrayElements(firstIndex, scene.meshes[last].firstIndex + scene.meshes[last].indexCount - firstIndex, 0);
+
+            m = last;
+        }
+
+        if (bound) rlDisableVertexArray();
+    }
+
+    if (albedoId != 0)
+    {
+        rlActiveTextureSlot(MATERIAL_MAP_ALBEDO);
+        rlDisableTexture();
+    }
+
+    rlDisableShader();
+}
+
+// Get draw statistics accumulated since last reset
+SceneStats GetSceneStats(void)
+{
+    return sceneStats;
+}
+
+// Reset draw statistics, usually once per frame
+void ResetSceneStats(void)
+{
+    sceneStats = (SceneStats){ 0 };
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Map whole file read only (read into memory on _WIN32)
+static void *MapSceneFile(const char *fileName, long long *size)
+{
+    void *mapping = NULL;
+    *size = 0;
+
+#if defined(_WIN32)
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL) return NULL;
+
+    fseek(file, 0, SEEK_END);
+    long long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if (fileSize > SCENE_HEADER_SIZE)
+    {
+        mapping = RL_MALLOC((size_t)fileSize);
+        if ((mapping != NULL) && (fread(mapping, 1, (size_t)fileSize, file) == (size_t)fileSize)) *size = fileSize;
+        else
+        {
+            RL_FREE(mapping);
+            mapping = NULL;
+        }
+    }
+    fclose(file);
+#else
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st = { 0 };
+    if ((fstat(fd, &st) == 0) && (st.st_size > SCENE_HEADER_SIZE))
+    {
+        mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) mapping = NULL;
+        else *size = (long long)st.st_size;
+    }
+    close(fd);
+#endif
+
+    return mapping;
+}
+
+// Unmap file mapped with MapSceneFile()
+static void UnmapSceneFile(void *mapping, long long size)
+{
+#if defined(_WIN32)
+    (void)size;
+    RL_FREE(mapping);
+#else
+    munmap(mapping, (size_t)size);
+#endif
+}
+
+// Read and validate header, every table and stream must fit in the file
+static bool ReadSceneHeader(const void *mapping, long long size, SceneFileHeader *header)
+{
+    memcpy(header, mapping, sizeof(SceneFileHeader));
+
+    if ((header->magic != SCENE_MAGIC) || (header->version != SCENE_VERSION)) return false;
+    if ((header->vertexStride != SCENE_VERTEX_STRIDE) && (header->vertexStride != SCENE_QUANTIZED_STRIDE)) return false;
+
+    if ((header->meshCount < 0) || (header->batchCount < 0) || (header->materialCount < 0) || (header->textureCount < 0) || (header->vertexCount < 0) || (header->indexCount < 0)) return false;
+
+    return (header->meshOffset + header->meshCount*(long long)sizeof(SceneFileMesh) <= size) &&
+           (header->batchOffset + header->batchCount*(long long)sizeof(SceneFileBatch) <= size) &&
+           (header->materialOffset + header->materialCount*(long long)sizeof(SceneFileMaterial) <= size) &&
+           (header->textureOffset + header->textureCount*(long long)sizeof(TextureRequest) <= size) &&
+           (header->vertexOffset + header->vertexCount*(long long)header->vertexStride <= size) &&
+           (header->indexOffset + header->indexCount*(long long)sizeof(unsigned short) <= size);
+}
+
+// Round offset up to the section alignment
+static long long AlignOffset(long long offset)
+{
+    return (offset + SCENE_ALIGNMENT - 1)/SCENE_ALIGNMENT*SCENE_ALIGNMENT;
+}
+
+// Write zero padding up to offset, then the section data
+static bool WriteSection(FILE *file, long long *position, long long offset, const void *data, long long size)
+{
+    static const unsigned char padding[SCENE_ALIGNMENT] = { 0 };
+
+    while (*position < offset)
+    {
+        long long count = ((offset - *position) < SCENE_ALIGNMENT)? (offset - *position) : SCENE_ALIGNMENT;
+        if (fwrite(padding, 1, (size_t)count, file) != (size_t)count) return false;
+        *position += count;
+    }
+
+    if ((size > 0) && (fwrite(data, 1, (size_t)size, file) != (size_t)size)) return false;
+    *position += size;
+
+    return true;
+}
+
+// Get inverse transpose of the upper 3x3 of a column major matrix, column major result
+static void GetNormalMatrix(const float *world, float *normal)
+{
+    float a = world[0], b = world[4], c = world[8];
+    float d = world[1], e = world[5], f = world[9];
+    float g = world[2], h = world[6], i = world[10];
+
+    // Cofactor matrix equals the inverse transpose times the determinant, the scale is
+    // removed when normals get normalized
+    float cofactor[9] = {
+        e*i - f*h, -(d*i - f*g), d*h - e*g,
+        -(b*i - c*h), a*i - c*g, -(a*h - b*g),
+        b*f - c*e, -(a*f - c*d), a*e - b*d
+    };
+
+    float det = a*cofactor[0] + b*cofactor[1] + c*cofactor[2];
+    float sign = (det < 0.0f)? -1.0f : 1.0f;
+
+    // Row r of the cofactor matrix is column r of the result (column major)
+    for (int r = 0; r < 3; r++) for (int col = 0; col < 3; col++) normal[col*3 + r] = sign*cofactor[r*3 + col];
+}
+
+// Sort primitives by material, keeping node tree order within a material
+static int ComparePrimitives(const void *a, const void *b)
+{
+    const ScenePrimitive *pa = (const ScenePrimitive *)a;
+    const ScenePrimitive *pb = (const ScenePrimitive *)b;
+
+    if (pa->material != pb->material) return (pa->material < pb->material)? -1 : 1;
+
+    return (pa->order > pb->order) - (pa->order < pb->order);
+}
+
+// Bake node world transform into interleaved vertices, fills mesh counts and bounds
+static void WriteMeshVertices(const ScenePrimitive *primitive, float *vertices, SceneFileMesh *mesh)
+{
+    const cgltf_accessor *positions = primitive->positions;
+    const cgltf_accessor *normals = NULL;
+    const cgltf_accessor *texcoords = NULL;
+    const cgltf_accessor *tangents = NULL;
+
+    for (unsigned int a = 0; a < primitive->primitive->attributes_count; a++)
+    {
+        const cgltf_attribute *attribute = &primitive->primitive->attributes[a];
+
+        if (attribute->type == cgltf_attribute_type_normal) normals = attribute->data;
+        else if ((attribute->type == cgltf_attribute_type_texcoord) && (attribute->index == 0)) texcoords = attribute->data;
+        else if (attribute->type == cgltf_attribute_type_tangent) tangents = attribute->data;
+    }
+
+    float world[16] = { 0 };
+    float normalMatrix[9] = { 0 };
+    cgltf_node_transform_world(primitive->node, world);
+    GetNormalMatrix(world, normalMatrix);
+
+    mesh->vertexCount = (int)positions->count;
+    mesh->indexCount = (primitive->primitive->indices != NULL)? (int)primitive->primitive->indices->count : (int)positions->count;
+
+    for (int c = 0; c < 3; c++)
+    {
+        mesh->boundsMin[c] = 3.4e38f;
+        mesh->boundsMax[c] = -3.4e38f;
+    }
+
+    for (cgltf_size v = 0; v < positions->count; v++)
+    {
+        float *vertex = vertices + v*(SCENE_VERTEX_STRIDE/sizeof(float));
+        float value[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+        // Position
+        cgltf_accessor_read_float(positions, v, value, 3);
+        for (int c = 0; c < 3; c++)
+        {
+            vertex[c] = world[c]*value[0] + world[4 + c]*value[1] + world[8 + c]*value[2] + world[12 + c];
+            if (vertex[c] < mesh->boundsMin[c]) mesh->boundsMin[c] = vertex[c];
+            if (vertex[c] > mesh->boundsMax[c]) mesh->boundsMax[c] = vertex[c];
+        }
+
+        // Normal, transformed by the inverse transpose
+        if ((normals != NULL) && cgltf_accessor_read_float(normals, v, value, 3))
+        {
+            float normal[3] = { 0 };
+            for (int c = 0; c < 3; c++) normal[c] = normalMatrix[c]*value[0] + normalMatrix[3 + c]*value[1] + normalMatrix[6 + c]*value[2];
+
+            float length = sqrtf(normal[0]*normal[0] + normal[1]*normal[1] + normal[2]*normal[2]);
+            if (length > 0.0f) for (int c = 0; c < 3; c++) vertex[3 + c] = normal[c]/length;
+        }
+
+        // Texcoord
+        if ((texcoords != NULL) && cgltf_accessor_read_float(texcoords, v, value, 2))
+        {
+            vertex[6] = value[0];
+            vertex[7] = value[1];
+        }
+
+        // Tangent, w keeps the bitangent sign
+        if ((tangents != NULL) && cgltf_accessor_read_float(tangents, v, value, 4))
+        {
+            for (int c = 0; c < 3; c++) vertex[8 + c] = world[c]*value[0] + world[4 + c]*value[1] + world[8 + c]*value[2];
+            vertex[11] = value[3];
+        }
+    }
+}
+
+// Optimize, simplify and measure the UV density of a range of meshes
+static void BuildMeshRange(int start, int end, void *data)
+{
+    SceneMeshBuild *build = (SceneMeshBuild *)data;
+
+    for (int i = start; i < end; i++)
+    {
+        OptimizeMeshOrder(build, i);
+        BuildMeshLods(build, i);
+        build->meshes[i].uvDensity = GetMeshUvDensity(build, i);
+    }
+}
+
+// Reorder mesh triangles for the vertex cache and overdraw, then its vertices for fetch locality
+// NOTE: Indices are rewritten in the index stream, vertices are moved within the mesh range
+static void OptimizeMeshOrder(SceneMeshBuild *build, int index)
+{
+    SceneFileMesh *mesh = &build->meshes[index];
+    unsigned short *stream = build->indices + mesh->firstIndex;
+    float *vertices = build->vertices + (long long)mesh->firstVertex*(SCENE_VERTEX_STRIDE/sizeof(float));
+    int rebase = mesh->firstVertex - build->batches[mesh->batch].firstVertex;
+
+    unsigned int *indices = (unsigned int *)RL_MALLOC(2*mesh->indexCount*sizeof(unsigned int) + 1);
+    unsigned int *ordered = indices + mesh->indexCount;
+    unsigned int *remap = (unsigned int *)RL_MALLOC(mesh->vertexCount*sizeof(unsigned int) + 1);
+    float *copy = (float *)RL_MALLOC((long long)mesh->vertexCount*SCENE_VERTEX_STRIDE + 1);
+
+    for (int j = 0; j < mesh->indexCount; j++) indices[j] = (unsigned int)(stream[j] - rebase);
+    build->cacheStats[2*index] = GetVertexCacheStats(indices, mesh->indexCount, mesh->vertexCount, MESHOPT_FIFO_SIZE);
+
+    OptimizeVertexCache(ordered, indices, mesh->indexCount, mesh->vertexCount);
+    OptimizeOverdraw(indices, ordered, mesh->indexCount, vertices, mesh->vertexCount, SCENE_VERTEX_STRIDE);
+    OptimizeVertexFetch(remap, indices, mesh->indexCount, mesh->vertexCount);
+
+    memcpy(copy, vertices, (long long)mesh->vertexCount*SCENE_VERTEX_STRIDE);
+    RemapVertexBuffer(vertices, copy, mesh->vertexCount, SCENE_VERTEX_STRIDE, remap);
+
+    build->cacheStats[2*index + 1] = GetVertexCacheStats(indices, mesh->indexCount, mesh->vertexCount, MESHOPT_FIFO_SIZE);
+    for (int j = 0; j < mesh->indexCount; j++) stream[j] = (unsigned short)(indices[j] + rebase);
+
+    RL_FREE(copy);
+    RL_FREE(remap);
+    RL_FREE(indices);
+}
+
+// Simplify a mesh to 1/2, 1/4 and 1/8 of its indices, every level from the previous one
+// NOTE: Levels stop early when the error limit keeps a level from getting clearly smaller,
+// every level gets its triangles reordered for the vertex cache
+static void BuildMeshLods(SceneMeshBuild *build, int index)
+{
+    SceneFileMesh *mesh = &build->meshes[index];
+
+    mesh->lodCount = 1;
+    mesh->lodFirstIndex[0] = mesh->firstIndex;
+    mesh->lodIndexCount[0] = mesh->indexCount;
+
+    if (mesh->indexCount < SCENE_LOD_MIN_INDICES) return;
+
+    // Mesh relative indices, the simplifier only sees this mesh's vertices
+    unsigned int *lodIndices = (unsigned int *)RL_MALLOC(SCENE_MAX_LODS*mesh->indexCount*sizeof(unsigned int));
+    unsigned int *ordered = (unsigned int *)RL_MALLOC(mesh->indexCount*sizeof(unsigned int));
+    int rebase = mesh->firstVertex - build->batches[mesh->batch].firstVertex;
+
+    unsigned int *previous = lodIndices;
+    int previousCount = mesh->indexCount;
+    unsigned int *next = lodIndices + mesh->indexCount;
+    const float *positions = build->vertices + (long long)mesh->firstVertex*(SCENE_VERTEX_STRIDE/sizeof(float));
+
+    for (int j = 0; j < mesh->indexCount; j++) previous[j] = (unsigned int)build->indices[mesh->firstIndex + j] - (unsigned int)rebase;
+
+    for (int l = 1; l < SCENE_MAX_LODS; l++)
+    {
+        float error = 0.0f;
+        int target = (mesh->indexCount >> l)/3*3;
+        int count = SimplifyMesh(next, previous, previousCount, positions, mesh->vertexCount, SCENE_VERTEX_STRIDE, target, SCENE_LOD_ERROR*(float)(1 << (l - 1)), &error);
+
+        if (count > previousCount*9/10) break;
+
+        OptimizeVertexCache(ordered, next, count, mesh->vertexCount);
+        memcpy(next, ordered, count*sizeof(unsigned int));
+
+        mesh->lodIndexCount[l] = count;
+        mesh->lodError[l] = error;
+        mesh->lodCount++;
+
+        previous = next;
+        previousCount = count;
+        next += count;
+    }
+
+    // LOD 1.. are kept one after the other, LOD 0 is the original range
+    if (mesh->lodCount > 1) memmove(lodIndices, lodIndices + mesh->indexCount, (next - lodIndices - mesh->indexCount)*sizeof(unsigned int));
+    build->lodIndices[index] = lodIndices;
+
+    RL_FREE(ordered);
+}
+
+// Get UV units per scene unit of a mesh: square root of its UV area over its scene space area
+// NOTE: Reads the float vertices, texture coordinates at offset 24
+static float GetMeshUvDensity(const SceneMeshBuild *build, int index)
+{
+    const SceneFileMesh *mesh = &build->meshes[index];
+    const unsigned short *indices = build->indices + mesh->firstIndex;
+    const float *vertices = build->vertices + (long long)build->batches[mesh->batch].firstVertex*(SCENE_VERTEX_STRIDE/sizeof(float));
+    double area = 0.0;
+    double uvArea = 0.0;
+
+    for (int i = 0; i + 2 < mesh->indexCount; i += 3)
+    {
+        const float *a = vertices + indices[i]*(SCENE_VERTEX_STRIDE/sizeof(float));
+        const float *b = vertices + indices[i + 1]*(SCENE_VERTEX_STRIDE/sizeof(float));
+        const float *c = vertices + indices[i + 2]*(SCENE_VERTEX_STRIDE/sizeof(float));
+
+        Vector3 cross = Vector3CrossProduct((Vector3){ b[0] - a[0], b[1] - a[1], b[2] - a[2] }, (Vector3){ c[0] - a[0], c[1] - a[1], c[2] - a[2] });
+        area += 0.5*Vector3Length(cross);
+        uvArea += 0.5*fabs((b[6] - a[6])*(c[7] - a[7]) - (c[6] - a[6])*(b[7] - a[7]));
+    }
+
+    return (area > 0.0)? (float)sqrt(uvArea/area) : 0.0f;
+}
+
+// Quantize the float vertices of a batch, positions relative to the batch bounds
+static void QuantizeBatchVertices(const float *vertices, unsigned char *quantized, const SceneFileBatch *batch)
+{
+    float scale[3] = { 0 };
+    for (int c = 0; c < 3; c++) scale[c] = (batch->boundsMax[c] > batch->boundsMin[c])? 65535.0f/(batch->boundsMax[c] - batch->boundsMin[c]) : 0.0f;
+
+    for (int v = batch->firstVertex; v < batch->firstVertex + batch->vertexCount; v++)
+    {
+        const float *vertex = vertices + (long long)v*(SCENE_VERTEX_STRIDE/sizeof(float));
+        unsigned char *output = quantized + (long long)v*SCENE_QUANTIZED_STRIDE;
+        unsigned short position[4] = { 0 };
+        short normal[2] = { 0 };
+        short tangent[2] = { 0 };
+        unsigned short texcoord[2] = { FloatToHalf(vertex[6]), FloatToHalf(vertex[7]) };
+
+        for (int c = 0; c < 3; c++)
+        {
+            long value = lrintf((vertex[c] - batch->boundsMin[c])*scale[c]);
+            position[c] = (unsigned short)((value < 0)? 0 : (value > 65535)? 65535 : value);
+        }
+
+        position[3] = (vertex[11] < 0.0f)? 0 : 65535;       // Bitangent sign, decodes to 0 or 1
+        EncodeOctahedral(vertex + 3, normal);
+        EncodeOctahedral(vertex + 8, tangent);
+
+        memcpy(output, position, 8);
+        memcpy(output + 8, normal, 4);
+        memcpy(output + 12, tangent, 4);
+        memcpy(output + 16, texcoord, 4);
+    }
+}
+
+// Encode a direction as octahedral coordinates, 16 bit signed normalized
+// NOTE: The direction is projected on the octahedron, it does not need to be normalized
+static void EncodeOctahedral(const float *vector, short *encoded)
+{
+    float length = fabsf(vector[0]) + fabsf(vector[1]) + fabsf(vector[2]);
+    float x = (length > 0.0f)? vector[0]/length : 0.0f;
+    float y = (length > 0.0f)? vector[1]/length : 0.0f;
+
+    // Lower hemisphere folds over the diagonals
+    if (vector[2] < 0.0f)
+    {
+        float foldedX = (1.0f - fabsf(y))*((x >= 0.0f)? 1.0f : -1.0f);
+        float foldedY = (1.0f - fabsf(x))*((y >= 0.0f)? 1.0f : -1.0f);
+        x = foldedX;
+        y = foldedY;
+    }
+
+    encoded[0] = (short)lrintf(fminf(fmaxf(x, -1.0f), 1.0f)*32767.0f);
+    encoded[1] = (short)lrintf(fminf(fmaxf(y, -1.0f), 1.0f)*32767.0f);
+}
+
+// Decode octahedral coordinates, 16 bit signed normalized, to a unit vector (DecodeOctahedral() of pbr.vert)
+static void DecodeOctahedral(const short *encoded, float *vector)
+{
+    float x = fmaxf(encoded[0]/32767.0f, -1.0f);
+    float y = fmaxf(encoded[1]/32767.0f, -1.0f);
+    float z = 1.0f - fabsf(x) - fabsf(y);
+
+    if (z < 0.0f)
+    {
+        float foldedX = (1.0f - fabsf(y))*((x >= 0.0f)? 1.0f : -1.0f);
+        float foldedY = (1.0f - fabsf(x))*((y >= 0.0f)? 1.0f : -1.0f);
+        x = foldedX;
+        y = foldedY;
+    }
+
+    float length = sqrtf(x*x + y*y + z*z);
+    vector[0] = x/length;
+    vector[1] = y/length;
+    vector[2] = z/length;
+}
+
+// Convert float to half float, rounded to nearest
+// NOTE: Values below the smallest normal half flush to zero, values above the largest become infinity
+static unsigned short FloatToHalf(float value)
+{
+    unsigned int bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+
+    unsigned short sign = (unsigned short)((bits >> 16) & 0x8000);
+    int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+    unsigned int mantissa = bits & 0x7fffff;
+
+    if (exponent <= 0) return sign;
+    if (exponent >= 31) return sign | 0x7c00;
+
+    // Rounding may carry into the exponent, which is still the right result
+    return (unsigned short)(sign | ((exponent << 10) + (mantissa >> 13) + ((mantissa >> 12) & 1)));
+}
+
+// Convert half float to float
+// NOTE: FloatToHalf() never writes denormals, they decode to zero like flushed values
+static float HalfToFloat(unsigned short value)
+{
+    unsigned int sign = (unsigned int)(value & 0x8000) << 16;
+    unsigned int exponent = (value >> 10) & 0x1f;
+    unsigned int mantissa = value & 0x3ff;
+    unsigned int bits = sign;
+
+    if (exponent == 31) bits |= 0x7f800000 | (mantissa << 13);
+    else if (exponent > 0) bits |= ((exponent - 15 + 127) << 23) | (mantissa << 13);
+
+    float result = 0.0f;
+    memcpy(&result, &bits, sizeof(result));
+
+    return result;
+}
+
+// Decode the image files of a request range, only the first request of every file
+static void DecodeSceneImages(int start, int end, void *data)
+{
+    SceneDataDecode *decode = (SceneDataDecode *)data;
+
+    for (int i = start; i < end; i++)
+    {
+        if (decode->firstRequest[i] != i) continue;
+
+        Image image = LoadImage(decode->requests[i].fileName);
+        if (image.data != NULL) ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        decode->images[i] = image;
+    }
+}
+
+// Decode the vertices and copy the indices of a batch range into float meshes
+static void DecodeSceneBatches(int start, int end, void *data)
+{
+    SceneDataDecode *decode = (SceneDataDecode *)data;
+
+    for (int i = start; i < end; i++)
+    {
+        const SceneFileBatch *batch = &decode->batches[i];
+        Mesh *mesh = &decode->meshes[i];
+        if (mesh->vertexCount == 0) continue;
+
+        mesh->vertices = (float *)RL_MALLOC(mesh->vertexCount*3*sizeof(float));
+        mesh->normals = (float *)RL_MALLOC(mesh->vertexCount*3*sizeof(float));
+        mesh->texcoords = (float *)RL_MALLOC(mesh->vertexCount*2*sizeof(float));
+        mesh->tangents = (float *)RL_MALLOC(mesh->vertexCount*4*sizeof(float));
+        mesh->indices = (unsigned short *)RL_MALLOC((mesh->triangleCount*3 + 1)*sizeof(unsigned short));
+        memcpy(mesh->indices, decode->indexData + batch->firstIndex, mesh->triangleCount*3*sizeof(unsigned short));
+
+        for (int v = 0; v < mesh->vertexCount; v++)
+        {
+            const unsigned char *vertex = decode->vertexData + (long long)(batch->firstVertex + v)*decode->vertexStride;
+
+            if (decode->vertexStride == SCENE_QUANTIZED_STRIDE)
+            {
+                unsigned short position[4] = { 0 };
+                short normal[2] = { 0 };
+                short tangent[2] = { 0 };
+                unsigned short texcoord[2] = { 0 };
+
+                memcpy(position, vertex, 8);
+                memcpy(normal, vertex + 8, 4);
+                memcpy(tangent, vertex + 12, 4);
+                memcpy(texcoord, vertex + 16, 4);
+
+                for (int c = 0; c < 3; c++) mesh->vertices[v*3 + c] = batch->boundsMin[c] + position[c]/65535.0f*(batch->boundsMax[c] - batch->boundsMin[c]);
+                DecodeOctahedral(normal, mesh->normals + v*3);
+                DecodeOctahedral(tangent, mesh->tangents + v*4);
+                mesh->tangents[v*4 + 3] = (position[3] != 0)? 1.0f : -1.0f;
+                mesh->texcoords[v*2 + 0] = HalfToFloat(texcoord[0]);
+                mesh->texcoords[v*2 + 1] = HalfToFloat(texcoord[1]);
+            }
+            else
+            {
+                memcpy(mesh->vertices + v*3, vertex, 3*sizeof(float));
+                memcpy(mesh->normals + v*3, vertex + 12, 3*sizeof(float));
+                memcpy(mesh->texcoords + v*2, vertex + 24, 2*sizeof(float));
+                memcpy(mesh->tangents + v*4, vertex + 32, 4*sizeof(float));
+            }
+        }
+    }
+}
+
+// Get LOD of a mesh from its projected size, staying on the current one until the size is
+// SCENE_LOD_HYSTERESIS levels past its range
+static int GetMeshLod(const SceneMesh *mesh, int current, Matrix matModelView, float scale, float pixelScale)
+{
+    Vector3 center = Vector3Scale(Vector3Add(mesh->bounds.min, mesh->bounds.max), 0.5f);
+    float depth = -Vector3Transform(center, matModelView).z;
+    float radius = 0.5f*Vector3Distance(mesh->bounds.min, mesh->bounds.max)*scale;
+
+    if (depth <= radius) return 0;      // Camera inside or close to the bounds
+
+    // LOD 1 below SCENE_LOD_PIXELS, one more level every time the size halves
+    float size = 2.0f*radius*pixelScale/depth;
+    float level = log2f(SCENE_LOD_PIXELS/size) + 1.0f;
+
+    if (current >= mesh->lodCount) current = mesh->lodCount - 1;
+    if (((current == 0) || (level >= current - SCENE_LOD_HYSTERESIS)) &&
+        ((current == mesh->lodCount - 1) || (level < current + 1.0f + SCENE_LOD_HYSTERESIS))) return current;
+
+    int lod = (int)floorf(level);
+
+    return (lod < 0)? 0 : (lod >= mesh->lodCount)? mesh->lodCount - 1 : lod;
+}
+
+// Get screen pixels per UV unit at the closest point of a mesh, the texture streaming feedback
+// NOTE: The largest value on screen decides, so the closest point of the bounds is used
+static float GetMeshTextureUsage(const SceneMesh *mesh, Matrix matModelView, float scale, float pixelScale)
+{
+    if (mesh->uvDensity <= 0.0f) return 0.0f;
+
+    Vector3 center = Vector3Scale(Vector3Add(mesh->bounds.min, mesh->bounds.max), 0.5f);
+    float depth = -Vector3Transform(center, matModelView).z;
+    float radius = 0.5f*Vector3Distance(mesh->bounds.min, mesh->bounds.max)*scale;
+
+    if (depth <= radius) return FLT_MAX;    // Camera inside or close to the bounds, full resolution
+
+    return pixelScale*scale/((depth - radius)*mesh->uvDensity);
+}
+
+// Keep the largest opaque meshes as occluders, positions decoded to scene space, returns the mesh count
+// NOTE: Blended and alpha tested meshes can be seen through, small meshes hide too little to be worth rasterizing
+static int LoadSceneOccluders(Scene *scene, const unsigned char *vertexData, const unsigned short *indexData)
+{
+    BoundingBox sceneBounds = { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+    for (int i = 0; i < scene->meshCount; i++)
+    {
+        sceneBounds.min = Vector3Min(sceneBounds.min, scene->meshes[i].bounds.min);
+        sceneBounds.max = Vector3Max(sceneBounds.max, scene->meshes[i].bounds.max);
+    }
+
+    Vector3 sceneExtent = Vector3Subtract(sceneBounds.max, sceneBounds.min);
+    float minSize = SCENE_OCCLUDER_SIZE*fmaxf(sceneExtent.x, fmaxf(sceneExtent.y, sceneExtent.z));
+
+    // Largest meshes first, the smallest one falls off when the list is full
+    int occluders[SCENE_MAX_OCCLUDERS] = { 0 };
+    float sizes[SCENE_MAX_OCCLUDERS] = { 0 };
+    int count = 0;
+
+    for (int i = 0; i < scene->meshCount; i++)
+    {
+        const SceneMesh *mesh = &scene->meshes[i];
+        const Material *material = &scene->materials[mesh->material];
+        if ((material->maps[MATERIAL_MAP_ALBEDO].color.a < 255) || (material->params[SCENE_PARAM_ALPHA_CUTOFF] > 0.0f)) continue;
+
+        Vector3 extent = Vector3Subtract(mesh->bounds.max, mesh->bounds.min);
+        float size = fmaxf(extent.x, fmaxf(extent.y, extent.z));
+        if ((size < minSize) || ((count == SCENE_MAX_OCCLUDERS) && (size <= sizes[count - 1]))) continue;
+
+        int j = (count < SCENE_MAX_OCCLUDERS)? count++ : count - 1;
+        while ((j > 0) && (sizes[j - 1] < size))
+        {
+            sizes[j] = sizes[j - 1];
+            occluders[j] = occluders[j - 1];
+            j--;
+        }
+
+        sizes[j] = size;
+        occluders[j] = i;
+    }
+
+    // Coarsest LOD still close to the mesh, simplified silhouettes must not reach far past the real one
+    int lods[SCENE_MAX_OCCLUDERS] = { 0 };
+    for (int i = 0; i < count; i++)
+    {
+        const SceneMesh *mesh = &scene->meshes[occluders[i]];
+        while ((lods[i] + 1 < mesh->lodCount) && (mesh->lods[lods[i] + 1].error <= SCENE_OCCLUDER_LOD_ERROR)) lods[i]++;
+
+        scene->occluderVertexCount += mesh->vertexCount;
+        scene->occluderIndexCount += mesh->lods[lods[i]].indexCount;
+    }
+
+    scene->occluderVertices = (Vector3 *)RL_MALLOC((scene->occluderVertexCount + 1)*sizeof(Vector3));
+    scene->occluderIndices = (int *)RL_MALLOC((scene->occluderIndexCount + 1)*sizeof(int));
+
+    int vertexCount = 0;
+    int indexCount = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        const SceneMesh *mesh = &scene->meshes[occluders[i]];
+        const SceneBatch *batch = &scene->batches[mesh->batch];
+        const SceneLod *lod = &mesh->lods[lods[i]];
+
+        for (int v = 0; v < mesh->vertexCount; v++)
+        {
+            const unsigned char *vertex = vertexData + (long long)(mesh->firstVertex + v)*scene->vertexStride;
+            Vector3 *position = &scene->occluderVertices[vertexCount + v];
+
+            if (scene->vertexStride == SCENE_QUANTIZED_STRIDE)
+            {
+                unsigned short quantized[3] = { 0 };
+                memcpy(quantized, vertex, sizeof(quantized));
+                position->x = batch->positionDequant[0] + quantized[0]/65535.0f*batch->positionDequant[3];
+                position->y = batch->positionDequant[1] + quantized[1]/65535.0f*batch->positionDequant[4];
+                position->z = batch->positionDequant[2] + quantized[2]/65535.0f*batch->positionDequant[5];
+            }
+            else memcpy(position, vertex, sizeof(Vector3));
+        }
+
+        // Scene indices are batch relative, occluder ones relative to the occluder vertices
+        int rebase = mesh->firstVertex - batch->firstVertex;
+        for (int k = 0; k < lod->indexCount; k++) scene->occluderIndices[indexCount + k] = vertexCount + indexData[lod->firstIndex + k] - rebase;
+
+        vertexCount += mesh->vertexCount;
+        indexCount += lod->indexCount;
+    }
+
+    return count;
+}
+
+// Bind material shader, uniforms and textures
+// NOTE: Same shader inputs as raylib DrawMesh(), so shaders work with both
+static void BeginSceneMaterial(const Material *material, Matrix transform)
+{
+    const int *locs = material->shader.locs;
+
+    rlEnableShader(material->shader.id);
+
+    if (locs[SHADER_LOC_COLOR_DIFFUSE] != -1)
+    {
+        Color color = material->maps[MATERIAL_MAP_DIFFUSE].color;
+        float values[4] = { color.r/255.0f, color.g/255.0f, color.b/255.0f, color.a/255.0f };
+        rlSetUniform(locs[SHADER_LOC_COLOR_DIFFUSE], values, SHADER_UNIFORM_VEC4, 1);
+    }
+
+    if (locs[SHADER_LOC_COLOR_SPECULAR] != -1)
+    {
+        Color color = material->maps[MATERIAL_MAP_SPECULAR].color;
+        float values[4] = { color.r/255.0f, color.g/255.0f, color.b/255.0f, color.a/255.0f };
+        rlSetUniform(locs[SHADER_LOC_COLOR_SPECULAR], values, SHADER_UNIFORM_VEC4, 1);
+    }
+
+    if (locs[SHADER_LOC_ALPHA_CUTOFF] != -1) rlSetUniform(locs[SHADER_LOC_ALPHA_CUTOFF], &material->params[SCENE_PARAM_ALPHA_CUTOFF], SHADER_UNIFORM_FLOAT, 1);
+
+    Matrix matModel = MatrixMultiply(transform, rlGetMatrixTransform());
+    Matrix matView = rlGetMatrixModelview();
+    Matrix matProjection = rlGetMatrixProjection();
+    Matrix matModelView = MatrixMultiply(matModel, matView);
+
+    if (locs[SHADER_LOC_MATRIX_VIEW] != -1) rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_VIEW], matView);
+    if (locs[SHADER_LOC_MATRIX_PROJECTION] != -1) rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_PROJECTION], matProjection);
+    if (locs[SHADER_LOC_MATRIX_MODEL] != -1) rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_MODEL], matModel);
+    if (locs[SHADER_LOC_MATRIX_NORMAL] != -1) rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_NORMAL], MatrixTranspose(MatrixInvert(matModel)));
+    if (locs[SHADER_LOC_MATRIX_MVP] != -1) rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_MVP], MatrixMultiply(matModelView, matProjection));
+
+    for (int i = 0; i < MAX_MATERIAL_MAPS; i++)
+    {
+        if (material->maps[i].texture.id == 0) continue;
+
+        rlActiveTextureSlot(i);
+        if ((i == MATERIAL_MAP_IRRADIANCE) || (i == MATERIAL_MAP_PREFILTER) || (i == MATERIAL_MAP_CUBEMAP)) rlEnableTextureCubemap(material->maps[i].texture.id);
+        else rlEnableTexture(material->maps[i].texture.id);
+
+        rlSetUniform(locs[SHADER_LOC_MAP_DIFFUSE + i], &i, SHADER_UNIFORM_INT, 1);
+    }
+
+    sceneStats.materialBinds++;
+}
+
+// Unbind material textures and shader
+static void EndSceneMaterial(const Material *material)
+{
+    for (int i = 0; i < MAX_MATERIAL_MAPS; i++)
+    {
+        if (material->maps[i].texture.id == 0) continue;
+
+        rlActiveTextureSlot(i);
+        if ((i == MATERIAL_MAP_IRRADIANCE) || (i == MATERIAL_MAP_PREFILTER) || (i == MATERIAL_MAP_CUBEMAP)) rlDisableTextureCubemap();
+        else rlDisableTexture();
+    }
+
+    rlDisableShader();
+}
+
+// Draw an index range of a batch vertex array, material must be bound
+static void DrawSceneRange(const SceneBatch *batch, const int *locs, int firstIndex, int indexCount)
+{
+    rlEnableVertexArray(batch->vaoId);
+
+    if (locs[SHADER_LOC_POSITION_DEQUANT] != -1) rlSetUniform(locs[SHADER_LOC_POSITION_DEQUANT], batch->positionDequant, SHADER_UNIFORM_VEC3, 2);
+
+    // Scene files have no vertex colors, shaders reading them get white
+    if (locs[SHADER_LOC_VERTEX_COLOR] != -1)
+    {
+        float white[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        rlSetVertexAttributeDefault(locs[SHADER_LOC_VERTEX_COLOR], white, SHADER_ATTRIB_VEC4, 4);
+        rlDisableVertexAttribute(locs[SHADER_LOC_VERTEX_COLOR]);
+    }
+
+    rlDrawVertexArrayElements(firstIndex, indexCount, 0);
+    rlDisableVertexArray();
+
+    sceneStats.drawCalls++;
+    sceneStats.triangles += indexCount/3;
+}
+
+#endif // RSCENE_IMPLEMENTATION
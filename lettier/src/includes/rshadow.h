@@ -0,0 +1,557 @@
+/**********************************************************************************************
+*
+*   raylib.shadow - Cached shadow maps for point and directional lights
+*
+*   Point lights render depth into a cube map (six 90 degree views), the directional light
+*   into SHADOW_CASCADES layers of a texture array. Cascades split the camera view between
+*   the near plane and SHADOW_DISTANCE, mixing logarithmic and uniform splits, and every
+*   cascade covers the bounding sphere of its slice so its size never changes as the camera
+*   turns. Cascade centers are snapped to the shadow texel grid, moving the camera does not
+*   make shadow edges crawl.
+*
+*   Maps are only rendered when they are out of date: a point light moved or changed range,
+*   the directional light turned, static geometry moved (InvalidateShadowMaps()) or, for a
+*   cascade, the camera moved more than SHADOW_CASCADE_MARGIN of the cascade radius since
+*   it was rendered. Cascades are rendered with that margin added, so a cached cascade still
+*   covers its slice. A scene with static lights and geometry renders its maps once.
+*
+*   Shaders look maps up with hardware depth comparison (sampler2DArrayShadow and
+*   samplerCubeShadow, linear filtering gives 2x2 PCF per tap). The number of maps and the
+*   taps per lookup are compiled into the shader variant (see GetShadowShaderDefines()),
+*   so filtering cost is fixed and shaders without shadows pay nothing.
+*
+*   CONFIGURATION:
+*
+*   #define RSHADOW_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+*   DEPENDENCIES:
+*       rlights.h   - Light data
+*
+*   NOTE: Texture units SHADOW_TEXTURE_SLOT to SHADOW_TEXTURE_SLOT + SHADOW_MAX_POINT are used,
+*   after the light cluster buffers (see rcluster.h). The last one must stay below the 16 units
+*   GL 3.3 guarantees, drivers with fewer units get fewer cube maps
+*
+**********************************************************************************************/
+
+#ifndef RSHADOW_H
+#define RSHADOW_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define SHADOW_MAX_POINT        4           // Point lights with a cube map
+#define SHADOW_CASCADES         3           // Directional light cascades
+#define SHADOW_CUBE_SIZE        512         // Cube map face size
+#define SHADOW_CASCADE_SIZE     1024        // Cascade size
+#define SHADOW_TEXTURE_SLOT     9           // Cascades, cube maps follow (after the cluster buffers)
+
+#define SHADOW_NEAR             0.05f       // Near plane of point light views
+#define SHADOW_POINT_FAR        10.0f       // Range of point lights without a radius
+#define SHADOW_DISTANCE         16.0f       // View distance covered by the cascades
+#define SHADOW_SPLIT_LAMBDA     0.75f       // Cascade splits: 0 uniform, 1 logarithmic
+#define SHADOW_CASCADE_MARGIN   0.25f       // Fraction of the cascade radius the camera moves before it is rendered again
+#define SHADOW_CASTER_DISTANCE  20.0f       // Distance towards the light covered by cascades, casters further away are clipped
+#define SHADOW_SLOPE_BIAS       2.0f        // Polygon offset factor while rendering depth
+#define SHADOW_CONSTANT_BIAS    4.0f        // Polygon offset units while rendering depth
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Draw shadow casters with the current matrices, only depth is written
+typedef void (*ShadowDrawFunc)(void *data);
+
+// Shadow map statistics of the last update
+typedef struct ShadowStats {
+    int views;                  // Cube faces and cascades in use
+    int viewsRendered;          // Views rendered this update, the rest were cached
+    double renderTime;          // CPU time spent submitting shadow views in seconds
+} ShadowStats;
+
+typedef struct ShadowMaps ShadowMaps;
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+ShadowMaps *LoadShadowMaps(int pointCount, bool cascades, int filterTaps);      // Load cube maps for pointCount lights and cascades (requires GL context)
+void UnloadShadowMaps(ShadowMaps *shadows);                                     // Unload shadow textures
+const char *GetShadowShaderDefines(const ShadowMaps *shadows);                  // Get shader #define block of the shadow configuration
+void UpdateShadowLights(ShadowMaps *shadows, const Light *lights, int count);  // Assign enabled lights to maps, marks maps of changed lights out of date
+void InvalidateShadowMaps(ShadowMaps *shadows);                                 // Mark every map out of date, static geometry moved
+ShadowStats UpdateShadowMaps(ShadowMaps *shadows, Camera camera, float aspect, ShadowDrawFunc draw, void *data);  // Render out of date maps
+void SetShaderShadows(Shader shader);                                           // Set shader shadow sampler units, no light shadowed
+void BindShadowMaps(ShadowMaps *shadows, Shader shader);                        // Bind shadow maps and set shadowed lights in shader
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RSHADOW_H
+
+
+/***********************************************************************************
+*
+*   RSHADOW IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RSHADOW_IMPLEMENTATION)
+
+#include "raylib.h"
+#include "rlgl.h"
+#include "raymath.h"            // Required for: MatrixLookAt(), MatrixOrtho(), MatrixPerspective()
+
+#if defined(PLATFORM_DESKTOP)
+    // NOTE: Depth textures, texture arrays and framebuffer layers are not exposed by rlgl
+    #include "external/glad.h"
+#endif
+
+#include <math.h>               // Required for: sqrtf(), powf(), floorf(), fabsf(), tanf()
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Point light cube map
+typedef struct {
+    unsigned int texture;
+    int light;                  // Light buffer index, -1 when unused
+    Vector3 position;
+    float far;
+    bool dirty;
+} ShadowPoint;
+
+// Directional light cascade
+typedef struct {
+    Vector3 center;             // Light view space center the cascade was rendered at
+    float radius;               // Covered radius, slice bounding sphere plus margin
+    float split;                // View depth where the cascade ends
+    Matrix matrix;              // World to light clip space
+    bool dirty;
+} ShadowCascade;
+
+struct ShadowMaps {
+    unsigned int framebuffer;
+    int pointCount;
+    ShadowPoint points[SHADOW_MAX_POINT];
+
+    bool cascades;
+    unsigned int cascadeTexture;
+    int directionalLight;       // Light buffer index, -1 when unused
+    Vector3 direction;
+    ShadowCascade cascade[SHADOW_CASCADES];
+    float fovy;                 // Projection the cascade radii were computed for
+    float aspect;
+
+    int filterTaps;
+};
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static unsigned int LoadShadowTexture(bool cube);
+static Matrix GetShadowLightView(Vector3 direction);
+static void UpdateShadowCascades(ShadowMaps *shadows, Camera camera, float aspect);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Load shadow textures: a cube map for each of pointCount lights and the cascades array
+// NOTE: filterTaps is rounded down to 1, 4 or 16 lookups
+ShadowMaps *LoadShadowMaps(int pointCount, bool cascades, int filterTaps)
+{
+    ShadowMaps *shadows = (ShadowMaps *)RL_CALLOC(1, sizeof(ShadowMaps));
+
+    if (pointCount < 0) pointCount = 0;
+    if (pointCount > SHADOW_MAX_POINT) pointCount = SHADOW_MAX_POINT;
+
+    shadows->pointCount = pointCount;
+    shadows->cascades = cascades;
+    shadows->directionalLight = -1;
+    shadows->filterTaps = (filterTaps >= 16)? 16 : (filterTaps >= 4)? 4 : 1;
+
+    for (int i = 0; i < SHADOW_MAX_POINT; i++) shadows->points[i].light = -1;
+
+#if defined(PLATFORM_DESKTOP)
+    // Cube maps take the units after the cascades, drop the ones the driver can not bind
+    int maxUnits = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &maxUnits);
+
+    if (SHADOW_TEXTURE_SLOT + 1 + pointCount > maxUnits)
+    {
+        pointCount = (maxUnits > SHADOW_TEXTURE_SLOT + 1)? maxUnits - SHADOW_TEXTURE_SLOT - 1 : 0;
+        TraceLog(LOG_WARNING, "SHADOW: Only %i texture units, shadow cube maps limited to %i", maxUnits, pointCount);
+    }
+    shadows->pointCount = pointCount;
+
+    glGenFramebuffers(1, &shadows->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadows->framebuffer);
+    glDrawBuffer(GL_NONE);      // Depth only
+    glReadBuffer(GL_NONE);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);     // Filter across cube faces
+
+    for (int i = 0; i < pointCount; i++) shadows->points[i].texture = LoadShadowTexture(true);
+    if (cascades) shadows->cascadeTexture = LoadShadowTexture(false);
+
+    long long bytes = (long long)pointCount*6*SHADOW_CUBE_SIZE*SHADOW_CUBE_SIZE*4 + (cascades? (long long)SHADOW_CASCADES*SHADOW_CASCADE_SIZE*SHADOW_CASCADE_SIZE*4 : 0);
+    TraceLog(LOG_INFO, "SHADOW: Shadow maps loaded (%i cube maps | %i cascades | %i taps | %.1f MB)", pointCount, cascades? SHADOW_CASCADES : 0, shadows->filterTaps, bytes/(1024.0*1024.0));
+#else
+    TraceLog(LOG_WARNING, "SHADOW: Depth cube maps and texture arrays not supported on this platform");
+#endif
+
+    return shadows;
+}
+
+// Unload shadow textures
+void UnloadShadowMaps(ShadowMaps *shadows)
+{
+    if (shadows == NULL) return;
+
+#if defined(PLATFORM_DESKTOP)
+    for (int i = 0; i < shadows->pointCount; i++) glDeleteTextures(1, &shadows->points[i].texture);
+    if (shadows->cascades) glDeleteTextures(1, &shadows->cascadeTexture);
+    glDeleteFramebuffers(1, &shadows->framebuffer);
+#endif
+
+    RL_FREE(shadows);
+}
+
+// Get shader #define block of the shadow configuration, shaders sample exactly the maps loaded
+// NOTE: NULL gives an empty block, shadows off
+const char *GetShadowShaderDefines(const ShadowMaps *shadows)
+{
+    if (shadows == NULL) return "";
+
+    return TextFormat("#define SHADOW_POINTS %i\n%s#define SHADOW_PCF %i\n", shadows->pointCount,
+        shadows->cascades? TextFormat("#define SHADOW_CASCADES %i\n", SHADOW_CASCADES) : "", shadows->filterTaps);
+}
+
+// Assign lights to shadow maps: the first enabled point lights get the cube maps,
+// the first enabled directional light the cascades
+// NOTE: Only lights in the light buffer (index >= 0) can be shadowed, the shader matches them by index
+void UpdateShadowLights(ShadowMaps *shadows, const Light *lights, int count)
+{
+    int point = 0;
+    int directional = -1;
+    Vector3 direction = { 0 };
+
+    for (int i = 0; i < count; i++)
+    {
+        if (!lights[i].enabled || (lights[i].index < 0)) continue;
+
+        if ((lights[i].type == LIGHT_POINT) && (point < shadows->pointCount))
+        {
+            ShadowPoint *map = &shadows->points[point++];
+            float far = (lights[i].radius > 0.0f)? lights[i].radius : SHADOW_POINT_FAR;
+
+            if ((map->light != lights[i].index) || !Vector3Equals(map->position, lights[i].position) || (map->far != far)) map->dirty = true;
+
+            map->light = lights[i].index;
+            map->position = lights[i].position;
+            map->far = far;
+        }
+        else if ((lights[i].type == LIGHT_DIRECTIONAL) && shadows->cascades && (directional == -1))
+        {
+            directional = lights[i].index;
+            direction = Vector3Normalize(Vector3Subtract(lights[i].target, lights[i].position));
+        }
+    }
+
+    for (int i = point; i < shadows->pointCount; i++) shadows->points[i].light = -1;
+
+    if ((directional != shadows->directionalLight) || !Vector3Equals(direction, shadows->direction))
+    {
+        for (int c = 0; c < SHADOW_CASCADES; c++) shadows->cascade[c].dirty = true;
+    }
+
+    shadows->directionalLight = directional;
+    shadows->direction = direction;
+}
+
+// Mark every map out of date, next update renders them all
+// NOTE: Call when static geometry moved, maps of unchanged lights are kept otherwise
+void InvalidateShadowMaps(ShadowMaps *shadows)
+{
+    for (int i = 0; i < shadows->pointCount; i++) shadows->points[i].dirty = true;
+    for (int c = 0; c < SHADOW_CASCADES; c++) shadows->cascade[c].dirty = true;
+}
+
+// Render out of date shadow maps, draw is called once per rendered view
+// NOTE: Call outside BeginMode3D(), framebuffer, viewport and matrices are restored afterwards
+ShadowStats UpdateShadowMaps(ShadowMaps *shadows, Camera camera, float aspect, ShadowDrawFunc draw, void *data)
+{
+    ShadowStats stats = { 0 };
+    double start = GetTime();
+
+    if (shadows->directionalLight >= 0) UpdateShadowCascades(shadows, camera, aspect);
+
+#if defined(PLATFORM_DESKTOP)
+    rlDrawRenderBatchActive();      // Flush pending draws to the current framebuffer
+
+    int framebuffer = 0;
+    int viewport[4] = { 0 };
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    Matrix matView = rlGetMatrixModelview();
+    Matrix matProjection = rlGetMatrixProjection();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, shadows->framebuffer);
+    rlEnableDepthTest();
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(SHADOW_SLOPE_BIAS, SHADOW_CONSTANT_BIAS);
+
+    // Point lights: six 90 degree views, in cube map face order
+    const Vector3 faceDirections[6] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+    const Vector3 faceUps[6] = { { 0, -1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }, { 0, -1, 0 }, { 0, -1, 0 } };
+
+    rlViewport(0, 0, SHADOW_CUBE_SIZE, SHADOW_CUBE_SIZE);
+
+    for (int i = 0; i < shadows->pointCount; i++)
+    {
+        ShadowPoint *map = &shadows->points[i];
+        if (map->light < 0) continue;
+
+        stats.views += 6;
+        if (!map->dirty) continue;
+
+        rlSetMatrixProjection(MatrixPerspective(90.0*DEG2RAD, 1.0, SHADOW_NEAR, map->far));
+
+        for (int f = 0; f < 6; f++)
+        {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_CUBE_MAP_POSITIVE_X + f, map->texture, 0);
+            glClear(GL_DEPTH_BUFFER_BIT);
+
+            rlSetMatrixModelview(MatrixLookAt(map->position, Vector3Add(map->position, faceDirections[f]), faceUps[f]));
+            draw(data);
+            rlDrawRenderBatchActive();
+        }
+
+        map->dirty = false;
+        stats.viewsRendered += 6;
+    }
+
+    // Directional light cascades
+    if (shadows->directionalLight >= 0)
+    {
+        Matrix lightView = GetShadowLightView(shadows->direction);
+
+        rlViewport(0, 0, SHADOW_CASCADE_SIZE, SHADOW_CASCADE_SIZE);
+
+        for (int c = 0; c < SHADOW_CASCADES; c++)
+        {
+            ShadowCascade *cascade = &shadows->cascade[c];
+
+            stats.views++;
+            if (!cascade->dirty) continue;
+
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadows->cascadeTexture, 0, c);
+            glClear(GL_DEPTH_BUFFER_BIT);
+
+            // Light view looks down -z: casters up to SHADOW_CASTER_DISTANCE in front of the sphere are kept
+            Vector3 center = cascade->center;
+            float radius = cascade->radius;
+            Matrix projection = MatrixOrtho(center.x - radius, center.x + radius, center.y - radius, center.y + radius,
+                -center.z - radius - SHADOW_CASTER_DISTANCE, -center.z + radius);
+
+            rlSetMatrixModelview(lightView);
+            rlSetMatrixProjection(projection);
+            draw(data);
+            rlDrawRenderBatchActive();
+
+            cascade->matrix = MatrixMultiply(lightView, projection);
+            cascade->dirty = false;
+            stats.viewsRendered++;
+        }
+    }
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    rlDisableDepthTest();
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    rlViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    rlSetMatrixModelview(matView);
+    rlSetMatrixProjection(matProjection);
+#endif
+
+    stats.renderTime = GetTime() - start;
+
+    return stats;
+}
+
+// Set shader shadow sampler units, no light shadowed
+// NOTE: Required even when shadows are not used, unset samplers would share unit 0 with a sampler2D
+void SetShaderShadows(Shader shader)
+{
+    int slot = SHADOW_TEXTURE_SLOT;
+    int unused[SHADOW_MAX_POINT] = { -1, -1, -1, -1 };
+
+    SetShaderValue(shader, GetShaderLocation(shader, "shadowCascades"), &slot, SHADER_UNIFORM_INT);
+
+    for (int i = 0; i < SHADOW_MAX_POINT; i++)
+    {
+        slot = SHADOW_TEXTURE_SLOT + 1 + i;
+        SetShaderValue(shader, GetShaderLocation(shader, TextFormat("shadowCube%i", i)), &slot, SHADER_UNIFORM_INT);
+    }
+
+    SetShaderValueV(shader, GetShaderLocation(shader, "shadowPointLights"), unused, SHADER_UNIFORM_INT, SHADOW_MAX_POINT);
+    SetShaderValue(shader, GetShaderLocation(shader, "shadowDirectionalLight"), &unused[0], SHADER_UNIFORM_INT);
+}
+
+// Bind shadow maps and set the shadowed lights, cascade matrices and splits in shader
+void BindShadowMaps(ShadowMaps *shadows, Shader shader)
+{
+    int pointLights[SHADOW_MAX_POINT] = { 0 };
+    float pointFar[SHADOW_MAX_POINT] = { 0 };
+    Matrix matrices[SHADOW_CASCADES] = { 0 };
+    float splits[SHADOW_CASCADES] = { 0 };
+
+    for (int i = 0; i < SHADOW_MAX_POINT; i++)
+    {
+        pointLights[i] = (i < shadows->pointCount)? shadows->points[i].light : -1;
+        pointFar[i] = (i < shadows->pointCount)? shadows->points[i].far : 1.0f;
+    }
+
+    for (int c = 0; c < SHADOW_CASCADES; c++)
+    {
+        matrices[c] = shadows->cascade[c].matrix;
+        splits[c] = shadows->cascade[c].split;
+    }
+
+    // x: near plane of point light views, y: cube texel size at unit distance, z: cascade texel size
+    float params[4] = { SHADOW_NEAR, 2.0f/SHADOW_CUBE_SIZE, 1.0f/SHADOW_CASCADE_SIZE, 0.0f };
+
+    SetShaderValueV(shader, GetShaderLocation(shader, "shadowPointLights"), pointLights, SHADER_UNIFORM_INT, SHADOW_MAX_POINT);
+    SetShaderValueV(shader, GetShaderLocation(shader, "shadowPointFar"), pointFar, SHADER_UNIFORM_FLOAT, SHADOW_MAX_POINT);
+    SetShaderValue(shader, GetShaderLocation(shader, "shadowDirectionalLight"), &shadows->directionalLight, SHADER_UNIFORM_INT);
+    SetShaderValueV(shader, GetShaderLocation(shader, "shadowCascadeSplits"), splits, SHADER_UNIFORM_FLOAT, SHADOW_CASCADES);
+    SetShaderValue(shader, GetShaderLocation(shader, "shadowParams"), params, SHADER_UNIFORM_VEC4);
+
+    int matricesLoc = GetShaderLocation(shader, "shadowCascadeMatrices");
+    if (matricesLoc != -1)
+    {
+        rlEnableShader(shader.id);
+        rlSetUniformMatrices(matricesLoc, matrices, SHADOW_CASCADES);
+        rlDisableShader();
+    }
+
+#if defined(PLATFORM_DESKTOP)
+    if (shadows->cascades)
+    {
+        glActiveTexture(GL_TEXTURE0 + SHADOW_TEXTURE_SLOT);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, shadows->cascadeTexture);
+    }
+
+    for (int i = 0; i < shadows->pointCount; i++)
+    {
+        glActiveTexture(GL_TEXTURE0 + SHADOW_TEXTURE_SLOT + 1 + i);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, shadows->points[i].texture);
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+#endif
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Load a depth texture with comparison enabled: a cube map or the cascades array
+static unsigned int LoadShadowTexture(bool cube)
+{
+    unsigned int id = 0;
+
+#if defined(PLATFORM_DESKTOP)
+    GLenum target = cube? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D_ARRAY;
+
+    glGenTextures(1, &id);
+    glBindTexture(target, id);
+
+    if (cube)
+    {
+        for (int f = 0; f < 6; f++) glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + f, 0, GL_DEPTH_COMPONENT24, SHADOW_CUBE_SIZE, SHADOW_CUBE_SIZE, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+    }
+    else glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, SHADOW_CASCADE_SIZE, SHADOW_CASCADE_SIZE, SHADOW_CASCADES, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+
+    // Linear filtering with comparison: every lookup is a 2x2 PCF
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(target, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+    glBindTexture(target, 0);
+#endif
+
+    return id;
+}
+
+// Get world to light view matrix of a light direction, origin at the world origin
+// NOTE: Fixed basis per direction, so cascade centers snap to the same texel grid every frame
+static Matrix GetShadowLightView(Vector3 direction)
+{
+    Vector3 up = (fabsf(direction.y) > 0.99f)? (Vector3){ 0.0f, 0.0f, 1.0f } : (Vector3){ 0.0f, 1.0f, 0.0f };
+
+    return MatrixLookAt(Vector3Zero(), direction, up);
+}
+
+// Fit cascades to the camera view slices, marks cascades the camera moved out of
+static void UpdateShadowCascades(ShadowMaps *shadows, Camera camera, float aspect)
+{
+    float near = (float)rlGetCullDistanceNear();
+    float far = SHADOW_DISTANCE;
+    float tanY = tanf(camera.fovy*0.5f*DEG2RAD);
+    float tanX = tanY*aspect;
+    bool resized = (shadows->fovy != camera.fovy) || (shadows->aspect != aspect);
+
+    shadows->fovy = camera.fovy;
+    shadows->aspect = aspect;
+
+    Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+    Matrix lightView = GetShadowLightView(shadows->direction);
+    float sliceStart = near;
+
+    for (int c = 0; c < SHADOW_CASCADES; c++)
+    {
+        ShadowCascade *cascade = &shadows->cascade[c];
+
+        // Practical split scheme: blend of logarithmic and uniform split distances
+        float t = (float)(c + 1)/SHADOW_CASCADES;
+        float sliceEnd = SHADOW_SPLIT_LAMBDA*near*powf(far/near, t) + (1.0f - SHADOW_SPLIT_LAMBDA)*(near + (far - near)*t);
+
+        // Bounding sphere of the slice: centered on the view axis, far corners are furthest.
+        // Radius only depends on the projection, cascades keep their size as the camera turns
+        float halfDepth = 0.5f*(sliceEnd - sliceStart);
+        float sphere = sqrtf(halfDepth*halfDepth + sliceEnd*sliceEnd*(tanX*tanX + tanY*tanY));
+        float radius = sphere*(1.0f + SHADOW_CASCADE_MARGIN);
+        Vector3 center = Vector3Transform(Vector3Add(camera.position, Vector3Scale(forward, sliceStart + halfDepth)), lightView);
+
+        // Snap the center to whole texels in light space
+        float texel = 2.0f*radius/SHADOW_CASCADE_SIZE;
+        center.x = floorf(center.x/texel)*texel;
+        center.y = floorf(center.y/texel)*texel;
+
+        // Cached cascade still covers the slice while the center moved less than the margin
+        if (resized || (Vector3Distance(center, cascade->center) > sphere*SHADOW_CASCADE_MARGIN)) cascade->dirty = true;
+
+        if (cascade->dirty)
+        {
+            cascade->center = center;
+            cascade->radius = radius;
+        }
+
+        cascade->split = sliceEnd;
+        sliceStart = sliceEnd;
+    }
+}
+
+#endif // RSHADOW_IMPLEMENTATION
@@ -0,0 +1,420 @@
+/**********************************************************************************************
+*
+*   raylib.simplify - Quadric error metric mesh simplification
+*
+*   SimplifyMesh() reduces an indexed triangle list by collapsing edges onto one of their end
+*   vertices. No vertex is created or moved, so every simplified index list still points into
+*   the original vertex buffer and LODs only cost their indices.
+*
+*   Collapses are ranked with the quadric error metric (Garland and Heckbert): every position
+*   accumulates the planes of the triangles around it weighted by their area, the cost of moving
+*   a vertex onto another is the mean squared distance of the new position to the planes of both.
+*
+*   Vertices on attribute seams (several vertices at one position, split UVs or normals) and on
+*   open borders are locked: they can be collapse targets but are never removed, so seams and
+*   the outline of open meshes stay intact. Collapses that would flip a triangle are rejected.
+*
+*   Work is done in passes: candidate collapses are sorted by cost and applied greedily, a
+*   vertex and the triangle fan around it take part in at most one collapse per pass.
+*
+*   CONFIGURATION:
+*
+*   #define RSIMPLIFY_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+**********************************************************************************************/
+
+#ifndef RSIMPLIFY_H
+#define RSIMPLIFY_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define SIMPLIFY_MIN_NORMAL_COS     0.25f       // Collapses turning a triangle further are rejected
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+// Simplify triangle list to targetIndexCount indices or until the error would exceed maxError
+// (relative to the mesh extent), positions point at the first vertex position, stride in bytes.
+// Returns destination index count (destination needs indexCount entries), error is optional
+int SimplifyMesh(unsigned int *destination, const unsigned int *indices, int indexCount, const float *positions, int vertexCount, int stride, int targetIndexCount, float maxError, float *error);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RSIMPLIFY_H
+
+
+/***********************************************************************************
+*
+*   RSIMPLIFY IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RSIMPLIFY_IMPLEMENTATION)
+
+#include "raylib.h"
+
+#include <string.h>             // Required for: memcpy(), memcmp(), memset()
+#include <stdlib.h>             // Required for: qsort()
+#include <math.h>               // Required for: sqrt(), fmaxf()
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define SIMPLIFY_EMPTY_SLOT         0xffffffffu
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Symmetric 4x4 quadric: A (3x3), b and c of x'Ax + 2b'x + c, planes weighted by triangle area
+typedef struct {
+    double a00, a11, a22, a01, a02, a12;
+    double b0, b1, b2;
+    double c;
+    double weight;              // Summed area, errors are mean squared distances
+} Quadric;
+
+// Edge collapse candidate, from is removed and its triangles use to
+typedef struct {
+    unsigned int from;
+    unsigned int to;
+    double cost;
+} Collapse;
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static const float *GetSimplifyPosition(const float *positions, int stride, unsigned int vertex);
+static void AddTriangleQuadric(Quadric *quadric, const float *p0, const float *p1, const float *p2);
+static void AddQuadric(Quadric *quadric, const Quadric *other);
+static double GetQuadricError(const Quadric *q0, const Quadric *q1, const float *p);
+static bool IsCollapseFlipping(const unsigned int *triangles, const int *fanOffsets, const int *fans, const float *positions, int stride, unsigned int from, unsigned int to);
+static int CompareCollapses(const void *a, const void *b);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Simplify triangle list by quadric error edge collapses
+int SimplifyMesh(unsigned int *destination, const unsigned int *indices, int indexCount, const float *positions, int vertexCount, int stride, int targetIndexCount, float maxError, float *error)
+{
+    memcpy(destination, indices, indexCount*sizeof(unsigned int));
+    if (error != NULL) *error = 0.0f;
+    if ((indexCount < 3) || (vertexCount < 3) || (targetIndexCount >= indexCount)) return indexCount;
+
+    // Weld vertices by position: remap[v] is the first vertex at the same position
+    int tableSize = 1;
+    while (tableSize < 2*vertexCount) tableSize *= 2;
+
+    unsigned int *table = (unsigned int *)RL_MALLOC(tableSize*sizeof(unsigned int));
+    unsigned int *remap = (unsigned int *)RL_MALLOC(vertexCount*sizeof(unsigned int));
+    unsigned char *locked = (unsigned char *)RL_CALLOC(vertexCount, 1);
+    memset(table, 0xff, tableSize*sizeof(unsigned int));
+
+    for (int v = 0; v < vertexCount; v++)
+    {
+        const unsigned int *bits = (const unsigned int *)GetSimplifyPosition(positions, stride, v);
+        unsigned int slot = (bits[0]*73856093u ^ bits[1]*19349663u ^ bits[2]*83492791u) & (tableSize - 1);
+
+        while ((table[slot] != SIMPLIFY_EMPTY_SLOT) && (memcmp(GetSimplifyPosition(positions, stride, table[slot]), bits, 3*sizeof(float)) != 0)) slot = (slot + 1) & (tableSize - 1);
+
+        if (table[slot] == SIMPLIFY_EMPTY_SLOT) table[slot] = v;
+        else locked[table[slot]] = locked[v] = 1;      // Seam: several vertices at one position
+
+        remap[v] = table[slot];
+    }
+
+    RL_FREE(table);
+
+    // Border edges: welded directed edges without their opposite, both ends are locked
+    int edgeTableSize = 1;
+    while (edgeTableSize < 2*indexCount) edgeTableSize *= 2;
+
+    unsigned long long *edges = (unsigned long long *)RL_MALLOC(edgeTableSize*sizeof(unsigned long long));
+    memset(edges, 0xff, edgeTableSize*sizeof(unsigned long long));
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int i = 0; i < indexCount; i++)
+        {
+            unsigned int a = remap[indices[i]];
+            unsigned int b = remap[indices[(i%3 == 2)? i - 2 : i + 1]];
+            unsigned long long key = (pass == 0)? (((unsigned long long)a << 32) | b) : (((unsigned long long)b << 32) | a);
+            unsigned int slot = (unsigned int)((key*0x9e3779b97f4a7c15ull) >> 32) & (edgeTableSize - 1);
+
+            while ((edges[slot] != ~0ull) && (edges[slot] != key)) slot = (slot + 1) & (edgeTableSize - 1);
+
+            if (pass == 0) edges[slot] = key;
+            else if (edges[slot] != key)
+            {
+                // Opposite edge missing, lock every vertex at both positions
+                locked[a] = locked[b] = 1;
+            }
+        }
+    }
+
+    RL_FREE(edges);
+
+    for (int v = 0; v < vertexCount; v++) if (locked[remap[v]]) locked[v] = 1;
+
+    // Quadrics per welded position, extent for the relative error
+    Quadric *quadrics = (Quadric *)RL_CALLOC(vertexCount, sizeof(Quadric));
+    float boundsMin[3] = { 0 };
+    float boundsMax[3] = { 0 };
+
+    for (int i = 0; i < indexCount; i += 3)
+    {
+        const float *p0 = GetSimplifyPosition(positions, stride, indices[i]);
+        const float *p1 = GetSimplifyPosition(positions, stride, indices[i + 1]);
+        const float *p2 = GetSimplifyPosition(positions, stride, indices[i + 2]);
+
+        AddTriangleQuadric(&quadrics[remap[indices[i]]], p0, p1, p2);
+        AddTriangleQuadric(&quadrics[remap[indices[i + 1]]], p0, p1, p2);
+        AddTriangleQuadric(&quadrics[remap[indices[i + 2]]], p0, p1, p2);
+
+        for (int c = 0; c < 3; c++)
+        {
+            if (i == 0) boundsMin[c] = boundsMax[c] = p0[c];
+            boundsMin[c] = fminf(boundsMin[c], fminf(p0[c], fminf(p1[c], p2[c])));
+            boundsMax[c] = fmaxf(boundsMax[c], fmaxf(p0[c], fmaxf(p1[c], p2[c])));
+        }
+    }
+
+    float extent = fmaxf(boundsMax[0] - boundsMin[0], fmaxf(boundsMax[1] - boundsMin[1], boundsMax[2] - boundsMin[2]));
+    double errorLimit = (double)maxError*extent*maxError*extent;
+    double errorUsed = 0.0;
+
+    Collapse *collapses = (Collapse *)RL_MALLOC(2*indexCount*sizeof(Collapse));
+    unsigned int *collapseTo = (unsigned int *)RL_MALLOC(vertexCount*sizeof(unsigned int));
+    unsigned char *touched = (unsigned char *)RL_MALLOC(vertexCount);
+    int *fanOffsets = (int *)RL_MALLOC((vertexCount + 1)*sizeof(int));
+    int *fans = (int *)RL_MALLOC(indexCount*sizeof(int));
+    int count = indexCount;
+    bool limitReached = false;
+
+    while ((count > targetIndexCount) && !limitReached)
+    {
+        // Triangle fan of every vertex, CSR layout
+        memset(fanOffsets, 0, (vertexCount + 1)*sizeof(int));
+        for (int i = 0; i < count; i++) fanOffsets[destination[i] + 1]++;
+        for (int v = 0; v < vertexCount; v++) fanOffsets[v + 1] += fanOffsets[v];
+        for (int i = 0; i < count; i++) fans[fanOffsets[destination[i]]++] = i/3;
+        for (int v = vertexCount; v > 0; v--) fanOffsets[v] = fanOffsets[v - 1];
+        fanOffsets[0] = 0;
+
+        // Candidates: both directions of every edge with an unlocked source
+        int collapseCount = 0;
+
+        for (int i = 0; i < count; i++)
+        {
+            unsigned int a = destination[i];
+            unsigned int b = destination[(i%3 == 2)? i - 2 : i + 1];
+            const float *pa = GetSimplifyPosition(positions, stride, a);
+            const float *pb = GetSimplifyPosition(positions, stride, b);
+
+            if (!locked[a]) collapses[collapseCount++] = (Collapse){ a, b, GetQuadricError(&quadrics[remap[a]], &quadrics[remap[b]], pb) };
+            if (!locked[b]) collapses[collapseCount++] = (Collapse){ b, a, GetQuadricError(&quadrics[remap[b]], &quadrics[remap[a]], pa) };
+        }
+
+        if (collapseCount == 0) break;
+
+        qsort(collapses, collapseCount, sizeof(Collapse), CompareCollapses);
+
+        for (int v = 0; v < vertexCount; v++) collapseTo[v] = v;
+        memset(touched, 0, vertexCount);
+
+        // Every collapse removes at least one triangle, most remove two
+        int removeBudget = (count - targetIndexCount)/3;
+        int removed = 0;
+        int applied = 0;
+
+        for (int i = 0; (i < collapseCount) && (removed < removeBudget); i++)
+        {
+            const Collapse *collapse = &collapses[i];
+
+            if (collapse->cost > errorLimit)
+            {
+                limitReached = true;
+                break;
+            }
+
+            if (touched[collapse->from] || touched[collapse->to]) continue;
+            if (IsCollapseFlipping(destination, fanOffsets, fans, positions, stride, collapse->from, collapse->to)) continue;
+
+            collapseTo[collapse->from] = collapse->to;
+            AddQuadric(&quadrics[remap[collapse->to]], &quadrics[remap[collapse->from]]);
+            if (collapse->cost > errorUsed) errorUsed = collapse->cost;
+            applied++;
+
+            // Fan of the removed vertex changes, keep it out of this pass
+            for (int f = fanOffsets[collapse->from]; f < fanOffsets[collapse->from + 1]; f++)
+            {
+                const unsigned int *triangle = &destination[fans[f]*3];
+                touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+                if ((triangle[0] == collapse->to) || (triangle[1] == collapse->to) || (triangle[2] == collapse->to)) removed++;
+            }
+        }
+
+        if (applied == 0) break;
+
+        // Rewrite triangles, collapsed ones drop out
+        int newCount = 0;
+
+        for (int i = 0; i < count; i += 3)
+        {
+            unsigned int a = collapseTo[destination[i]];
+            unsigned int b = collapseTo[destination[i + 1]];
+            unsigned int c = collapseTo[destination[i + 2]];
+
+            if ((a == b) || (b == c) || (a == c)) continue;
+
+            destination[newCount++] = a;
+            destination[newCount++] = b;
+            destination[newCount++] = c;
+        }
+
+        count = newCount;
+    }
+
+    RL_FREE(fans);
+    RL_FREE(fanOffsets);
+    RL_FREE(touched);
+    RL_FREE(collapseTo);
+    RL_FREE(collapses);
+    RL_FREE(quadrics);
+    RL_FREE(locked);
+    RL_FREE(remap);
+
+    if ((error != NULL) && (extent > 0.0f)) *error = (float)(sqrt(errorUsed)/extent);
+
+    return count;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Get vertex position from a strided vertex array
+static const float *GetSimplifyPosition(const float *positions, int stride, unsigned int vertex)
+{
+    return (const float *)((const unsigned char *)positions + (size_t)vertex*stride);
+}
+
+// Add area weighted plane of a triangle to a quadric, degenerate triangles add nothing
+static void AddTriangleQuadric(Quadric *quadric, const float *p0, const float *p1, const float *p2)
+{
+    double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+    double n[3] = { e1[1]*e2[2] - e1[2]*e2[1], e1[2]*e2[0] - e1[0]*e2[2], e1[0]*e2[1] - e1[1]*e2[0] };
+    double length = sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+
+    if (length <= 0.0) return;
+
+    n[0] /= length;
+    n[1] /= length;
+    n[2] /= length;
+    double d = -(n[0]*p0[0] + n[1]*p0[1] + n[2]*p0[2]);
+    double area = 0.5*length;
+
+    quadric->a00 += area*n[0]*n[0];
+    quadric->a11 += area*n[1]*n[1];
+    quadric->a22 += area*n[2]*n[2];
+    quadric->a01 += area*n[0]*n[1];
+    quadric->a02 += area*n[0]*n[2];
+    quadric->a12 += area*n[1]*n[2];
+    quadric->b0 += area*n[0]*d;
+    quadric->b1 += area*n[1]*d;
+    quadric->b2 += area*n[2]*d;
+    quadric->c += area*d*d;
+    quadric->weight += area;
+}
+
+// Add quadric
+static void AddQuadric(Quadric *quadric, const Quadric *other)
+{
+    quadric->a00 += other->a00;
+    quadric->a11 += other->a11;
+    quadric->a22 += other->a22;
+    quadric->a01 += other->a01;
+    quadric->a02 += other->a02;
+    quadric->a12 += other->a12;
+    quadric->b0 += other->b0;
+    quadric->b1 += other->b1;
+    quadric->b2 += other->b2;
+    quadric->c += other->c;
+    quadric->weight += other->weight;
+}
+
+// Get mean squared plane distance of position p for the sum of two quadrics
+static double GetQuadricError(const Quadric *q0, const Quadric *q1, const float *p)
+{
+    double x = p[0], y = p[1], z = p[2];
+    double error = 0.0;
+    double weight = q0->weight + q1->weight;
+
+    for (int i = 0; i < 2; i++)
+    {
+        const Quadric *q = (i == 0)? q0 : q1;
+
+        error += q->a00*x*x + q->a11*y*y + q->a22*z*z + 2.0*(q->a01*x*y + q->a02*x*z + q->a12*y*z) +
+                 2.0*(q->b0*x + q->b1*y + q->b2*z) + q->c;
+    }
+
+    return ((error > 0.0) && (weight > 0.0))? error/weight : 0.0;
+}
+
+// Check if moving vertex from onto vertex to turns a remaining triangle of its fan too far
+static bool IsCollapseFlipping(const unsigned int *triangles, const int *fanOffsets, const int *fans, const float *positions, int stride, unsigned int from, unsigned int to)
+{
+    const float *target = GetSimplifyPosition(positions, stride, to);
+
+    for (int f = fanOffsets[from]; f < fanOffsets[from + 1]; f++)
+    {
+        const unsigned int *triangle = &triangles[fans[f]*3];
+        if ((triangle[0] == to) || (triangle[1] == to) || (triangle[2] == to)) continue;   // Removed by the collapse
+
+        const float *p[3] = { 0 };
+        const float *q[3] = { 0 };
+
+        for (int k = 0; k < 3; k++)
+        {
+            p[k] = GetSimplifyPosition(positions, stride, triangle[k]);
+            q[k] = (triangle[k] == from)? target : p[k];
+        }
+
+        float e1[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+        float e2[3] = { p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] };
+        float f1[3] = { q[1][0] - q[0][0], q[1][1] - q[0][1], q[1][2] - q[0][2] };
+        float f2[3] = { q[2][0] - q[0][0], q[2][1] - q[0][1], q[2][2] - q[0][2] };
+
+        float n0[3] = { e1[1]*e2[2] - e1[2]*e2[1], e1[2]*e2[0] - e1[0]*e2[2], e1[0]*e2[1] - e1[1]*e2[0] };
+        float n1[3] = { f1[1]*f2[2] - f1[2]*f2[1], f1[2]*f2[0] - f1[0]*f2[2], f1[0]*f2[1] - f1[1]*f2[0] };
+
+        float dot = n0[0]*n1[0] + n0[1]*n1[1] + n0[2]*n1[2];
+        float lengths = sqrtf((n0[0]*n0[0] + n0[1]*n0[1] + n0[2]*n0[2])*(n1[0]*n1[0] + n1[1]*n1[1] + n1[2]*n1[2]));
+
+        if (dot <= SIMPLIFY_MIN_NORMAL_COS*lengths) return true;
+    }
+
+    return false;
+}
+
+// Sort collapses by increasing cost
+static int CompareCollapses(const void *a, const void *b)
+{
+    double costA = ((const Collapse *)a)->cost;
+    double costB = ((const Collapse *)b)->cost;
+
+    return (costA < costB)? -1 : (costA > costB);
+}
+
+#endif // RSIMPLIFY_IMPLEMENTATION
@@ -0,0 +1,422 @@
+/**********************************************************************************************
+*
+*   raylib.texcache - GPU-ready texture cache files with prebuilt mip chains
+*
+*   A cache file is a small header followed by the full mip chain, laid out exactly as
+*   rlLoadTexture() expects it (levels stored one after another, largest first). At runtime
+*   the file is memory mapped and handed to GL as is, no image decoding is involved.
+*
+*   Mipmaps are generated on the CPU with a 2x2 box filter. Color textures are filtered in
+*   linear space (sRGB decode, average, sRGB encode), normal maps are renormalized after
+*   every level and data textures (metallic/roughness, occlusion) are averaged as is.
+*
+*   The chain can also be stored block compressed (see rbcenc.h), compressed chains stop
+*   at the last level with whole 4x4 blocks and GL_TEXTURE_MAX_LEVEL is set accordingly.
+*
+*   CONFIGURATION:
+*
+*   #define RTEXCACHE_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+**********************************************************************************************/
+
+#ifndef RTEXCACHE_H
+#define RTEXCACHE_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define TEXCACHE_FILE_EXT       ".rtc"          // Texture cache file extension
+#define TEXCACHE_VERSION        2               // Increase when the file layout or the filtering changes
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Texture content, selects mipmap filtering
+typedef enum {
+    TEXCACHE_DATA = 0,          // Linear data, plain average (metallic/roughness, occlusion)
+    TEXCACHE_COLOR,             // sRGB color, averaged in linear space (albedo, emission)
+    TEXCACHE_NORMAL             // Tangent space normal map, renormalized per level
+} TextureCacheUsage;
+
+// Memory mapped texture cache file
+typedef struct TextureCacheFile {
+    void *mapping;              // Whole file mapping
+    long long mappingSize;
+    const void *data;           // Mip chain, points into mapping
+    int width;
+    int height;
+    int mipmaps;
+    int format;                 // PixelFormat
+} TextureCacheFile;
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+void GenImageMipmapsFiltered(Image *image, int usage);                                  // Generate full mip chain on CPU
+bool ExportTextureCache(Image image, long sourceModTime, const char *cacheFileName);    // Write image and its mip chain to a cache file
+bool BuildTextureCache(const char *sourceFileName, int usage, const char *cacheFileName); // Decode source, generate mips and write cache
+
+TextureCacheFile LoadTextureCacheFile(const char *cacheFileName, long sourceModTime);   // Map cache file (fails if stale)
+void UnloadTextureCacheFile(TextureCacheFile cache);                                    // Unmap cache file
+Texture2D LoadTextureFromCacheFile(TextureCacheFile cache);                             // Upload mapped mip chain (GL thread only)
+bool IsTextureCacheFormatSupported(int format);                                         // Check GL can sample a cache file format
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTEXCACHE_H
+
+
+/***********************************************************************************
+*
+*   RTEXCACHE IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RTEXCACHE_IMPLEMENTATION)
+
+#include "raylib.h"
+#include "rlgl.h"
+
+#if defined(PLATFORM_DESKTOP)
+    // NOTE: Texture max level and S3TC support are not exposed by rlgl
+    #include "external/glad.h"
+#endif
+#if !defined(_WIN32)
+    #include <fcntl.h>          // Required for: open()
+    #include <sys/mman.h>       // Required for: mmap(), munmap(), madvise()
+    #include <sys/stat.h>       // Required for: fstat()
+    #include <unistd.h>         // Required for: close()
+#endif
+
+#include <stdio.h>              // Required for: FILE, fopen(), fwrite(), fclose()
+#include <string.h>             // Required for: memcpy()
+#include <math.h>               // Required for: powf(), sqrtf()
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define TEXCACHE_MAGIC          0x43545852      // "RXTC"
+#define TEXCACHE_HEADER_SIZE    64              // Header is padded so the mip chain stays aligned
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    int width;
+    int height;
+    int mipmaps;
+    int format;
+    long long dataSize;         // Size of the whole mip chain
+    long long sourceModTime;    // Source file modification time, cache is stale when it differs
+} TextureCacheHeader;
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static int GetPixelChannels(int format);
+static unsigned char LinearToSrgb(float value);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Generate full mip chain on CPU with a 2x2 box filter
+// NOTE: Image is converted to an 8 bit per channel format if required
+void GenImageMipmapsFiltered(Image *image, int usage)
+{
+    if ((image->data == NULL) || (image->mipmaps > 1)) return;
+
+    int channels = GetPixelChannels(image->format);
+    if (channels == 0)
+    {
+        ImageFormat(image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        channels = 4;
+    }
+
+    // Color channels are filtered in linear space, alpha and data channels as is
+    float srgbToLinear[256] = { 0 };
+    for (int i = 0; i < 256; i++)
+    {
+        float c = i/255.0f;
+        srgbToLinear[i] = (c <= 0.04045f)? c/12.92f : powf((c + 0.055f)/1.055f, 2.4f);
+    }
+
+    int colorChannels = (usage == TEXCACHE_COLOR)? ((channels >= 3)? 3 : 1) : 0;
+    if ((usage == TEXCACHE_COLOR) && (channels == 2)) colorChannels = 1;
+
+    int mipCount = 1;
+    long long dataSize = (long long)image->width*image->height*channels;
+    for (int w = image->width, h = image->height; (w > 1) || (h > 1); mipCount++)
+    {
+        w = (w > 1)? w/2 : 1;
+        h = (h > 1)? h/2 : 1;
+        dataSize += (long long)w*h*channels;
+    }
+
+    unsigned char *data = (unsigned char *)RL_REALLOC(image->data, dataSize);
+    if (data == NULL) return;
+
+    unsigned char *src = data;
+    int srcWidth = image->width;
+    int srcHeight = image->height;
+
+    for (int level = 1; level < mipCount; level++)
+    {
+        int dstWidth = (srcWidth > 1)? srcWidth/2 : 1;
+        int dstHeight = (srcHeight > 1)? srcHeight/2 : 1;
+        unsigned char *dst = src + (long long)srcWidth*srcHeight*channels;
+
+        for (int y = 0; y < dstHeight; y++)
+        {
+            // NOTE: Odd sizes are handled by clamping to the last row/column
+            int y0 = y*2;
+            int y1 = (y*2 + 1 < srcHeight)? y*2 + 1 : y0;
+
+            for (int x = 0; x < dstWidth; x++)
+            {
+                int x0 = x*2;
+                int x1 = (x*2 + 1 < srcWidth)? x*2 + 1 : x0;
+
+                const unsigned char *p[4] = {
+                    src + ((long long)y0*srcWidth + x0)*channels, src + ((long long)y0*srcWidth + x1)*channels,
+                    src + ((long long)y1*srcWidth + x0)*channels, src + ((long long)y1*srcWidth + x1)*channels
+                };
+                unsigned char *out = dst + ((long long)y*dstWidth + x)*channels;
+
+                for (int c = 0; c < channels; c++)
+                {
+                    if (c < colorChannels)
+                    {
+                        float sum = srgbToLinear[p[0][c]] + srgbToLinear[p[1][c]] + srgbToLinear[p[2][c]] + srgbToLinear[p[3][c]];
+                        out[c] = LinearToSrgb(sum*0.25f);
+                    }
+                    else out[c] = (unsigned char)((p[0][c] + p[1][c] + p[2][c] + p[3][c] + 2)/4);
+                }
+
+                if ((usage == TEXCACHE_NORMAL) && (channels >= 3))
+                {
+                    float n[3] = { out[0]/127.5f - 1.0f, out[1]/127.5f - 1.0f, out[2]/127.5f - 1.0f };
+                    float length = sqrtf(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+
+                    if (length > 0.0f)
+                    {
+                        for (int c = 0; c < 3; c++)
+                        {
+                            float v = (n[c]/length + 1.0f)*127.5f + 0.5f;
+                            out[c] = (unsigned char)((v > 255.0f)? 255.0f : (v < 0.0f)? 0.0f : v);
+                        }
+                    }
+                }
+            }
+        }
+
+        src = dst;
+        srcWidth = dstWidth;
+        srcHeight = dstHeight;
+    }
+
+    image->data = data;
+    image->mipmaps = mipCount;
+}
+
+// Write image and its mip chain to a cache file
+bool ExportTextureCache(Image image, long sourceModTime, const char *cacheFileName)
+{
+    if (image.data == NULL) return false;
+
+    long long dataSize = 0;
+    for (int i = 0, w = image.width, h = image.height; i < image.mipmaps; i++)
+    {
+        dataSize += GetPixelDataSize(w, h, image.format);
+        w = (w > 1)? w/2 : 1;
+        h = (h > 1)? h/2 : 1;
+    }
+
+    unsigned char header[TEXCACHE_HEADER_SIZE] = { 0 };
+    TextureCacheHeader info = { TEXCACHE_MAGIC, TEXCACHE_VERSION, image.width, image.height, image.mipmaps, image.format, dataSize, sourceModTime };
+    memcpy(header, &info, sizeof(info));
+
+    FILE *file = fopen(cacheFileName, "wb");
+    if (file == NULL) return false;
+
+    bool success = (fwrite(header, 1, TEXCACHE_HEADER_SIZE, file) == TEXCACHE_HEADER_SIZE) &&
+                   (fwrite(image.data, 1, (size_t)dataSize, file) == (size_t)dataSize);
+    fclose(file);
+
+    if (!success) remove(cacheFileName);
+
+    return success;
+}
+
+// Decode source, generate mips and write cache
+bool BuildTextureCache(const char *sourceFileName, int usage, const char *cacheFileName)
+{
+    Image image = LoadImage(sourceFileName);
+    if (image.data == NULL) return false;
+
+    GenImageMipmapsFiltered(&image, usage);
+    bool success = ExportTextureCache(image, GetFileModTime(sourceFileName), cacheFileName);
+
+    UnloadImage(image);
+
+    return success;
+}
+
+// Map cache file, fails if missing, from another version or older than the source
+// NOTE: Safe to call from worker threads
+TextureCacheFile LoadTextureCacheFile(const char *cacheFileName, long sourceModTime)
+{
+    TextureCacheFile cache = { 0 };
+    void *mapping = NULL;
+    long long mappingSize = 0;
+
+#if defined(_WIN32)
+    FILE *file = fopen(cacheFileName, "rb");
+    if (file == NULL) return cache;
+
+    fseek(file, 0, SEEK_END);
+    mappingSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if (mappingSize > TEXCACHE_HEADER_SIZE)
+    {
+        mapping = RL_MALLOC((size_t)mappingSize);
+        if ((mapping != NULL) && (fread(mapping, 1, (size_t)mappingSize, file) != (size_t)mappingSize))
+        {
+            RL_FREE(mapping);
+            mapping = NULL;
+        }
+    }
+    fclose(file);
+#else
+    int fd = open(cacheFileName, O_RDONLY);
+    if (fd < 0) return cache;
+
+    struct stat st = { 0 };
+    if ((fstat(fd, &st) == 0) && (st.st_size > TEXCACHE_HEADER_SIZE))
+    {
+        mappingSize = (long long)st.st_size;
+        mapping = mmap(NULL, (size_t)mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) mapping = NULL;
+        else madvise(mapping, (size_t)mappingSize, MADV_WILLNEED);   // Start reading ahead, upload touches every page
+    }
+    close(fd);
+#endif
+
+    if (mapping == NULL) return cache;
+
+    TextureCacheHeader info = { 0 };
+    memcpy(&info, mapping, sizeof(info));
+
+    if ((info.magic != TEXCACHE_MAGIC) || (info.version != TEXCACHE_VERSION) ||
+        (info.sourceModTime != sourceModTime) || (info.dataSize + TEXCACHE_HEADER_SIZE > mappingSize))
+    {
+        cache.mapping = mapping;
+        cache.mappingSize = mappingSize;
+        UnloadTextureCacheFile(cache);
+
+        return (TextureCacheFile){ 0 };
+    }
+
+    cache.mapping = mapping;
+    cache.mappingSize = mappingSize;
+    cache.data = (const unsigned char *)mapping + TEXCACHE_HEADER_SIZE;
+    cache.width = info.width;
+    cache.height = info.height;
+    cache.mipmaps = info.mipmaps;
+    cache.format = info.format;
+
+    return cache;
+}
+
+// Unmap cache file
+void UnloadTextureCacheFile(TextureCacheFile cache)
+{
+    if (cache.mapping == NULL) return;
+
+#if defined(_WIN32)
+    RL_FREE(cache.mapping);
+#else
+    munmap(cache.mapping, (size_t)cache.mappingSize);
+#endif
+}
+
+// Upload mapped mip chain, no decoding or conversion involved
+// NOTE: Must be called from the thread owning the GL context
+Texture2D LoadTextureFromCacheFile(TextureCacheFile cache)
+{
+    Texture2D texture = { 0 };
+
+    if (cache.data == NULL) return texture;
+
+    texture.id = rlLoadTexture(cache.data, cache.width, cache.height, cache.format, cache.mipmaps);
+    texture.width = cache.width;
+    texture.height = cache.height;
+    texture.mipmaps = cache.mipmaps;
+    texture.format = cache.format;
+
+    if ((texture.id != 0) && (texture.mipmaps > 1))
+    {
+#if defined(PLATFORM_DESKTOP)
+        // Compressed chains may stop before 1x1, the texture would be incomplete otherwise
+        glBindTexture(GL_TEXTURE_2D, texture.id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texture.mipmaps - 1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+#endif
+        SetTextureFilter(texture, TEXTURE_FILTER_TRILINEAR);
+    }
+
+    return texture;
+}
+
+// Check GL can sample a cache file format, uncompressed formats are always supported
+// NOTE: Requires a GL context
+bool IsTextureCacheFormatSupported(int format)
+{
+    if (format < PIXELFORMAT_COMPRESSED_DXT1_RGB) return true;
+
+#if defined(PLATFORM_DESKTOP)
+    if ((format >= PIXELFORMAT_COMPRESSED_DXT1_RGB) && (format <= PIXELFORMAT_COMPRESSED_DXT5_RGBA)) return (GLAD_GL_EXT_texture_compression_s3tc != 0);
+#endif
+
+    return false;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Get number of 8 bit channels for a pixel format, 0 if it is not an 8 bit per channel format
+static int GetPixelChannels(int format)
+{
+    switch (format)
+    {
+        case PIXELFORMAT_UNCOMPRESSED_GRAYSCALE: return 1;
+        case PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA: return 2;
+        case PIXELFORMAT_UNCOMPRESSED_R8G8B8: return 3;
+        case PIXELFORMAT_UNCOMPRESSED_R8G8B8A8: return 4;
+        default: return 0;
+    }
+}
+
+// Linear to sRGB conversion
+static unsigned char LinearToSrgb(float value)
+{
+    float c = (value <= 0.0031308f)? value*12.92f : 1.055f*powf(value, 1.0f/2.4f) - 0.055f;
+    c = c*255.0f + 0.5f;
+
+    return (unsigned char)((c > 255.0f)? 255.0f : (c < 0.0f)? 0.0f : c);
+}
+
+#endif // RTEXCACHE_IMPLEMENTATION
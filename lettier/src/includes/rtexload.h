@@ -0,0 +1,585 @@
+/**********************************************************************************************
+*
+*   raylib.texload - Parallel texture loading for glTF models
+*
+*   LoadModel() decodes every material texture one after another on the calling thread.
+*   This module reads the glTF material table first, decodes every referenced image once
+*   on a JobPool while raylib parses the glTF and its buffers, and leaves only the GL
+*   uploads on the render thread. Textures end up in the material map slots raylib would
+*   have used, except the glTF metallic-roughness map: it goes into MATERIAL_MAP_METALNESS,
+*   the MRA slot the PBR shaders sample. Every image is uploaded once and its texture is
+*   shared by its slots: UnloadMaterialTextures() unloads them once, UnloadModel() leaves
+*   textures to the caller.
+*
+*   When a cache directory is set, every decoded image is stored there as a texture cache
+*   file with its full mip chain (see rtexcache.h). Later runs map the cache file instead
+*   of decoding, so startup is bound by I/O rather than by image decoding.
+*
+*   With texture compression enabled, decoded images are block compressed on the workers
+*   (see rbcenc.h) before being cached: DXT1 for color maps, DXT5 for maps with alpha and
+*   DXT5nm for normal maps. Data maps stay uncompressed: DXT1 fits one color line per block,
+*   so occlusion, roughness and metalness packed in one map would bleed into each other.
+*
+*   With a texture stream, every image becomes one streamed texture shared by its slots and
+*   only its coarsest levels are uploaded, finer ones follow the usage (see rtexstream.h).
+*
+*   CONFIGURATION:
+*
+*   #define RTEXLOAD_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+*   DEPENDENCIES:
+*       rjobs.h     - JobPool used to decode images
+*       rtexcache.h - Texture cache files and CPU mipmap generation
+*       rtexstream.h - Streamed textures
+*       rbcenc.h    - Block compression of decoded images
+*       cgltf       - Compiled into raylib, used to read the glTF material table
+*
+**********************************************************************************************/
+
+#ifndef RTEXLOAD_H
+#define RTEXLOAD_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define TEXLOAD_MAX_REQUESTS    256     // Max material texture slots read from a glTF file
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Texture to be loaded into a material map slot
+typedef struct TextureRequest {
+    char fileName[256];         // Image file path
+    int material;               // Index into model.materials
+    int map;                    // Material map index (MATERIAL_MAP_*)
+} TextureRequest;
+
+typedef struct TextureBatch TextureBatch;
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+void SetTextureCacheDirectory(const char *dirPath);                                             // Set texture cache directory (NULL to disable)
+void SetTextureCompression(bool enabled);                                                       // Block compress decoded images (see IsTextureCacheFormatSupported())
+int GetGltfTextureRequests(const char *fileName, TextureRequest *requests, int maxCount);      // Read material texture slots from glTF
+int BuildModelTextureCache(const char *fileName, JobPool *pool);                               // Rebuild texture cache files for a glTF model
+TextureBatch *LoadTextureBatchAsync(JobPool *pool, const TextureRequest *requests, int count);  // Start decoding images on pool
+int UploadTextureBatch(TextureBatch *batch, Material *materials, int materialCount);           // Wait for decodes, upload and assign textures (batch is freed)
+int UploadTextureBatchStreamed(TextureBatch *batch, Material *materials, int materialCount, TextureStream *stream); // Same, textures are streamed when stream is not NULL
+void UnloadMaterialTextures(Material *materials, int materialCount);                           // Unload material map textures, shared ones once
+
+Model LoadModelParallel(const char *fileName, JobPool *pool);   // Load model decoding its textures on pool
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTEXLOAD_H
+
+
+/***********************************************************************************
+*
+*   RTEXLOAD IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RTEXLOAD_IMPLEMENTATION)
+
+#include "raylib.h"
+#include "rlgl.h"
+#include "external/cgltf.h"     // glTF parser compiled into raylib
+
+#include <stdio.h>              // Required for: FILE, fopen(), fread(), fseek(), ftell(), fclose()
+#include <string.h>             // Required for: strcmp()
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Image decoded once and shared by all the slots referencing it
+typedef struct {
+    char fileName[256];
+    int usage;                  // TextureCacheUsage, selects mipmap filtering
+    bool rebuild;               // Ignore existing cache file
+    Image image;                // Decoded image, when not loaded from cache
+    TextureCacheFile cache;     // Mapped cache file
+    bool exported;              // Cache file written by the decode job
+    JobGroup group;             // Decode job, waited on before upload
+} TextureBatchImage;
+
+struct TextureBatch {
+    JobPool *pool;
+
+    TextureRequest *requests;
+    int *requestImage;          // Image index for every request
+    int requestCount;
+
+    TextureBatchImage *images;
+    int imageCount;
+};
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static const TextureBatch *skipBatch = NULL;    // Images LoadModel() must not decode
+static char cacheDirectory[256] = { 0 };        // Texture cache directory, empty if disabled
+static bool compressTextures = false;           // Block compress decoded images
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static unsigned char *ReadFileData(const char *fileName, int *dataSize);
+static unsigned char *LoadFileDataSkipImages(const char *fileName, int *dataSize);
+static void DecodeImageJob(void *data);
+static bool IsCacheFileCurrent(TextureCacheFile cache, int usage);
+static void CompressBatchImage(Image *image, int usage);
+static int AddBatchImage(TextureBatch *batch, const TextureRequest *request);
+static int GetMapCacheUsage(int map);
+static const char *GetCacheFileName(const char *fileName, char *buffer, int bufferSize);
+static void AddRequest(TextureRequest *requests, int *count, int maxCount, const char *basePath, const cgltf_texture_view *view, int material, int map);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Set texture cache directory, it is created if missing (NULL to disable)
+void SetTextureCacheDirectory(const char *dirPath)
+{
+    cacheDirectory[0] = '\0';
+
+    if (dirPath == NULL) return;
+
+    if (!DirectoryExists(dirPath)) MakeDirectory(dirPath);
+    if (DirectoryExists(dirPath)) TextCopy(cacheDirectory, dirPath);
+    else TraceLog(LOG_WARNING, "TEXLOAD: [%s] Failed to create texture cache directory", dirPath);
+}
+
+// Block compress decoded images, cache files with the other encoding are rebuilt
+// NOTE: Only enable when the GL context supports S3TC formats
+void SetTextureCompression(bool enabled)
+{
+    compressTextures = enabled;
+}
+
+// Read material texture slots from glTF, returns number of requests
+// NOTE: Only the JSON is parsed, buffers are not loaded. Slots match raylib LoadGLTF(), except the
+// metallic-roughness map, which goes into MATERIAL_MAP_METALNESS (occlusion r, roughness g, metalness b)
+int GetGltfTextureRequests(const char *fileName, TextureRequest *requests, int maxCount)
+{
+    cgltf_options options = { 0 };
+    cgltf_data *data = NULL;
+    int count = 0;
+
+    if (cgltf_parse_file(&options, fileName, &data) != cgltf_result_success)
+    {
+        TraceLog(LOG_WARNING, "TEXLOAD: [%s] Failed to parse glTF materials", fileName);
+        return 0;
+    }
+
+    char basePath[256] = { 0 };
+    TextCopy(basePath, GetDirectoryPath(fileName));
+
+    // NOTE: raylib reserves materials[0] for the default material
+    for (unsigned int i = 0; i < data->materials_count; i++)
+    {
+        const cgltf_material *material = &data->materials[i];
+
+        if (material->has_pbr_metallic_roughness)
+        {
+            AddRequest(requests, &count, maxCount, basePath, &material->pbr_metallic_roughness.base_color_texture, i + 1, MATERIAL_MAP_ALBEDO);
+            AddRequest(requests, &count, maxCount, basePath, &material->pbr_metallic_roughness.metallic_roughness_texture, i + 1, MATERIAL_MAP_METALNESS);
+        }
+
+        AddRequest(requests, &count, maxCount, basePath, &material->normal_texture, i + 1, MATERIAL_MAP_NORMAL);
+        AddRequest(requests, &count, maxCount, basePath, &material->occlusion_texture, i + 1, MATERIAL_MAP_OCCLUSION);
+        AddRequest(requests, &count, maxCount, basePath, &material->emissive_texture, i + 1, MATERIAL_MAP_EMISSION);
+    }
+
+    cgltf_free(data);
+
+    return count;
+}
+
+// Start decoding images on pool, every distinct file is decoded once
+TextureBatch *LoadTextureBatchAsync(JobPool *pool, const TextureRequest *requests, int count)
+{
+    TextureBatch *batch = (TextureBatch *)RL_CALLOC(1, sizeof(TextureBatch));
+
+    batch->pool = pool;
+    batch->requestCount = count;
+    batch->requests = (TextureRequest *)RL_CALLOC(count, sizeof(TextureRequest));
+    batch->requestImage = (int *)RL_CALLOC(count, sizeof(int));
+    batch->images = (TextureBatchImage *)RL_CALLOC(count, sizeof(TextureBatchImage));
+
+    for (int i = 0; i < count; i++)
+    {
+        batch->requests[i] = requests[i];
+        batch->requestImage[i] = AddBatchImage(batch, &requests[i]);
+    }
+
+    // NOTE: Images array is not resized after this point, jobs keep pointers into it
+    for (int i = 0; i < batch->imageCount; i++) SubmitJob(pool, DecodeImageJob, &batch->images[i], &batch->images[i].group);
+
+    return batch;
+}
+
+// Wait for decodes in submission order, upload and assign textures to material slots
+// NOTE: Must be called from the thread owning the GL context, batch is freed
+int UploadTextureBatch(TextureBatch *batch, Material *materials, int materialCount)
+{
+    return UploadTextureBatchStreamed(batch, materials, materialCount, NULL);
+}
+
+// Wait for decodes in submission order, assign every image to its slots as one streamed texture
+// NOTE: Images the stream can not take are uploaded in full, one texture shared by their slots
+int UploadTextureBatchStreamed(TextureBatch *batch, Material *materials, int materialCount, TextureStream *stream)
+{
+    if (batch == NULL) return 0;
+
+    int uploaded = 0;
+
+    for (int i = 0; i < batch->imageCount; i++)
+    {
+        TextureBatchImage *image = &batch->images[i];
+
+        WaitJobGroup(batch->pool, &image->group);
+
+        if ((image->image.data == NULL) && (image->cache.data == NULL))
+        {
+            TraceLog(LOG_WARNING, "TEXLOAD: [%s] Failed to decode image", image->fileName);
+            continue;
+        }
+
+        // Decoded images go through the cache file path too, compressed chains need their max level set
+        TextureCacheFile chain = (image->cache.data != NULL)? image->cache :
+            (TextureCacheFile){ NULL, 0, image->image.data, image->image.width, image->image.height, image->image.mipmaps, image->image.format };
+        int streamed = (stream != NULL)? AddStreamedTexture(stream, chain, (image->cache.data != NULL)? NULL : image->image.data) : -1;
+
+        if (streamed >= 0)
+        {
+            // The stream owns the chain now
+            image->cache = (TextureCacheFile){ 0 };
+            image->image.data = NULL;
+        }
+
+        // One texture per image, uploaded with its first slot and shared by the others
+        Texture2D texture = { 0 };
+
+        for (int r = 0; r < batch->requestCount; r++)
+        {
+            const TextureRequest *request = &batch->requests[r];
+
+            if ((batch->requestImage[r] != i) || (request->material >= materialCount)) continue;
+
+            MaterialMap *map = &materials[request->material].maps[request->map];
+            if ((map->texture.id != 0) && (map->texture.id != rlGetTextureIdDefault())) UnloadTexture(map->texture);
+
+            if (streamed >= 0) SetStreamedTextureSlot(stream, streamed, materials, request->material, request->map);
+            else
+            {
+                if (texture.id == 0) texture = LoadTextureFromCacheFile(chain);
+                map->texture = texture;
+            }
+            uploaded++;
+        }
+
+        UnloadTextureCacheFile(image->cache);
+        UnloadImage(image->image);
+    }
+
+    RL_FREE(batch->images);
+    RL_FREE(batch->requestImage);
+    RL_FREE(batch->requests);
+    RL_FREE(batch);
+
+    return uploaded;
+}
+
+// Unload material map textures, a texture shared by several slots is unloaded once
+// NOTE: Slots are cleared, the default texture is left alone
+void UnloadMaterialTextures(Material *materials, int materialCount)
+{
+    for (int i = 0; i < materialCount; i++)
+    {
+        for (int m = 0; m < MAX_MATERIAL_MAPS; m++)
+        {
+            Texture2D texture = materials[i].maps[m].texture;
+            if ((texture.id == 0) || (texture.id == rlGetTextureIdDefault())) continue;
+
+            UnloadTexture(texture);
+
+            // Clear every slot sharing it, later ones are then skipped
+            for (int j = i; j < materialCount; j++)
+            {
+                for (int n = 0; n < MAX_MATERIAL_MAPS; n++)
+                {
+                    if (materials[j].maps[n].texture.id == texture.id) materials[j].maps[n].texture = (Texture2D){ 0 };
+                }
+            }
+        }
+    }
+}
+
+// Load model decoding its textures on pool
+// NOTE: Image decodes overlap raylib parsing the glTF and loading its buffers
+Model LoadModelParallel(const char *fileName, JobPool *pool)
+{
+    TextureRequest *requests = (TextureRequest *)RL_CALLOC(TEXLOAD_MAX_REQUESTS, sizeof(TextureRequest));
+    int requestCount = GetGltfTextureRequests(fileName, requests, TEXLOAD_MAX_REQUESTS);
+
+    TextureBatch *batch = LoadTextureBatchAsync(pool, requests, requestCount);
+    RL_FREE(requests);
+
+    // Make raylib skip decoding the images the batch already takes care of
+    skipBatch = batch;
+    SetLoadFileDataCallback(LoadFileDataSkipImages);
+
+    Model model = LoadModel(fileName);
+
+    SetLoadFileDataCallback(NULL);
+    skipBatch = NULL;
+
+    int uploaded = UploadTextureBatch(batch, model.materials, model.materialCount);
+    TraceLog(LOG_INFO, "TEXLOAD: [%s] %i textures decoded on %i threads", fileName, uploaded, GetJobPoolThreadCount(pool) + 1);
+
+    return model;
+}
+
+// Rebuild texture cache files for all the images referenced by a glTF model, returns number of files written
+// NOTE: Does not require a GL context, can run as an offline build step
+int BuildModelTextureCache(const char *fileName, JobPool *pool)
+{
+    if (cacheDirectory[0] == '\0') return 0;
+
+    TextureRequest *requests = (TextureRequest *)RL_CALLOC(TEXLOAD_MAX_REQUESTS, sizeof(TextureRequest));
+    int requestCount = GetGltfTextureRequests(fileName, requests, TEXLOAD_MAX_REQUESTS);
+
+    TextureBatch *batch = (TextureBatch *)RL_CALLOC(1, sizeof(TextureBatch));
+    batch->images = (TextureBatchImage *)RL_CALLOC(requestCount + 1, sizeof(TextureBatchImage));
+
+    for (int i = 0; i < requestCount; i++) batch->images[AddBatchImage(batch, &requests[i])].rebuild = true;
+
+    JobGroup group = { 0 };
+    for (int i = 0; i < batch->imageCount; i++) SubmitJob(pool, DecodeImageJob, &batch->images[i], &group);
+    WaitJobGroup(pool, &group);
+
+    int built = 0;
+    for (int i = 0; i < batch->imageCount; i++)
+    {
+        if (batch->images[i].exported) built++;
+        else TraceLog(LOG_WARNING, "TEXLOAD: [%s] Failed to build texture cache file", batch->images[i].fileName);
+
+        UnloadImage(batch->images[i].image);
+    }
+
+    TraceLog(LOG_INFO, "TEXLOAD: [%s] %i texture cache files built in %s", fileName, built, cacheDirectory);
+
+    RL_FREE(batch->images);
+    RL_FREE(batch);
+    RL_FREE(requests);
+
+    return built;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Read whole file into memory
+// NOTE: Used instead of LoadFileData(), it is safe to call from worker threads
+static unsigned char *ReadFileData(const char *fileName, int *dataSize)
+{
+    unsigned char *data = NULL;
+    *dataSize = 0;
+
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL) return NULL;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if (size > 0)
+    {
+        data = (unsigned char *)RL_MALLOC(size);
+        if ((data != NULL) && (fread(data, 1, size, file) == (size_t)size)) *dataSize = (int)size;
+        else
+        {
+            RL_FREE(data);
+            data = NULL;
+        }
+    }
+
+    fclose(file);
+
+    return data;
+}
+
+// File data callback used while LoadModel() runs, images handled by the batch are not loaded
+// NOTE: raylib leaves the material slot untouched when image data can not be loaded
+static unsigned char *LoadFileDataSkipImages(const char *fileName, int *dataSize)
+{
+    if (skipBatch != NULL)
+    {
+        for (int i = 0; i < skipBatch->imageCount; i++)
+        {
+            if (strcmp(GetFileName(fileName), GetFileName(skipBatch->images[i].fileName)) == 0)
+            {
+                *dataSize = 0;
+                return NULL;
+            }
+        }
+    }
+
+    return ReadFileData(fileName, dataSize);
+}
+
+// Map cached image or read and decode it, runs on a worker thread
+// NOTE: Decoded images get their mip chain generated and written to the cache
+static void DecodeImageJob(void *data)
+{
+    TextureBatchImage *image = (TextureBatchImage *)data;
+
+    char cacheFileName[512] = { 0 };
+    bool cached = (cacheDirectory[0] != '\0');
+    long modTime = GetFileModTime(image->fileName);
+
+    if (cached && !image->rebuild)
+    {
+        image->cache = LoadTextureCacheFile(GetCacheFileName(image->fileName, cacheFileName, sizeof(cacheFileName)), modTime);
+        if (IsCacheFileCurrent(image->cache, image->usage)) return;
+
+        UnloadTextureCacheFile(image->cache);
+        image->cache = (TextureCacheFile){ 0 };
+    }
+
+    int dataSize = 0;
+    unsigned char *fileData = ReadFileData(image->fileName, &dataSize);
+
+    if (fileData != NULL)
+    {
+        image->image = LoadImageFromMemory(GetFileExtension(image->fileName), fileData, dataSize);
+        RL_FREE(fileData);
+    }
+
+    if (image->image.data != NULL)
+    {
+        GenImageMipmapsFiltered(&image->image, image->usage);
+        if (compressTextures) CompressBatchImage(&image->image, image->usage);
+
+        if (cached) image->exported = ExportTextureCache(image->image, modTime, GetCacheFileName(image->fileName, cacheFileName, sizeof(cacheFileName)));
+    }
+}
+
+// Check mapped cache file matches the current compression setting
+// NOTE: Uncompressed files stay valid with compression on when their size is not made of whole blocks
+// or they hold data maps, compressed data maps written by older builds are rebuilt
+static bool IsCacheFileCurrent(TextureCacheFile cache, int usage)
+{
+    if (cache.data == NULL) return false;
+
+    bool compressed = (cache.format >= PIXELFORMAT_COMPRESSED_DXT1_RGB);
+    bool compressible = ((cache.width%4) == 0) && ((cache.height%4) == 0) && (usage != TEXCACHE_DATA);
+
+    return compressTextures? (compressed || !compressible) : !compressed;
+}
+
+// Block compress decoded image and its mip chain, runs on a worker thread
+// NOTE: Images are already spread over the pool, blocks of one image are encoded serially
+static void CompressBatchImage(Image *image, int usage)
+{
+    int format = PIXELFORMAT_COMPRESSED_DXT1_RGB;
+    int flags = 0;
+
+    // Data maps pack independent channels (MRA: occlusion r, roughness g, metalness b), DXT1 shares
+    // one endpoint line between them and BC4/BC5 are not raylib pixel formats (see --bc-report)
+    if (usage == TEXCACHE_DATA) return;
+
+    if (usage == TEXCACHE_NORMAL)
+    {
+        format = PIXELFORMAT_COMPRESSED_DXT5_RGBA;
+        flags = BC_FLAG_NORMAL_XY;
+    }
+    else if ((image->format == PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA) || (image->format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8))
+    {
+        // Keep alpha only when some texel is not opaque
+        int channels = (image->format == PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA)? 2 : 4;
+        const unsigned char *pixels = (const unsigned char *)image->data;
+
+        for (long long i = 0; i < (long long)image->width*image->height; i++)
+        {
+            if (pixels[i*channels + channels - 1] < 255)
+            {
+                format = PIXELFORMAT_COMPRESSED_DXT5_RGBA;
+                break;
+            }
+        }
+    }
+
+    ImageCompressBC(image, format, flags, NULL);
+}
+
+// Add image for request unless the same file is already in the batch, returns image index
+// NOTE: Images array must have room for one image per request
+static int AddBatchImage(TextureBatch *batch, const TextureRequest *request)
+{
+    int image = 0;
+    while ((image < batch->imageCount) && (strcmp(batch->images[image].fileName, request->fileName) != 0)) image++;
+
+    if (image == batch->imageCount)
+    {
+        TextCopy(batch->images[image].fileName, request->fileName);
+        batch->images[image].usage = GetMapCacheUsage(request->map);
+        batch->imageCount++;
+    }
+
+    return image;
+}
+
+// Get mipmap filtering for a material map slot
+static int GetMapCacheUsage(int map)
+{
+    if ((map == MATERIAL_MAP_ALBEDO) || (map == MATERIAL_MAP_EMISSION)) return TEXCACHE_COLOR;
+    if (map == MATERIAL_MAP_NORMAL) return TEXCACHE_NORMAL;
+
+    return TEXCACHE_DATA;
+}
+
+// Get cache file name for a source image, written into buffer
+// NOTE: Does not use TextFormat() static buffers, it is called from worker threads
+static const char *GetCacheFileName(const char *fileName, char *buffer, int bufferSize)
+{
+    snprintf(buffer, bufferSize, "%s/%s%s", cacheDirectory, GetFileName(fileName), TEXCACHE_FILE_EXT);
+
+    return buffer;
+}
+
+// Add request for a texture view referencing an external image file
+static void AddRequest(TextureRequest *requests, int *count, int maxCount, const char *basePath, const cgltf_texture_view *view, int material, int map)
+{
+    if ((view->texture == NULL) || (view->texture->image == NULL)) return;
+
+    const char *uri = view->texture->image->uri;
+
+    // NOTE: Embedded images (data URIs, buffer views) are still decoded by LoadModel()
+    if ((uri == NULL) || (strncmp(uri, "data:", 5) == 0)) return;
+
+    if (*count >= maxCount)
+    {
+        TraceLog(LOG_WARNING, "TEXLOAD: Too many texture requests, max is %i", maxCount);
+        return;
+    }
+
+    snprintf(requests[*count].fileName, sizeof(requests[*count].fileName), "%s/%s", basePath, uri);
+    requests[*count].material = material;
+    requests[*count].map = map;
+    (*count)++;
+}
+
+#endif // RTEXLOAD_IMPLEMENTATION
@@ -0,0 +1,481 @@
+/**********************************************************************************************
+*
+*   raylib.texstream - Texture streaming with a memory budget and LRU mip residency
+*
+*   Streamed textures keep their whole mip chain in CPU memory (usually a mapped texture cache
+*   file, see rtexcache.h) and only a tail of it on the GPU: every texture starts with the
+*   levels of TEXSTREAM_MIN_SIZE texels and smaller, and finer levels are added one at a time
+*   when the views ask for them.
+*
+*   Usage feedback comes from the caller every frame as screen pixels per UV unit for every
+*   material (see rscene.h, culling computes it for the visible meshes). A texture of size S
+*   seen at P pixels per UV unit samples level log2(S/P), that level becomes its wanted level.
+*
+*   A finer level is first read from the chain on a JobPool (page faults of the mapping happen
+*   there), then uploaded on the GL thread within TEXSTREAM_UPLOAD_BUDGET bytes per frame.
+*   GL 3.3 has no sparse textures, so changing the resident levels re-creates the texture from
+*   the chain, which costs the new finest level plus a third of it for the coarser ones.
+*
+*   When an upload does not fit the budget, textures give back levels in least recently used
+*   order: first the ones no view asked for the longest, then levels finer than wanted by
+*   textures in use. Textures in use never drop below their wanted level, when nothing else
+*   can be evicted the upload waits.
+*
+*   CONFIGURATION:
+*
+*   #define RTEXSTREAM_IMPLEMENTATION
+*       Generates the implementation of the library into the included file.
+*       If not defined, the library is in header only mode and can be included in other headers
+*       or source files without problems. But only ONE file should hold the implementation.
+*
+*   DEPENDENCIES:
+*       rjobs.h     - JobPool used to read mip levels
+*       rtexcache.h - Texture cache files holding the mip chains
+*
+**********************************************************************************************/
+
+#ifndef RTEXSTREAM_H
+#define RTEXSTREAM_H
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define TEXSTREAM_MAX_TEXTURES  256             // Max streamed textures
+#define TEXSTREAM_MAX_LEVELS    16              // Max mip levels of a streamed texture
+#define TEXSTREAM_MAX_SLOTS     8               // Max material map slots sharing a streamed texture
+#define TEXSTREAM_MIN_SIZE      64              // Levels this size and smaller are always resident
+#define TEXSTREAM_MAX_PENDING   16              // Max mip level reads in flight
+#define TEXSTREAM_UPLOAD_BUDGET (4*1024*1024)   // Bytes uploaded per frame, the first upload of a frame always goes through
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Streaming statistics, upload figures are for the last update
+typedef struct TextureStreamStats {
+    int textures;
+    int texturesWanted;         // Textures resident down to their wanted level
+    int pending;                // Level reads in flight or waiting for upload
+    long long budget;
+    long long residentBytes;
+    long long wantedBytes;      // Resident bytes with every texture at its wanted level
+    long long fullBytes;        // Resident bytes with every texture at full resolution
+    int uploads;                // Texture uploads, evictions included
+    int evictions;              // Textures dropped to a coarser level
+    long long uploadBytes;
+    double uploadTime;          // Seconds spent uploading
+} TextureStreamStats;
+
+typedef struct TextureStream TextureStream;
+
+#ifdef __cplusplus
+extern "C" {            // Prevents name mangling of functions
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+TextureStream *LoadTextureStream(JobPool *pool, long long budget);                  // Create texture stream, levels are read on pool
+void UnloadTextureStream(TextureStream *stream);                                    // Unload textures and chains, clears their material slots
+int AddStreamedTexture(TextureStream *stream, TextureCacheFile chain, void *chainData);     // Upload coarsest levels, on success stream owns chain (and chainData if not NULL)
+void SetStreamedTextureSlot(TextureStream *stream, int texture, Material *materials, int material, int map);   // Assign texture to a material map slot, kept updated
+TextureStreamStats UpdateTextureStream(TextureStream *stream, float *materialUsage, int materialCount);    // Apply usage feedback, evict and upload levels (usage is cleared)
+TextureStreamStats GetTextureStreamStats(const TextureStream *stream);              // Get statistics of the last update
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTEXSTREAM_H
+
+
+/***********************************************************************************
+*
+*   RTEXSTREAM IMPLEMENTATION
+*
+************************************************************************************/
+
+#if defined(RTEXSTREAM_IMPLEMENTATION)
+
+#include "raylib.h"
+
+#if !defined(_WIN32)
+    #include <sys/mman.h>       // Required for: madvise()
+    #include <unistd.h>         // Required for: sysconf()
+#endif
+
+#include <stdlib.h>             // Required for: qsort()
+#include <math.h>               // Required for: log2f(), floorf()
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Material map slot showing a streamed texture
+typedef struct {
+    Material *materials;
+    int material;
+    int map;
+} StreamSlot;
+
+typedef struct {
+    TextureCacheFile chain;     // Whole mip chain, mapped file or memory
+    void *chainData;            // Chain memory owned by the stream, NULL for mapped files
+    long long levelOffsets[TEXSTREAM_MAX_LEVELS + 1];   // Level offsets into the chain, the last one is the chain size
+    int baseLevel;              // Coarsest streamed level, resident from the start
+    int residentLevel;          // Finest resident level
+    int wantedLevel;            // Finest level the views sample
+    int requestLevel;           // Level read by the pending job, -1 if none
+    JobGroup group;
+    unsigned int lastUsedFrame;
+    Texture2D texture;
+    StreamSlot slots[TEXSTREAM_MAX_SLOTS];
+    int slotCount;
+} StreamTexture;
+
+struct TextureStream {
+    JobPool *pool;
+    StreamTexture *textures;    // Not resized, pending jobs keep pointers into it
+    int textureCount;
+    unsigned int frame;
+    TextureStreamStats stats;
+};
+
+// Upload candidate, finer levels first for the textures furthest from their wanted level
+typedef struct {
+    int texture;
+    int missing;                // Levels between resident and wanted level
+} StreamCandidate;
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static long long GetLevelBytes(const StreamTexture *texture, int level);
+static void SetResidentLevel(TextureStream *stream, StreamTexture *texture, int level);
+static bool MakeStreamRoom(TextureStream *stream, long long size, const StreamTexture *keep);
+static void ReadLevelJob(void *data);
+static int CompareCandidates(const void *a, const void *b);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+
+// Create texture stream with a budget in bytes for the resident levels, levels are read on pool
+TextureStream *LoadTextureStream(JobPool *pool, long long budget)
+{
+    TextureStream *stream = (TextureStream *)RL_CALLOC(1, sizeof(TextureStream));
+
+    stream->pool = pool;
+    stream->textures = (StreamTexture *)RL_CALLOC(TEXSTREAM_MAX_TEXTURES, sizeof(StreamTexture));
+    stream->stats.budget = budget;
+
+    TraceLog(LOG_INFO, "TEXSTREAM: Budget %.2f MB, up to %.2f MB uploaded per frame", budget/(1024.0*1024.0), TEXSTREAM_UPLOAD_BUDGET/(1024.0*1024.0));
+
+    return stream;
+}
+
+// Unload textures and chains, their material slots are cleared
+// NOTE: Call before the materials are unloaded (UnloadScene() skips cleared slots)
+void UnloadTextureStream(TextureStream *stream)
+{
+    if (stream == NULL) return;
+
+    for (int i = 0; i < stream->textureCount; i++)
+    {
+        StreamTexture *texture = &stream->textures[i];
+
+        if (texture->requestLevel >= 0) WaitJobGroup(stream->pool, &texture->group);
+
+        for (int s = 0; s < texture->slotCount; s++) texture->slots[s].materials[texture->slots[s].material].maps[texture->slots[s].map].texture = (Texture2D){ 0 };
+
+        UnloadTexture(texture->texture);
+        UnloadTextureCacheFile(texture->chain);
+        RL_FREE(texture->chainData);
+    }
+
+    RL_FREE(stream->textures);
+    RL_FREE(stream);
+}
+
+// Upload the coarsest levels of a mip chain, returns texture index or -1 on failure
+// NOTE: On success the stream owns the chain: a mapped file is unmapped, chainData is freed.
+// On failure the caller keeps both
+int AddStreamedTexture(TextureStream *stream, TextureCacheFile chain, void *chainData)
+{
+    if ((chain.data == NULL) || (stream->textureCount >= TEXSTREAM_MAX_TEXTURES) || (chain.mipmaps > TEXSTREAM_MAX_LEVELS))
+    {
+        if (chain.data != NULL) TraceLog(LOG_WARNING, "TEXSTREAM: Texture can not be streamed (%i textures, %i levels)", stream->textureCount, chain.mipmaps);
+        return -1;
+    }
+
+    StreamTexture *texture = &stream->textures[stream->textureCount];
+    texture->chain = chain;
+    texture->chainData = chainData;
+    texture->requestLevel = -1;
+
+    for (int i = 0, w = chain.width, h = chain.height; i < chain.mipmaps; i++)
+    {
+        texture->levelOffsets[i + 1] = texture->levelOffsets[i] + GetPixelDataSize(w, h, chain.format);
+        if ((w > TEXSTREAM_MIN_SIZE) || (h > TEXSTREAM_MIN_SIZE)) texture->baseLevel = i + 1;
+        w = (w > 1)? w/2 : 1;
+        h = (h > 1)? h/2 : 1;
+    }
+
+    if (texture->baseLevel >= chain.mipmaps) texture->baseLevel = chain.mipmaps - 1;
+    texture->residentLevel = texture->baseLevel;
+    texture->wantedLevel = texture->baseLevel;
+
+    SetResidentLevel(stream, texture, texture->baseLevel);
+    if (texture->texture.id == 0)
+    {
+        *texture = (StreamTexture){ 0 };
+
+        return -1;
+    }
+
+    stream->stats.textures++;
+    stream->stats.fullBytes += GetLevelBytes(texture, 0);
+
+    return stream->textureCount++;
+}
+
+// Assign streamed texture to a material map slot, the slot follows every level change
+void SetStreamedTextureSlot(TextureStream *stream, int texture, Material *materials, int material, int map)
+{
+    if ((texture < 0) || (texture >= stream->textureCount)) return;
+
+    StreamTexture *streamed = &stream->textures[texture];
+
+    if (streamed->slotCount < TEXSTREAM_MAX_SLOTS) streamed->slots[streamed->slotCount++] = (StreamSlot){ materials, material, map };
+    else TraceLog(LOG_WARNING, "TEXSTREAM: Texture %i is used by more than %i slots", texture, TEXSTREAM_MAX_SLOTS);
+
+    materials[material].maps[map].texture = streamed->texture;
+}
+
+// Apply usage feedback (screen pixels per UV unit per material, cleared afterwards),
+// upload levels that finished reading, evict LRU levels to make room and start new reads
+// NOTE: Must be called once per frame from the thread owning the GL context
+TextureStreamStats UpdateTextureStream(TextureStream *stream, float *materialUsage, int materialCount)
+{
+    stream->frame++;
+    stream->stats.uploads = 0;
+    stream->stats.evictions = 0;
+    stream->stats.uploadBytes = 0;
+    stream->stats.uploadTime = 0.0;
+
+    // Wanted levels from the usage of the materials showing every texture
+    StreamCandidate candidates[TEXSTREAM_MAX_TEXTURES] = { 0 };
+    int candidateCount = 0;
+
+    for (int i = 0; i < stream->textureCount; i++)
+    {
+        StreamTexture *texture = &stream->textures[i];
+        float usage = 0.0f;
+
+        for (int s = 0; s < texture->slotCount; s++)
+        {
+            int material = texture->slots[s].material;
+            if ((material < materialCount) && (materialUsage[material] > usage)) usage = materialUsage[material];
+        }
+
+        texture->wantedLevel = texture->baseLevel;
+
+        if (usage > 0.0f)
+        {
+            int size = (texture->chain.width > texture->chain.height)? texture->chain.width : texture->chain.height;
+            float level = floorf(log2f((float)size/usage));
+
+            texture->lastUsedFrame = stream->frame;
+            texture->wantedLevel = (level < 0.0f)? 0 : (level > (float)texture->baseLevel)? texture->baseLevel : (int)level;
+        }
+
+        if (texture->wantedLevel < texture->residentLevel) candidates[candidateCount++] = (StreamCandidate){ i, texture->residentLevel - texture->wantedLevel };
+    }
+
+    for (int i = 0; i < materialCount; i++) materialUsage[i] = 0.0f;
+
+    qsort(candidates, candidateCount, sizeof(StreamCandidate), CompareCandidates);
+
+    // Drop finished reads no longer wanted (evicted, or the wanted level rose while reading)
+    // NOTE: All textures are checked, a texture that stopped being a candidate must not hold a pending read
+    for (int i = 0; i < stream->textureCount; i++)
+    {
+        StreamTexture *texture = &stream->textures[i];
+
+        if ((texture->requestLevel < 0) || !IsJobGroupDone(stream->pool, &texture->group)) continue;
+        if ((texture->requestLevel >= texture->residentLevel) || (texture->wantedLevel >= texture->residentLevel)) texture->requestLevel = -1;
+    }
+
+    // Upload levels that finished reading, one level per texture and frame
+    int pending = 0;
+    int uploads = 0;
+    double uploadStart = GetTime();
+
+    for (int c = 0; c < candidateCount; c++)
+    {
+        StreamTexture *texture = &stream->textures[candidates[c].texture];
+
+        if ((texture->requestLevel < 0) || !IsJobGroupDone(stream->pool, &texture->group)) continue;
+
+        int level = texture->requestLevel;
+        long long size = GetLevelBytes(texture, level);
+
+        if ((uploads > 0) && (stream->stats.uploadBytes + size > TEXSTREAM_UPLOAD_BUDGET)) break;
+        if (!MakeStreamRoom(stream, size - GetLevelBytes(texture, texture->residentLevel), texture)) continue;
+
+        SetResidentLevel(stream, texture, level);
+        texture->requestLevel = -1;
+        uploads++;
+    }
+
+    stream->stats.uploadTime = GetTime() - uploadStart;
+
+    // Start reading the next finer level of the textures still missing some
+    for (int i = 0; i < stream->textureCount; i++) if (stream->textures[i].requestLevel >= 0) pending++;
+
+    for (int c = 0; (c < candidateCount) && (pending < TEXSTREAM_MAX_PENDING); c++)
+    {
+        StreamTexture *texture = &stream->textures[candidates[c].texture];
+
+        if ((texture->requestLevel >= 0) || (texture->wantedLevel >= texture->residentLevel)) continue;
+
+        texture->requestLevel = texture->residentLevel - 1;
+        SubmitJob(stream->pool, ReadLevelJob, texture, &texture->group);
+        pending++;
+    }
+
+    // Residency statistics
+    stream->stats.pending = pending;
+    stream->stats.texturesWanted = 0;
+    stream->stats.wantedBytes = 0;
+
+    for (int i = 0; i < stream->textureCount; i++)
+    {
+        const StreamTexture *texture = &stream->textures[i];
+
+        if (texture->residentLevel <= texture->wantedLevel) stream->stats.texturesWanted++;
+        stream->stats.wantedBytes += GetLevelBytes(texture, texture->wantedLevel);
+    }
+
+    return stream->stats;
+}
+
+// Get statistics of the last update
+TextureStreamStats GetTextureStreamStats(const TextureStream *stream)
+{
+    return (stream != NULL)? stream->stats : (TextureStreamStats){ 0 };
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+
+// Get GPU bytes of a texture with level as its finest resident level
+static long long GetLevelBytes(const StreamTexture *texture, int level)
+{
+    return texture->levelOffsets[texture->chain.mipmaps] - texture->levelOffsets[level];
+}
+
+// Re-create texture with level as its finest level and update the slots showing it
+// NOTE: The chain tail starting at level is laid out like a full chain of a smaller texture
+static void SetResidentLevel(TextureStream *stream, StreamTexture *texture, int level)
+{
+    TextureCacheFile view = texture->chain;
+    view.data = (const unsigned char *)texture->chain.data + texture->levelOffsets[level];
+    view.width = (texture->chain.width >> level > 1)? texture->chain.width >> level : 1;
+    view.height = (texture->chain.height >> level > 1)? texture->chain.height >> level : 1;
+    view.mipmaps = texture->chain.mipmaps - level;
+
+    Texture2D resident = LoadTextureFromCacheFile(view);
+    if (resident.id == 0)
+    {
+        TraceLog(LOG_WARNING, "TEXSTREAM: Failed to upload level %i", level);
+        return;
+    }
+
+    if (texture->texture.id != 0)
+    {
+        stream->stats.residentBytes -= GetLevelBytes(texture, texture->residentLevel);
+        UnloadTexture(texture->texture);
+    }
+
+    texture->texture = resident;
+    texture->residentLevel = level;
+
+    for (int s = 0; s < texture->slotCount; s++) texture->slots[s].materials[texture->slots[s].material].maps[texture->slots[s].map].texture = resident;
+
+    stream->stats.residentBytes += GetLevelBytes(texture, level);
+    stream->stats.uploadBytes += GetLevelBytes(texture, level);
+    stream->stats.uploads++;
+}
+
+// Evict levels until size more bytes fit the budget, least recently used textures first
+// NOTE: Textures in use keep their wanted level, returns false when there is nothing left to evict
+static bool MakeStreamRoom(TextureStream *stream, long long size, const StreamTexture *keep)
+{
+    while (stream->stats.residentBytes + size > stream->stats.budget)
+    {
+        StreamTexture *victim = NULL;
+
+        for (int i = 0; i < stream->textureCount; i++)
+        {
+            StreamTexture *texture = &stream->textures[i];
+
+            if ((texture == keep) || (texture->residentLevel >= texture->wantedLevel)) continue;
+
+            if ((victim == NULL) || (texture->lastUsedFrame < victim->lastUsedFrame) ||
+                ((texture->lastUsedFrame == victim->lastUsedFrame) && (GetLevelBytes(texture, texture->residentLevel) > GetLevelBytes(victim, victim->residentLevel)))) victim = texture;
+        }
+
+        if (victim == NULL) return false;
+
+        // Drop just enough levels, every drop is one more upload of the remaining chain
+        long long resident = GetLevelBytes(victim, victim->residentLevel);
+        int level = victim->residentLevel + 1;
+
+        while ((level < victim->wantedLevel) && (stream->stats.residentBytes - resident + GetLevelBytes(victim, level) + size > stream->stats.budget)) level++;
+
+        int previous = victim->residentLevel;
+        SetResidentLevel(stream, victim, level);
+        if (victim->residentLevel == previous) return false;
+
+        stream->stats.evictions++;
+    }
+
+    return true;
+}
+
+// Read a level from the chain so the upload does not wait on page faults, runs on a worker thread
+static void ReadLevelJob(void *data)
+{
+    const StreamTexture *texture = (const StreamTexture *)data;
+    const unsigned char *start = (const unsigned char *)texture->chain.data + texture->levelOffsets[texture->requestLevel];
+    long long size = texture->levelOffsets[texture->requestLevel + 1] - texture->levelOffsets[texture->requestLevel];
+    long long page = 4096;
+
+#if !defined(_WIN32)
+    page = sysconf(_SC_PAGESIZE);
+
+    if (texture->chain.mapping != NULL)
+    {
+        // madvise() wants a page aligned start
+        const unsigned char *aligned = (const unsigned char *)((size_t)start & ~(size_t)(page - 1));
+        madvise((void *)aligned, (size_t)(start + size - aligned), MADV_WILLNEED);
+    }
+#endif
+
+    volatile unsigned char sum = 0;
+    for (long long i = 0; i < size; i += page) sum += start[i];
+    (void)sum;
+}
+
+// Compare upload candidates, most missing levels first
+static int CompareCandidates(const void *a, const void *b)
+{
+    const StreamCandidate *candidateA = (const StreamCandidate *)a;
+    const StreamCandidate *candidateB = (const StreamCandidate *)b;
+
+    if (candidateA->missing != candidateB->missing) return candidateB->missing - candidateA->missing;
+
+    return candidateA->texture - candidateB->texture;
+}
+
+#endif // RTEXSTREAM_IMPLEMENTATION
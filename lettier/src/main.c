@@ -1,69 +1,324 @@
 #include "raylib.h"
 
+#define RBENCH_IMPLEMENTATION
+#include "includes/rbench.h"
+#define RPROF_IMPLEMENTATION
+#include "common/rprof.h"               // Included before rjobs.h, jobs are recorded as scopes
+#define RJOBS_IMPLEMENTATION
+#include "common/rjobs.h"
+#define RBCENC_IMPLEMENTATION
+#include "includes/rbcenc.h"
+#define RTEXCACHE_IMPLEMENTATION
+#include "includes/rtexcache.h"
+#define RTEXSTREAM_IMPLEMENTATION
+#include "includes/rtexstream.h"
+#define RTEXLOAD_IMPLEMENTATION
+#include "includes/rtexload.h"
+#define RCULL_IMPLEMENTATION
+#include "includes/rcull.h"
+#define ROCCLUDE_IMPLEMENTATION
+#include "includes/rocclude.h"
+#define RSOFT_IMPLEMENTATION
+#include "common/rsoft.h"
+#define RSIMPLIFY_IMPLEMENTATION
+#include "includes/rsimplify.h"
+#define RMESHOPT_IMPLEMENTATION
+#include "includes/rmeshopt.h"
+#define RSCENE_IMPLEMENTATION
+#include "includes/rscene.h"
+#define RLIGHTS_IMPLEMENTATION
+#include "common/rlights.h"
+#define RCLUSTER_IMPLEMENTATION
+#include "includes/rcluster.h"
+#define RSHADOW_IMPLEMENTATION
+#include "includes/rshadow.h"
+#define RPOST_IMPLEMENTATION
+#include "common/rpost.h"
+#define ROIT_IMPLEMENTATION
+#include "includes/roit.h"
+#define RSHADER_IMPLEMENTATION
+#include "common/rshader.h"
+#define RQUEUE_IMPLEMENTATION
+#include "includes/rqueue.h"
+
+#include "raymath.h"            // Required for: MatrixMultiply(), MatrixScale(), MatrixTranslate()
+#include "rlgl.h"               // Required for: rlGetTextureIdDefault()
+
+#include <math.h>               // Required for: sinf(), cosf(), log10()
+
 #if defined(PLATFORM_DESKTOP)
 #define GLSL_VERSION            330
 #else   // PLATFORM_ANDROID, PLATFORM_WEB
 #define GLSL_VERSION            100
 #endif
 
-#define MAX_LIGHTS 4
+#define TEXTURE_CACHE_DIR       "resources/cache"   // Texture cache files with prebuilt mipmaps
+#define SHADER_CACHE_DIR        TEXTURE_CACHE_DIR "/shaders"    // Linked shader program binaries
+#define SCENE_SOURCE_FILE       "resources/scene.gltf"
+#define SCENE_FILE              TEXTURE_CACHE_DIR "/scene" SCENE_FILE_EXT     // Flattened scene, built from SCENE_SOURCE_FILE
+#define LOAD_REPORT_RUNS        5       // Timed runs per load path in load report mode
+#define COPY_SPACING            6.0f    // Distance between scene copies in world units
+#define ORBIT_LIGHT_RADIUS      0.6f    // Range of the extra lights
+#define TEXTURE_BUDGET_MB       64      // Default memory budget of streamed textures
+#define SHADOW_FILTER_TAPS      4       // Default shadow lookup taps (1, 4 or 16)
+#define PROFILER_WIDTH          380     // Profiler overlay width in pixels
+#define POST_SAMPLES            4       // MSAA samples of the HDR scene target
+#define POST_MIN_SCALE          0.5f    // Lowest dynamic resolution scale
+#define OCCLUSION_SCALE         4       // Screen pixels per occlusion buffer pixel, on each axis
 
-//------------------------------------------------------------------------------------
-// Types and Structures Definition
-//------------------------------------------------------------------------------------
-// light type
-typedef enum {
-    LIGHT_DIRECTIONAL = 0,
-    LIGHT_POINT,
-    LIGHT_SPOT
-} LightType;
-
-// Light data
-typedef struct {
-    int type;
-    int enabled;
-    Vector3 position;
-    Vector3 target;
-    float color[4];
-    float intensity;
-
-    // Shader light parameters locations
-    int typeLoc;
-    int enabledLoc;
-    int positionLoc;
-    int targetLoc;
-    int colorLoc;
-    int intensityLoc;
-} Light;
+// PBR shader variant features, each one enables a HAS_* define in pbr.frag
+#define PBR_ALBEDO_MAP          1
+#define PBR_NORMAL_MAP          2
+#define PBR_MRA_MAP             4
+#define PBR_EMISSIVE_MAP        8
+#define PBR_QUANTIZED_VERTICES  16      // Scene vertices are quantized, enables QUANTIZED_VERTICES in pbr.vert
+#define PBR_ALPHA_TEST          32      // Material has an alpha cutoff (glTF MASK), enables ALPHA_TEST in pbr.frag
+#define PBR_OIT_OUTPUT          64      // Blended material drawn order independent, enables OIT_OUTPUT in pbr.frag
+#define PBR_AMBIENT             0.02f   // Ambient intensity of the PBR shaders
+#define PBR_AMBIENT_COLOR       (Color){ 26, 32, 135, 255 }
+
+#define BENCH_DEFAULT_FRAMES    600     // Frames recorded in benchmark mode
+#define BENCH_DEFAULT_WARMUP    60      // Frames run before recording in benchmark mode
 
 //----------------------------------------------------------------------------------
-// Global Variables Definition
+// Types and Structures Definition
 //----------------------------------------------------------------------------------
-static int lightCount = 0;     // Current number of dynamic lights that have been created
+// Scene copies drawn into the shadow maps
+typedef struct {
+    Scene scene;
+    const Matrix *transforms;
+    int count;
+    Shader shader;              // Depth only shader
+    Shader alphaShader;         // Depth shader with the alpha test, for alpha tested materials
+} ShadowCasters;
 
 //----------------------------------------------------------------------------------
 // Module specific Functions Declaration
 //----------------------------------------------------------------------------------
-// Create a light and get shader locations
-static Light CreateLight(int type, Vector3 position, Vector3 target, Color color, float intensity, Shader shader);
+// Set PBR shader locations and constant uniforms
+// NOTE: Required again after a hot reload, the new program starts with default uniform values
+static void SetupPbrShader(Shader shader);
+
+// Get PBR variant features of a material from the texture maps it has, its alpha test and blending
+static unsigned int GetPbrFeatures(Material material, bool orderIndependent);
+
+// Get PBR shader variant for a material, a light buffer light count, the scene vertex format, the shadow maps, the output range
+// and the transparency output of blended materials
+static Shader GetPbrShader(ShaderVariants *variants, Material material, int lightCount, bool quantized, const ShadowMaps *shadows, bool hdr, bool orderIndependent);
+
+// Draw every scene copy depth only, shadow map draw callback
+static void DrawShadowCasters(void *data);
+
+// Set material values the glTF does not provide
+static void SetupSceneMaterials(Material *materials, int materialCount);
+
+// Get transforms of the scene copies, laid out on a square grid
+static Matrix *LoadCopyTransforms(int count);
+
+// Get scene light without adding it to the light buffer: 0-3 are the static lights, 4 and up orbit the island at time t
+static Light GetSceneLight(int index, float t);
+
+// Get directional light of simple3d --sun
+static Light GetSunLight(void);
+
+// Get position of an extra light orbiting the island at time t
+static Vector3 GetOrbitLightPosition(int index, float t);
+
+// Get camera for a benchmark frame, follows a fixed path so runs are comparable
+static Camera GetBenchCamera(int frame, int frameCount);
+
+// Get CPU renderer material of a scene material, same inputs as its PBR variant
+static SoftMaterial GetSoftMaterial(SceneData data, int index);
 
-// Update light properties on shader
-// NOTE: Light shader locations should be available
-static void UpdateLight(Shader shader, Light light);
+// Get CPU renderer light of a light
+static SoftLight GetSoftLight(Light light);
+
+// Render the scene with the CPU renderer along the benchmark camera path, timed when frameCount > 0,
+// the last frame is written to imageFileName when it is not NULL
+static bool RenderSceneSoft(const char *imageFileName, int frameCount, int warmupFrames, const char *reportFileName, int copies, int lightTotal, bool sunLight, int width, int height, JobPool *pool);
+
+// Print block compression quality and encoder throughput for the model textures
+static int PrintTextureCompressionReport(const char *fileName, JobPool *pool);
+
+// Print load times of the glTF and scene file paths
+// NOTE: Requires a GL context
+static void PrintLoadReport(const char *gltfFileName, const char *sceneFileName, JobPool *pool);
 
 //------------------------------------------------------------------------------------
 // Program main entry point
 //------------------------------------------------------------------------------------
-int main(void)
+int main(int argc, char **argv)
 {
     // Initialization
     //--------------------------------------------------------------------------------------
     const int screenWidth = 800;
     const int screenHeight = 600;
 
-    SetConfigFlags(FLAG_MSAA_4X_HINT);  // Enable Multi Sampling Anti Aliasing 4x (if available)
+    // Benchmark mode: simple3d --bench [--frames N] [--warmup N] [--out report.csv|report.json]
+    bool benchMode = false;
+    int benchFrames = BENCH_DEFAULT_FRAMES;
+    int benchWarmup = BENCH_DEFAULT_WARMUP;
+    const char *benchOutput = "bench_report.csv";
+    bool buildTextureCache = false;
+    bool compressionReport = false;
+    bool buildScene = false;
+    bool loadReport = false;
+    bool compressTextures = true;
+    bool batching = true;
+    bool sortedQueue = true;
+    bool depthPrepass = true;
+    bool culling = true;
+    bool occlusionCulling = true;
+    bool lods = true;
+    bool quantize = true;
+    bool streaming = true;
+    int textureBudget = TEXTURE_BUDGET_MB;
+    int sceneCopies = 1;
+    int lightTotal = 4;
+    bool clusteredLights = false;
+    bool shadowMaps = true;
+    int shadowTaps = SHADOW_FILTER_TAPS;
+    bool sunLight = false;
+    bool profilerOverlay = false;
+    const char *traceOutput = NULL;
+    bool postProcess = true;
+    bool orderIndependent = true;
+    bool grayscale = false;
+    float exposure = 1.0f;
+    float saturation = 1.0f;
+    float frameBudget = 0.0f;
+    float resolutionScale = 1.0f;
+    const char *softImage = NULL;
+    bool softBackend = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (TextIsEqual(argv[i], "--build-texture-cache")) buildTextureCache = true;
+        else if (TextIsEqual(argv[i], "--bc-report")) compressionReport = true;
+        else if (TextIsEqual(argv[i], "--build-scene")) buildScene = true;
+        else if (TextIsEqual(argv[i], "--load-report")) loadReport = true;
+        else if (TextIsEqual(argv[i], "--no-bc")) compressTextures = false;
+        else if (TextIsEqual(argv[i], "--no-batching")) batching = false;
+        else if (TextIsEqual(argv[i], "--no-queue")) sortedQueue = false;
+        else if (TextIsEqual(argv[i], "--no-prepass")) depthPrepass = false;
+        else if (TextIsEqual(argv[i], "--no-culling")) culling = false;
+        else if (TextIsEqual(argv[i], "--no-occlusion")) occlusionCulling = false;
+        else if (TextIsEqual(argv[i], "--no-lod")) lods = false;
+        else if (TextIsEqual(argv[i], "--no-quantize")) quantize = false;
+        else if (TextIsEqual(argv[i], "--no-streaming")) streaming = false;
+        else if (TextIsEqual(argv[i], "--texture-budget") && (i + 1 < argc)) textureBudget = TextToInteger(argv[++i]);
+        else if (TextIsEqual(argv[i], "--copies") && (i + 1 < argc)) sceneCopies = TextToInteger(argv[++i]);
+        else if (TextIsEqual(argv[i], "--lights") && (i + 1 < argc)) lightTotal = TextToInteger(argv[++i]);
+        else if (TextIsEqual(argv[i], "--clustered")) clusteredLights = true;
+        else if (TextIsEqual(argv[i], "--no-shadows")) shadowMaps = false;
+        else if (TextIsEqual(argv[i], "--shadow-pcf") && (i + 1 < argc)) shadowTaps = TextToInteger(argv[++i]);
+        else if (TextIsEqual(argv[i], "--sun")) sunLight = true;
+        else if (TextIsEqual(argv[i], "--no-post")) postProcess = false;
+        else if (TextIsEqual(argv[i], "--no-oit")) orderIndependent = false;
+        else if (TextIsEqual(argv[i], "--grayscale")) grayscale = true;
+        else if (TextIsEqual(argv[i], "--exposure") && (i + 1 < argc)) exposure = TextToFloat(argv[++i]);
+        else if (TextIsEqual(argv[i], "--saturation") && (i + 1 < argc)) saturation = TextToFloat(argv[++i]);
+        else if (TextIsEqual(argv[i], "--frame-budget") && (i + 1 < argc)) frameBudget = TextToFloat(argv[++i]);
+        else if (TextIsEqual(argv[i], "--scale") && (i + 1 < argc)) resolutionScale = TextToFloat(argv[++i]);
+        else if (TextIsEqual(argv[i], "--profile")) profilerOverlay = true;
+        else if (TextIsEqual(argv[i], "--trace") && (i + 1 < argc)) traceOutput = argv[++i];
+        else if (TextIsEqual(argv[i], "--bench")) benchMode = true;
+        else if (TextIsEqual(argv[i], "--soft")) softBackend = true;
+        else if (TextIsEqual(argv[i], "--soft-render") && (i + 1 < argc)) softImage = argv[++i];
+        else if (TextIsEqual(argv[i], "--frames") && (i + 1 < argc)) benchFrames = TextToInteger(argv[++i]);
+        else if (TextIsEqual(argv[i], "--warmup") && (i + 1 < argc)) benchWarmup = TextToInteger(argv[++i]);
+        else if (TextIsEqual(argv[i], "--out") && (i + 1 < argc)) benchOutput = argv[++i];
+    }
+
+    // Offline build step: simple3d --build-texture-cache [--no-bc]
+    // NOTE: Converts the scene textures into cache files with mipmaps and exits, no window required
+    if (buildTextureCache)
+    {
+        JobPool *jobs = LoadJobPool(-1);
+        SetTextureCacheDirectory(TEXTURE_CACHE_DIR);
+        SetTextureCompression(compressTextures);
+        int built = BuildModelTextureCache(SCENE_SOURCE_FILE, jobs);
+        UnloadJobPool(jobs);
+
+        return (built > 0)? 0 : 1;
+    }
+
+    // Offline build step: simple3d --build-scene
+    // NOTE: Flattens the glTF into a binary scene file and exits, no window required.
+    // Mesh LODs are simplified on worker threads
+    if (buildScene)
+    {
+        SetTextureCacheDirectory(TEXTURE_CACHE_DIR);
+        SetSceneQuantization(quantize);
+
+        JobPool *pool = LoadJobPool(-1);
+        bool built = BuildSceneFile(SCENE_SOURCE_FILE, SCENE_FILE, pool);
+        UnloadJobPool(pool);
+
+        return built? 0 : 1;
+    }
+
+    // Block compression report: simple3d --bc-report
+    // NOTE: Runs on the CPU only, no window required
+    if (compressionReport)
+    {
+        JobPool *jobs = LoadJobPool(-1);
+        int reported = PrintTextureCompressionReport(SCENE_SOURCE_FILE, jobs);
+        UnloadJobPool(jobs);
+
+        return (reported > 0)? 0 : 1;
+    }
+
+    // CPU reference renderer: simple3d --soft-render image.png writes the first benchmark camera frame,
+    // simple3d --bench --soft times the benchmark path ([--frames N] [--warmup N] [--out report.csv])
+    // NOTE: Runs on the CPU only, no window required. Takes --copies, --lights and --sun like the window
+    if ((softImage != NULL) || (benchMode && softBackend))
+    {
+        JobPool *jobs = LoadJobPool(-1);
+        SetTextureCacheDirectory(TEXTURE_CACHE_DIR);
+        SetSceneQuantization(quantize);
+        if (!IsSceneFileCurrent(SCENE_FILE, SCENE_SOURCE_FILE)) BuildSceneFile(SCENE_SOURCE_FILE, SCENE_FILE, jobs);
+
+        bool rendered = RenderSceneSoft(softImage, benchMode? benchFrames : 0, benchWarmup, benchOutput, sceneCopies, lightTotal, sunLight, screenWidth, screenHeight, jobs);
+        UnloadJobPool(jobs);
+
+        return rendered? 0 : 1;
+    }
+
+    // NOTE: In benchmark mode the window is never shown, the scene is rendered offscreen
+    // so it also runs on software GL (Mesa llvmpipe) without a display attached
+    // NOTE: With post-process the HDR scene target is multisampled instead of the window
+    if (benchMode || loadReport) SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    else if (!postProcess) SetConfigFlags(FLAG_MSAA_4X_HINT);  // Enable Multi Sampling Anti Aliasing 4x (if available)
     InitWindow(screenWidth, screenHeight, "model load");
 
+    // Profiler scopes stay enabled, the overlay is toggled with F1 (simple3d --profile starts with it)
+    // and simple3d --trace trace.json writes the recorded scopes as Chrome trace JSON on exit
+    ProfInit();
+    int drawCallProfCounter = ProfAddCounter("draw_calls");
+    int triangleProfCounter = ProfAddCounter("triangles");
+    int stateChangeProfCounter = ProfAddCounter("state_changes");
+    int uniformUploadProfCounter = ProfAddCounter("uniform_uploads");
+    int meshesDrawnProfCounter = ProfAddCounter("meshes_drawn");
+    int shadowViewsProfCounter = ProfAddCounter("shadow_views");
+    int meshesOccludedProfCounter = ProfAddCounter("meshes_occluded");
+
+    // Load report: simple3d --load-report
+    // NOTE: Compares LoadModel() with the scene file path, window stays hidden
+    if (loadReport)
+    {
+        JobPool *jobs = LoadJobPool(-1);
+        SetTextureCacheDirectory(TEXTURE_CACHE_DIR);
+        SetTextureCompression(compressTextures && IsTextureCacheFormatSupported(PIXELFORMAT_COMPRESSED_DXT1_RGB));
+        SetSceneQuantization(quantize);
+        PrintLoadReport(SCENE_SOURCE_FILE, SCENE_FILE, jobs);
+        UnloadJobPool(jobs);
+        ProfClose();
+        CloseWindow();
+
+        return 0;
+    }
+
     // Define the camera to look into our 3d world
     Camera camera = { 0 };
     camera.position = (Vector3){ 1.0f, 1.0f, 1.0f };    // Camera position
@@ -72,7 +327,546 @@ int main(void)
     camera.fovy = 45.0f;                                // Camera field-of-view Y
     camera.projection = CAMERA_PERSPECTIVE;             // Camera projection type
 
-    Shader shader = LoadShader(TextFormat("resources/shaders/pbr.vert", GLSL_VERSION), TextFormat("resources/shaders/pbr.frag", GLSL_VERSION));
+    // Lights are kept in one uniform buffer, shaders bind their LightBlock to it
+    LoadLights();
+
+    // PBR materials get a program compiled for their texture maps and light count instead of
+    // branching on uniforms. Programs are restored from the binary cache when sources and driver
+    // did not change, edited sources are recompiled while running (hot reload)
+    SetShaderCacheDirectory(SHADER_CACHE_DIR);
+    ShaderVariants *pbrShaders = LoadShaderVariants("resources/shaders/pbr.vert", "resources/shaders/pbr.frag", SetupPbrShader);
+
+    // Worker threads used to speed up loading
+    JobPool *jobs = LoadJobPool(-1);
+
+    // The glTF is flattened once into a scene file that is mapped and uploaded as is,
+    // textures are decoded on the worker threads and only uploaded on this one
+    // NOTE: First run writes the decoded textures with their mipmaps to the cache, later runs map them
+    SetTextureCacheDirectory(TEXTURE_CACHE_DIR);
+    SetTextureCompression(compressTextures && IsTextureCacheFormatSupported(PIXELFORMAT_COMPRESSED_DXT1_RGB));
+    SetSceneQuantization(quantize);     // --no-quantize rebuilds the scene file with float vertices
+
+    // Textures start at their coarsest levels, finer levels are streamed in as the camera gets close
+    // NOTE: simple3d --texture-budget MB limits the resident levels, --no-streaming uploads them in full
+    TextureStream *textureStream = streaming? LoadTextureStream(jobs, (long long)textureBudget*1024*1024) : NULL;
+    SetSceneTextureStream(textureStream);
+
+    double loadStart = GetTime();
+    if (!IsSceneFileCurrent(SCENE_FILE, SCENE_SOURCE_FILE)) BuildSceneFile(SCENE_SOURCE_FILE, SCENE_FILE, jobs);
+    Scene scene = LoadScene(SCENE_FILE, jobs);
+    TraceLog(LOG_INFO, "SCENE: Loaded in %.2f ms", (GetTime() - loadStart)*1000.0);
+
+    if (textureStream != NULL)
+    {
+        TextureStreamStats streamStats = GetTextureStreamStats(textureStream);
+        TraceLog(LOG_INFO, "TEXSTREAM: %i textures, %.2f MB resident of %.2f MB at full resolution", streamStats.textures, streamStats.residentBytes/(1024.0*1024.0), streamStats.fullBytes/(1024.0*1024.0));
+    }
+    SetSceneCulling(culling);
+    SetSceneLod(lods);
+
+    // Meshes left by frustum culling are tested against the largest opaque meshes of every copy,
+    // rasterized on the worker threads into a small depth buffer each frame
+    // NOTE: simple3d --no-occlusion draws everything in the frustum, --no-culling disables both
+    OcclusionBuffer *occlusion = (occlusionCulling && culling)? LoadOcclusionBuffer(screenWidth/OCCLUSION_SCALE, screenHeight/OCCLUSION_SCALE) : NULL;
+    SetSceneOcclusion(occlusion);
+
+    // Triangles of the whole scene per LOD level, meshes without a level count with their coarsest one
+    int lodTriangles[SCENE_MAX_LODS] = { 0 };
+    for (int i = 0; i < scene.meshCount; i++)
+    {
+        for (int l = 0; l < SCENE_MAX_LODS; l++) lodTriangles[l] += scene.meshes[i].lods[(l < scene.meshes[i].lodCount)? l : scene.meshes[i].lodCount - 1].indexCount/3;
+    }
+
+    TraceLog(LOG_INFO, "SCENE: Triangles per LOD level: %i | %i | %i | %i (%s)", lodTriangles[0], lodTriangles[1], lodTriangles[2], lodTriangles[3], lods? "enabled" : "disabled");
+
+    SetupSceneMaterials(scene.materials, scene.materialCount);
+
+    // Scene copies: simple3d --copies N [--no-queue] [--no-batching], cottages laid out on a square grid
+    if (sceneCopies < 1) sceneCopies = 1;
+    Matrix *copyTransforms = LoadCopyTransforms(sceneCopies);
+
+    TraceLog(LOG_INFO, "SCENE: %i copies, %i draw calls per copy (%s)", sceneCopies, batching? scene.batchCount : scene.meshCount, batching? "batched" : "per mesh");
+
+    // Every copy keeps its own mesh LODs, hysteresis works on the LOD of the previous frame
+    unsigned char *copyLods = (unsigned char *)RL_CALLOC(sceneCopies*scene.meshCount + 1, 1);
+
+    // Create some lights, extra lights (--lights N) orbit the island so they change every frame
+    // NOTE: With --clustered the extra lights skip the light buffer and are binned into froxels,
+    // so they are not limited to MAX_LIGHTS
+    int maxLights = clusteredLights? 4 + CLUSTER_MAX_LIGHTS : MAX_LIGHTS - (sunLight? 1 : 0);
+    if (lightTotal < 4) lightTotal = 4;
+    if (lightTotal > maxLights) lightTotal = maxLights;
+
+    Light *lights = (Light *)RL_CALLOC(lightTotal, sizeof(Light));
+    for (int i = 0; i < 4; i++)
+    {
+        Light light = GetSceneLight(i, 0.0f);
+        lights[i] = CreateLight(light.type, light.position, light.target, light.color, light.intensity);
+    }
+
+    // Directional light: simple3d --sun, shines from position towards target
+    Light sun = { 0 };
+    if (sunLight)
+    {
+        Light light = GetSunLight();
+        sun = CreateLight(light.type, light.position, light.target, light.color, light.intensity);
+    }
+
+    for (int i = 4; i < lightTotal; i++)
+    {
+        Light light = GetSceneLight(i, 0.0f);
+
+        if (clusteredLights) lights[i] = light;
+        else lights[i] = CreateLight(light.type, light.position, light.target, light.color, light.intensity);
+
+        lights[i].radius = light.radius;
+    }
+
+    LightClusters *clusters = clusteredLights? LoadLightClusters() : NULL;
+    RenderQueue *queue = (sortedQueue && batching)? LoadRenderQueue() : NULL;
+    TraceLog(LOG_INFO, "LIGHTS: %i lights (%s)", lightTotal, clusteredLights? "extra lights clustered" : "light buffer only");
+
+    // The four static lights cast shadows from cube maps, the sun from cascades. Maps are only
+    // rendered again when a light or the static geometry moves, extra lights are unshadowed
+    // NOTE: simple3d --no-shadows compiles the variants without shadow lookups, --shadow-pcf N sets the taps
+    ShadowMaps *shadows = shadowMaps? LoadShadowMaps(4, sunLight, shadowTaps) : NULL;
+    Light shadowLights[5] = { lights[0], lights[1], lights[2], lights[3], sun };
+    int shadowLightCount = sunLight? 5 : 4;
+
+    Shader depthShader = LoadShaderCached("resources/shaders/depth.vert", "resources/shaders/depth.frag", (scene.vertexStride == SCENE_QUANTIZED_STRIDE)? "#define QUANTIZED_VERTICES\n" : "");
+    depthShader.locs[SHADER_LOC_POSITION_DEQUANT] = GetShaderLocation(depthShader, "positionDequant");
+
+    // Depth pre-pass of the render queue: opaque depth first with the position only shader, the PBR pass
+    // then shades every pixel once. Alpha tested materials need their albedo alpha in the pre-pass and shadow maps too
+    // NOTE: simple3d --no-prepass starts without it, F2 toggles it
+    Shader depthAlphaShader = LoadShaderCached("resources/shaders/depth.vert", "resources/shaders/depth.frag", (scene.vertexStride == SCENE_QUANTIZED_STRIDE)? "#define QUANTIZED_VERTICES\n#define ALPHA_TEST\n" : "#define ALPHA_TEST\n");
+    depthAlphaShader.locs[SHADER_LOC_POSITION_DEQUANT] = GetShaderLocation(depthAlphaShader, "positionDequant");
+    depthAlphaShader.locs[SHADER_LOC_ALPHA_CUTOFF] = GetShaderLocation(depthAlphaShader, "alphaCutoff");
+    ShadowCasters casters = { scene, copyTransforms, sceneCopies, depthShader, depthAlphaShader };
+
+    // The scene is rendered in linear HDR, tonemap, gamma and the color grade run once per pixel
+    // in one post-process pass. simple3d --exposure E and --saturation S add the color grade,
+    // --grayscale a gray screen and --no-post tonemaps every shaded fragment instead.
+    // simple3d --frame-budget MS scales the scene resolution to hold its GPU time under MS,
+    // --scale S renders it at a fixed scale, both upscaled and sharpened to the window
+    PostProcess *post = postProcess? LoadPostProcess(screenWidth, screenHeight, benchMode? 1 : POST_SAMPLES) : NULL;
+    Shader postShader = { 0 };
+
+    if (post != NULL)
+    {
+        if ((exposure != 1.0f) || (saturation != 1.0f)) AddPostEffect(post, POST_COLOR_GRADE);
+        AddPostEffect(post, POST_TONEMAP);
+        AddPostEffect(post, POST_GAMMA);
+        if (grayscale) AddPostEffect(post, POST_GRAYSCALE);
+
+        postShader = LoadShaderCached("resources/shaders/post.vert", "resources/shaders/post.frag", GetPostShaderDefines(post));
+        SetPostShader(post, postShader);
+        SetPostGrade(post, (PostGrade){ exposure, (Vector3){ 1.0f, 1.0f, 1.0f }, saturation, 1.0f });
+        SetPostScale(post, resolutionScale);
+        if (frameBudget > 0.0f) SetPostDynamicResolution(post, frameBudget/1000.0, POST_MIN_SCALE);
+    }
+
+    // Blended materials (glTF BLEND, the water) are weighted blended into accumulation and revealage
+    // targets in any order and composited over the scene, no back to front sort of the queue
+    // NOTE: simple3d --no-oit sorts them instead, the targets need the HDR scene target depth
+    TransparencyTarget *transparency = (orderIndependent && (post != NULL) && (queue != NULL))? LoadTransparencyTarget(screenWidth, screenHeight) : NULL;
+    Shader oitShader = { 0 };
+
+    if (transparency != NULL)
+    {
+        oitShader = LoadShaderCached("resources/shaders/oit.vert", "resources/shaders/oit.frag", "");
+        SetTransparencyShader(transparency, oitShader);
+        SetRenderQueueTransparency(queue, transparency);
+    }
+
+    // Every glTF material (MATERIAL index + 1) gets the PBR variant matching its maps,
+    // draw order comes from the render queue sort keys
+    // NOTE: The light count, shadow maps, output range and transparency output are compiled into the variants, no lights are added to the buffer after this
+    double shaderStart = GetTime();
+    for (int i = 1; i < scene.materialCount; i++) scene.materials[i].shader = GetPbrShader(pbrShaders, scene.materials[i], GetLightCount(), scene.vertexStride == SCENE_QUANTIZED_STRIDE, shadows, post != NULL, transparency != NULL);
+    TraceLog(LOG_INFO, "SHADER: %i PBR variants ready in %.2f ms", pbrShaders->count, (GetTime() - shaderStart)*1000.0);
+
+    // Benchmark passes, only timed when benchmark mode is enabled
+    int scenePass = -1;
+    int hudPass = -1;
+    int binningPass = -1;
+    int streamPass = -1;
+    int shadowPass = -1;
+    int postPass = -1;
+    int occlusionPass = -1;
+    int drawCallCounter = -1;
+    int materialBindCounter = -1;
+    int triangleCounter = -1;
+    int meshesTestedCounter = -1;
+    int meshesCulledCounter = -1;
+    int meshesDrawnCounter = -1;
+    int lightBytesCounter = -1;
+    int visibleLightsCounter = -1;
+    int clusterIndicesCounter = -1;
+    int clusterMaxLightsCounter = -1;
+    int shaderBindCounter = -1;
+    int textureBindCounter = -1;
+    int meshesLodCounter = -1;
+    int textureResidentCounter = -1;
+    int textureUploadCounter = -1;
+    int shadowViewsCounter = -1;
+    int meshesOccludedCounter = -1;
+    int occluderTrianglesCounter = -1;
+    int resolutionCounter = -1;
+    int transparentItemsCounter = -1;
+    RenderTexture2D target = { 0 };
+
+    if (benchMode)
+    {
+        BenchInit(benchFrames, benchWarmup);
+        scenePass = BenchAddPass("scene");
+        hudPass = BenchAddPass("hud");
+        binningPass = BenchAddPass("light_binning");
+        streamPass = BenchAddPass("texture_stream");
+        shadowPass = BenchAddPass("shadows");
+        postPass = BenchAddPass("post");
+        occlusionPass = BenchAddPass("occlusion");
+        drawCallCounter = BenchAddCounter("draw_calls");
+        materialBindCounter = BenchAddCounter("material_binds");
+        triangleCounter = BenchAddCounter("triangles");
+        meshesTestedCounter = BenchAddCounter("meshes_tested");
+        meshesCulledCounter = BenchAddCounter("meshes_culled");
+        meshesDrawnCounter = BenchAddCounter("meshes_drawn");
+        lightBytesCounter = BenchAddCounter("light_upload_bytes");
+        visibleLightsCounter = BenchAddCounter("cluster_visible_lights");
+        clusterIndicesCounter = BenchAddCounter("cluster_indices");
+        clusterMaxLightsCounter = BenchAddCounter("cluster_max_lights");
+        shaderBindCounter = BenchAddCounter("shader_binds");
+        textureBindCounter = BenchAddCounter("texture_binds");
+        meshesLodCounter = BenchAddCounter("meshes_lod");
+        textureResidentCounter = BenchAddCounter("texture_resident_kb");
+        textureUploadCounter = BenchAddCounter("texture_upload_kb");
+        shadowViewsCounter = BenchAddCounter("shadow_views_rendered");
+        meshesOccludedCounter = BenchAddCounter("meshes_occluded");
+        occluderTrianglesCounter = BenchAddCounter("occluder_triangles");
+        resolutionCounter = BenchAddCounter("resolution_scale_pct");
+        transparentItemsCounter = BenchAddCounter("transparent_items");
+
+        target = LoadRenderTexture(screenWidth, screenHeight);
+    }
+    else
+    {
+        DisableCursor();                    // Limit cursor to relative movement inside the window
+        SetTargetFPS(60);                   // Set our game to run at 60 frames-per-second
+    }
+    //--------------------------------------------------------------------------------------
+
+    // Main game loop
+    while (benchMode? !BenchIsFinished() : !WindowShouldClose())    // Detect window close button or ESC key
+    {
+        if (benchMode) BenchBeginFrame();
+        ProfBeginFrame();
+
+        // Update
+        //----------------------------------------------------------------------------------
+        ProfBeginScope("Update");
+
+        if (!benchMode && IsKeyPressed(KEY_F1)) profilerOverlay = !profilerOverlay;
+        if (!benchMode && IsKeyPressed(KEY_F2)) depthPrepass = !depthPrepass;
+
+        if (benchMode) camera = GetBenchCamera(BenchGetFrame(), BenchGetFrameCount());
+        else UpdateCamera(&camera, CAMERA_FREE);
+
+        // Hot reload: an edited pbr.vert/pbr.frag recompiles every variant, then uniforms and materials are set again
+        if (!benchMode) ReloadShaderVariants(pbrShaders, scene.materials, scene.materialCount);
+        if (!benchMode && (post != NULL) && ReloadShaderChanged(&postShader)) SetPostShader(post, postShader);
+        if (!benchMode && (transparency != NULL) && ReloadShaderChanged(&oitShader)) SetTransparencyShader(transparency, oitShader);
+
+        // Move extra lights, only lights that changed get uploaded
+        ProfBeginScope("Lights");
+        float lightTime = benchMode? BenchGetFrame()/60.0f : (float)GetTime();
+        for (int i = 4; i < lightTotal; i++)
+        {
+            lights[i].position = GetOrbitLightPosition(i, lightTime);
+            UpdateLightValues(lights[i]);
+        }
+
+        int lightBytes = UploadLights();
+        ProfEndScope();
+
+        // Bin the extra lights into the camera froxels, timed apart from shading (scene pass)
+        ClusterStats clusterStats = { 0 };
+
+        if (clusters != NULL)
+        {
+            BenchBeginPass(binningPass);
+            ProfBeginScope("Light binning");
+            clusterStats = UpdateLightClusters(clusters, lights + 4, lightTotal - 4, camera, (float)screenWidth/screenHeight, jobs);
+            ProfEndScope();
+            BenchEndPass(binningPass);
+        }
+
+        // Rasterize the occluders of every copy from this frame's camera, culling in the scene pass tests against them
+        OcclusionStats occlusionStats = { 0 };
+
+        if (occlusion != NULL)
+        {
+            BenchBeginPass(occlusionPass);
+            ProfBeginScope("Occlusion");
+            ClearOccluders(occlusion);
+            for (int i = 0; i < sceneCopies; i++) AddOccluder(occlusion, scene.occluderVertices, scene.occluderVertexCount, scene.occluderIndices, scene.occluderIndexCount, copyTransforms[i]);
+            occlusionStats = RasterizeOccluders(occlusion, camera, (float)screenWidth/screenHeight, jobs);
+            ProfEndScope();
+            BenchEndPass(occlusionPass);
+        }
+
+        // Render shadow maps that are out of date, static lights and geometry keep theirs
+        ShadowStats shadowStats = { 0 };
+
+        if (shadows != NULL)
+        {
+            BenchBeginPass(shadowPass);
+            ProfBeginScope("Shadows");
+            ProfBeginGpuScope("Shadows");
+            UpdateShadowLights(shadows, shadowLights, shadowLightCount);
+            shadowStats = UpdateShadowMaps(shadows, camera, (float)screenWidth/screenHeight, DrawShadowCasters, &casters);
+            ProfEndGpuScope();
+            ProfEndScope();
+            BenchEndPass(shadowPass);
+        }
+
+        ProfEndScope();
+        //----------------------------------------------------------------------------------
+
+        // Draw
+        //----------------------------------------------------------------------------------
+        ProfBeginScope("Draw");
+        BeginDrawing();
+
+            if (benchMode) BeginTextureMode(target);
+
+            BeginPostScene(post);       // Scene goes to the HDR target, nothing without post-process
+
+            ClearBackground(BLACK);
+
+            BenchBeginPass(scenePass);
+            ProfBeginScope("Scene");
+            ProfBeginGpuScope("Scene");
+
+            if (clusters != NULL)
+            {
+                for (int i = 0; i < pbrShaders->count; i++) BindLightClusters(clusters, pbrShaders->shaders[i]);
+            }
+
+            if (shadows != NULL)
+            {
+                for (int i = 0; i < pbrShaders->count; i++) BindShadowMaps(shadows, pbrShaders->shaders[i]);
+            }
+
+            BeginMode3D(camera);
+
+                ResetSceneStats();
+
+                // Draw 3d scene with texture: all copies go through one sorted render queue,
+                // --no-queue draws every copy by material batch and --no-batching mesh by mesh
+                if (queue != NULL)
+                {
+                    ClearRenderQueue(queue);
+                    for (int i = 0; i < sceneCopies; i++)
+                    {
+                        Scene copy = scene;
+                        copy.lod = copyLods + i*scene.meshCount;
+                        AddSceneToRenderQueue(queue, copy, copyTransforms[i]);
+                    }
+
+                    if (depthPrepass)
+                    {
+                        ProfBeginScope("Depth pre-pass");
+                        ProfBeginGpuScope("Depth pre-pass");
+                        DrawRenderQueueDepth(queue, depthShader, depthAlphaShader);
+                        ProfEndGpuScope();
+                        ProfEndScope();
+                    }
+
+                    ProfBeginGpuScope("Shading");
+                    DrawRenderQueue(queue);
+                    ProfEndGpuScope();
+                }
+                else
+                {
+                    for (int i = 0; i < sceneCopies; i++)
+                    {
+                        Scene copy = scene;
+                        copy.lod = copyLods + i*scene.meshCount;
+
+                        if (batching) DrawScene(copy, copyTransforms[i]);
+                        else DrawSceneMeshes(copy, copyTransforms[i]);
+                    }
+                }
+
+            EndMode3D();
+
+            ProfEndGpuScope();
+            ProfEndScope();
+            BenchEndPass(scenePass);
+
+            // Resolve the scene and run the effect chain, one pass over the screen
+            if (post != NULL)
+            {
+                BenchBeginPass(postPass);
+                ProfBeginScope("Post");
+                ProfBeginGpuScope("Post");
+                EndPostScene(post);
+                DrawPostProcess(post);
+                ProfEndGpuScope();
+                ProfEndScope();
+                BenchEndPass(postPass);
+            }
+
+            // Markers keep their display colors, the post pass wrote the scene depth they are tested against
+            BeginMode3D(camera);
+
+                DrawGrid(10, 1.0f);     // Draw a grid
+
+                // Draw spheres to show the lights positions
+                for (int i = 0; i < lightTotal; i++)
+                {
+                    if (i >= 4) DrawSphereEx(lights[i].position, 0.05f, 4, 4, lights[i].color);
+                    else if (lights[i].enabled) DrawSphereEx(lights[i].position, 0.2f, 8, 8, lights[i].color);
+                    else DrawSphereWires(lights[i].position, 0.2f, 8, 8, ColorAlpha(lights[i].color, 0.3f));
+                }
+
+            EndMode3D();
+
+            // Culling left the texture usage of all copies in scene.materialUsage: evict and upload levels
+            TextureStreamStats streamStats = { 0 };
+
+            if (textureStream != NULL)
+            {
+                BenchBeginPass(streamPass);
+                ProfBeginScope("Texture stream");
+                streamStats = UpdateTextureStream(textureStream, scene.materialUsage, scene.materialCount);
+                ProfEndScope();
+                BenchEndPass(streamPass);
+            }
+
+            // Queued draws are counted by the queue, culling by the scene
+            SceneStats stats = GetSceneStats();
+            PostResolution resolution = GetPostResolution(post);
+            RenderQueueStats queueStats = { 0 };
+            if (queue != NULL)
+            {
+                queueStats = GetRenderQueueStats(queue);
+                stats.drawCalls = queueStats.drawCalls;
+                stats.materialBinds = queueStats.materialBinds;
+                stats.triangles = queueStats.triangles;
+            }
+
+            BenchSetCounter(drawCallCounter, stats.drawCalls);
+            BenchSetCounter(materialBindCounter, stats.materialBinds);
+            BenchSetCounter(triangleCounter, stats.triangles);
+            BenchSetCounter(meshesTestedCounter, stats.meshesTested);
+            BenchSetCounter(meshesCulledCounter, stats.meshesCulled);
+            BenchSetCounter(meshesDrawnCounter, stats.meshesDrawn);
+            BenchSetCounter(lightBytesCounter, lightBytes);
+            BenchSetCounter(visibleLightsCounter, (clusters != NULL)? clusterStats.visibleLights : -1);
+            BenchSetCounter(clusterIndicesCounter, (clusters != NULL)? clusterStats.indices : -1);
+            BenchSetCounter(clusterMaxLightsCounter, (clusters != NULL)? clusterStats.maxClusterLights : -1);
+            BenchSetCounter(shaderBindCounter, (queue != NULL)? queueStats.shaderBinds : -1);
+            BenchSetCounter(textureBindCounter, (queue != NULL)? queueStats.textureBinds : -1);
+            BenchSetCounter(meshesLodCounter, stats.meshesLod);
+            BenchSetCounter(textureResidentCounter, (textureStream != NULL)? (int)(streamStats.residentBytes/1024) : -1);
+            BenchSetCounter(textureUploadCounter, (textureStream != NULL)? (int)(streamStats.uploadBytes/1024) : -1);
+            BenchSetCounter(shadowViewsCounter, (shadows != NULL)? shadowStats.viewsRendered : -1);
+            BenchSetCounter(meshesOccludedCounter, (occlusion != NULL)? stats.meshesOccluded : -1);
+            BenchSetCounter(occluderTrianglesCounter, (occlusion != NULL)? occlusionStats.trianglesRasterized : -1);
+            BenchSetCounter(resolutionCounter, (post != NULL)? (int)(resolution.scale*100.0f + 0.5f) : -1);
+            BenchSetCounter(transparentItemsCounter, (transparency != NULL)? queueStats.transparentItems : -1);
+
+            // State changes: program, texture and vertex array binds; uniform uploads: material and transform blocks
+            ProfCount(drawCallProfCounter, stats.drawCalls);
+            ProfCount(triangleProfCounter, stats.triangles);
+            ProfCount(stateChangeProfCounter, (queue != NULL)? queueStats.shaderBinds + queueStats.textureBinds + queueStats.vertexArrayBinds : stats.materialBinds);
+            ProfCount(uniformUploadProfCounter, (queue != NULL)? queueStats.materialBinds + queueStats.transformBinds : stats.materialBinds);
+            ProfCount(meshesDrawnProfCounter, stats.meshesDrawn);
+            ProfCount(shadowViewsProfCounter, shadowStats.viewsRendered);
+            ProfCount(meshesOccludedProfCounter, stats.meshesOccluded);
+
+            BenchBeginPass(hudPass);
+            ProfBeginScope("HUD");
+            ProfBeginGpuScope("HUD");
+
+            DrawText("Cottage", screenWidth - 210, screenHeight - 20, 10, GRAY);
+            DrawText(TextFormat("%i draw calls", stats.drawCalls), 10, 30, 10, GRAY);
+            DrawText(TextFormat("%i meshes drawn, %i culled, %i at reduced LOD, %i triangles", stats.meshesDrawn, stats.meshesCulled, stats.meshesLod, stats.triangles), 10, 45, 10, GRAY);
+            if (queue != NULL) DrawText(TextFormat("%i items: %i shader, %i texture, %i material binds", queueStats.items, queueStats.shaderBinds, queueStats.textureBinds, queueStats.materialBinds), 10, 75, 10, GRAY);
+            if (queue != NULL) DrawText(depthPrepass? TextFormat("Depth pre-pass: %i draw calls, %i triangles (F2)", queueStats.depthDrawCalls, queueStats.depthTriangles) : "Depth pre-pass: off (F2)", 10, 120, 10, GRAY);
+            if (textureStream != NULL) DrawText(TextFormat("Textures: %.1f/%.0f MB (wanted %.1f, full %.1f), %i/%i at wanted level, %i pending, %.0f KB uploaded",
+                streamStats.residentBytes/(1024.0*1024.0), streamStats.budget/(1024.0*1024.0), streamStats.wantedBytes/(1024.0*1024.0), streamStats.fullBytes/(1024.0*1024.0),
+                streamStats.texturesWanted, streamStats.textures, streamStats.pending, streamStats.uploadBytes/1024.0), 10, 90, 10, GRAY);
+            if (shadows != NULL) DrawText(TextFormat("Shadows: %i/%i views rendered in %.2f ms", shadowStats.viewsRendered, shadowStats.views, shadowStats.renderTime*1000.0), 10, 105, 10, GRAY);
+            if (transparency != NULL) DrawText(TextFormat("Transparency: %i items weighted blended, unsorted", queueStats.transparentItems), 10, 165, 10, GRAY);
+            if (post != NULL) DrawText(TextFormat("Scene: %ix%i (%.0f%%), %.2f ms GPU, budget %s", resolution.width, resolution.height, resolution.scale*100.0f, resolution.sceneTime*1000.0,
+                (resolution.budget > 0.0)? TextFormat("%.2f ms", resolution.budget*1000.0) : "off"), 10, 150, 10, GRAY);
+            if (occlusion != NULL) DrawText(TextFormat("Occlusion: %i meshes hidden, %i/%i occluder triangles rasterized in %.2f ms", stats.meshesOccluded, occlusionStats.trianglesRasterized, occlusionStats.triangles, occlusionStats.rasterTime*1000.0), 10, 135, 10, GRAY);
+            if (clusters != NULL) DrawText(TextFormat("%i/%i lights visible, %i indices, binned in %.2f ms", clusterStats.visibleLights, clusterStats.lights, clusterStats.indices, clusterStats.binTime*1000.0), 10, 60, 10, GRAY);
+
+            DrawFPS(10, 10);
+
+            if (profilerOverlay) DrawProfiler(screenWidth - PROFILER_WIDTH - 10, 10, PROFILER_WIDTH);
+
+            ProfEndGpuScope();
+            ProfEndScope();
+            BenchEndPass(hudPass);
+
+            if (benchMode) EndTextureMode();
+
+            if (benchMode) BenchEndFrame();
+
+        ProfBeginScope("Present");
+        EndDrawing();
+        ProfEndScope();
+        ProfEndScope();
+
+        ProfEndFrame();
+        //----------------------------------------------------------------------------------
+    }
+
+    // De-Initialization
+    //--------------------------------------------------------------------------------------
+    if (benchMode)
+    {
+        BenchExportReport(benchOutput);
+        BenchClose();
+        UnloadRenderTexture(target);
+    }
+
+    RL_FREE(lights);
+    UnloadLightClusters(clusters);  // Unload cluster buffers
+    UnloadShadowMaps(shadows);  // Unload shadow textures
+    UnloadShaderCached(depthShader);
+    UnloadShaderCached(depthAlphaShader);
+    if (post != NULL) UnloadShaderCached(postShader);
+    UnloadPostProcess(post);    // Unload HDR scene target
+    if (transparency != NULL) UnloadShaderCached(oitShader);
+    UnloadTransparencyTarget(transparency);     // Unload accumulation and revealage targets
+    UnloadRenderQueue(queue);   // Unload render queue items
+    UnloadOcclusionBuffer(occlusion);   // Unload occlusion depth buffer
+    UnloadLights();             // Unload light buffer
+    RL_FREE(copyTransforms);
+    RL_FREE(copyLods);
+    UnloadTextureStream(textureStream);     // Unload streamed textures, before the scene materials go
+    UnloadScene(scene);         // Unload scene buffers and textures
+    UnloadShaderVariants(pbrShaders);   // Unload shader variants and stop watching their sources
+    UnloadJobPool(jobs);        // Stop worker threads
+
+    if (traceOutput != NULL) ProfExportTrace(traceOutput);
+    ProfClose();                // Free profiler rings, after the worker threads stopped
+
+    CloseWindow();          // Close window and OpenGL context
+    //--------------------------------------------------------------------------------------
+
+    return 0;
+}
+
+// Set PBR shader locations and constant uniforms
+static void SetupPbrShader(Shader shader)
+{
     shader.locs[SHADER_LOC_MAP_ALBEDO] = GetShaderLocation(shader, "albedoMap");
     // WARNING: Metalness, roughness, and ambient occlusion are all packed into a MRA texture
     // They are passed as to the SHADER_LOC_MAP_METALNESS location for convenience,
@@ -84,171 +878,460 @@ int main(void)
     // It is binded to SHADER_LOC_MAP_EMISSION location an properly processed on shader
     shader.locs[SHADER_LOC_MAP_EMISSION] = GetShaderLocation(shader, "emissiveMap");
     shader.locs[SHADER_LOC_COLOR_DIFFUSE] = GetShaderLocation(shader, "albedoColor");
+    shader.locs[SHADER_LOC_POSITION_DEQUANT] = GetShaderLocation(shader, "positionDequant");
+    shader.locs[SHADER_LOC_ALPHA_CUTOFF] = GetShaderLocation(shader, "alphaCutoff");
 
     // Setup additional required shader locations, including lights data
     shader.locs[SHADER_LOC_VECTOR_VIEW] = GetShaderLocation(shader, "viewPos");
-    int lightCountLoc = GetShaderLocation(shader, "numOfLights");
-    int maxLightCount = MAX_LIGHTS;
-    SetShaderValue(shader, lightCountLoc, &maxLightCount, SHADER_UNIFORM_INT);
+    SetShaderLights(shader);
+    SetShaderLightClusters(shader);
+    SetShaderShadows(shader);
 
     // Setup ambient color and intensity parameters
-    float ambientIntensity = 0.02f;
-    Color ambientColor = (Color){ 26, 32, 135, 255 };
+    float ambientIntensity = PBR_AMBIENT;
+    Color ambientColor = PBR_AMBIENT_COLOR;
     Vector3 ambientColorNormalized = (Vector3){ ambientColor.r/255.0f, ambientColor.g/255.0f, ambientColor.b/255.0f };
     SetShaderValue(shader, GetShaderLocation(shader, "ambientColor"), &ambientColorNormalized, SHADER_UNIFORM_VEC3);
     SetShaderValue(shader, GetShaderLocation(shader, "ambient"), &ambientIntensity, SHADER_UNIFORM_FLOAT);
+}
 
-    // Get location for shader parameters that can be modified in real time
-    int emissiveIntensityLoc = GetShaderLocation(shader, "emissivePower");
-    int emissiveColorLoc = GetShaderLocation(shader, "emissiveColor");
-    int textureTilingLoc = GetShaderLocation(shader, "tiling");
+// Get PBR variant features of a material from the texture maps it has, its alpha test and blending
+// NOTE: Metalness, roughness and occlusion are sampled from the map bound at SHADER_LOC_MAP_METALNESS.
+// Blended materials are the ones the render queue blends (albedo alpha below 255 and no alpha test)
+static unsigned int GetPbrFeatures(Material material, bool orderIndependent)
+{
+    unsigned int features = 0;
 
-    // Raylib loads and unloads textures automatically for .gltf / .glb
-    Model scene = LoadModel("resources/scene.gltf");
+    // Materials without an albedo texture still get the 1x1 default texture assigned
+    unsigned int albedoId = material.maps[MATERIAL_MAP_ALBEDO].texture.id;
+    if ((albedoId != 0) && (albedoId != rlGetTextureIdDefault())) features |= PBR_ALBEDO_MAP;
+    if (material.maps[MATERIAL_MAP_NORMAL].texture.id != 0) features |= PBR_NORMAL_MAP;
+    if (material.maps[MATERIAL_MAP_METALNESS].texture.id != 0) features |= PBR_MRA_MAP;
+    if (material.maps[MATERIAL_MAP_EMISSION].texture.id != 0) features |= PBR_EMISSIVE_MAP;
+    if (material.params[SCENE_PARAM_ALPHA_CUTOFF] > 0.0f) features |= PBR_ALPHA_TEST;
+    else if (orderIndependent && (material.maps[MATERIAL_MAP_ALBEDO].color.a < 255)) features |= PBR_OIT_OUTPUT;
 
-    // MATERIAL index + 1
-    scene.materials[1].shader = shader;
-//    scene.materials[2].shader = shader;
-    scene.materials[3].shader = shader;
-    scene.materials[4].shader = shader;
-    scene.materials[5].shader = shader; // METAL
-//    scene.materials[6].shader = shader;
-//    scene.materials[7].shader = shader;
+    return features;
+}
+
+// Get PBR shader variant for a material, a light buffer light count, the scene vertex format, the shadow maps, the output range
+// and the transparency output of blended materials
+// NOTE: Shadow configuration and output range are the same for every variant of a run, they are not part of the key
+static Shader GetPbrShader(ShaderVariants *variants, Material material, int lightCount, bool quantized, const ShadowMaps *shadows, bool hdr, bool orderIndependent)
+{
+    unsigned int features = GetPbrFeatures(material, orderIndependent) | (quantized? PBR_QUANTIZED_VERTICES : 0);
+    const char *defines = TextFormat("#define LIGHT_COUNT %i\n%s%s%s%s%s%s%s%s%s", lightCount,
+        (features & PBR_ALBEDO_MAP)? "#define HAS_ALBEDO_MAP\n" : "",
+        (features & PBR_NORMAL_MAP)? "#define HAS_NORMAL_MAP\n" : "",
+        (features & PBR_MRA_MAP)? "#define HAS_MRA_MAP\n" : "",
+        (features & PBR_EMISSIVE_MAP)? "#define HAS_EMISSIVE_MAP\n" : "",
+        (features & PBR_QUANTIZED_VERTICES)? "#define QUANTIZED_VERTICES\n" : "",
+        (features & PBR_ALPHA_TEST)? "#define ALPHA_TEST\n" : "",
+        (features & PBR_OIT_OUTPUT)? "#define OIT_OUTPUT\n" : "",
+        GetShadowShaderDefines(shadows),
+        hdr? "#define HDR_OUTPUT\n" : "");
+
+    return GetShaderVariant(variants, features | ((unsigned int)lightCount << 7), defines);
+}
+
+// Draw every scene copy depth only, called once per shadow map view
+static void DrawShadowCasters(void *data)
+{
+    const ShadowCasters *casters = (const ShadowCasters *)data;
+
+    for (int i = 0; i < casters->count; i++) DrawSceneDepth(casters->scene, casters->transforms[i], casters->shader, casters->alphaShader);
+}
+
+// Set material values the glTF does not provide
+static void SetupSceneMaterials(Material *materials, int materialCount)
+{
+    if (materialCount <= 5) return;
 
     // Setup materials[0].maps default parameters
-    scene.materials[1].maps[MATERIAL_MAP_ALBEDO].color = WHITE;
-    scene.materials[1].maps[MATERIAL_MAP_METALNESS].value = 0.0f;
-    scene.materials[1].maps[MATERIAL_MAP_ROUGHNESS].value = 0.0f;
+    materials[1].maps[MATERIAL_MAP_ALBEDO].color = WHITE;
+    materials[1].maps[MATERIAL_MAP_METALNESS].value = 0.0f;
+    materials[1].maps[MATERIAL_MAP_ROUGHNESS].value = 0.0f;
     // not sure about the occlusion and emission values
-    scene.materials[1].maps[MATERIAL_MAP_OCCLUSION].value = 1.0f;
-    scene.materials[1].maps[MATERIAL_MAP_EMISSION].color = (Color){ 255, 162, 0, 255 };
+    materials[1].maps[MATERIAL_MAP_OCCLUSION].value = 1.0f;
+    materials[1].maps[MATERIAL_MAP_EMISSION].color = (Color){ 255, 162, 0, 255 };
 
     // Setup materials[0].maps default parameters
-//    scene.materials[5].maps[MATERIAL_MAP_ALBEDO].color = WHITE;
-    scene.materials[5].maps[MATERIAL_MAP_METALNESS].value = 0.0f;
-    scene.materials[5].maps[MATERIAL_MAP_ROUGHNESS].value = 0.0f;
+//    materials[5].maps[MATERIAL_MAP_ALBEDO].color = WHITE;
+    materials[5].maps[MATERIAL_MAP_METALNESS].value = 0.0f;
+    materials[5].maps[MATERIAL_MAP_ROUGHNESS].value = 0.0f;
     // not sure about the occlusion and emission values
-    scene.materials[5].maps[MATERIAL_MAP_OCCLUSION].value = 1.0f;
-    scene.materials[5].maps[MATERIAL_MAP_EMISSION].color = (Color){ 255, 162, 0, 255 };
+    materials[5].maps[MATERIAL_MAP_OCCLUSION].value = 1.0f;
+    materials[5].maps[MATERIAL_MAP_EMISSION].color = (Color){ 255, 162, 0, 255 };
+}
 
+// Get transforms of the scene copies, cottages laid out on a square grid around the origin
+// NOTE: Returned array has to be freed with RL_FREE()
+static Matrix *LoadCopyTransforms(int count)
+{
     Vector3 position = { 0.0f, 0.0f, 0.0f };    // Set model position
+    Matrix sceneTransform = MatrixMultiply(MatrixScale(0.2f, 0.2f, 0.2f), MatrixTranslate(position.x, position.y, position.z));
 
-    // Create some lights
-    Light lights[MAX_LIGHTS] = { 0 };
-    lights[0] = CreateLight(LIGHT_POINT, (Vector3){ -1.0f, 1.0f, -2.0f }, (Vector3){ 0.0f, 0.0f, 0.0f }, YELLOW, 4.0f, shader);
-    lights[1] = CreateLight(LIGHT_POINT, (Vector3){ 2.0f, 1.0f, 1.0f }, (Vector3){ 0.0f, 0.0f, 0.0f }, GREEN, 3.3f, shader);
-    lights[2] = CreateLight(LIGHT_POINT, (Vector3){ -2.0f, 1.0f, 1.0f }, (Vector3){ 0.0f, 0.0f, 0.0f }, RED, 8.3f, shader);
-    lights[3] = CreateLight(LIGHT_POINT, (Vector3){ 1.0f, 1.0f, -2.0f }, (Vector3){ 0.0f, 0.0f, 0.0f }, BLUE, 2.0f, shader);
-
-    // Setup material texture maps usage in shader
-    // NOTE: By default, the texture maps are always used
-    int usage = 1;
-    SetShaderValue(shader, GetShaderLocation(shader, "useTexAlbedo"), &usage, SHADER_UNIFORM_INT);
-    SetShaderValue(shader, GetShaderLocation(shader, "useTexNormal"), &usage, SHADER_UNIFORM_INT);
-    SetShaderValue(shader, GetShaderLocation(shader, "useTexMRA"), &usage, SHADER_UNIFORM_INT);
-    SetShaderValue(shader, GetShaderLocation(shader, "useTexEmissive"), &usage, SHADER_UNIFORM_INT);
-
-    DisableCursor();                    // Limit cursor to relative movement inside the window
-    SetTargetFPS(60);                   // Set our game to run at 60 frames-per-second
-    //--------------------------------------------------------------------------------------
+    int copiesPerRow = (int)ceilf(sqrtf((float)count));
+    Matrix *copyTransforms = (Matrix *)RL_CALLOC(count, sizeof(Matrix));
 
-    // Main game loop
-    while (!WindowShouldClose())        // Detect window close button or ESC key
+    for (int i = 0; i < count; i++)
     {
-        // Update
-        //----------------------------------------------------------------------------------
-        UpdateCamera(&camera, CAMERA_FREE);
-        //----------------------------------------------------------------------------------
+        float x = (float)(i%copiesPerRow) - 0.5f*(copiesPerRow - 1);
+        float z = (float)(i/copiesPerRow) - 0.5f*(copiesPerRow - 1);
+        copyTransforms[i] = MatrixMultiply(sceneTransform, MatrixTranslate(x*COPY_SPACING, 0.0f, z*COPY_SPACING));
+    }
 
-        // Draw
-        //----------------------------------------------------------------------------------
-        BeginDrawing();
+    return copyTransforms;
+}
 
-            ClearBackground(BLACK);
+// Get scene light without adding it to the light buffer
+// NOTE: The window creates them in the light buffer, the CPU renderer reads them as they are
+static Light GetSceneLight(int index, float t)
+{
+    Light light = { .type = LIGHT_POINT, .enabled = true, .index = -1 };
 
-            BeginMode3D(camera);
+    switch (index)
+    {
+        case 0: light.position = (Vector3){ -1.0f, 1.0f, -2.0f }; light.color = YELLOW; light.intensity = 4.0f; break;
+        case 1: light.position = (Vector3){ 2.0f, 1.0f, 1.0f }; light.color = GREEN; light.intensity = 3.3f; break;
+        case 2: light.position = (Vector3){ -2.0f, 1.0f, 1.0f }; light.color = RED; light.intensity = 8.3f; break;
+        case 3: light.position = (Vector3){ 1.0f, 1.0f, -2.0f }; light.color = BLUE; light.intensity = 2.0f; break;
+        default:
+        {
+            // Extra lights (--lights N), short range so only what they orbit close to is lit
+            light.position = GetOrbitLightPosition(index, t);
+            light.color = ColorFromHSV(index*137.5f, 0.8f, 1.0f);
+            light.intensity = 0.5f;
+            light.radius = ORBIT_LIGHT_RADIUS;
+        } break;
+    }
 
-                DrawModel(scene, position, 0.2f, WHITE);   // Draw 3d model with texture
+    return light;
+}
 
-                DrawGrid(10, 1.0f);     // Draw a grid
+// Get directional light of simple3d --sun, shines from position towards the origin
+static Light GetSunLight(void)
+{
+    return (Light){ .type = LIGHT_DIRECTIONAL, .enabled = true, .position = (Vector3){ 4.0f, 8.0f, 3.0f }, .color = (Color){ 255, 244, 214, 255 }, .intensity = 1.5f, .index = -1 };
+}
 
-        // Draw spheres to show the lights positions
-        for (int i = 0; i < MAX_LIGHTS; i++)
-        {
-            Color lightColor = (Color){ lights[i].color[0]*255, lights[i].color[1]*255, lights[i].color[2]*255, lights[i].color[3]*255 };
+// Get position of an extra light orbiting the island
+// NOTE: Radius, height and speed only depend on the light index, so runs are comparable
+static Vector3 GetOrbitLightPosition(int index, float t)
+{
+    float radius = 1.0f + 2.0f*(float)((index*7919)%1000)/1000.0f;
+    float speed = 0.2f + 0.3f*(float)((index*104729)%1000)/1000.0f;
+    float angle = index*2.39996f + t*speed;
+
+    return (Vector3){ radius*cosf(angle), 0.3f + 0.5f*(float)(index%5)/4.0f, radius*sinf(angle) };
+}
+
+// Get camera for a benchmark frame
+// NOTE: Camera orbits the island once while bobbing up and down, only depends on frame index
+static Camera GetBenchCamera(int frame, int frameCount)
+{
+    float t = (frameCount > 0)? (float)frame/(float)frameCount : 0.0f;
+    float angle = t*2.0f*PI;
+
+    Camera camera = { 0 };
+    camera.position = (Vector3){ 2.5f*cosf(angle), 1.0f + 0.5f*sinf(2.0f*angle), 2.5f*sinf(angle) };
+    camera.target = (Vector3){ 0.0f, 0.3f, 0.0f };
+    camera.up = (Vector3){ 0.0f, 1.0f, 0.0f };
+    camera.fovy = 45.0f;
+    camera.projection = CAMERA_PERSPECTIVE;
+
+    return camera;
+}
+
+// Get CPU renderer material of a scene material, same inputs as its PBR variant
+// NOTE: Tiling, offset, metallic/roughness/ao values and emission are not set on the shaders either, they stay 0.
+// Blended materials are sorted back to front per draw like with --no-oit
+static SoftMaterial GetSoftMaterial(SceneData data, int index)
+{
+    const Material *material = &data.materials[index];
+    const Image *images = &data.images[index*MAX_MATERIAL_MAPS];
+    Color albedo = material->maps[MATERIAL_MAP_ALBEDO].color;
+    Color ambient = PBR_AMBIENT_COLOR;
+    SoftMaterial soft = { 0 };
+
+    soft.shading = SOFT_SHADING_PBR;
+    soft.albedoMap = images[MATERIAL_MAP_ALBEDO];
+    soft.mraMap = images[MATERIAL_MAP_METALNESS];
+    soft.normalMap = images[MATERIAL_MAP_NORMAL];
+    soft.emissiveMap = images[MATERIAL_MAP_EMISSION];
+    soft.albedoColor = (Vector4){ albedo.r/255.0f, albedo.g/255.0f, albedo.b/255.0f, albedo.a/255.0f };
+    soft.ambientColor = (Vector3){ ambient.r/255.0f, ambient.g/255.0f, ambient.b/255.0f };
+    soft.ambient = PBR_AMBIENT;
+    soft.alphaCutoff = material->params[SCENE_PARAM_ALPHA_CUTOFF];
+    soft.blend = (albedo.a < 255) && (soft.alphaCutoff <= 0.0f);
+
+    return soft;
+}
+
+// Get CPU renderer light of a light, colors are normalized like in the light buffer
+static SoftLight GetSoftLight(Light light)
+{
+    SoftLight soft = { 0 };
+
+    soft.type = (light.type == LIGHT_DIRECTIONAL)? SOFT_LIGHT_DIRECTIONAL : SOFT_LIGHT_POINT;
+    soft.enabled = light.enabled;
+    soft.position = light.position;
+    soft.target = light.target;
+    soft.color = (Vector3){ light.color.r/255.0f, light.color.g/255.0f, light.color.b/255.0f };
+    soft.intensity = light.intensity;
+    soft.radius = light.radius;
+
+    return soft;
+}
+
+// Render the scene with the CPU renderer along the benchmark camera path
+// NOTE: No window or GL context, the scene file is decoded on the CPU. Copies, materials, lights and cameras are the
+// window ones, the grid and light spheres are not drawn and there are no shadows or post-process
+static bool RenderSceneSoft(const char *imageFileName, int frameCount, int warmupFrames, const char *reportFileName, int copies, int lightTotal, bool sunLight, int width, int height, JobPool *pool)
+{
+    SceneData data = LoadSceneData(SCENE_FILE, pool);
+    if (data.meshCount == 0) return false;
+
+    SetupSceneMaterials(data.materials, data.materialCount);
+
+    SoftMaterial *materials = (SoftMaterial *)RL_CALLOC(data.materialCount, sizeof(SoftMaterial));
+    for (int i = 0; i < data.materialCount; i++) materials[i] = GetSoftMaterial(data, i);
+
+    if (copies < 1) copies = 1;
+    Matrix *copyTransforms = LoadCopyTransforms(copies);
 
-            if (lights[i].enabled) DrawSphereEx(lights[i].position, 0.2f, 8, 8, lightColor);
-            else DrawSphereWires(lights[i].position, 0.2f, 8, 8, ColorAlpha(lightColor, 0.3f));
+    // Lights in light buffer order: static lights, the sun, extra lights
+    if (lightTotal < 4) lightTotal = 4;
+    if (lightTotal > SOFT_MAX_LIGHTS - (sunLight? 1 : 0)) lightTotal = SOFT_MAX_LIGHTS - (sunLight? 1 : 0);
+
+    SoftLight lights[SOFT_MAX_LIGHTS] = { 0 };
+    int lightCount = 0;
+    for (int i = 0; i < 4; i++) lights[lightCount++] = GetSoftLight(GetSceneLight(i, 0.0f));
+    if (sunLight) lights[lightCount++] = GetSoftLight(GetSunLight());
+    int firstExtraLight = lightCount;
+
+    SoftRenderer *renderer = LoadSoftRenderer(width, height);
+    bool bench = (frameCount > 0) && BenchInitCpu(frameCount, warmupFrames);
+    int renderPass = bench? BenchAddPass("soft_render") : -1;
+    int setupCounter = bench? BenchAddCounter("soft_setup_us") : -1;
+    int rasterCounter = bench? BenchAddCounter("soft_raster_us") : -1;
+    int triangleCounter = bench? BenchAddCounter("soft_triangles") : -1;
+    int fragmentCounter = bench? BenchAddCounter("soft_fragments") : -1;
+    int stealCounter = bench? BenchAddCounter("soft_steals") : -1;
+    int throughputCounter = bench? BenchAddCounter("soft_mpix_per_s") : -1;
+
+    SoftStats stats = { 0 };
+    double recordedTime = 0.0;
+    int recordedFrames = 0;
+
+    for (int frame = 0; bench? !BenchIsFinished() : (frame < 1); frame++)
+    {
+        if (bench) BenchBeginFrame();
+
+        // Same camera path and light motion as the window benchmark, 60 frames per second
+        Camera camera = GetBenchCamera(frame, bench? BenchGetFrameCount() : 1);
+
+        lightCount = firstExtraLight;
+        for (int i = 4; i < lightTotal; i++) lights[lightCount++] = GetSoftLight(GetSceneLight(i, frame/60.0f));
+        SetSoftLights(renderer, lights, lightCount);
+
+        ClearSoftDraws(renderer);
+        for (int c = 0; c < copies; c++)
+        {
+            for (int m = 0; m < data.meshCount; m++) AddSoftDraw(renderer, data.meshes[m], &materials[data.meshMaterial[m]], copyTransforms[c]);
         }
 
-            EndMode3D();
+        BenchBeginPass(renderPass);
+        stats = RenderSoft(renderer, camera, BLACK, pool);
+        BenchEndPass(renderPass);
 
-            DrawText("Cottage", screenWidth - 210, screenHeight - 20, 10, GRAY);
+        if (bench)
+        {
+            BenchSetCounter(setupCounter, (int)(stats.setupTime*1000000.0));
+            BenchSetCounter(rasterCounter, (int)(stats.rasterTime*1000000.0));
+            BenchSetCounter(triangleCounter, stats.trianglesRasterized);
+            BenchSetCounter(fragmentCounter, (int)stats.fragments);
+            BenchSetCounter(stealCounter, stats.steals);
+            BenchSetCounter(throughputCounter, (int)(width*height/stats.renderTime/1000000.0));
 
-            DrawFPS(10, 10);
+            if (frame >= warmupFrames)
+            {
+                recordedTime += stats.renderTime;
+                recordedFrames++;
+            }
 
-        EndDrawing();
-        //----------------------------------------------------------------------------------
+            BenchEndFrame();
+        }
     }
 
-    // De-Initialization
-    //--------------------------------------------------------------------------------------
-    UnloadModel(scene);         // Unload model
+    if (bench)
+    {
+        BenchExportReport(reportFileName);
+        BenchClose();
 
-    CloseWindow();          // Close window and OpenGL context
-    //--------------------------------------------------------------------------------------
+        if (recordedFrames > 0) TraceLog(LOG_INFO, "SOFT: %.2f MPix/s, %.2f ms per frame over %i frames (%i workers, %i lanes)",
+            (double)width*height*recordedFrames/recordedTime/1000000.0, recordedTime*1000.0/recordedFrames, recordedFrames, stats.workers, stats.lanes);
+    }
 
-    return 0;
+    bool written = true;
+    if (imageFileName != NULL)
+    {
+        Image image = GetSoftImage(renderer);
+        written = ExportImage(image, imageFileName);
+        UnloadImage(image);
+
+        TraceLog(LOG_INFO, "SOFT: [%s] Frame written (%i triangles, %lld fragments, %.2f ms)", imageFileName, stats.trianglesRasterized, stats.fragments, stats.renderTime*1000.0);
+    }
+
+    UnloadSoftRenderer(renderer);
+    RL_FREE(copyTransforms);
+    RL_FREE(materials);
+    UnloadSceneData(data);
+
+    return written;
 }
 
-// Create light with provided data
-// NOTE: It updated the global lightCount and it's limited to MAX_LIGHTS
-static Light CreateLight(int type, Vector3 position, Vector3 target, Color color, float intensity, Shader shader)
+// Print block compression quality and encoder throughput for the model textures
+// NOTE: Only the first level is measured, quality is PSNR over the channels the shader reads.
+// Data maps are loaded uncompressed, their DXT1 loss is printed per channel to show why
+static int PrintTextureCompressionReport(const char *fileName, JobPool *pool)
 {
-    Light light = { 0 };
+    TextureRequest *requests = (TextureRequest *)RL_CALLOC(TEXLOAD_MAX_REQUESTS, sizeof(TextureRequest));
+    int requestCount = GetGltfTextureRequests(fileName, requests, TEXLOAD_MAX_REQUESTS);
+    int reported = 0;
+
+    TraceLog(LOG_INFO, "BCENC: Encoding with 1 and %i threads", GetJobPoolThreadCount(pool) + 1);
 
-    if (lightCount < MAX_LIGHTS)
+    for (int i = 0; i < requestCount; i++)
     {
-        light.enabled = 1;
-        light.type = type;
-        light.position = position;
-        light.target = target;
-        light.color[0] = (float)color.r/255.0f;
-        light.color[1] = (float)color.g/255.0f;
-        light.color[2] = (float)color.b/255.0f;
-        light.color[3] = (float)color.a/255.0f;
-        light.intensity = intensity;
+        bool duplicate = false;
+        for (int j = 0; j < i; j++) if (TextIsEqual(requests[i].fileName, requests[j].fileName)) duplicate = true;
+        if (duplicate) continue;
+
+        Image source = LoadImage(requests[i].fileName);
+        if (!IsImageBCCompressible(source))
+        {
+            UnloadImage(source);
+            continue;
+        }
+        ImageFormat(&source, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+        bool normalMap = (requests[i].map == MATERIAL_MAP_NORMAL);
+        bool dataMap = !normalMap && (requests[i].map != MATERIAL_MAP_ALBEDO) && (requests[i].map != MATERIAL_MAP_EMISSION);
+        int format = normalMap? PIXELFORMAT_COMPRESSED_DXT5_RGBA : PIXELFORMAT_COMPRESSED_DXT1_RGB;
+        int flags = normalMap? BC_FLAG_NORMAL_XY : 0;
+
+        Image serial = ImageCopy(source);
+        double start = BenchGetTime();
+        ImageCompressBC(&serial, format, flags, NULL);
+        double serialTime = BenchGetTime() - start;
+
+        Image parallel = ImageCopy(source);
+        start = BenchGetTime();
+        ImageCompressBC(&parallel, format, flags, pool);
+        double parallelTime = BenchGetTime() - start;
+
+        Image decoded = ImageDecompressBC(parallel);
+        const unsigned char *expected = (const unsigned char *)source.data;
+        const unsigned char *actual = (const unsigned char *)decoded.data;
+        double errorSum = 0.0;
+        double channelErrorSum[3] = { 0 };
+        long long samples = 0;
+
+        for (long long p = 0; p < (long long)source.width*source.height; p++)
+        {
+            const unsigned char *a = expected + p*4;
+            const unsigned char *b = actual + p*4;
 
-        // NOTE: Shader parameters names for lights must match the requested ones
-        light.enabledLoc = GetShaderLocation(shader, TextFormat("lights[%i].enabled", lightCount));
-        light.typeLoc = GetShaderLocation(shader, TextFormat("lights[%i].type", lightCount));
-        light.positionLoc = GetShaderLocation(shader, TextFormat("lights[%i].position", lightCount));
-        light.targetLoc = GetShaderLocation(shader, TextFormat("lights[%i].target", lightCount));
-        light.colorLoc = GetShaderLocation(shader, TextFormat("lights[%i].color", lightCount));
-        light.intensityLoc = GetShaderLocation(shader, TextFormat("lights[%i].intensity", lightCount));
+            if (normalMap)
+            {
+                // DXT5nm: X is read back from alpha, Y from green
+                errorSum += (double)(a[0] - b[3])*(a[0] - b[3]) + (double)(a[1] - b[1])*(a[1] - b[1]);
+                samples += 2;
+            }
+            else
+            {
+                for (int c = 0; c < 3; c++)
+                {
+                    errorSum += (double)(a[c] - b[c])*(a[c] - b[c]);
+                    channelErrorSum[c] += (double)(a[c] - b[c])*(a[c] - b[c]);
+                }
+                samples += 3;
+            }
+        }
+
+        double mse = errorSum/(double)samples;
+        double psnr = (mse > 0.0)? 10.0*log10(255.0*255.0/mse) : 99.0;
+        double megapixels = (double)source.width*source.height/1000000.0;
+
+        TraceLog(LOG_INFO, "BCENC: %-32s %4ix%-4i %-6s PSNR: %6.2f dB | %7.1f MPix/s (1 thread) | %7.1f MPix/s (pool)",
+            GetFileName(requests[i].fileName), source.width, source.height, normalMap? "DXT5nm" : "DXT1", psnr,
+            megapixels/serialTime, megapixels/parallelTime);
+
+        if (dataMap)
+        {
+            // MRA channels share the DXT1 endpoint line, a flat channel loses precision to its varying neighbors
+            double channelPsnr[3] = { 0 };
+            for (int c = 0; c < 3; c++)
+            {
+                double channelMse = channelErrorSum[c]/(double)(samples/3);
+                channelPsnr[c] = (channelMse > 0.0)? 10.0*log10(255.0*255.0/channelMse) : 99.0;
+            }
 
-        UpdateLight(shader, light);
+            TraceLog(LOG_INFO, "BCENC: %-32s occlusion %6.2f dB | roughness %6.2f dB | metalness %6.2f dB, kept uncompressed",
+                GetFileName(requests[i].fileName), channelPsnr[0], channelPsnr[1], channelPsnr[2]);
+        }
 
-        lightCount++;
+        UnloadImage(decoded);
+        UnloadImage(parallel);
+        UnloadImage(serial);
+        UnloadImage(source);
+        reported++;
     }
 
-    return light;
+    RL_FREE(requests);
+
+    return reported;
 }
 
-// Send light properties to shader
-// NOTE: Light shader locations should be available
-static void UpdateLight(Shader shader, Light light)
+// Print load times of the glTF and scene file paths
+// NOTE: Every path runs once untimed so file and texture caches are warm
+static void PrintLoadReport(const char *gltfFileName, const char *sceneFileName, JobPool *pool)
 {
-    SetShaderValue(shader, light.enabledLoc, &light.enabled, SHADER_UNIFORM_INT);
-    SetShaderValue(shader, light.typeLoc, &light.type, SHADER_UNIFORM_INT);
+    const char *names[4] = { "LoadModel()", "LoadModelParallel()", "BuildSceneFile()", "LoadScene()" };
+    double times[4] = { 0 };
+
+    for (int run = 0; run <= LOAD_REPORT_RUNS; run++)
+    {
+        double elapsed[4] = { 0 };
+        Model models[2] = { 0 };
 
-    // Send to shader light position values
-    float position[3] = { light.position.x, light.position.y, light.position.z };
-    SetShaderValue(shader, light.positionLoc, position, SHADER_UNIFORM_VEC3);
+        double start = BenchGetTime();
+        models[0] = LoadModel(gltfFileName);
+        elapsed[0] = BenchGetTime() - start;
 
-    // Send to shader light target position values
-    float target[3] = { light.target.x, light.target.y, light.target.z };
-    SetShaderValue(shader, light.targetLoc, target, SHADER_UNIFORM_VEC3);
-    SetShaderValue(shader, light.colorLoc, light.color, SHADER_UNIFORM_VEC4);
-    SetShaderValue(shader, light.intensityLoc, &light.intensity, SHADER_UNIFORM_FLOAT);
-}
\ No newline at end of file
+        start = BenchGetTime();
+        models[1] = LoadModelParallel(gltfFileName, pool);
+        elapsed[1] = BenchGetTime() - start;
+
+        start = BenchGetTime();
+        BuildSceneFile(gltfFileName, sceneFileName, pool);
+        elapsed[2] = BenchGetTime() - start;
+
+        start = BenchGetTime();
+        Scene scene = LoadScene(sceneFileName, pool);
+        elapsed[3] = BenchGetTime() - start;
+
+        // NOTE: UnloadModel() leaves material textures to the caller
+        for (int m = 0; m < 2; m++)
+        {
+            UnloadMaterialTextures(models[m].materials, models[m].materialCount);
+            UnloadModel(models[m]);
+        }
+        UnloadScene(scene);
+
+        if (run > 0) for (int i = 0; i < 4; i++) times[i] += elapsed[i]/LOAD_REPORT_RUNS;
+    }
+
+    for (int i = 0; i < 4; i++) TraceLog(LOG_INFO, "LOAD: %-20s %8.2f ms (mean of %i runs)", names[i], times[i]*1000.0, LOAD_REPORT_RUNS);
+}
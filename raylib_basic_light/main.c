@@ -22,8 +22,20 @@
 
 #include "raymath.h"
 
+#define RPROF_IMPLEMENTATION
+#include "common/rprof.h"               // Included before rjobs.h, jobs are recorded as scopes
 #define RLIGHTS_IMPLEMENTATION
-#include "includes/rlights.h"
+#include "common/rlights.h"
+#define RSHADER_IMPLEMENTATION
+#include "common/rshader.h"
+#define RPOST_IMPLEMENTATION
+#include "common/rpost.h"
+#define RJOBS_IMPLEMENTATION
+#include "common/rjobs.h"
+#define RSOFT_IMPLEMENTATION
+#include "common/rsoft.h"
+#define RINSTANCE_IMPLEMENTATION
+#include "common/rinstance.h"
 
 #if defined(PLATFORM_DESKTOP)
 #define GLSL_VERSION            330
@@ -31,19 +43,77 @@
 #define GLSL_VERSION            100
 #endif
 
+#define INSTANCE_SPACING        2.0f    // Distance between instanced tori in world units
+#define INSTANCE_SCALE          0.2f    // Same scale as the single torus
+#define PROFILER_WIDTH          380     // Profiler overlay width in pixels
+#define POST_SAMPLES            4       // MSAA samples of the HDR scene target
+#define POST_MIN_SCALE          0.5f    // Lowest dynamic resolution scale
+
+#define STRESS_DEFAULT_FRAMES   240     // Frames measured per stress run
+#define STRESS_WARMUP           30      // Frames run before measuring
+#define STRESS_MAX_SINGLE_DRAWS 10000   // Larger runs with one draw call per torus take minutes
+
+// Set lighting shader locations and constant uniforms, again after a hot reload
+static void SetupLightingShader(Shader shader);
+
+// Set instanced lighting shader locations, the instance transform is a vertex attribute
+static void SetupInstancedLightingShader(Shader shader);
+
+// Draw 1k, 10k and 100k animated tori, instanced and one draw per torus, and log frame timings
+static void RunStressTest(Mesh mesh, Material material, Material instancedMaterial, PostProcess *post, JobPool *pool, int frames);
+
+// Render the torus with the CPU renderer and write it to fileName, the frames are timed
+static bool RenderTorusSoft(Model model, const Light *lights, int lightCount, Camera camera, const char *fileName, int frames, JobPool *pool);
+
 //------------------------------------------------------------------------------------
 // Program main entry point
 //------------------------------------------------------------------------------------
-int main(void)
+int main(int argc, char **argv)
 {
     // Initialization
     //--------------------------------------------------------------------------------------
     const int screenWidth = 800;
     const int screenHeight = 450;
 
-    SetConfigFlags(FLAG_MSAA_4X_HINT);  // Enable Multi Sampling Anti Aliasing 4x (if available)
+    // Instanced tori: basic_light --instances N
+    // Scaling benchmark: basic_light --stress [--frames N]
+    // Profiler: basic_light --profile shows the overlay (F1 toggles it), --trace trace.json writes a Chrome trace on exit
+    // Gamma per fragment instead of once per pixel: basic_light --no-post
+    // Dynamic resolution: basic_light --frame-budget MS holds the scene GPU time under MS, --scale S renders at a fixed scale
+    // CPU reference renderer: basic_light --soft-render image.png [--frames N] writes the first frame rendered by rsoft.h
+    int instanceCount = 0;
+    bool stressTest = false;
+    int stressFrames = STRESS_DEFAULT_FRAMES;
+    bool profilerOverlay = false;
+    const char *traceOutput = NULL;
+    bool postProcess = true;
+    float frameBudget = 0.0f;
+    float resolutionScale = 1.0f;
+    const char *softImage = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (TextIsEqual(argv[i], "--instances") && (i + 1 < argc)) instanceCount = TextToInteger(argv[++i]);
+        else if (TextIsEqual(argv[i], "--stress")) stressTest = true;
+        else if (TextIsEqual(argv[i], "--frames") && (i + 1 < argc)) stressFrames = TextToInteger(argv[++i]);
+        else if (TextIsEqual(argv[i], "--no-post")) postProcess = false;
+        else if (TextIsEqual(argv[i], "--frame-budget") && (i + 1 < argc)) frameBudget = TextToFloat(argv[++i]);
+        else if (TextIsEqual(argv[i], "--scale") && (i + 1 < argc)) resolutionScale = TextToFloat(argv[++i]);
+        else if (TextIsEqual(argv[i], "--profile")) profilerOverlay = true;
+        else if (TextIsEqual(argv[i], "--trace") && (i + 1 < argc)) traceOutput = argv[++i];
+        else if (TextIsEqual(argv[i], "--soft-render") && (i + 1 < argc)) softImage = argv[++i];
+    }
+
+    // NOTE: With post-process the HDR scene target is multisampled instead of the window
+    if (!postProcess) SetConfigFlags(FLAG_MSAA_4X_HINT);  // Enable Multi Sampling Anti Aliasing 4x (if available)
+    // NOTE: The CPU renderer needs no window, it stays hidden and only provides the context LoadModel() uploads to
+    if (softImage != NULL) SetConfigFlags(FLAG_WINDOW_HIDDEN);
     InitWindow(screenWidth, screenHeight, "raylib [shaders] example - basic lighting");
 
+    ProfInit();
+    int drawCallProfCounter = ProfAddCounter("draw_calls");
+    int triangleProfCounter = ProfAddCounter("triangles");
+
     // Define the camera to look into our 3d world
     Camera camera = { 0 };
     camera.position = (Vector3){ 2.0f, 4.0f, 6.0f };    // Camera position
@@ -55,27 +125,102 @@ int main(void)
     Model model = LoadModel("resources/torus.glb");
     Texture texture = LoadTexture("resources/torus_diffuse.png");
 
-    // Load basic lighting shader
-    Shader shader = LoadShader(TextFormat("resources/shaders/lighting.vert", GLSL_VERSION),
-                               TextFormat("resources/shaders/lighting.frag", GLSL_VERSION));
-    // Get some required shader locations
-    shader.locs[SHADER_LOC_VECTOR_VIEW] = GetShaderLocation(shader, "viewPos");
+    // Load basic lighting shader, the linked program is cached and reloaded when the sources change
+    SetShaderCacheDirectory("resources/cache");
 
-    // Ambient light level (some basic lighting)
-    int ambientLoc = GetShaderLocation(shader, "ambient");
-    // ambient light is dark grey (rgba(0.1, 0.1, 0.1, 0.1))
-    SetShaderValue(shader, ambientLoc, (float[4]){ 0.1f, 0.1f, 0.1f, 1.0f }, SHADER_UNIFORM_VEC4);
+    // Lighting writes linear color to an HDR target, gamma runs once per pixel in the post-process pass
+    PostProcess *post = postProcess? LoadPostProcess(screenWidth, screenHeight, POST_SAMPLES) : NULL;
+    Shader postShader = { 0 };
+
+    if (post != NULL)
+    {
+        AddPostEffect(post, POST_GAMMA);
+        postShader = LoadShaderCached("resources/shaders/post.vert", "resources/shaders/post.frag", GetPostShaderDefines(post));
+        SetPostShader(post, postShader);
+        SetPostScale(post, resolutionScale);
+        if (frameBudget > 0.0f) SetPostDynamicResolution(post, frameBudget/1000.0, POST_MIN_SCALE);
+    }
+
+    const char *outputDefines = (post != NULL)? "#define HDR_OUTPUT\n" : "";
+
+    Shader shader = LoadShaderCached("resources/shaders/lighting.vert", "resources/shaders/lighting.frag", outputDefines);
+    SetupLightingShader(shader);
+
+    // Instanced variant of the same shader, the transform and tint of every torus come from the instance buffer
+    Shader instancedShader = LoadShaderCached("resources/shaders/lighting.vert", "resources/shaders/lighting.frag", TextFormat("#define INSTANCING\n%s", outputDefines));
+    SetupInstancedLightingShader(instancedShader);
 
-    // Create lights
-    Light lights[MAX_LIGHTS] = { 0 };
-    lights[0] = CreateLight(LIGHT_POINT, (Vector3){ -2, 1, -2 }, Vector3Zero(), WHITE, shader);
-    lights[1] = CreateLight(LIGHT_POINT, (Vector3){ 2, 1, 2 }, Vector3Zero(), RED, shader);
-    lights[2] = CreateLight(LIGHT_POINT, (Vector3){ -2, 1, 2 }, Vector3Zero(), GREEN, shader);
-    lights[3] = CreateLight(LIGHT_POINT, (Vector3){ 2, 1, -2 }, Vector3Zero(), BLUE, shader);
+    // Create lights, stored in a uniform buffer the shader reads through its LightBlock
+    LoadLights();
+
+    Light lights[4] = { 0 };
+    lights[0] = CreateLight(LIGHT_POINT, (Vector3){ -2, 1, -2 }, Vector3Zero(), WHITE, 1.0f);
+    lights[1] = CreateLight(LIGHT_POINT, (Vector3){ 2, 1, 2 }, Vector3Zero(), RED, 1.0f);
+    lights[2] = CreateLight(LIGHT_POINT, (Vector3){ -2, 1, 2 }, Vector3Zero(), GREEN, 1.0f);
+    lights[3] = CreateLight(LIGHT_POINT, (Vector3){ 2, 1, -2 }, Vector3Zero(), BLUE, 1.0f);
+
+    // Enable only the first light
+    for (int i = 1; i < 4; i++)
+    {
+        lights[i].enabled = false;
+        UpdateLightValues(lights[i]);
+    }
 
     model.materials[1].shader = shader;                     // Set shader effect to 3d model
     model.materials[1].maps[MATERIAL_MAP_DIFFUSE].texture = texture; // Bind texture to model
 
+    // Instanced material shares the maps of the model material
+    Material instancedMaterial = model.materials[1];
+    instancedMaterial.shader = instancedShader;
+
+    // Worker threads used to animate the instances
+    JobPool *jobs = LoadJobPool(-1);
+
+    if (stressTest)
+    {
+        UploadLights();
+        RunStressTest(model.meshes[0], model.materials[1], instancedMaterial, post, jobs, stressFrames);
+
+        UnloadJobPool(jobs);
+        ProfClose();
+        UnloadLights();
+        UnloadShaderCached(instancedShader);
+        UnloadShaderCached(shader);
+        if (post != NULL) UnloadShaderCached(postShader);
+        UnloadPostProcess(post);
+        UnloadTexture(texture);
+        UnloadModel(model);
+        CloseWindow();
+
+        return 0;
+    }
+
+    if (softImage != NULL)
+    {
+        bool rendered = RenderTorusSoft(model, lights, 4, camera, softImage, stressFrames, jobs);
+
+        UnloadJobPool(jobs);
+        ProfClose();
+        UnloadLights();
+        UnloadShaderCached(instancedShader);
+        UnloadShaderCached(shader);
+        if (post != NULL) UnloadShaderCached(postShader);
+        UnloadPostProcess(post);
+        UnloadTexture(texture);
+        UnloadModel(model);
+        CloseWindow();
+
+        return rendered? 0 : 1;
+    }
+
+    InstanceSet instances = { 0 };
+    if (instanceCount > 0)
+    {
+        instances = LoadInstanceSet(instanceCount, INSTANCE_SPACING, INSTANCE_SCALE);
+        camera.position = (Vector3){ 0.6f*instances.size, 0.5f*instances.size, 0.9f*instances.size };
+        camera.target = Vector3Zero();
+    }
+
     Vector3 position = { 0.0f, 0.0f, 0.0f };    // Set model position
 
     SetTargetFPS(60);                   // Set our game to run at 60 frames-per-second
@@ -84,13 +229,40 @@ int main(void)
     // Main game loop
     while (!WindowShouldClose())        // Detect window close button or ESC key
     {
+        ProfBeginFrame();
+
         // Update
         //----------------------------------------------------------------------------------
+        ProfBeginScope("Update");
+
+        if (IsKeyPressed(KEY_F1)) profilerOverlay = !profilerOverlay;
+
         UpdateCamera(&camera, CAMERA_ORBITAL);
 
+        // Recompile the shaders when lighting.vert/lighting.frag are saved
+        if (ReloadShaderChanged(&shader))
+        {
+            SetupLightingShader(shader);
+            model.materials[1].shader = shader;
+        }
+
+        if (ReloadShaderChanged(&instancedShader))
+        {
+            SetupInstancedLightingShader(instancedShader);
+            instancedMaterial.shader = instancedShader;
+        }
+
+        if ((post != NULL) && ReloadShaderChanged(&postShader)) SetPostShader(post, postShader);
+
         // Update the shader with the camera view vector (points towards { 0.0f, 0.0f, 0.0f })
         float cameraPos[3] = { camera.position.x, camera.position.y, camera.position.z };
         SetShaderValue(shader, shader.locs[SHADER_LOC_VECTOR_VIEW], cameraPos, SHADER_UNIFORM_VEC3);
+        SetShaderValue(instancedShader, instancedShader.locs[SHADER_LOC_VECTOR_VIEW], cameraPos, SHADER_UNIFORM_VEC3);
+
+        // Animate instances on the worker threads
+        ProfBeginScope("Instances");
+        if (instanceCount > 0) UpdateInstanceSet(instances, (float)GetTime(), jobs);
+        ProfEndScope();
 
         // Check key inputs to enable/disable lights
 //        if (IsKeyPressed(KEY_Y)) { lights[0].enabled = !lights[0].enabled; }
@@ -99,24 +271,51 @@ int main(void)
 //        if (IsKeyPressed(KEY_B)) { lights[3].enabled = !lights[3].enabled; }
 
         // Update light values (actually, only enable/disable them)
-        // for (int i = 0; i < MAX_LIGHTS; i++) UpdateLightValues(shader, lights[i]);
+        // NOTE: Unchanged lights are not uploaded again
+        for (int i = 0; i < 4; i++) UpdateLightValues(lights[i]);
+        UploadLights();
 
-        // Enable only the first light
-        UpdateLightValues(shader, lights[0]);
+        ProfEndScope();
         //----------------------------------------------------------------------------------
 
         // Draw
         //----------------------------------------------------------------------------------
+        ProfBeginScope("Draw");
         BeginDrawing();
 
+            BeginPostScene(post);       // Scene goes to the HDR target, nothing without post-process
+
             ClearBackground(RAYWHITE);
 
+            ProfBeginScope("Scene");
+            ProfBeginGpuScope("Scene");
+
             BeginMode3D(camera);
 
-                DrawModel(model, position, 0.2f, WHITE);   // Draw 3d model with texture
+                if (instanceCount > 0) DrawInstanceSet(instances, model.meshes[0], instancedMaterial);  // One draw call for all tori
+                else DrawModel(model, position, 0.2f, WHITE);   // Draw 3d model with texture
+
+            EndMode3D();
+
+            ProfEndGpuScope();
+            ProfEndScope();
+
+            // Resolve the scene and apply gamma, one pass over the screen
+            if (post != NULL)
+            {
+                ProfBeginScope("Post");
+                ProfBeginGpuScope("Post");
+                EndPostScene(post);
+                DrawPostProcess(post);
+                ProfEndGpuScope();
+                ProfEndScope();
+            }
+
+            // Markers keep their display colors, the post pass wrote the scene depth they are tested against
+            BeginMode3D(camera);
 
                 // Draw spheres to show where the lights are
-                for (int i = 0; i < MAX_LIGHTS; i++)
+                for (int i = 0; i < 4; i++)
                 {
                     if (lights[i].enabled) DrawSphereEx(lights[i].position, 0.2f, 8, 8, lights[i].color);
                     else DrawSphereWires(lights[i].position, 0.2f, 8, 8, ColorAlpha(lights[i].color, 0.3f));
@@ -126,17 +325,41 @@ int main(void)
 
             EndMode3D();
 
+            // Scaled scene size, the text stays at the window resolution
+            PostResolution resolution = GetPostResolution(post);
+            if ((post != NULL) && ((frameBudget > 0.0f) || (resolutionScale < 1.0f))) DrawText(TextFormat("Scene: %ix%i (%.0f%%), %.2f ms GPU", resolution.width, resolution.height, resolution.scale*100.0f, resolution.sceneTime*1000.0), 10, 100, 20, DARKGRAY);
+
             DrawFPS(10, 10);
 
+            if (instanceCount > 0) DrawText(TextFormat("%i instanced tori", instanceCount), 10, 70, 20, DARKGRAY);
             DrawText("Use keys [Y][R][G][B] to toggle lights", 10, 40, 20, DARKGRAY);
 
+            if (profilerOverlay) DrawProfiler(screenWidth - PROFILER_WIDTH - 10, 10, PROFILER_WIDTH);
+
+        ProfBeginScope("Present");
         EndDrawing();
+        ProfEndScope();
+
+        ProfEndScope();
+
+        ProfCount(drawCallProfCounter, (instanceCount > 0)? 1 : model.meshCount);
+        ProfCount(triangleProfCounter, model.meshes[0].triangleCount*((instanceCount > 0)? instanceCount : 1));
+        ProfEndFrame();
         //----------------------------------------------------------------------------------
     }
 
     // De-Initialization
     //--------------------------------------------------------------------------------------
-    UnloadShader(shader);   // Unload shader
+    if (instanceCount > 0) UnloadInstanceSet(instances);
+    if (traceOutput != NULL) ProfExportTrace(traceOutput);
+
+    UnloadJobPool(jobs);    // Stop worker threads
+    ProfClose();            // Release profiler queries
+    UnloadLights();         // Unload light buffer
+    UnloadShaderCached(instancedShader);    // Unload instanced shader
+    UnloadShaderCached(shader); // Unload shader
+    if (post != NULL) UnloadShaderCached(postShader);
+    UnloadPostProcess(post);    // Unload HDR scene target
     UnloadTexture(texture);     // Unload texture
     UnloadModel(model);         // Unload model
 
@@ -145,3 +368,182 @@ int main(void)
 
     return 0;
 }
+
+// Set lighting shader locations and constant uniforms
+static void SetupLightingShader(Shader shader)
+{
+    // Get some required shader locations
+    shader.locs[SHADER_LOC_VECTOR_VIEW] = GetShaderLocation(shader, "viewPos");
+
+    // Ambient light level (some basic lighting)
+    int ambientLoc = GetShaderLocation(shader, "ambient");
+    // ambient light is dark grey (rgba(0.1, 0.1, 0.1, 0.1))
+    SetShaderValue(shader, ambientLoc, (float[4]){ 0.1f, 0.1f, 0.1f, 1.0f }, SHADER_UNIFORM_VEC4);
+
+    // Lights are read from the light buffer through the LightBlock uniform block
+    SetShaderLights(shader);
+}
+
+// Set instanced lighting shader locations
+// NOTE: DrawMeshInstanced() binds the instance buffer to the SHADER_LOC_MATRIX_MODEL attribute
+static void SetupInstancedLightingShader(Shader shader)
+{
+    SetupLightingShader(shader);
+    shader.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(shader, "instanceTransform");
+}
+
+// Draw 1k, 10k and 100k animated tori and log average frame, update and draw submission times
+// NOTE: Every count is drawn instanced and, up to STRESS_MAX_SINGLE_DRAWS, with one draw call per torus.
+// Frame time includes waiting for the GPU, so where it grows faster than the draw submission time
+// the run is limited by vertex or fragment work instead of per draw overhead
+static void RunStressTest(Mesh mesh, Material material, Material instancedMaterial, PostProcess *post, JobPool *pool, int frames)
+{
+    const int counts[3] = { 1000, 10000, 100000 };
+
+    if (frames < 1) frames = STRESS_DEFAULT_FRAMES;
+    SetTargetFPS(0);                    // Measure uncapped frames
+
+    TraceLog(LOG_INFO, "STRESS: %i frames per run, %i worker threads", frames, GetJobPoolThreadCount(pool));
+
+    for (int c = 0; c < 3; c++)
+    {
+        InstanceSet instances = LoadInstanceSet(counts[c], INSTANCE_SPACING, INSTANCE_SCALE);
+
+        Camera camera = { 0 };
+        camera.position = (Vector3){ 0.6f*instances.size, 0.5f*instances.size, 0.9f*instances.size };
+        camera.target = Vector3Zero();
+        camera.up = (Vector3){ 0.0f, 1.0f, 0.0f };
+        camera.fovy = 45.0f;
+        camera.projection = CAMERA_PERSPECTIVE;
+
+        float cameraPos[3] = { camera.position.x, camera.position.y, camera.position.z };
+        SetShaderValue(material.shader, material.shader.locs[SHADER_LOC_VECTOR_VIEW], cameraPos, SHADER_UNIFORM_VEC3);
+        SetShaderValue(instancedMaterial.shader, instancedMaterial.shader.locs[SHADER_LOC_VECTOR_VIEW], cameraPos, SHADER_UNIFORM_VEC3);
+
+        for (int instanced = 1; instanced >= 0; instanced--)
+        {
+            if (!instanced && (counts[c] > STRESS_MAX_SINGLE_DRAWS)) continue;
+
+            double updateTime = 0.0;
+            double drawTime = 0.0;
+            double frameStart = 0.0;
+
+            for (int frame = 0; frame < STRESS_WARMUP + frames; frame++)
+            {
+                if (frame == STRESS_WARMUP)
+                {
+                    updateTime = 0.0;
+                    drawTime = 0.0;
+                    frameStart = GetTime();
+                }
+
+                double time = GetTime();
+                UpdateInstanceSet(instances, frame/60.0f, pool);
+                updateTime += GetTime() - time;
+
+                BeginDrawing();
+
+                    BeginPostScene(post);
+
+                    ClearBackground(RAYWHITE);
+
+                    BeginMode3D(camera);
+
+                        time = GetTime();
+                        if (instanced) DrawInstanceSet(instances, mesh, instancedMaterial);
+                        else DrawInstanceSetSingle(instances, mesh, material);
+                        drawTime += GetTime() - time;
+
+                    EndMode3D();
+
+                    EndPostScene(post);
+                    DrawPostProcess(post);
+
+                    DrawText(TextFormat("%i tori, %s", counts[c], instanced? "instanced" : "one draw each"), 10, 10, 20, DARKGRAY);
+
+                EndDrawing();
+            }
+
+            double frameTime = (GetTime() - frameStart)/frames;
+
+            TraceLog(LOG_INFO, "STRESS: %6i tori | %-13s | frame %8.3f ms | update %7.3f ms | draw %8.3f ms", counts[c],
+                instanced? "instanced" : "one draw each", frameTime*1000.0, updateTime/frames*1000.0, drawTime/frames*1000.0);
+        }
+
+        UnloadInstanceSet(instances);
+    }
+}
+
+// Render the torus with the CPU renderer and write the first frame to fileName
+// NOTE: Same camera, diffuse texture, ambient and lights as lighting.frag in the window, without the grid,
+// light spheres and text. Every frame is the same, they are only rendered again to time them
+static bool RenderTorusSoft(Model model, const Light *lights, int lightCount, Camera camera, const char *fileName, int frames, JobPool *pool)
+{
+    if (frames < 1) frames = 1;
+
+    // Texture pixels are read on the CPU, the model texture only lives on the GPU
+    Image diffuse = LoadImage("resources/torus_diffuse.png");
+    if (diffuse.data == NULL) return false;
+    ImageFormat(&diffuse, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    Color color = model.materials[1].maps[MATERIAL_MAP_DIFFUSE].color;
+
+    SoftMaterial material = { 0 };
+    material.shading = SOFT_SHADING_PHONG;
+    material.albedoMap = diffuse;
+    material.albedoColor = (Vector4){ color.r/255.0f, color.g/255.0f, color.b/255.0f, color.a/255.0f };
+    material.ambientColor = (Vector3){ 0.1f, 0.1f, 0.1f };      // Same ambient as SetupLightingShader()
+    material.ambient = 1.0f;
+
+    SoftLight softLights[SOFT_MAX_LIGHTS] = { 0 };
+    if (lightCount > SOFT_MAX_LIGHTS) lightCount = SOFT_MAX_LIGHTS;
+
+    for (int i = 0; i < lightCount; i++)
+    {
+        softLights[i].type = (lights[i].type == LIGHT_DIRECTIONAL)? SOFT_LIGHT_DIRECTIONAL : SOFT_LIGHT_POINT;
+        softLights[i].enabled = lights[i].enabled;
+        softLights[i].position = lights[i].position;
+        softLights[i].target = lights[i].target;
+        softLights[i].color = (Vector3){ lights[i].color.r/255.0f, lights[i].color.g/255.0f, lights[i].color.b/255.0f };
+        softLights[i].intensity = lights[i].intensity;
+    }
+
+    // Same transform as DrawModel(model, position, 0.2f, WHITE) at the origin
+    Matrix transform = MatrixMultiply(model.transform, MatrixScale(0.2f, 0.2f, 0.2f));
+
+    SoftRenderer *renderer = LoadSoftRenderer(GetScreenWidth(), GetScreenHeight());
+    SetSoftLights(renderer, softLights, lightCount);
+    for (int i = 0; i < model.meshCount; i++) AddSoftDraw(renderer, model.meshes[i], &material, transform);
+
+    SoftStats stats = { 0 };
+    double renderTime = 0.0;
+
+    for (int frame = 0; frame < frames; frame++)
+    {
+        stats = RenderSoft(renderer, camera, RAYWHITE, pool);
+        renderTime += stats.renderTime;
+
+        // First frame is the image, the next ones are only timed
+        if (frame == 0)
+        {
+            Image image = GetSoftImage(renderer);
+            bool written = ExportImage(image, fileName);
+            UnloadImage(image);
+
+            if (!written)
+            {
+                UnloadSoftRenderer(renderer);
+                UnloadImage(diffuse);
+                return false;
+            }
+        }
+    }
+
+    TraceLog(LOG_INFO, "SOFT: [%s] %i frames, %.3f ms per frame, %.2f MPix/s (%i triangles, %i workers, %i lanes)", fileName, frames,
+        renderTime*1000.0/frames, (double)GetScreenWidth()*GetScreenHeight()*frames/renderTime/1000000.0, stats.trianglesRasterized, stats.workers, stats.lanes);
+
+    UnloadSoftRenderer(renderer);
+    UnloadImage(diffuse);
+
+    return true;
+}
@@ -15,20 +15,25 @@ out vec4 finalColor;
 
 // NOTE: Add here your custom variables
 
-#define     MAX_LIGHTS              4
+#define     MAX_LIGHTS              128     // Must match MAX_LIGHTS in rlights.h
 #define     LIGHT_DIRECTIONAL       0
 #define     LIGHT_POINT             1
 
+// std140 layout, matches LightData in rlights.h
 struct Light {
     int enabled;
     int type;
-    vec3 position;
-    vec3 target;
+    float intensity;
+    vec4 position;
+    vec4 target;
     vec4 color;
 };
 
-// Input lighting values
-uniform Light lights[MAX_LIGHTS];
+// Input lighting values, shared light buffer
+layout(std140) uniform LightBlock {
+    int lightCount;
+    Light lights[MAX_LIGHTS];
+};
 // ambient color
 uniform vec4 ambient;
 // camera position
@@ -48,7 +53,7 @@ void main()
 
     // NOTE: Implement here your fragment shader code
 
-    for (int i = 0; i < MAX_LIGHTS; i++)
+    for (int i = 0; i < lightCount; i++)
     {
         if (lights[i].enabled == 1)
         {
@@ -56,12 +61,12 @@ void main()
 
             if (lights[i].type == LIGHT_DIRECTIONAL)
             {
-                light = -normalize(lights[i].target - lights[i].position);
+                light = -normalize(lights[i].target.xyz - lights[i].position.xyz);
             }
 
             if (lights[i].type == LIGHT_POINT)
             {
-                light = normalize(lights[i].position - fragPosition);
+                light = normalize(lights[i].position.xyz - fragPosition);
             }
 
             float NdotL = max(dot(normal, light), 0.0);
@@ -76,6 +81,8 @@ void main()
     finalColor = (texelColor*((tint + vec4(specular, 1.0))*vec4(lightDot, 1.0)));
     finalColor += texelColor*(ambient/10.0)*tint;
 
-    // Gamma correction
+#if !defined(HDR_OUTPUT)
+    // Gamma correction, with HDR_OUTPUT it runs once per pixel in post.frag (see rpost.h)
     finalColor = pow(finalColor, vec4(1.0/2.2));
+#endif
 }
\ No newline at end of file
@@ -5,6 +5,9 @@ in vec3 vertexPosition;
 in vec2 vertexTexCoord;
 in vec3 vertexNormal;
 in vec4 vertexColor;
+#if defined(INSTANCING)
+in mat4 instanceTransform;      // Bottom row holds the instance tint (rinstance.h)
+#endif
 
 // Input uniform values
 uniform mat4 mvp;
@@ -21,6 +24,24 @@ out vec3 fragNormal;
 
 void main()
 {
+#if defined(INSTANCING)
+    // Instanced variant: DrawMeshInstanced() leaves matModel unset, the instance transform is the model matrix
+    vec4 instanceTint = vec4(instanceTransform[0].w, instanceTransform[1].w, instanceTransform[2].w, instanceTransform[3].w);
+    mat4 matInstance = instanceTransform;
+    matInstance[0].w = 0.0;
+    matInstance[1].w = 0.0;
+    matInstance[2].w = 0.0;
+    matInstance[3].w = 1.0;
+
+    // Send vertex attributes to fragment shader
+    fragPosition = vec3(matInstance*vec4(vertexPosition, 1.0));
+    fragTexCoord = vertexTexCoord;
+    fragColor = vertexColor*instanceTint;
+    fragNormal = normalize(vec3(matNormal*matInstance*vec4(vertexNormal, 0.0)));
+
+    // Calculate final vertex position
+    gl_Position = mvp*matInstance*vec4(vertexPosition, 1.0);
+#else
     // Send vertex attributes to fragment shader
     fragPosition = vec3(matModel*vec4(vertexPosition, 1.0));
     fragTexCoord = vertexTexCoord;
@@ -29,4 +50,5 @@ void main()
 
     // Calculate final vertex position
     gl_Position = mvp*vec4(vertexPosition, 1.0);
+#endif
 }
\ No newline at end of file
@@ -11,6 +11,11 @@ in vec2 vertexTexCoord;
 in vec3 vertexNormal;
 // rgb color for each vertex
 in vec4 vertexColor;
+#if defined(INSTANCING)
+// transformation matrix of each instance, drawn with DrawMeshInstanced()
+// the bottom row is free in an affine transform and carries the instance tint (rinstance.h)
+in mat4 instanceTransform;
+#endif
 
 // Input uniform values; these are automatically filled by Raylib
 // ====================================================================================
@@ -37,6 +42,27 @@ out vec4 fragColor;
 out vec3 fragNormal;
 
 void main() {
+#if defined(INSTANCING)
+    /**
+        Instanced variant: each instance brings its own model matrix, matModel is not set by DrawMeshInstanced()
+
+        1. Read the tint from the bottom row of the instance matrix
+        2. Restore the bottom row to (0, 0, 0, 1) so it is a plain affine transform again
+        3. Transform positions and normals with it (w = 0 for normals, they must not be translated)
+    */
+    vec4 instanceTint = vec4(instanceTransform[0].w, instanceTransform[1].w, instanceTransform[2].w, instanceTransform[3].w);
+    mat4 matInstance = instanceTransform;
+    matInstance[0].w = 0.0;
+    matInstance[1].w = 0.0;
+    matInstance[2].w = 0.0;
+    matInstance[3].w = 1.0;
+
+    fragPosition = vec3(matInstance*vec4(vertexPosition, 1.0));
+    fragTexCoord = vertexTexCoord;
+    fragColor = vertexColor*instanceTint;
+    fragNormal = normalize(vec3(matNormal*matInstance*vec4(vertexNormal, 0.0)));
+    gl_Position = mvp*matInstance*vec4(vertexPosition, 1.0);
+#else
     // Send vertex attributes to fragment shader
     /**
         1. Use vec4 to add the w dimension to each vertex' position
@@ -70,4 +96,5 @@ void main() {
             2.3 view space -> clip space (projection matrix: determines which vertices end up on the screen; adds perspective
     */
     gl_Position = mvp*vec4(vertexPosition, 1.0);
+#endif
 }
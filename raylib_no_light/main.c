@@ -20,25 +20,82 @@
 
 #include "raylib.h"
 
+#include "raymath.h"
+
+#define RPROF_IMPLEMENTATION
+#include "common/rprof.h"               // Included before rjobs.h, jobs are recorded as scopes
+#define RSHADER_IMPLEMENTATION
+#include "common/rshader.h"
+#define RPOST_IMPLEMENTATION
+#include "common/rpost.h"
+#define RJOBS_IMPLEMENTATION
+#include "common/rjobs.h"
+#define RINSTANCE_IMPLEMENTATION
+#include "common/rinstance.h"
+
 #if defined(PLATFORM_DESKTOP)
 #define GLSL_VERSION            330
 #else   // PLATFORM_ANDROID, PLATFORM_WEB
 #define GLSL_VERSION            100
 #endif
 
+#define INSTANCE_SPACING        2.0f    // Distance between instanced tori in world units
+#define INSTANCE_SCALE          0.2f    // Same scale as the single torus
+#define PROFILER_WIDTH          380     // Profiler overlay width in pixels
+#define POST_SAMPLES            4       // MSAA samples of the HDR scene target
+#define POST_MIN_SCALE          0.5f    // Lowest dynamic resolution scale
+
+#define STRESS_DEFAULT_FRAMES   240     // Frames measured per stress run
+#define STRESS_WARMUP           30      // Frames run before measuring
+#define STRESS_MAX_SINGLE_DRAWS 10000   // Larger runs with one draw call per torus take minutes
+
+// Draw 1k, 10k and 100k animated tori, instanced and one draw per torus, and log frame timings
+static void RunStressTest(Mesh mesh, Material material, Material instancedMaterial, PostProcess *post, JobPool *pool, int frames);
+
 //------------------------------------------------------------------------------------
 // Program main entry point
 //------------------------------------------------------------------------------------
-int main(void)
+int main(int argc, char **argv)
 {
     // Initialization
     //--------------------------------------------------------------------------------------
     const int screenWidth = 800;
     const int screenHeight = 450;
 
-    SetConfigFlags(FLAG_MSAA_4X_HINT);  // Enable Multi Sampling Anti Aliasing 4x (if available)
+    // Instanced tori: no_light --instances N
+    // Scaling benchmark: no_light --stress [--frames N]
+    // Profiler: no_light --profile shows the overlay (F1 toggles it), --trace trace.json writes a Chrome trace on exit
+    // Grayscale material shader instead of the grayscale screen pass: no_light --no-post
+    // Dynamic resolution: no_light --frame-budget MS holds the scene GPU time under MS, --scale S renders at a fixed scale
+    int instanceCount = 0;
+    bool stressTest = false;
+    int stressFrames = STRESS_DEFAULT_FRAMES;
+    bool profilerOverlay = false;
+    const char *traceOutput = NULL;
+    bool postProcess = true;
+    float frameBudget = 0.0f;
+    float resolutionScale = 1.0f;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (TextIsEqual(argv[i], "--instances") && (i + 1 < argc)) instanceCount = TextToInteger(argv[++i]);
+        else if (TextIsEqual(argv[i], "--stress")) stressTest = true;
+        else if (TextIsEqual(argv[i], "--frames") && (i + 1 < argc)) stressFrames = TextToInteger(argv[++i]);
+        else if (TextIsEqual(argv[i], "--no-post")) postProcess = false;
+        else if (TextIsEqual(argv[i], "--frame-budget") && (i + 1 < argc)) frameBudget = TextToFloat(argv[++i]);
+        else if (TextIsEqual(argv[i], "--scale") && (i + 1 < argc)) resolutionScale = TextToFloat(argv[++i]);
+        else if (TextIsEqual(argv[i], "--profile")) profilerOverlay = true;
+        else if (TextIsEqual(argv[i], "--trace") && (i + 1 < argc)) traceOutput = argv[++i];
+    }
+
+    // NOTE: With post-process the HDR scene target is multisampled instead of the window
+    if (!postProcess) SetConfigFlags(FLAG_MSAA_4X_HINT);  // Enable Multi Sampling Anti Aliasing 4x (if available)
     InitWindow(screenWidth, screenHeight, "model load");
 
+    ProfInit();
+    int drawCallProfCounter = ProfAddCounter("draw_calls");
+    int triangleProfCounter = ProfAddCounter("triangles");
+
     // Define the camera to look into our 3d world
     Camera camera = { 0 };
     camera.position = (Vector3){ 4.0f, 4.0f, 4.0f };    // Camera position
@@ -49,13 +106,68 @@ int main(void)
 
     Model model = LoadModel("resources/torus.glb");
     Texture texture = LoadTexture("resources/torus_diffuse.png");
-    // Load shader for model
-    // NOTE: Defining 0 (NULL) for vertex shader forces usage of internal default vertex shader
-    Shader shader = LoadShader(0, TextFormat("resources/shaders/grayscale.frag", GLSL_VERSION));
+
+    // The scene is rendered to an HDR target and turned gray once per pixel in the post-process pass,
+    // the chain shader is cached and reloaded when its sources change
+    SetShaderCacheDirectory("resources/cache");
+    PostProcess *post = postProcess? LoadPostProcess(screenWidth, screenHeight, POST_SAMPLES) : NULL;
+    Shader postShader = { 0 };
+
+    if (post != NULL)
+    {
+        AddPostEffect(post, POST_GRAYSCALE);
+        postShader = LoadShaderCached("resources/shaders/post.vert", "resources/shaders/post.frag", GetPostShaderDefines(post));
+        SetPostShader(post, postShader);
+        SetPostScale(post, resolutionScale);
+        if (frameBudget > 0.0f) SetPostDynamicResolution(post, frameBudget/1000.0, POST_MIN_SCALE);
+    }
+
+    // Load shader for model, grayscale per fragment only without the post-process pass
+    // NOTE: Defining 0 (NULL) for vertex shader forces usage of internal default vertex shader,
+    // 0 for fragment shader the internal default fragment shader
+    const char *fsFileName = (post != NULL)? NULL : "resources/shaders/grayscale.frag";
+    Shader shader = LoadShader(0, fsFileName);
+
+    // Instanced shader: same fragment shader, the transform and tint of every torus come from the instance buffer
+    // NOTE: DrawMeshInstanced() binds the instance buffer to the SHADER_LOC_MATRIX_MODEL attribute
+    Shader instancedShader = LoadShader("resources/shaders/instancing.vert", fsFileName);
+    instancedShader.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(instancedShader, "instanceTransform");
 
     model.materials[1].shader = shader;                     // Set shader effect to 3d model
     model.materials[1].maps[MATERIAL_MAP_DIFFUSE].texture = texture; // Bind texture to model
 
+    // Instanced material shares the maps of the model material
+    Material instancedMaterial = model.materials[1];
+    instancedMaterial.shader = instancedShader;
+
+    // Worker threads used to animate the instances
+    JobPool *jobs = LoadJobPool(-1);
+
+    if (stressTest)
+    {
+        RunStressTest(model.meshes[0], model.materials[1], instancedMaterial, post, jobs, stressFrames);
+
+        UnloadJobPool(jobs);
+        ProfClose();
+        UnloadShader(instancedShader);
+        UnloadShader(shader);
+        if (post != NULL) UnloadShaderCached(postShader);
+        UnloadPostProcess(post);
+        UnloadTexture(texture);
+        UnloadModel(model);
+        CloseWindow();
+
+        return 0;
+    }
+
+    InstanceSet instances = { 0 };
+    if (instanceCount > 0)
+    {
+        instances = LoadInstanceSet(instanceCount, INSTANCE_SPACING, INSTANCE_SCALE);
+        camera.position = (Vector3){ 0.6f*instances.size, 0.5f*instances.size, 0.9f*instances.size };
+        camera.target = Vector3Zero();
+    }
+
     Vector3 position = { 0.0f, 0.0f, 0.0f };    // Set model position
 
     DisableCursor();                    // Limit cursor to relative movement inside the window
@@ -65,36 +177,100 @@ int main(void)
     // Main game loop
     while (!WindowShouldClose())        // Detect window close button or ESC key
     {
+        ProfBeginFrame();
+
         // Update
         //----------------------------------------------------------------------------------
+        ProfBeginScope("Update");
+
+        if (IsKeyPressed(KEY_F1)) profilerOverlay = !profilerOverlay;
+
         UpdateCamera(&camera, CAMERA_FREE);
+
+        if ((post != NULL) && ReloadShaderChanged(&postShader)) SetPostShader(post, postShader);
+
+        // Animate instances on the worker threads
+        ProfBeginScope("Instances");
+        if (instanceCount > 0) UpdateInstanceSet(instances, (float)GetTime(), jobs);
+        ProfEndScope();
+
+        ProfEndScope();
         //----------------------------------------------------------------------------------
 
         // Draw
         //----------------------------------------------------------------------------------
+        ProfBeginScope("Draw");
         BeginDrawing();
 
+        BeginPostScene(post);       // Scene goes to the HDR target, nothing without post-process
+
         ClearBackground(RAYWHITE);
 
+        ProfBeginScope("Scene");
+        ProfBeginGpuScope("Scene");
+
         BeginMode3D(camera);
 
-        DrawModel(model, position, 0.2f, WHITE);   // Draw 3d model with texture
+        if (instanceCount > 0) DrawInstanceSet(instances, model.meshes[0], instancedMaterial);  // One draw call for all tori
+        else DrawModel(model, position, 0.2f, WHITE);   // Draw 3d model with texture
+
+        EndMode3D();
+
+        ProfEndGpuScope();
+        ProfEndScope();
+
+        // Resolve the scene and turn it gray, one pass over the screen
+        if (post != NULL)
+        {
+            ProfBeginScope("Post");
+            ProfBeginGpuScope("Post");
+            EndPostScene(post);
+            DrawPostProcess(post);
+            ProfEndGpuScope();
+            ProfEndScope();
+        }
+
+        // The grid keeps its display colors, the post pass wrote the scene depth it is tested against
+        BeginMode3D(camera);
 
         DrawGrid(10, 1.0f);     // Draw a grid
 
         EndMode3D();
 
+        // Scaled scene size, the text stays at the window resolution
+        PostResolution resolution = GetPostResolution(post);
+        if ((post != NULL) && ((frameBudget > 0.0f) || (resolutionScale < 1.0f))) DrawText(TextFormat("Scene: %ix%i (%.0f%%), %.2f ms GPU", resolution.width, resolution.height, resolution.scale*100.0f, resolution.sceneTime*1000.0), 10, 45, 10, GRAY);
+
         DrawText("Torus Knot", screenWidth - 210, screenHeight - 20, 10, GRAY);
+        if (instanceCount > 0) DrawText(TextFormat("%i instanced tori", instanceCount), 10, 30, 10, GRAY);
 
         DrawFPS(10, 10);
 
+        if (profilerOverlay) DrawProfiler(screenWidth - PROFILER_WIDTH - 10, 10, PROFILER_WIDTH);
+
+        ProfBeginScope("Present");
         EndDrawing();
+        ProfEndScope();
+
+        ProfEndScope();
+
+        ProfCount(drawCallProfCounter, (instanceCount > 0)? 1 : model.meshCount);
+        ProfCount(triangleProfCounter, model.meshes[0].triangleCount*((instanceCount > 0)? instanceCount : 1));
+        ProfEndFrame();
         //----------------------------------------------------------------------------------
     }
 
     // De-Initialization
     //--------------------------------------------------------------------------------------
+    if (instanceCount > 0) UnloadInstanceSet(instances);
+    if (traceOutput != NULL) ProfExportTrace(traceOutput);
+
+    UnloadJobPool(jobs);    // Stop worker threads
+    ProfClose();            // Release profiler queries
+    UnloadShader(instancedShader);  // Unload instanced shader
     UnloadShader(shader);   // Unload shader
+    if (post != NULL) UnloadShaderCached(postShader);
+    UnloadPostProcess(post);    // Unload HDR scene target
     UnloadTexture(texture);     // Unload texture
     UnloadModel(model);         // Unload model
 
@@ -103,3 +279,81 @@ int main(void)
 
     return 0;
 }
+
+// Draw 1k, 10k and 100k animated tori and log average frame, update and draw submission times
+// NOTE: Every count is drawn instanced and, up to STRESS_MAX_SINGLE_DRAWS, with one draw call per torus.
+// Frame time includes waiting for the GPU, so where it grows faster than the draw submission time
+// the run is limited by vertex or fragment work instead of per draw overhead
+static void RunStressTest(Mesh mesh, Material material, Material instancedMaterial, PostProcess *post, JobPool *pool, int frames)
+{
+    const int counts[3] = { 1000, 10000, 100000 };
+
+    if (frames < 1) frames = STRESS_DEFAULT_FRAMES;
+    SetTargetFPS(0);                    // Measure uncapped frames
+
+    TraceLog(LOG_INFO, "STRESS: %i frames per run, %i worker threads", frames, GetJobPoolThreadCount(pool));
+
+    for (int c = 0; c < 3; c++)
+    {
+        InstanceSet instances = LoadInstanceSet(counts[c], INSTANCE_SPACING, INSTANCE_SCALE);
+
+        Camera camera = { 0 };
+        camera.position = (Vector3){ 0.6f*instances.size, 0.5f*instances.size, 0.9f*instances.size };
+        camera.target = Vector3Zero();
+        camera.up = (Vector3){ 0.0f, 1.0f, 0.0f };
+        camera.fovy = 45.0f;
+        camera.projection = CAMERA_PERSPECTIVE;
+
+        for (int instanced = 1; instanced >= 0; instanced--)
+        {
+            if (!instanced && (counts[c] > STRESS_MAX_SINGLE_DRAWS)) continue;
+
+            double updateTime = 0.0;
+            double drawTime = 0.0;
+            double frameStart = 0.0;
+
+            for (int frame = 0; frame < STRESS_WARMUP + frames; frame++)
+            {
+                if (frame == STRESS_WARMUP)
+                {
+                    updateTime = 0.0;
+                    drawTime = 0.0;
+                    frameStart = GetTime();
+                }
+
+                double time = GetTime();
+                UpdateInstanceSet(instances, frame/60.0f, pool);
+                updateTime += GetTime() - time;
+
+                BeginDrawing();
+
+                BeginPostScene(post);
+
+                ClearBackground(RAYWHITE);
+
+                BeginMode3D(camera);
+
+                time = GetTime();
+                if (instanced) DrawInstanceSet(instances, mesh, instancedMaterial);
+                else DrawInstanceSetSingle(instances, mesh, material);
+                drawTime += GetTime() - time;
+
+                EndMode3D();
+
+                EndPostScene(post);
+                DrawPostProcess(post);
+
+                DrawText(TextFormat("%i tori, %s", counts[c], instanced? "instanced" : "one draw each"), 10, 10, 20, DARKGRAY);
+
+                EndDrawing();
+            }
+
+            double frameTime = (GetTime() - frameStart)/frames;
+
+            TraceLog(LOG_INFO, "STRESS: %6i tori | %-13s | frame %8.3f ms | update %7.3f ms | draw %8.3f ms", counts[c],
+                instanced? "instanced" : "one draw each", frameTime*1000.0, updateTime/frames*1000.0, drawTime/frames*1000.0);
+        }
+
+        UnloadInstanceSet(instances);
+    }
+}
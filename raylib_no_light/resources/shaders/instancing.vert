@@ -0,0 +1,34 @@
+#version 330
+
+// Input vertex attributes
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+in vec4 vertexColor;
+in mat4 instanceTransform;      // Bottom row holds the instance tint (rinstance.h)
+
+// Input uniform values
+uniform mat4 mvp;
+
+// Output vertex attributes (to fragment shader)
+out vec2 fragTexCoord;
+out vec4 fragColor;
+
+// NOTE: raylib default vertex shader, instanced: DrawMeshInstanced() leaves matModel unset,
+// the instance transform is the model matrix
+
+void main()
+{
+    vec4 instanceTint = vec4(instanceTransform[0].w, instanceTransform[1].w, instanceTransform[2].w, instanceTransform[3].w);
+    mat4 matInstance = instanceTransform;
+    matInstance[0].w = 0.0;
+    matInstance[1].w = 0.0;
+    matInstance[2].w = 0.0;
+    matInstance[3].w = 1.0;
+
+    // Send vertex attributes to fragment shader
+    fragTexCoord = vertexTexCoord;
+    fragColor = vertexColor*instanceTint;
+
+    // Calculate final vertex position
+    gl_Position = mvp*matInstance*vec4(vertexPosition, 1.0);
+}
\ No newline at end of file
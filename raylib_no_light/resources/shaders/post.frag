@@ -0,0 +1,93 @@
+#version 330
+
+// POST_CHAIN(color): calls of the effect functions in chain order, set by the loader
+// from GetPostShaderDefines() (see rpost.h). Without it the scene is copied as is
+#if !defined(POST_CHAIN)
+    #define POST_CHAIN(color)
+#endif
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+
+// Input uniform values
+uniform sampler2D texture0;     // Linear HDR scene color
+uniform sampler2D sceneDepth;   // Scene depth, written out so 3D drawn after this pass is hidden by the scene
+
+// Dynamic resolution: the scene fills the lower left part of texture0 and is stretched over the screen
+uniform vec4 postTexel;         // xy: texel size, zw: texture coordinates of the last scene texel center
+uniform float postSharpness;    // Sharpening of upscaled scenes, 0.0 at full resolution
+
+// Color grade, unused uniforms are removed when the chain has no POST_COLOR_GRADE
+uniform float postExposure;
+uniform vec3 postTint;
+uniform float postSaturation;
+uniform float postContrast;
+
+// Output fragment color
+out vec4 finalColor;
+
+// NTSC conversion weights
+const vec3 LUMA = vec3(0.299, 0.587, 0.114);
+
+// HDR tonemapping, the curve the scene shaders applied per fragment
+vec3 Tonemap(vec3 color)
+{
+    color = max(color, vec3(0.0));
+    return pow(color, color + vec3(1.0));
+}
+
+// Gamma correction
+vec3 Gamma(vec3 color)
+{
+    return pow(max(color, vec3(0.0)), vec3(1.0/2.2));
+}
+
+// Grayscale
+vec3 Grayscale(vec3 color)
+{
+    return vec3(dot(color, LUMA));
+}
+
+// Exposure and white balance, then saturation and contrast around middle gray
+vec3 ColorGrade(vec3 color)
+{
+    color *= postExposure*postTint;
+    color = mix(vec3(dot(color, LUMA)), color, postSaturation);
+
+    return max((color - vec3(0.18))*postContrast + vec3(0.18), vec3(0.0));
+}
+
+// Bilinear scene sample, clamped to the scene texels rendered this frame
+vec3 SampleScene(vec2 texCoord)
+{
+    return texture(texture0, min(texCoord, postTexel.zw)).rgb;
+}
+
+// Upscaled scene, sharpened with the four neighbours one scene texel away. The result is
+// clamped to the neighbourhood range, so edges get crisper without ringing
+vec3 UpscaleScene(vec2 texCoord)
+{
+    vec3 color = SampleScene(texCoord);
+    if (postSharpness <= 0.0) return color;
+
+    vec3 left = SampleScene(texCoord - vec2(postTexel.x, 0.0));
+    vec3 right = SampleScene(texCoord + vec2(postTexel.x, 0.0));
+    vec3 down = SampleScene(texCoord - vec2(0.0, postTexel.y));
+    vec3 up = SampleScene(texCoord + vec2(0.0, postTexel.y));
+
+    vec3 low = min(color, min(min(left, right), min(down, up)));
+    vec3 high = max(color, max(max(left, right), max(down, up)));
+    vec3 sharpened = color + postSharpness*(color - 0.25*(left + right + down + up));
+
+    return clamp(sharpened, low, high);
+}
+
+void main()
+{
+    vec3 color = UpscaleScene(fragTexCoord);
+
+    POST_CHAIN(color)
+
+    finalColor = vec4(color, 1.0);
+    gl_FragDepth = texture(sceneDepth, min(fragTexCoord, postTexel.zw)).r;
+}
@@ -0,0 +1,19 @@
+#version 330
+
+// Input vertex attributes
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+
+// Input uniform values
+uniform mat4 mvp;
+
+// Output vertex attributes (to fragment shader)
+out vec2 fragTexCoord;
+
+// NOTE: Screen quad drawn by DrawPostProcess() (see rpost.h)
+
+void main()
+{
+    fragTexCoord = vertexTexCoord;
+    gl_Position = mvp*vec4(vertexPosition, 1.0);
+}